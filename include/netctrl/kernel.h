@@ -0,0 +1,62 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_H
+#define NETCTRL_KERNEL_H
+
+/**
+ * \file kernel.h
+ *
+ * The kernels of the controllability models are templates that accept any
+ * graph type satisfying the following \em graph \em concept, so they can
+ * run on graph structures owned by the caller without converting them into
+ * an \c igraph::Graph first:
+ *
+ * - <tt>long int vertexCount() const</tt> returns the number of vertices;
+ *   vertices are identified by integers from zero to vertexCount()-1.
+ *
+ * - <tt>long int edgeCount() const</tt> returns the number of edges; edges
+ *   are identified by integers from zero to edgeCount()-1.
+ *
+ * - <tt>bool isDirected() const</tt> returns whether the graph is directed.
+ *
+ * - <tt>long int outDegree(long int v) const</tt> returns the number of
+ *   outbound edges of v; <tt>outNeighbor(v, i)</tt> and
+ *   <tt>outEdge(v, i)</tt> return the target and the ID of the i-th one.
+ *
+ * - <tt>long int inDegree(long int v) const</tt> returns the number of
+ *   inbound edges of v; <tt>inNeighbor(v, i)</tt> and <tt>inEdge(v, i)</tt>
+ *   return the source and the ID of the i-th one.
+ *
+ * For undirected graphs, the outbound and the inbound edges of a vertex are
+ * both the set of all the edges incident on the vertex.
+ *
+ * A \em masked \em view (e.g., \c EgoView or \c CommunityView) restricts a
+ * graph to a subset of its vertices or edges without copying it. It reports
+ * the full degrees of the vertices, but <tt>outNeighbor()</tt> and
+ * <tt>inNeighbor()</tt> return -1 for neighbors outside the view. Masked
+ * views that renumber the edges also return -1 from <tt>outEdge()</tt> and
+ * <tt>inEdge()</tt> for edges outside the view, and overload
+ * \c visibleOutDegree() and \c visibleInDegree() for the kernels that
+ * need the degrees within the view. Only the kernels that say so accept
+ * masked views.
+ *
+ * Adaptors are provided for igraph graphs (\c AdjacencyView) and for raw
+ * compressed sparse row arrays (\c CSRGraphView and \c CSRGraph).
+ */
+
+#include <netctrl/kernel/alternating_graph.h>
+#include <netctrl/kernel/communities.h>
+#include <netctrl/kernel/control_energy.h>
+#include <netctrl/kernel/dominating_set.h>
+#include <netctrl/kernel/ego.h>
+#include <netctrl/kernel/input_sets.h>
+#include <netctrl/kernel/edge_classes.h>
+#include <netctrl/kernel/matching.h>
+#include <netctrl/kernel/scc.h>
+#include <netctrl/kernel/sparse_rank.h>
+#include <netctrl/kernel/switchboard.h>
+#include <netctrl/kernel/zero_forcing.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/csr_graph.h>
+
+#endif
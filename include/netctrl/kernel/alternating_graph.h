@@ -0,0 +1,130 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_ALTERNATING_GRAPH_H
+#define NETCTRL_KERNEL_ALTERNATING_GRAPH_H
+
+#include <netctrl/util/directed_matching.h>
+
+namespace netctrl {
+
+/// Implicit directed bipartite graph oriented by a matching
+/**
+ * This is the directed bipartite graph used in the edge classification of
+ * the Liu model, without constructing it explicitly. Node \c v (for v < n)
+ * is the "bottom" (matched) copy of vertex v and node <tt>u+n</tt> is the
+ * "top" (matching) copy of vertex u. An edge u -> v of the original graph
+ * becomes <tt>v -> u+n</tt> if u is matched to v and <tt>u+n -> v</tt>
+ * otherwise.
+ *
+ * Both the outbound and the inbound edges of a node are enumerated by
+ * walking over a list of \em candidates (the inbound or outbound edges of
+ * the corresponding vertex in the original graph) and skipping those that
+ * point in the other direction; \c outEntry() and \c inEntry() return -1
+ * for these and for the candidates that lead out of a masked view.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h;
+ * masked views are supported.
+ */
+template <typename G>
+class AlternatingGraph {
+private:
+    /// The original graph
+    const G& m_graph;
+
+    /// The matching that orients the edges
+    const DirectedMatching& m_matching;
+
+    /// The number of vertices in the original graph
+    long int m_n;
+
+public:
+    /// Constructs the alternating graph of the given graph and matching
+    AlternatingGraph(const G& graph, const DirectedMatching& matching)
+        : m_graph(graph), m_matching(matching), m_n(graph.vertexCount()) {}
+
+    /// Returns the original graph
+    const G& graph() const {
+        return m_graph;
+    }
+
+    /// Returns the number of inbound edge candidates of the given node
+    long int inCandidates(long int x) const {
+        return x < m_n ? m_graph.inDegree(x) : m_graph.outDegree(x - m_n);
+    }
+
+    /// Returns the source of the i-th inbound edge candidate of the given node
+    /**
+     * \param  x     the node
+     * \param  i     the index of the candidate
+     * \param  edge  the ID of the edge in the original graph is returned here
+     * \return the source node, or -1 if the candidate is not an inbound edge
+     */
+    long int inEntry(long int x, long int i, long int* edge) const {
+        long int u, v;
+
+        if (x < m_n) {
+            u = m_graph.inNeighbor(x, i);
+            if (u < 0 || m_matching.matchOut(u) == x)
+                return -1;
+            *edge = m_graph.inEdge(x, i);
+            return u + m_n;
+        }
+
+        u = x - m_n;
+        v = m_graph.outNeighbor(u, i);
+        if (v < 0 || m_matching.matchOut(u) != v)
+            return -1;
+        *edge = m_graph.outEdge(u, i);
+        return v;
+    }
+
+    /// Returns the matching that orients the edges
+    const DirectedMatching& matching() const {
+        return m_matching;
+    }
+
+    /// Returns the number of nodes, i.e. twice the number of vertices
+    long int nodeCount() const {
+        return 2 * m_n;
+    }
+
+    /// Returns the number of outbound edge candidates of the given node
+    long int outCandidates(long int x) const {
+        return x < m_n ? m_graph.inDegree(x) : m_graph.outDegree(x - m_n);
+    }
+
+    /// Returns the target of the i-th outbound edge candidate of the given node
+    /**
+     * \param  x     the node
+     * \param  i     the index of the candidate
+     * \param  edge  the ID of the edge in the original graph is returned here
+     * \return the target node, or -1 if the candidate is not an outbound edge
+     */
+    long int outEntry(long int x, long int i, long int* edge) const {
+        long int u, v;
+
+        if (x < m_n) {
+            u = m_graph.inNeighbor(x, i);
+            if (u < 0 || m_matching.matchOut(u) != x)
+                return -1;
+            *edge = m_graph.inEdge(x, i);
+            return u + m_n;
+        }
+
+        u = x - m_n;
+        v = m_graph.outNeighbor(u, i);
+        if (v < 0 || m_matching.matchOut(u) == v)
+            return -1;
+        *edge = m_graph.outEdge(u, i);
+        return v;
+    }
+
+    /// Returns the number of vertices in the original graph
+    long int vertexCount() const {
+        return m_n;
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_ALTERNATING_GRAPH_H
@@ -0,0 +1,386 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_COMMUNITIES_H
+#define NETCTRL_KERNEL_COMMUNITIES_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <netctrl/kernel/edge_classes.h>
+#include <netctrl/kernel/matching.h>
+#include <netctrl/kernel/switchboard.h>
+#include <netctrl/util/directed_matching.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Index of a partition of the vertices of a graph into communities
+/**
+ * The index assigns consecutive local IDs to the vertices and the edges of
+ * each community, and to the edges between different communities and their
+ * endpoints, so \c CommunityView can present any of them as a graph on its
+ * own without copying it. Vertices may be left out of the partition; they
+ * belong to no community and their edges are ignored.
+ *
+ * Building the index costs time linear in the size of the graph; the index
+ * is shared by all the views over the graph.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class CommunityPartition {
+private:
+    /// The underlying graph
+    const G& m_graph;
+
+    /// The community of each vertex, or -1 if it belongs to no community
+    std::vector<long int> m_membership;
+
+    /// The number of communities
+    long int m_communityCount;
+
+    /// The vertices grouped by community; the last group lists the vertices
+    /// incident on inter-community edges
+    std::vector<long int> m_vertices;
+
+    /// Start of the group of each community in \c m_vertices
+    std::vector<long int> m_vertexOffsets;
+
+    /// Index of each vertex within its community
+    std::vector<long int> m_localIds;
+
+    /// Index of each vertex among the endpoints of inter-community edges, or -1
+    std::vector<long int> m_crossingLocalIds;
+
+    /// Index of each edge within its community or among the inter-community
+    /// edges, or -1 if it is incident on a vertex without a community
+    std::vector<long int> m_localEdgeIds;
+
+    /// The number of edges in each community and between the communities
+    std::vector<long int> m_edgeCounts;
+
+public:
+    /// Builds the index of the given partition
+    /**
+     * \param  graph       the graph
+     * \param  membership  the community of each vertex, numbered from zero,
+     *                     or -1 for vertices that belong to no community
+     */
+    CommunityPartition(const G& graph, const std::vector<long int>& membership);
+
+    /// Returns the community of the given vertex, or -1
+    long int community(long int v) const {
+        return m_membership[v];
+    }
+
+    /// Returns the number of communities
+    long int communityCount() const {
+        return m_communityCount;
+    }
+
+    /// Returns the index that denotes the edges between the communities
+    long int crossing() const {
+        return m_communityCount;
+    }
+
+    /// Returns the number of edges in a community or between the communities
+    long int edgeCount(long int community) const {
+        return m_edgeCounts[community];
+    }
+
+    /// Returns the underlying graph
+    const G& graph() const {
+        return m_graph;
+    }
+
+    /// Returns the local ID of a vertex within a community or among the
+    /// endpoints of the edges between the communities
+    long int localId(long int community, long int v) const {
+        return community == m_communityCount ? m_crossingLocalIds[v] : m_localIds[v];
+    }
+
+    /// Returns the local ID of an edge
+    long int localEdgeId(long int e) const {
+        return m_localEdgeIds[e];
+    }
+
+    /// Returns the vertex with the given local ID in a community or among the
+    /// endpoints of the edges between the communities
+    long int vertex(long int community, long int v) const {
+        return m_vertices[m_vertexOffsets[community] + v];
+    }
+
+    /// Returns the number of vertices in a community or incident on the
+    /// edges between the communities
+    long int vertexCount(long int community) const {
+        return m_vertexOffsets[community + 1] - m_vertexOffsets[community];
+    }
+
+    /// Returns whether an edge from u to v belongs to the given community
+    /// or to the edges between the communities
+    bool isVisible(long int community, long int u, long int v) const {
+        long int c = m_membership[v];
+        if (community == m_communityCount)
+            return c >= 0 && c != m_membership[u];
+        return c == community;
+    }
+};
+
+/// Masked view of a community or of the edges between the communities
+/**
+ * A view over a \c CommunityPartition presents either the subgraph induced
+ * by a community or the subgraph formed by the edges between different
+ * communities and their endpoints. The vertices and the edges are
+ * renumbered from zero by the partition; neighbors and edges outside the
+ * view are reported as -1. See the description of masked views in
+ * \c netctrl/kernel.h.
+ *
+ * Views are cheap to construct as all the bookkeeping is done by the
+ * partition, so any number of them can be used concurrently.
+ */
+template <typename G>
+class CommunityView {
+private:
+    /// The partition that the view belongs to
+    const CommunityPartition<G>& m_partition;
+
+    /// The underlying graph
+    const G& m_graph;
+
+    /// The community being viewed or \c CommunityPartition::crossing()
+    long int m_community;
+
+public:
+    /// Constructs a view of the given community or of the edges between the
+    /// communities if \c community is equal to <tt>partition.crossing()</tt>
+    CommunityView(const CommunityPartition<G>& partition, long int community)
+        : m_partition(partition), m_graph(partition.graph()), m_community(community) {}
+
+    /// Returns the vertex of the underlying graph for a vertex of the view
+    long int globalId(long int v) const {
+        return m_partition.vertex(m_community, v);
+    }
+
+    // Methods required by the graph concept; see netctrl/kernel.h
+
+    long int edgeCount() const {
+        return m_partition.edgeCount(m_community);
+    }
+
+    long int inDegree(long int v) const {
+        return m_graph.inDegree(globalId(v));
+    }
+
+    long int inEdge(long int v, long int i) const {
+        long int u = globalId(v);
+        return m_partition.isVisible(m_community, u, m_graph.inNeighbor(u, i)) ?
+            m_partition.localEdgeId(m_graph.inEdge(u, i)) : -1;
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        long int u = globalId(v), w = m_graph.inNeighbor(u, i);
+        return m_partition.isVisible(m_community, u, w) ?
+            m_partition.localId(m_community, w) : -1;
+    }
+
+    bool isDirected() const {
+        return m_graph.isDirected();
+    }
+
+    long int outDegree(long int v) const {
+        return m_graph.outDegree(globalId(v));
+    }
+
+    long int outEdge(long int v, long int i) const {
+        long int u = globalId(v);
+        return m_partition.isVisible(m_community, u, m_graph.outNeighbor(u, i)) ?
+            m_partition.localEdgeId(m_graph.outEdge(u, i)) : -1;
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        long int u = globalId(v), w = m_graph.outNeighbor(u, i);
+        return m_partition.isVisible(m_community, u, w) ?
+            m_partition.localId(m_community, w) : -1;
+    }
+
+    long int vertexCount() const {
+        return m_partition.vertexCount(m_community);
+    }
+};
+
+/// Returns the number of outbound edges of a vertex within a community view
+template <typename G>
+long int visibleOutDegree(const CommunityView<G>& view, long int v) {
+    long int i, k = view.outDegree(v), result = 0;
+    for (i = 0; i < k; i++) {
+        if (view.outNeighbor(v, i) >= 0)
+            result++;
+    }
+    return result;
+}
+
+/// Returns the number of inbound edges of a vertex within a community view
+template <typename G>
+long int visibleInDegree(const CommunityView<G>& view, long int v) {
+    long int i, k = view.inDegree(v), result = 0;
+    for (i = 0; i < k; i++) {
+        if (view.inNeighbor(v, i) >= 0)
+            result++;
+    }
+    return result;
+}
+
+/// Controllability of a community in the Liu and the switchboard models
+struct CommunityControllability {
+    /// The number of vertices in the community
+    long int vertexCount;
+
+    /// The number of edges in the community
+    long int edgeCount;
+
+    /// The number of driver nodes in the Liu model; at least one unless the
+    /// community is empty
+    long int liuDriverCount;
+
+    /// The number of edges in each \c EdgeClass in the Liu model
+    long int liuEdgeCounts[EDGE_DISTINGUISHED + 1];
+
+    /// The number of driver nodes in the switchboard model
+    long int switchboardDriverCount;
+
+    /// The number of edges in each \c EdgeClass in the switchboard model
+    long int switchboardEdgeCounts[EDGE_DISTINGUISHED + 1];
+};
+
+/**
+ * \brief Calculates the driver nodes and the edge classes of the Liu and
+ *        the switchboard models for the subgraph induced by each community
+ *        of a graph and for the edges between the communities.
+ *
+ * The subgraphs are never copied; they are \c CommunityView instances over
+ * a shared \c CommunityPartition. They are processed on all the threads of
+ * the library (see \c setThreadCount()), largest first, each thread having
+ * its own matching workspace. The results for a community are the same as
+ * what the models report for a copy of the induced subgraph.
+ *
+ * \param  graph       the graph; must satisfy the graph concept described
+ *                     in \c netctrl/kernel.h
+ * \param  membership  the community of each vertex, numbered from zero, or
+ *                     -1 for vertices that belong to no community
+ * \param  results     the results for each community are returned here,
+ *                     followed by the results for the subgraph formed by
+ *                     the edges between different communities
+ */
+template <typename G>
+void communityControllability(const G& graph, const std::vector<long int>& membership,
+        std::vector<CommunityControllability>& results) {
+    CommunityPartition<G> partition(graph, membership);
+    long int i, numViews = partition.communityCount() + 1;
+    std::vector<long int> order(numViews);
+    std::atomic<long int> next(0);
+
+    results.resize(numViews);
+    for (i = 0; i < numViews; i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](long int a, long int b) {
+        return partition.edgeCount(a) + partition.vertexCount(a) >
+            partition.edgeCount(b) + partition.vertexCount(b);
+    });
+
+    parallelFor(0, std::min<long int>(threadCount(), numViews), [&](long int) {
+        MatchingEngine<CommunityView<G> > engine;
+        DirectedMatching matching;
+        igraph::VectorInt driverNodes;
+        long int index;
+
+        while ((index = next.fetch_add(1)) < numViews) {
+            long int community = order[index];
+            CommunityView<G> view(partition, community);
+            CommunityControllability& result = results[community];
+
+            result.vertexCount = view.vertexCount();
+            result.edgeCount = view.edgeCount();
+
+            // A perfect matching still needs one driver node, as in the
+            // Liu model; only an empty community needs none
+            matching = DirectedMatching();
+            result.liuDriverCount = view.vertexCount() - engine.run(view, matching);
+            if (result.liuDriverCount == 0 && view.vertexCount() > 0)
+                result.liuDriverCount = 1;
+            countLiuEdgeClasses(view, matching, result.liuEdgeCounts);
+
+            findSwitchboardDriverNodes(view, driverNodes);
+            result.switchboardDriverCount = driverNodes.size();
+            countSwitchboardEdgeClasses(view, result.switchboardEdgeCounts);
+        }
+    });
+}
+
+
+/*************************************************************************/
+
+
+template <typename G>
+CommunityPartition<G>::CommunityPartition(const G& graph,
+        const std::vector<long int>& membership)
+    : m_graph(graph), m_membership(membership), m_communityCount(0), m_vertices(),
+    m_vertexOffsets(), m_localIds(graph.vertexCount(), -1),
+    m_crossingLocalIds(graph.vertexCount(), -1),
+    m_localEdgeIds(graph.edgeCount(), -1), m_edgeCounts() {
+    long int i, k, u, v, e, c, n = graph.vertexCount();
+
+    for (u = 0; u < n; u++)
+        m_communityCount = std::max(m_communityCount, m_membership[u] + 1);
+
+    // Group the vertices by community with a counting sort
+    m_vertexOffsets.assign(m_communityCount + 2, 0);
+    for (u = 0; u < n; u++) {
+        if (m_membership[u] >= 0)
+            m_vertexOffsets[m_membership[u] + 1]++;
+    }
+    for (c = 0; c < m_communityCount; c++)
+        m_vertexOffsets[c + 1] += m_vertexOffsets[c];
+    m_vertices.resize(m_vertexOffsets[m_communityCount]);
+    std::vector<long int> sizes(m_communityCount, 0);
+    for (u = 0; u < n; u++) {
+        if ((c = m_membership[u]) >= 0) {
+            m_localIds[u] = sizes[c]++;
+            m_vertices[m_vertexOffsets[c] + m_localIds[u]] = u;
+        }
+    }
+
+    // Number the edges within each community and between the communities;
+    // undirected edges are seen from both endpoints
+    m_edgeCounts.assign(m_communityCount + 1, 0);
+    for (u = 0; u < n; u++) {
+        if ((c = m_membership[u]) < 0)
+            continue;
+
+        k = graph.outDegree(u);
+        for (i = 0; i < k; i++) {
+            v = graph.outNeighbor(u, i);
+            e = graph.outEdge(u, i);
+            if (m_membership[v] < 0 || m_localEdgeIds[e] >= 0)
+                continue;
+
+            if (m_membership[v] == c) {
+                m_localEdgeIds[e] = m_edgeCounts[c]++;
+            } else {
+                m_localEdgeIds[e] = m_edgeCounts[m_communityCount]++;
+                if (m_crossingLocalIds[u] < 0) {
+                    m_crossingLocalIds[u] = m_vertices.size() - m_vertexOffsets[m_communityCount];
+                    m_vertices.push_back(u);
+                }
+                if (m_crossingLocalIds[v] < 0) {
+                    m_crossingLocalIds[v] = m_vertices.size() - m_vertexOffsets[m_communityCount];
+                    m_vertices.push_back(v);
+                }
+            }
+        }
+    }
+    m_vertexOffsets[m_communityCount + 1] = m_vertices.size();
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_COMMUNITIES_H
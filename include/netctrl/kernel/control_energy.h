@@ -0,0 +1,632 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_CONTROL_ENERGY_H
+#define NETCTRL_KERNEL_CONTROL_ENERGY_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <netctrl/kernel/sparse_rank.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Options of \c estimateGramian()
+struct GramianOptions {
+    /// The matrix of the dynamics is divided by this number; zero means one
+    /// plus an upper bound of the largest singular value of the matrix (see
+    /// \c singularValueBound()), which makes the dynamics stable
+    double scale;
+
+    /// The largest number of time steps taken into account
+    long int maxHorizon;
+
+    /// The series of the Gramian is truncated when the relative contribution
+    /// of a time step drops below this value
+    double tolerance;
+
+    /// The number of Lanczos steps used for the extreme eigenvalues
+    long int lanczosSteps;
+
+    /// The trace is calculated exactly for at most this many driver nodes;
+    /// for more, it is estimated from this many random probe vectors
+    long int traceProbes;
+
+    /// The number of impulse responses or probe vectors that are propagated
+    /// together when calculating the trace
+    long int blockSize;
+
+    GramianOptions() : scale(0.0), maxHorizon(1000), tolerance(1e-8),
+        lanczosSteps(30), traceProbes(64), blockSize(16) {}
+};
+
+/// Estimated properties of a controllability Gramian; see \c estimateGramian()
+struct GramianEstimate {
+    /// The number the matrix of the dynamics was divided by
+    double scale;
+
+    /// The number of time steps after which the series was truncated
+    long int horizon;
+
+    /// The trace of the Gramian, i.e. the average controllability
+    double trace;
+
+    /// Whether the trace was calculated exactly instead of being estimated
+    /// from random probes
+    bool exactTrace;
+
+    /// The largest eigenvalue of the Gramian
+    double largestEigenvalue;
+
+    /// The smallest Ritz value of the Gramian; an upper bound of its smallest
+    /// eigenvalue
+    double smallestEigenvalue;
+
+    /// The number of Lanczos steps taken
+    long int lanczosSteps;
+
+    GramianEstimate() : scale(0.0), horizon(0), trace(0.0), exactTrace(true),
+        largestEigenvalue(0.0), smallestEigenvalue(0.0), lanczosSteps(0) {}
+
+    /// Returns the energy needed to reach a unit state in the easiest direction
+    double minimumEnergy() const {
+        return largestEigenvalue > 0 ? 1.0 / largestEigenvalue :
+            std::numeric_limits<double>::infinity();
+    }
+
+    /// Returns the energy needed to reach a unit state in the hardest
+    /// direction; a lower bound since \c smallestEigenvalue is an upper bound
+    double maximumEnergy() const {
+        return smallestEigenvalue > 0 ? 1.0 / smallestEigenvalue :
+            std::numeric_limits<double>::infinity();
+    }
+};
+
+/// Number of rows that a thread processes at once in the vector kernels below
+const long int ENERGY_ROW_BLOCK = 4096;
+
+/// Returns the number of row blocks of a vector of length n
+inline long int energyBlockCount(long int n) {
+    return (n + ENERGY_ROW_BLOCK - 1) / ENERGY_ROW_BLOCK;
+}
+
+/**
+ * \brief The rows of the vectors that one thread of a team works on.
+ *
+ * The kernels below run on a team of threads started by \c parallelTeam(),
+ * which synchronize with a barrier between the steps of a calculation
+ * instead of being started for each step. Each thread gets a contiguous
+ * range of row blocks, so a thread writes the same rows in every step.
+ */
+struct EnergyRows {
+    /// The first row block of the thread and the block after its last one
+    long int firstBlock, endBlock;
+
+    /// The first row of the thread and the row after its last one
+    long int begin, end;
+
+    /// Calculates the rows of the given thread of a team
+    EnergyRows(long int n, long int thread, long int numThreads) {
+        long int numBlocks = energyBlockCount(n);
+        firstBlock = numBlocks * thread / numThreads;
+        endBlock = numBlocks * (thread + 1) / numThreads;
+        begin = std::min(n, firstBlock * ENERGY_ROW_BLOCK);
+        end = std::min(n, endBlock * ENERGY_ROW_BLOCK);
+    }
+
+    /// Returns whether the given row belongs to the thread
+    bool contains(long int row) const {
+        return row >= begin && row < end;
+    }
+};
+
+/// Returns the number of threads in a team that works on vectors of length n
+inline long int energyTeamSize(long int n) {
+    return std::max(1L, std::min<long int>(threadCount(), energyBlockCount(n)));
+}
+
+/**
+ * \brief Multiplies a block of vectors by a sparse matrix in the rows of
+ *        one thread.
+ *
+ * Calculates the given rows of <tt>Y = factor * A * X</tt> where X and Y
+ * have \c columns columns and are stored row by row. X must not change
+ * while the rows are calculated.
+ */
+inline void multiplySparseRows(const SparseMatrix& matrix, double factor, const double* x,
+        double* y, long int columns, const EnergyRows& rows) {
+    long int i, j, k;
+
+    if (columns == 1) {
+        for (i = rows.begin; i < rows.end; i++) {
+            double sum = 0.0;
+            for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++)
+                sum += matrix.values[k] * x[matrix.columns[k]];
+            y[i] = factor * sum;
+        }
+        return;
+    }
+
+    for (i = rows.begin; i < rows.end; i++) {
+        double* row = y + i * columns;
+        std::fill(row, row + columns, 0.0);
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++) {
+            const double* source = x + matrix.columns[k] * columns;
+            double value = factor * matrix.values[k];
+            for (j = 0; j < columns; j++)
+                row[j] += value * source[j];
+        }
+    }
+}
+
+/**
+ * \brief Calculates the partial dot products of two blocks of vectors in
+ *        the row blocks of one thread.
+ *
+ * The partial sum of each row block is stored in \c partial at the index of
+ * the block; \c sumBlocks() adds them up. The partial sums are added in a
+ * fixed order, so the result does not depend on the number of threads.
+ */
+inline void blockDotProducts(const double* x, const double* y, long int columns,
+        const EnergyRows& rows, double* partial) {
+    long int block, i;
+
+    for (block = rows.firstBlock; block < rows.endBlock; block++) {
+        long int begin = std::max(rows.begin, block * ENERGY_ROW_BLOCK) * columns;
+        long int end = std::min(rows.end, (block + 1) * ENERGY_ROW_BLOCK) * columns;
+        double sum = 0.0;
+        for (i = begin; i < end; i++)
+            sum += x[i] * y[i];
+        partial[block] = sum;
+    }
+}
+
+/// Adds up the partial sums of the row blocks calculated by \c blockDotProducts()
+inline double sumBlocks(const double* partial, long int numBlocks) {
+    double result = 0.0;
+    long int block;
+
+    for (block = 0; block < numBlocks; block++)
+        result += partial[block];
+    return result;
+}
+
+/**
+ * \brief Removes the components of a vector along a set of orthonormal
+ *        vectors.
+ *
+ * Classical Gram-Schmidt in blocked form: one team of threads calculates
+ * the coefficients along all the vectors in a single pass over the rows,
+ * and then subtracts all the components in a second one, so the vector is
+ * read twice instead of twice per basis vector.
+ *
+ * \param  basis         the orthonormal vectors
+ * \param  count         the number of vectors in \c basis to use
+ * \param  w             the vector of length \c n to orthogonalize
+ * \param  n             the length of the vectors
+ * \param  coefficients  the coefficients of \c w along the vectors, before
+ *                       they were removed, are returned here
+ * \return the squared norm of the orthogonalized vector
+ */
+inline double orthogonalize(const std::vector<std::vector<double> >& basis, long int count,
+        double* w, long int n, std::vector<double>& coefficients) {
+    long int numBlocks = energyBlockCount(n);
+    std::vector<double> partial(numBlocks * (count + 1));
+
+    coefficients.assign(count, 0.0);
+    parallelTeam(energyTeamSize(n), [&](long int thread, long int numThreads, Barrier& barrier) {
+        EnergyRows rows(n, thread, numThreads);
+        long int block, i, j;
+
+        for (j = 0; j < count; j++)
+            blockDotProducts(w, &basis[j][0], 1, rows, &partial[j * numBlocks]);
+        barrier.wait();
+
+        if (thread == 0) {
+            for (j = 0; j < count; j++)
+                coefficients[j] = sumBlocks(&partial[j * numBlocks], numBlocks);
+        }
+        barrier.wait();
+
+        // One row block at a time, so that it stays in the cache while the
+        // components along all the vectors are subtracted
+        for (block = rows.firstBlock; block < rows.endBlock; block++) {
+            long int begin = block * ENERGY_ROW_BLOCK, end = std::min(n, begin + ENERGY_ROW_BLOCK);
+            for (j = 0; j < count; j++) {
+                const double* q = &basis[j][0];
+                double coefficient = coefficients[j];
+                for (i = begin; i < end; i++)
+                    w[i] -= coefficient * q[i];
+            }
+        }
+        blockDotProducts(w, w, 1, rows, &partial[count * numBlocks]);
+    });
+
+    return sumBlocks(&partial[count * numBlocks], numBlocks);
+}
+
+/// Calculates the transpose of a sparse matrix
+inline void transposeSparse(const SparseMatrix& matrix, SparseMatrix& result) {
+    long int i, k, n = matrix.size;
+
+    result.size = n;
+    result.offsets.assign(n + 1, 0);
+    result.columns.resize(matrix.columns.size());
+    result.values.resize(matrix.values.size());
+
+    for (k = 0; k < static_cast<long int>(matrix.columns.size()); k++)
+        result.offsets[matrix.columns[k] + 1]++;
+    for (i = 0; i < n; i++)
+        result.offsets[i + 1] += result.offsets[i];
+
+    std::vector<long int> next(result.offsets.begin(), result.offsets.end() - 1);
+    for (i = 0; i < n; i++) {
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++) {
+            long int position = next[matrix.columns[k]]++;
+            result.columns[position] = i;
+            result.values[position] = matrix.values[k];
+        }
+    }
+}
+
+/**
+ * \brief Smallest or largest eigenvalue of a symmetric tridiagonal matrix.
+ *
+ * Uses bisection on the Sturm sequence, which needs no workspace and is
+ * accurate to about the machine precision relative to the spectrum.
+ *
+ * \param  diagonal     the diagonal entries
+ * \param  offDiagonal  the entries below (and above) the diagonal; the first
+ *                      \c k-1 elements are used
+ * \param  k            the size of the matrix
+ * \param  largest      whether the largest eigenvalue is needed
+ */
+inline double tridiagonalExtremeEigenvalue(const std::vector<double>& diagonal,
+        const std::vector<double>& offDiagonal, long int k, bool largest) {
+    long int i, count;
+    double low, high, middle, d, radius = 0.0;
+
+    // Gershgorin bounds of the spectrum
+    low = std::numeric_limits<double>::max();
+    high = -low;
+    for (i = 0; i < k; i++) {
+        radius = (i > 0 ? std::fabs(offDiagonal[i-1]) : 0.0) +
+            (i < k - 1 ? std::fabs(offDiagonal[i]) : 0.0);
+        low = std::min(low, diagonal[i] - radius);
+        high = std::max(high, diagonal[i] + radius);
+    }
+
+    while (high - low > 1e-15 * std::max(std::fabs(low), std::fabs(high)) &&
+            high - low > std::numeric_limits<double>::min()) {
+        middle = low + (high - low) / 2;
+        if (middle == low || middle == high)
+            break;
+
+        // The number of eigenvalues below middle
+        count = 0;
+        d = 1.0;
+        for (i = 0; i < k; i++) {
+            d = diagonal[i] - middle -
+                (i > 0 ? offDiagonal[i-1] * offDiagonal[i-1] / d : 0.0);
+            if (d == 0)
+                d = std::numeric_limits<double>::min();
+            if (d < 0)
+                count++;
+        }
+
+        if (largest ? count < k : count < 1)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    return low + (high - low) / 2;
+}
+
+/**
+ * \brief Estimates the extreme eigenvalues of a symmetric positive
+ *        semidefinite operator with the Lanczos method.
+ *
+ * The basis vectors are fully reorthogonalized, so the method is stable
+ * but keeps all of them in memory. The largest Ritz value converges
+ * quickly to the largest eigenvalue; the smallest one is an upper bound of
+ * the smallest eigenvalue and converges more slowly.
+ *
+ * \param  op         the operator; <tt>op.apply(x, y)</tt> must calculate
+ *                    <tt>y = M x</tt> for vectors of length \c n
+ * \param  n          the size of the operator
+ * \param  maxSteps   the largest number of steps
+ * \param  largest    the largest Ritz value is returned here
+ * \param  smallest   the smallest Ritz value is returned here, if not null
+ * \return the number of steps taken, which is smaller than \c maxSteps if
+ *         an invariant subspace was found
+ */
+template <typename Operator>
+long int lanczosExtremeEigenvalues(Operator& op, long int n, long int maxSteps,
+        double* largest, double* smallest = 0) {
+    long int i, step;
+    std::vector<std::vector<double> > basis;
+    std::vector<double> alpha, beta, coefficients, w(n);
+    double norm;
+
+    *largest = 0.0;
+    if (smallest)
+        *smallest = 0.0;
+    maxSteps = std::min(maxSteps, n);
+    if (maxSteps <= 0)
+        return 0;
+
+    // A fixed start vector that is not orthogonal to the dominant
+    // eigenvectors of the usual structures
+    basis.push_back(std::vector<double>(n));
+    norm = 0.0;
+    for (i = 0; i < n; i++) {
+        basis[0][i] = 1.0 + (i % 5) / 5.0;
+        norm += basis[0][i] * basis[0][i];
+    }
+    norm = std::sqrt(norm);
+    for (i = 0; i < n; i++)
+        basis[0][i] /= norm;
+
+    for (step = 0; step < maxSteps; step++) {
+        op.apply(&basis[step][0], &w[0]);
+
+        // Full reorthogonalization, twice for numerical safety. The first
+        // coefficient along the newest basis vector is the Rayleigh quotient.
+        orthogonalize(basis, step + 1, &w[0], n, coefficients);
+        alpha.push_back(coefficients[step]);
+        norm = std::sqrt(orthogonalize(basis, step + 1, &w[0], n, coefficients));
+        if (step + 1 == maxSteps || norm <= 1e-12 * std::fabs(alpha[0]))
+            break;
+
+        beta.push_back(norm);
+        basis.push_back(std::vector<double>(n));
+        for (i = 0; i < n; i++)
+            basis[step + 1][i] = w[i] / norm;
+    }
+
+    step = alpha.size();
+    *largest = tridiagonalExtremeEigenvalue(alpha, beta, step, true);
+    if (smallest)
+        *smallest = tridiagonalExtremeEigenvalue(alpha, beta, step, false);
+    return step;
+}
+
+/// Returns an upper bound of the largest singular value of a sparse matrix
+/**
+ * The bound is the smaller of the Frobenius norm of A and
+ * <tt>sqrt(|A|_1 * |A|_inf)</tt>, the geometric mean of the largest absolute
+ * column and row sums. Both are never smaller than the largest singular
+ * value, unlike an estimate from a few Lanczos steps, so dividing A by one
+ * plus the bound is guaranteed to make the dynamics stable.
+ */
+inline double singularValueBound(const SparseMatrix& matrix) {
+    long int i, k, n = matrix.size;
+    double frobenius = 0.0, maxRowSum = 0.0, maxColumnSum = 0.0, rowSum, value;
+    std::vector<double> columnSums(n, 0.0);
+
+    for (i = 0; i < n; i++) {
+        rowSum = 0.0;
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++) {
+            value = std::fabs(matrix.values[k]);
+            rowSum += value;
+            columnSums[matrix.columns[k]] += value;
+            frobenius += value * value;
+        }
+        maxRowSum = std::max(maxRowSum, rowSum);
+    }
+    for (i = 0; i < n; i++)
+        maxColumnSum = std::max(maxColumnSum, columnSums[i]);
+
+    return std::min(std::sqrt(frobenius), std::sqrt(maxRowSum * maxColumnSum));
+}
+
+/**
+ * \brief Matrix-free controllability Gramian of a discrete-time linear
+ *        system with the given driver nodes.
+ *
+ * The system is <tt>x(t+1) = A x(t) / scale + B u(t)</tt> where the columns
+ * of B are the unit vectors of the driver nodes, and the Gramian over
+ * \c horizon steps is
+ * <tt>W = sum_{t < horizon} (A/scale)^t B B^T (A^T/scale)^t</tt>.
+ * \c apply() multiplies a vector by W with <tt>2*horizon</tt> sparse
+ * matrix-vector products and keeps <tt>horizon</tt> values per driver node;
+ * W itself is never formed.
+ */
+class GramianOperator {
+private:
+    const SparseMatrix& m_matrix;
+    const SparseMatrix& m_transpose;
+    const std::vector<long int>& m_drivers;
+    double m_factor;
+    long int m_horizon;
+
+    /// The projections of the powers of the transpose onto the driver nodes
+    std::vector<double> m_projections;
+
+    std::vector<double> m_current, m_next;
+
+public:
+    /// Constructs the Gramian of the given system
+    GramianOperator(const SparseMatrix& matrix, const SparseMatrix& transpose,
+            const std::vector<long int>& drivers, double scale, long int horizon)
+        : m_matrix(matrix), m_transpose(transpose), m_drivers(drivers),
+        m_factor(1.0 / scale), m_horizon(horizon),
+        m_projections(horizon * drivers.size()), m_current(matrix.size),
+        m_next(matrix.size) {}
+
+    /// Calculates <tt>y = W x</tt>
+    /**
+     * All the time steps run on one team of threads; each thread calculates
+     * its own rows of every product and handles the driver nodes among them.
+     */
+    void apply(const double* x, double* y) {
+        long int n = m_matrix.size, d = m_drivers.size();
+
+        parallelTeam(energyTeamSize(n), [&](long int thread, long int numThreads, Barrier& barrier) {
+            EnergyRows rows(n, thread, numThreads);
+            double* current = &m_current[0];
+            double* next = &m_next[0];
+            long int i, t;
+
+            // B^T (A^T)^t x for each t
+            std::copy(x + rows.begin, x + rows.end, current + rows.begin);
+            barrier.wait();
+            for (t = 0; t < m_horizon; t++) {
+                for (i = 0; i < d; i++) {
+                    if (rows.contains(m_drivers[i]))
+                        m_projections[t * d + i] = current[m_drivers[i]];
+                }
+                if (t + 1 < m_horizon) {
+                    multiplySparseRows(m_transpose, m_factor, current, next, 1, rows);
+                    barrier.wait();
+                    std::swap(current, next);
+                }
+            }
+
+            // Horner's scheme: y = sum_t A^t B p_t
+            current = y;
+            next = &m_next[0];
+            std::fill(y + rows.begin, y + rows.end, 0.0);
+            for (t = m_horizon - 1; t >= 0; t--) {
+                if (t + 1 < m_horizon) {
+                    multiplySparseRows(m_matrix, m_factor, current, next, 1, rows);
+                    std::swap(current, next);
+                }
+                for (i = 0; i < d; i++) {
+                    if (rows.contains(m_drivers[i]))
+                        current[m_drivers[i]] += m_projections[t * d + i];
+                }
+                barrier.wait();
+            }
+            if (current != y)
+                std::copy(current + rows.begin, current + rows.end, y + rows.begin);
+        });
+    }
+};
+
+/**
+ * \brief Estimates the controllability Gramian of the given driver nodes
+ *        without forming any dense n-by-n matrix.
+ *
+ * The dynamics is <tt>x(t+1) = A x(t) / scale + B u(t)</tt>, where A is the
+ * given matrix (<tt>A[v][u]</tt> is the weight of the edge from u to v) and
+ * B injects an input into each driver node. The default scale is one plus
+ * an upper bound of the largest singular value of A, so the dynamics is
+ * always stable; the average controllability of Gu et al uses the largest
+ * singular value itself, which can only be estimated from below here.
+ *
+ * The trace of the Gramian is the sum of the squared Frobenius norms of
+ * <tt>(A/scale)^t B</tt>. With at most \c traceProbes driver nodes, the
+ * impulse responses of the driver nodes are propagated; otherwise, the
+ * responses to random +1/-1 combinations of the driver nodes are, and the
+ * mean of their squared norms is an unbiased estimate (Hutchinson's
+ * method). Blocks of responses are propagated together with the
+ * multi-column sparse product, so each pass over the matrix serves the
+ * whole block. The series is truncated when a step adds less than the
+ * tolerance; the number of steps needed is the horizon. The extreme
+ * eigenvalues are then estimated with the Lanczos method on
+ * \c GramianOperator over the same horizon, with full reorthogonalization
+ * against the at most \c lanczosSteps basis vectors. The memory use is
+ * <tt>O(n * (blockSize + lanczosSteps) + horizon * drivers)</tt>, and the
+ * running time is proportional to the number of nonzeros of A times the
+ * horizon times <tt>min(drivers, traceProbes) + 2 * lanczosSteps</tt>.
+ *
+ * \param  matrix   the matrix A of the dynamics
+ * \param  drivers  the driver nodes
+ * \param  result   the estimates are returned here
+ * \param  options  the parameters of the estimates
+ */
+inline void estimateGramian(const SparseMatrix& matrix, const std::vector<long int>& drivers,
+        GramianEstimate& result, const GramianOptions& options = GramianOptions()) {
+    long int i, j, t, n = matrix.size, d = drivers.size();
+    long int blockSize = std::max(1L, options.blockSize), numColumns;
+    long int numBlocks = energyBlockCount(n);
+    SparseMatrix transpose;
+    double factor, weight;
+    unsigned long state = 0x2545F4914F6CDD1DUL;
+
+    result = GramianEstimate();
+    transposeSparse(matrix, transpose);
+
+    result.scale = options.scale > 0 ? options.scale :
+        1.0 + singularValueBound(matrix);
+    factor = 1.0 / result.scale;
+
+    if (n == 0 || d == 0)
+        return;
+
+    // The trace, one block of impulse responses or probes at a time
+    result.exactTrace = (d <= options.traceProbes || options.traceProbes <= 0);
+    numColumns = result.exactTrace ? d : options.traceProbes;
+    weight = result.exactTrace ? 1.0 : 1.0 / numColumns;
+    std::vector<double> current(n * std::min(blockSize, numColumns)), next(current.size());
+    std::vector<double> partial(2 * numBlocks);
+    for (i = 0; i < numColumns; i += blockSize) {
+        long int columns = std::min(blockSize, numColumns - i), k;
+        double blockTrace = 0.0;
+
+        std::fill(current.begin(), current.end(), 0.0);
+        if (result.exactTrace) {
+            for (j = 0; j < columns; j++)
+                current[drivers[i + j] * columns + j] = 1.0;
+        } else {
+            for (k = 0; k < d; k++) {
+                for (j = 0; j < columns; j++) {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    current[drivers[k] * columns + j] = (state & 1) ? 1.0 : -1.0;
+                }
+            }
+        }
+
+        // The whole series of the block runs on one team of threads. The
+        // partial sums of consecutive steps go to alternate halves of
+        // partial, so a thread writing the next step cannot overwrite the
+        // sums that a slower thread still adds up; all the threads add them
+        // up in the same order and stop at the same step.
+        parallelTeam(energyTeamSize(n), [&](long int thread, long int numThreads, Barrier& barrier) {
+            EnergyRows rows(n, thread, numThreads);
+            double* source = &current[0];
+            double* target = &next[0];
+            double* sums;
+            double sum = 0.0, term;
+            long int step;
+
+            for (step = 0; step < options.maxHorizon; step++) {
+                if (step > 0) {
+                    multiplySparseRows(matrix, factor, source, target, columns, rows);
+                    std::swap(source, target);
+                }
+                sums = &partial[(step % 2) * numBlocks];
+                blockDotProducts(source, source, columns, rows, sums);
+                barrier.wait();
+
+                term = sumBlocks(sums, numBlocks);
+                sum += term;
+                if (term <= options.tolerance * sum)
+                    break;
+            }
+
+            if (thread == 0) {
+                blockTrace = sum;
+                t = step;
+            }
+        });
+
+        result.trace += weight * blockTrace;
+        result.horizon = std::max(result.horizon, std::min(t + 1, options.maxHorizon));
+    }
+
+    // The extreme eigenvalues with the Lanczos method
+    GramianOperator gramian(matrix, transpose, drivers, result.scale, result.horizon);
+    result.lanczosSteps = lanczosExtremeEigenvalues(gramian, n, options.lanczosSteps,
+            &result.largestEigenvalue, &result.smallestEigenvalue);
+    result.smallestEigenvalue = std::max(0.0, result.smallestEigenvalue);
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_CONTROL_ENERGY_H
@@ -0,0 +1,463 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_DOMINATING_SET_H
+#define NETCTRL_KERNEL_DOMINATING_SET_H
+
+#include <algorithm>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+#include <netctrl/util/bitset.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Local search for small dominating sets
+/**
+ * A node \em dominates itself and its outbound neighbors; a set of nodes is
+ * a dominating set if every node is dominated by at least one member. For
+ * undirected graphs, this is the usual definition.
+ *
+ * The search keeps track of the number of members dominating each node, so
+ * adding or removing a member and checking whether a member is redundant
+ * costs time proportional to the degree of the member only.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class DominatingSetSearch {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    /// The graph being dominated
+    const G& m_graph;
+
+    /// Number of members dominating each node
+    std::vector<long int> m_coverCount;
+
+    /// Whether each node is a member
+    Bitset m_isMember;
+
+    /// The members of the set, in arbitrary order
+    std::vector<long int> m_members;
+
+    /// Position of each member in \c m_members, or -1 for non-members
+    std::vector<long int> m_positions;
+
+    /// Marks used to count each node only once in a neighborhood
+    std::vector<unsigned long int> m_marks;
+
+    /// The current value of the mark
+    unsigned long int m_currentMark;
+
+public:
+    /// Constructs a search over the given graph with an empty set
+    explicit DominatingSetSearch(const G& graph)
+        : m_graph(graph), m_coverCount(graph.vertexCount(), 0),
+        m_isMember(graph.vertexCount()), m_members(),
+        m_positions(graph.vertexCount(), -1), m_marks(graph.vertexCount(), 0),
+        m_currentMark(0) {}
+
+    /// Replaces the current set with the given one
+    void assign(const std::vector<long int>& members);
+
+    /**
+     * \brief Builds a dominating set from scratch with the greedy heuristic.
+     *
+     * The greedy heuristic adds the node that dominates the most nodes that
+     * are not dominated yet until all the nodes are dominated, and then
+     * removes the redundant members. The initial gains are calculated in
+     * parallel; since the gains can only decrease, the greedy choices are
+     * then made lazily from a priority queue, re-evaluating the gain of a
+     * node only when it gets to the top of the queue. Each choice depends on
+     * all the previous ones, so the selection runs on the calling thread
+     * only.
+     */
+    void greedy();
+
+    /**
+     * \brief Tries to make the current set smaller with randomized local
+     *        search.
+     *
+     * In each step, a few random members are removed, the nodes that are
+     * not dominated any more are repaired greedily (preferring nodes that
+     * were not just removed), and the members that became redundant are
+     * removed. The step is undone if the set became larger. The smallest
+     * set seen is the result.
+     *
+     * \param  deadline  the search stops at this point in time
+     * \param  seed      seed of the random number generator
+     * \param  maxStall  the search also stops after this many steps without
+     *                   improvement
+     */
+    void improve(Clock::time_point deadline, unsigned long int seed, long int maxStall);
+
+    /// Returns whether the given node is a member
+    bool isMember(long int v) const {
+        return m_isMember.test(v);
+    }
+
+    /// Returns the members of the current set
+    const std::vector<long int>& members() const {
+        return m_members;
+    }
+
+    /// Returns the number of members of the current set
+    long int size() const {
+        return m_members.size();
+    }
+
+private:
+    /// Adds a node to the set
+    void add(long int v);
+
+    /// Returns the number of nodes dominated by v that are not dominated yet
+    long int gain(long int v);
+
+    /// Returns whether the given member can be removed from the set
+    bool isRedundant(long int v) const;
+
+    /// Starts a new round of marking nodes in \c m_marks
+    void nextMark() {
+        if (++m_currentMark == 0) {
+            std::fill(m_marks.begin(), m_marks.end(), 0);
+            m_currentMark = 1;
+        }
+    }
+
+    /// Removes a node from the set
+    void remove(long int v);
+
+    /// Removes the redundant members that dominate any node dominated by v
+    void removeRedundantAround(long int v, std::vector<long int>& changes);
+};
+
+/// Builds a dominating set with the greedy heuristic
+/**
+ * \param  graph   the graph; must satisfy the graph concept described in
+ *                 \c netctrl/kernel.h
+ * \param  result  the members of the dominating set are returned here
+ */
+template <typename G>
+void greedyDominatingSet(const G& graph, std::vector<long int>& result) {
+    DominatingSetSearch<G> search(graph);
+    search.greedy();
+    result = search.members();
+    std::sort(result.begin(), result.end());
+}
+
+/**
+ * \brief Tries to make a dominating set smaller with several independent
+ *        local searches in parallel.
+ *
+ * One search is started from the given set for each thread of the library
+ * (see \c setThreadCount()), each with its own random seed. The smallest
+ * set found by any of them is returned.
+ *
+ * \param  graph       the graph; must satisfy the graph concept described in
+ *                     \c netctrl/kernel.h
+ * \param  members     the members of a dominating set; the improved set is
+ *                     returned here
+ * \param  timeBudget  the maximum running time in seconds; zero or negative
+ *                     values mean no limit, and the searches stop only when
+ *                     they stop improving
+ * \param  seed        seed of the random number generators
+ */
+template <typename G>
+void improveDominatingSet(const G& graph, std::vector<long int>& members,
+        double timeBudget, unsigned long int seed) {
+    typedef std::chrono::steady_clock Clock;
+
+    long int i, numSearches = threadCount(), best = -1;
+    long int maxStall = 20 * graph.vertexCount() + 1000;
+    std::vector<std::vector<long int> > results(numSearches);
+    Clock::time_point deadline = timeBudget > 0 ? Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeBudget)) :
+        Clock::time_point::max();
+
+    if (members.empty())
+        return;
+
+    parallelFor(0, numSearches, [&](long int index) {
+        DominatingSetSearch<G> search(graph);
+        search.assign(members);
+        search.improve(deadline, seed + index, maxStall);
+        results[index] = search.members();
+    });
+
+    for (i = 0; i < numSearches; i++) {
+        if (results[i].size() < members.size() &&
+                (best < 0 || results[i].size() < results[best].size()))
+            best = i;
+    }
+
+    if (best >= 0) {
+        members.swap(results[best]);
+        std::sort(members.begin(), members.end());
+    }
+}
+
+
+/*************************************************************************/
+
+
+template <typename G>
+void DominatingSetSearch<G>::add(long int v) {
+    long int i, k = m_graph.outDegree(v);
+
+    m_isMember.set(v);
+    m_positions[v] = m_members.size();
+    m_members.push_back(v);
+
+    // Multiple edges and loops must not be counted more than once
+    nextMark();
+    m_marks[v] = m_currentMark;
+    m_coverCount[v]++;
+    for (i = 0; i < k; i++) {
+        long int w = m_graph.outNeighbor(v, i);
+        if (m_marks[w] != m_currentMark) {
+            m_marks[w] = m_currentMark;
+            m_coverCount[w]++;
+        }
+    }
+}
+
+template <typename G>
+void DominatingSetSearch<G>::assign(const std::vector<long int>& members) {
+    std::vector<long int>::const_iterator it;
+
+    while (!m_members.empty())
+        remove(m_members.back());
+    for (it = members.begin(); it != members.end(); ++it) {
+        if (!isMember(*it))
+            add(*it);
+    }
+}
+
+template <typename G>
+long int DominatingSetSearch<G>::gain(long int v) {
+    long int i, k = m_graph.outDegree(v), result = 0;
+
+    nextMark();
+    m_marks[v] = m_currentMark;
+    if (m_coverCount[v] == 0)
+        result++;
+    for (i = 0; i < k; i++) {
+        long int w = m_graph.outNeighbor(v, i);
+        if (m_marks[w] != m_currentMark) {
+            m_marks[w] = m_currentMark;
+            if (m_coverCount[w] == 0)
+                result++;
+        }
+    }
+
+    return result;
+}
+
+template <typename G>
+void DominatingSetSearch<G>::greedy() {
+    long int n = m_graph.vertexCount(), blockSize = 4096;
+    std::vector<long int> gains(n);
+    std::priority_queue<std::pair<long int, long int> > queue;
+
+    assign(std::vector<long int>());
+
+    // Initial gains: the sizes of the closed outbound neighborhoods
+    parallelFor(0, (n + blockSize - 1) / blockSize, [&](long int block) {
+        std::vector<long int> neighbors;
+        long int v, i, k, end = std::min(n, (block + 1) * blockSize);
+        for (v = block * blockSize; v < end; v++) {
+            k = m_graph.outDegree(v);
+            neighbors.clear();
+            neighbors.push_back(v);
+            for (i = 0; i < k; i++)
+                neighbors.push_back(m_graph.outNeighbor(v, i));
+            std::sort(neighbors.begin(), neighbors.end());
+            gains[v] = std::unique(neighbors.begin(), neighbors.end()) - neighbors.begin();
+        }
+    });
+
+    // Ties are broken in favour of smaller node indices
+    for (long int v = 0; v < n; v++)
+        queue.push(std::make_pair(gains[v], -v));
+
+    while (!queue.empty()) {
+        long int v = -queue.top().second, stored = queue.top().first, current;
+        queue.pop();
+
+        if (isMember(v))
+            continue;
+
+        current = stored;
+        if (!m_members.empty())
+            current = gain(v);
+        if (current == 0)
+            continue;
+
+        if (current == stored)
+            add(v);
+        else
+            queue.push(std::make_pair(current, -v));
+    }
+
+    // Remove the redundant members, starting from the ones added last
+    for (long int i = m_members.size() - 1; i >= 0; i--) {
+        if (i < static_cast<long int>(m_members.size()) && isRedundant(m_members[i]))
+            remove(m_members[i]);
+    }
+}
+
+template <typename G>
+void DominatingSetSearch<G>::improve(Clock::time_point deadline,
+        unsigned long int seed, long int maxStall) {
+    std::mt19937 rng(seed);
+    std::vector<long int> best(m_members), changes, uncovered, removed;
+    long int i, j, k, stall = 0;
+
+    while (!m_members.empty() && stall < maxStall && Clock::now() < deadline) {
+        long int previousSize = m_members.size();
+
+        changes.clear();
+        removed.clear();
+        uncovered.clear();
+
+        // Remove a few random members
+        k = 1 + rng() % std::min<long int>(3, m_members.size());
+        for (i = 0; i < k; i++) {
+            long int v = m_members[rng() % m_members.size()];
+            remove(v);
+            changes.push_back(v);
+            removed.push_back(v);
+        }
+
+        // Collect the nodes that are not dominated any more
+        nextMark();
+        for (i = 0; i < k; i++) {
+            long int v = removed[i], degree = m_graph.outDegree(v);
+            for (j = -1; j < degree; j++) {
+                long int w = j < 0 ? v : m_graph.outNeighbor(v, j);
+                if (m_coverCount[w] == 0 && m_marks[w] != m_currentMark) {
+                    m_marks[w] = m_currentMark;
+                    uncovered.push_back(w);
+                }
+            }
+        }
+
+        // Repair: dominate each uncovered node with the best of its dominators
+        for (i = 0; i < static_cast<long int>(uncovered.size()); i++) {
+            long int w = uncovered[i], degree = m_graph.inDegree(w);
+            long int bestNode = -1, bestGain = 0, ties = 0;
+            bool bestRemoved = true;
+
+            if (m_coverCount[w] > 0)
+                continue;
+
+            for (j = -1; j < degree; j++) {
+                long int v = j < 0 ? w : m_graph.inNeighbor(w, j);
+                long int g = gain(v);
+                bool wasRemoved = std::find(removed.begin(), removed.end(), v) != removed.end();
+
+                if (bestNode < 0 || (bestRemoved && !wasRemoved) ||
+                        (bestRemoved == wasRemoved && g > bestGain)) {
+                    bestNode = v;
+                    bestGain = g;
+                    bestRemoved = wasRemoved;
+                    ties = 1;
+                } else if (bestRemoved == wasRemoved && g == bestGain) {
+                    // Reservoir sampling among the tied candidates
+                    if (rng() % ++ties == 0)
+                        bestNode = v;
+                }
+            }
+
+            add(bestNode);
+            changes.push_back(bestNode);
+        }
+
+        // Remove the members that became redundant
+        for (i = k; i < static_cast<long int>(changes.size()); i++) {
+            if (isMember(changes[i]))
+                removeRedundantAround(changes[i], changes);
+        }
+
+        if (static_cast<long int>(m_members.size()) > previousSize) {
+            // Undo the changes in reverse order
+            for (i = changes.size() - 1; i >= 0; i--) {
+                if (isMember(changes[i]))
+                    remove(changes[i]);
+                else
+                    add(changes[i]);
+            }
+        }
+
+        if (m_members.size() < best.size()) {
+            best = m_members;
+            stall = 0;
+        } else {
+            stall++;
+        }
+    }
+
+    assign(best);
+}
+
+template <typename G>
+bool DominatingSetSearch<G>::isRedundant(long int v) const {
+    long int i, k = m_graph.outDegree(v);
+
+    if (m_coverCount[v] < 2)
+        return false;
+    for (i = 0; i < k; i++) {
+        long int w = m_graph.outNeighbor(v, i);
+        if (m_coverCount[w] < 2)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename G>
+void DominatingSetSearch<G>::remove(long int v) {
+    long int i, k = m_graph.outDegree(v), last = m_members.back();
+
+    m_isMember.reset(v);
+    m_members[m_positions[v]] = last;
+    m_positions[last] = m_positions[v];
+    m_members.pop_back();
+    m_positions[v] = -1;
+
+    nextMark();
+    m_marks[v] = m_currentMark;
+    m_coverCount[v]--;
+    for (i = 0; i < k; i++) {
+        long int w = m_graph.outNeighbor(v, i);
+        if (m_marks[w] != m_currentMark) {
+            m_marks[w] = m_currentMark;
+            m_coverCount[w]--;
+        }
+    }
+}
+
+template <typename G>
+void DominatingSetSearch<G>::removeRedundantAround(long int v,
+        std::vector<long int>& changes) {
+    long int i, j, k = m_graph.outDegree(v);
+
+    for (i = -1; i < k; i++) {
+        long int w = i < 0 ? v : m_graph.outNeighbor(v, i);
+        long int degree = m_graph.inDegree(w);
+        for (j = -1; j < degree; j++) {
+            long int u = j < 0 ? w : m_graph.inNeighbor(w, j);
+            if (u != v && isMember(u) && isRedundant(u)) {
+                remove(u);
+                changes.push_back(u);
+            }
+        }
+    }
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_DOMINATING_SET_H
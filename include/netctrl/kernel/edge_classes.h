@@ -0,0 +1,1025 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_EDGE_CLASSES_H
+#define NETCTRL_KERNEL_EDGE_CLASSES_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <netctrl/kernel/alternating_graph.h>
+#include <netctrl/kernel/scc.h>
+#include <netctrl/model/controllability.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/**
+ * \brief Classifies the edges of a graph according to the Liu model and
+ *        reports the class of each edge to a visitor.
+ *
+ * The algorithm implemented here is adapted from Algorithm 2 of the
+ * following publication:
+ *
+ * Regin JC: A filtering algorithm for constraints of difference in CSPs.
+ * In: AAAI '94 Proceedings of the 12th national conference on Artificial
+ * intelligence (vol. 1), pp. 362-367, 1994.
+ *
+ * It works on the implicit \c AlternatingGraph of the graph and the
+ * matching so the directed bipartite graph is never constructed. Whether
+ * an edge of the bipartite graph is traversed by the breadth-first searches
+ * or lies within a strongly connected component depends only on its
+ * endpoints, so the searches only mark nodes and the edges are classified
+ * in a single pass at the end, without any per-edge state.
+ *
+ * The visitor is called as <tt>visitor(edge, klass)</tt> once for each edge
+ * of the bipartite graph. Edges of directed graphs appear there exactly
+ * once; undirected edges appear once in each direction and may be reported
+ * with different classes, in which case \c EDGE_ORDINARY takes precedence
+ * over \c EDGE_CRITICAL, which takes precedence over \c EDGE_REDUNDANT.
+ *
+ * \param  graph     the graph; must satisfy the graph concept described in
+ *                   \c netctrl/kernel.h. Masked views are supported.
+ * \param  matching  a maximum matching of the graph
+ * \param  visitor   the function to call for each edge
+ */
+template <typename G, typename Visitor>
+void visitLiuEdgeClasses(const G& graph, const DirectedMatching& matching,
+        Visitor visitor) {
+    AlternatingGraph<G> digraph(graph, matching);
+    long int n = graph.vertexCount(), x, y, i, k, u, edge;
+    std::vector<long int> queue;
+    std::vector<bool> reachedBackward(2*n), reachedForward(2*n);
+    size_t head;
+    bool first;
+
+    // (1) Edges are REDUNDANT unless they are found otherwise below
+
+    // (2) The directed bipartite graph where matched edges are directed from
+    //     top to bottom and unmatched edges are directed from bottom to top
+    //     is provided by the AlternatingGraph
+
+    // (3a) Start a backward BFS from unmatched nodes; all edges leading into
+    //      the nodes reached are ORDINARY
+    for (u = 0; u < n; u++) {
+        if (!matching.isMatched(u)) {
+            queue.push_back(u);
+            reachedBackward[u] = true;
+        }
+        if (!matching.isMatching(u)) {
+            queue.push_back(u+n);
+            reachedBackward[u+n] = true;
+        }
+    }
+    for (head = 0; head < queue.size(); head++) {
+        x = queue[head];
+        k = digraph.inCandidates(x);
+        for (i = 0; i < k; i++) {
+            y = digraph.inEntry(x, i, &edge);
+            if (y != -1 && !reachedBackward[y]) {
+                reachedBackward[y] = true;
+                queue.push_back(y);
+            }
+        }
+    }
+
+    // (3b) Start a forward BFS; all edges leading out of the nodes reached
+    //      are ORDINARY
+    queue.clear();
+    for (u = 0; u < n; u++) {
+        if (!matching.isMatched(u)) {
+            queue.push_back(u);
+            reachedForward[u] = true;
+        }
+        if (!matching.isMatching(u)) {
+            queue.push_back(u+n);
+            reachedForward[u+n] = true;
+        }
+    }
+    for (head = 0; head < queue.size(); head++) {
+        x = queue[head];
+        k = digraph.outCandidates(x);
+        for (i = 0; i < k; i++) {
+            y = digraph.outEntry(x, i, &edge);
+            if (y != -1 && !reachedForward[y]) {
+                reachedForward[y] = true;
+                queue.push_back(y);
+            }
+        }
+    }
+
+    // (4) Compute the strongly connected components of the bipartite
+    //     directed graph; all edges inside the same component are ORDINARY
+    std::vector<long int> membership;
+    stronglyConnectedComponents(digraph, membership);
+
+    // (5) Classify the edges. Edges in the matching that are not ORDINARY
+    //     are CRITICAL; the matched edges are the outbound edges of the
+    //     bottom nodes, and only the first one counts if there are
+    //     multiple edges
+    for (x = 0; x < 2*n; x++) {
+        k = digraph.outCandidates(x);
+        first = x < n;
+        for (i = 0; i < k; i++) {
+            y = digraph.outEntry(x, i, &edge);
+            if (y == -1)
+                continue;
+            if (reachedForward[x] || reachedBackward[y] || membership[x] == membership[y])
+                visitor(edge, EDGE_ORDINARY);
+            else
+                visitor(edge, first ? EDGE_CRITICAL : EDGE_REDUNDANT);
+            first = false;
+        }
+    }
+}
+
+/**
+ * \brief Classifies the edges of a graph according to the Liu model.
+ *
+ * See \c visitLiuEdgeClasses() for the details of the algorithm.
+ *
+ * \param  graph     the graph; must satisfy the graph concept described in
+ *                   \c netctrl/kernel.h. Masked views are supported.
+ * \param  matching  a maximum matching of the graph
+ * \param  result    the class of each edge is returned here
+ */
+template <typename G>
+void classifyLiuEdges(const G& graph, const DirectedMatching& matching,
+        std::vector<EdgeClass>& result) {
+    result.assign(graph.edgeCount(), EDGE_REDUNDANT);
+    visitLiuEdgeClasses(graph, matching, [&result](long int edge, EdgeClass klass) {
+        if (klass == EDGE_ORDINARY || result[edge] == EDGE_REDUNDANT)
+            result[edge] = klass;
+    });
+}
+
+/**
+ * \brief Counts the edges of a graph in each class of the Liu model.
+ *
+ * For directed graphs, the edges are counted as they are classified and
+ * the classes of the individual edges are never stored. Undirected edges
+ * are seen twice by the classification, so they are classified with
+ * \c classifyLiuEdges() first.
+ *
+ * \param  graph     the graph; must satisfy the graph concept described in
+ *                   \c netctrl/kernel.h. Masked views are supported.
+ * \param  matching  a maximum matching of the graph
+ * \param  counts    array of <tt>EDGE_DISTINGUISHED + 1</tt> elements; the
+ *                   number of edges in each class is returned here, indexed
+ *                   by the class
+ */
+template <typename G>
+void countLiuEdgeClasses(const G& graph, const DirectedMatching& matching,
+        long int* counts) {
+    std::fill(counts, counts + EDGE_DISTINGUISHED + 1, 0);
+
+    if (graph.isDirected()) {
+        visitLiuEdgeClasses(graph, matching, [counts](long int, EdgeClass klass) {
+            counts[klass]++;
+        });
+    } else {
+        std::vector<EdgeClass> classes;
+        std::vector<EdgeClass>::const_iterator it;
+
+        classifyLiuEdges(graph, matching, classes);
+        for (it = classes.begin(); it != classes.end(); ++it)
+            counts[*it]++;
+    }
+}
+
+/**
+ * \brief Maintains the classes of the edges of a graph in the Liu model
+ *        while the graph and its maximum matching change.
+ *
+ * The class of an edge of the bipartite graph in \c visitLiuEdgeClasses()
+ * depends only on whether its source is reached by the forward search,
+ * whether its target is reached by the backward search, and whether the
+ * two lie in the same strongly connected component. The tracker keeps these
+ * labels for each node of the \c AlternatingGraph, so the edges can be
+ * classified in a single pass without any search. In directed graphs, it
+ * also keeps the number of outbound edges of each node in each class, so
+ * the edges can be counted without even looking at them.
+ *
+ * After a change of the graph or the matching, \c update() brings the
+ * labels up to date from the nodes whose edges or pairs changed:
+ *
+ * - Each node reached by a search keeps its level, which is larger than
+ *   the level of at least one of its reached neighbors that the search
+ *   comes from, unless the node is free. A node can only lose that
+ *   support if it changed or a supporting neighbor dropped out, so the
+ *   changed nodes are checked in the order of their levels and the loss is
+ *   passed on to the neighbors on higher levels only. The nodes that lost
+ *   their support are derived again from the free nodes and the rest of
+ *   the reached set, as in the DRed algorithm for materialized views, and
+ *   the searches are extended from the changed nodes.
+ *
+ * - The components are only needed among the nodes that neither search
+ *   reaches (the \em core): an edge that has a reached endpoint is
+ *   \c EDGE_ORDINARY anyway, and a cycle through a reached node lies
+ *   entirely in the reached set. A component of the core can only split if
+ *   it contains a changed node or loses nodes to the searches, and
+ *   components can only merge along a cycle through a changed node or a
+ *   node that joined the core. Only these components and the nodes that
+ *   are both downstream and upstream of the changed ones are relabeled,
+ *   with Tarjan's algorithm restricted to them. The downstream and the
+ *   upstream search run in lockstep until one of them is exhausted, and
+ *   the other one is confined to what the first one found.
+ *
+ * - The edge counts are refreshed at the changed nodes, the nodes whose
+ *   labels changed and the sources of the edges that point to them.
+ *
+ * The cost of an update therefore depends on the size of the regions whose
+ * labels may have changed and the edges around them, not on the size of
+ * the graph. The members of each component are kept in a circular list so
+ * a component can be relabeled without looking for its members.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ * The tracker keeps no reference to the graph or the matching; they are
+ * passed to each call.
+ */
+template <typename G>
+class LiuEdgeClassTracker {
+private:
+    /// Flags of the nodes in the workspace of an update
+    enum {
+        MARK_SEED = 1, MARK_REMOVED = 2, MARK_REGION = 4, MARK_DOWNSTREAM = 8,
+        MARK_UPSTREAM = 16, MARK_CYCLE = 32, MARK_COUNTED = 64
+    };
+
+    /// The number of nodes handed to a thread at once when all the edges
+    /// are classified or counted
+    enum { BLOCK_SIZE = 4096 };
+
+    /// The number of vertices in the original graph
+    long int m_n;
+
+    /// Whether the original graph is directed
+    bool m_directed;
+
+    /// Whether the labels belong to the graph and matching seen last
+    bool m_valid;
+
+    /// The level of each node in the forward search from the free nodes;
+    /// -1 if the node is not reached
+    std::vector<long int> m_forward;
+
+    /// The level of each node in the backward search from the free nodes;
+    /// -1 if the node is not reached
+    std::vector<long int> m_backward;
+
+    /// The strongly connected component of each core node; -1 for the
+    /// other nodes
+    std::vector<long int> m_component;
+
+    /// The next member of the component of each node; the members of each
+    /// component form a circular list
+    std::vector<long int> m_nextMember;
+
+    /// The number of component indices used so far
+    long int m_componentCount;
+
+    /// The number of outbound edges of each node in each class, three
+    /// entries per node; empty for undirected graphs
+    std::vector<long int> m_nodeCounts;
+
+    /// The number of edges in each class, in directed graphs
+    long int m_counts[EDGE_DISTINGUISHED + 1];
+
+    /// Flags of each node during an update; all zero between the updates
+    std::vector<signed char> m_mark;
+
+    /// The position of each node in \c m_region while it is relabeled, -1
+    /// otherwise
+    std::vector<long int> m_local;
+
+    /// The changed nodes of the current update, without duplicates
+    std::vector<long int> m_seeds;
+
+    /// The nodes whose forward and backward labels changed in the update
+    std::vector<long int> m_changedForward, m_changedBackward;
+
+    /// The core nodes whose components are relabeled in the update
+    std::vector<long int> m_region;
+
+    /// The nodes that left the core in the update
+    std::vector<long int> m_leaving;
+
+    /// The reached nodes whose support is checked, ordered by their levels
+    std::vector<std::pair<long int, long int> > m_heap;
+
+    /// The core nodes that the merged components must pass through
+    std::vector<long int> m_roots;
+
+    /// Queues of the searches
+    std::vector<long int> m_queue, m_frontier, m_cycle;
+
+public:
+    /// Constructs a tracker without any labels
+    LiuEdgeClassTracker() : m_n(0), m_directed(true), m_valid(false),
+        m_forward(), m_backward(), m_component(), m_nextMember(),
+        m_componentCount(0), m_nodeCounts(), m_mark(), m_local(), m_seeds(),
+        m_changedForward(), m_changedBackward(), m_region(), m_leaving(),
+        m_heap(), m_roots(), m_queue(), m_frontier(), m_cycle() {
+        std::fill(m_counts, m_counts + EDGE_DISTINGUISHED + 1, 0);
+    }
+
+    /// Returns whether the labels belong to the graph and matching seen last
+    bool valid() const {
+        return m_valid;
+    }
+
+    /// Forgets the labels so the next update starts from scratch
+    void invalidate() {
+        m_valid = false;
+    }
+
+    /**
+     * \brief Calculates the labels of the nodes from scratch.
+     *
+     * \param  graph     the graph
+     * \param  matching  a maximum matching of the graph
+     */
+    void reset(const G& graph, const DirectedMatching& matching);
+
+    /**
+     * \brief Brings the labels up to date after a change of the graph or
+     *        the matching.
+     *
+     * Falls back to \c reset() if the labels are not valid or the number
+     * of vertices changed.
+     *
+     * \param  graph     the graph after the change
+     * \param  matching  a maximum matching of the graph after the change
+     * \param  changed   the nodes of the \c AlternatingGraph that are
+     *                   endpoints of an edge that was inserted, deleted or
+     *                   reoriented, or whose pair was removed or created,
+     *                   since the labels were last brought up to date; may
+     *                   contain duplicates
+     */
+    void update(const G& graph, const DirectedMatching& matching,
+            const std::vector<long int>& changed);
+
+    /**
+     * \brief Reports the class of each edge to a visitor.
+     *
+     * The visitor is called as in \c visitLiuEdgeClasses(), from the
+     * labels and without any search.
+     */
+    template <typename Visitor>
+    void visit(const G& graph, const DirectedMatching& matching,
+            Visitor visitor) const {
+        visitRange(AlternatingGraph<G>(graph, matching), 0, 2*m_n, visitor);
+    }
+
+    /**
+     * \brief Classifies the edges as \c classifyLiuEdges() does, from the
+     *        labels.
+     *
+     * The nodes are split between the threads of the library. Each edge of
+     * a directed graph is seen once, so its class is simply written; an
+     * undirected edge is seen in both directions, possibly by two threads,
+     * and keeps the strongest class, ORDINARY before CRITICAL before
+     * REDUNDANT.
+     */
+    void classify(const G& graph, const DirectedMatching& matching,
+            std::vector<EdgeClass>& result) const;
+
+    /**
+     * \brief Counts the edges in each class as \c countLiuEdgeClasses()
+     *        does.
+     *
+     * The counts of directed graphs are maintained by the updates; the
+     * edges of undirected graphs are classified again.
+     */
+    void count(const G& graph, const DirectedMatching& matching,
+            long int* counts) const {
+        if (m_directed) {
+            std::copy(m_counts, m_counts + EDGE_DISTINGUISHED + 1, counts);
+        } else {
+            std::vector<EdgeClass> classes;
+            std::vector<EdgeClass>::const_iterator it;
+
+            std::fill(counts, counts + EDGE_DISTINGUISHED + 1, 0);
+            classify(graph, matching, classes);
+            for (it = classes.begin(); it != classes.end(); ++it)
+                counts[*it]++;
+        }
+    }
+
+private:
+    /// Reports the class of the outbound edges of the nodes from \c begin
+    /// to \c end to a visitor
+    template <typename Visitor>
+    void visitRange(const AlternatingGraph<G>& digraph, long int begin,
+            long int end, Visitor visitor) const {
+        long int x, y, i, k, edge;
+        bool first;
+
+        for (x = begin; x < end; x++) {
+            k = digraph.outCandidates(x);
+            first = x < m_n;
+            for (i = 0; i < k; i++) {
+                y = digraph.outEntry(x, i, &edge);
+                if (y == -1)
+                    continue;
+                visitor(edge, classOf(x, y, first));
+                first = false;
+            }
+        }
+    }
+
+    /// Returns the class of the edge from x to y
+    EdgeClass classOf(long int x, long int y, bool first) const {
+        if (m_forward[x] >= 0 || m_backward[y] >= 0 ||
+                (m_component[x] != -1 && m_component[x] == m_component[y]))
+            return EDGE_ORDINARY;
+        return first ? EDGE_CRITICAL : EDGE_REDUNDANT;
+    }
+
+    /// Returns whether the given node is reached by neither search
+    bool isCore(long int x) const {
+        return m_forward[x] < 0 && m_backward[x] < 0;
+    }
+
+    /// Returns whether the given node is free in the matching
+    bool isFree(const DirectedMatching& matching, long int x) const {
+        return x < m_n ? !matching.isMatched(x) : !matching.isMatching(x - m_n);
+    }
+
+    /// Returns the number of edge candidates of a node in the given direction
+    static long int stepCount(const AlternatingGraph<G>& digraph, long int x,
+            bool forward) {
+        return forward ? digraph.outCandidates(x) : digraph.inCandidates(x);
+    }
+
+    /// Returns the neighbor of a node along the i-th edge candidate in the
+    /// given direction, or -1
+    static long int step(const AlternatingGraph<G>& digraph, long int x, long int i,
+            bool forward) {
+        long int edge;
+        return forward ? digraph.outEntry(x, i, &edge) : digraph.inEntry(x, i, &edge);
+    }
+
+    /// Extends the set reached by a search from the nodes in \c queue
+    void spread(const AlternatingGraph<G>& digraph, std::vector<long int>& level,
+            bool forward, std::vector<long int>& queue);
+
+    /// Brings the set reached by a search up to date, recording the nodes
+    /// that were reached or not reached any more in \c changed
+    void updateReach(const AlternatingGraph<G>& digraph,
+            const DirectedMatching& matching, std::vector<long int>& level,
+            bool forward, std::vector<long int>& changed);
+
+    /// Brings the components of the core up to date after the searches
+    void updateComponents(const AlternatingGraph<G>& digraph);
+
+    /// Adds the core nodes both downstream and upstream of \c m_roots to
+    /// the region
+    void addCycleRegion(const AlternatingGraph<G>& digraph);
+
+    /// Assigns new components to the nodes of the region
+    void relabel(const AlternatingGraph<G>& digraph);
+
+    /// Counts the outbound edges of a node in each class into \c counts
+    void countEdges(const AlternatingGraph<G>& digraph, long int x,
+            long int* counts) const;
+
+    /// Counts the outbound edges of a node again
+    void recount(const AlternatingGraph<G>& digraph, long int x);
+
+    /// Marks a node whose edges have to be counted again
+    void touch(long int x) {
+        if (!(m_mark[x] & MARK_COUNTED)) {
+            m_mark[x] |= MARK_COUNTED;
+            m_queue.push_back(x);
+        }
+    }
+
+    /// Marks the sources of the inbound edges of a node to be counted again
+    void touchSources(const AlternatingGraph<G>& digraph, long int x) {
+        long int i, y, k = digraph.inCandidates(x);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, false);
+            if (y != -1)
+                touch(y);
+        }
+    }
+
+    /// Refreshes the edge counts after the labels were brought up to date
+    void updateCounts(const AlternatingGraph<G>& digraph);
+};
+
+template <typename G>
+void LiuEdgeClassTracker<G>::reset(const G& graph, const DirectedMatching& matching) {
+    AlternatingGraph<G> digraph(graph, matching);
+    long int x;
+
+    m_n = graph.vertexCount();
+    m_directed = graph.isDirected();
+    m_forward.assign(2*m_n, -1);
+    m_backward.assign(2*m_n, -1);
+    m_component.assign(2*m_n, -1);
+    m_nextMember.resize(2*m_n);
+    m_componentCount = 0;
+    m_mark.assign(2*m_n, 0);
+    m_local.assign(2*m_n, -1);
+
+    for (x = 0; x < 2*m_n; x++)
+        m_nextMember[x] = x;
+
+    // The searches from the free nodes
+    m_queue.clear();
+    for (x = 0; x < 2*m_n; x++) {
+        if (isFree(matching, x)) {
+            m_forward[x] = 0;
+            m_queue.push_back(x);
+        }
+    }
+    spread(digraph, m_forward, true, m_queue);
+
+    m_queue.clear();
+    for (x = 0; x < 2*m_n; x++) {
+        if (isFree(matching, x)) {
+            m_backward[x] = 0;
+            m_queue.push_back(x);
+        }
+    }
+    spread(digraph, m_backward, false, m_queue);
+
+    // The components of the core
+    m_region.clear();
+    for (x = 0; x < 2*m_n; x++) {
+        if (isCore(x))
+            m_region.push_back(x);
+    }
+    relabel(digraph);
+
+    // The edge counts; each block of nodes is summed up separately
+    std::fill(m_counts, m_counts + EDGE_DISTINGUISHED + 1, 0);
+    m_nodeCounts.assign(m_directed ? 3*2*m_n : 0, 0);
+    if (m_directed) {
+        long int numBlocks = (2*m_n + BLOCK_SIZE - 1) / BLOCK_SIZE, i, j;
+        std::vector<long int> blockCounts(3*numBlocks, 0);
+
+        parallelFor(0, numBlocks, [&](long int block) {
+            long int y, c, end = std::min<long int>(2*m_n, (block + 1) * BLOCK_SIZE);
+            for (y = block * BLOCK_SIZE; y < end; y++) {
+                countEdges(digraph, y, &m_nodeCounts[3*y]);
+                for (c = 0; c < 3; c++)
+                    blockCounts[3*block + c] += m_nodeCounts[3*y + c];
+            }
+        });
+        for (i = 0; i < numBlocks; i++) {
+            for (j = 0; j < 3; j++)
+                m_counts[j] += blockCounts[3*i + j];
+        }
+    }
+
+    m_valid = true;
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::classify(const G& graph, const DirectedMatching& matching,
+        std::vector<EdgeClass>& result) const {
+    AlternatingGraph<G> digraph(graph, matching);
+    long int m = graph.edgeCount(), e;
+    long int numBlocks = (2*m_n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    result.assign(m, EDGE_REDUNDANT);
+
+    if (m_directed) {
+        parallelFor(0, numBlocks, [&](long int block) {
+            visitRange(digraph, block * BLOCK_SIZE,
+                    std::min<long int>(2*m_n, (block + 1) * BLOCK_SIZE),
+                    [&result](long int edge, EdgeClass klass) {
+                result[edge] = klass;
+            });
+        });
+        return;
+    }
+
+    // The strength of the class of each undirected edge so far: 0 for
+    // REDUNDANT, 1 for CRITICAL and 2 for ORDINARY
+    std::unique_ptr<std::atomic<signed char>[]> strength(new std::atomic<signed char>[m]);
+    for (e = 0; e < m; e++)
+        strength[e].store(0, std::memory_order_relaxed);
+
+    parallelFor(0, numBlocks, [&](long int block) {
+        visitRange(digraph, block * BLOCK_SIZE,
+                std::min<long int>(2*m_n, (block + 1) * BLOCK_SIZE),
+                [&strength](long int edge, EdgeClass klass) {
+            signed char value = klass == EDGE_ORDINARY ? 2 : (klass == EDGE_CRITICAL ? 1 : 0);
+            signed char current = strength[edge].load(std::memory_order_relaxed);
+            while (current < value && !strength[edge].compare_exchange_weak(current, value))
+                ;
+        });
+    });
+
+    for (e = 0; e < m; e++) {
+        if (strength[e] == 2)
+            result[e] = EDGE_ORDINARY;
+        else if (strength[e] == 1)
+            result[e] = EDGE_CRITICAL;
+    }
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::update(const G& graph, const DirectedMatching& matching,
+        const std::vector<long int>& changed) {
+    if (!m_valid || graph.vertexCount() != m_n || graph.isDirected() != m_directed) {
+        reset(graph, matching);
+        return;
+    }
+
+    AlternatingGraph<G> digraph(graph, matching);
+    std::vector<long int>::const_iterator it;
+
+    m_seeds.clear();
+    for (it = changed.begin(); it != changed.end(); ++it) {
+        if (!(m_mark[*it] & MARK_SEED)) {
+            m_mark[*it] |= MARK_SEED;
+            m_seeds.push_back(*it);
+        }
+    }
+
+    m_changedForward.clear();
+    m_changedBackward.clear();
+    updateReach(digraph, matching, m_forward, true, m_changedForward);
+    updateReach(digraph, matching, m_backward, false, m_changedBackward);
+    updateComponents(digraph);
+    updateCounts(digraph);
+
+    for (it = m_seeds.begin(); it != m_seeds.end(); ++it)
+        m_mark[*it] &= ~MARK_SEED;
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::spread(const AlternatingGraph<G>& digraph,
+        std::vector<long int>& level, bool forward, std::vector<long int>& queue) {
+    long int x, y, i, k;
+    size_t head;
+
+    for (head = 0; head < queue.size(); head++) {
+        x = queue[head];
+        k = stepCount(digraph, x, forward);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, forward);
+            if (y != -1 && level[y] < 0) {
+                level[y] = level[x] + 1;
+                queue.push_back(y);
+            }
+        }
+    }
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::updateReach(const AlternatingGraph<G>& digraph,
+        const DirectedMatching& matching, std::vector<long int>& level, bool forward,
+        std::vector<long int>& changed) {
+    std::greater<std::pair<long int, long int> > later;
+    long int x, y, i, k;
+    std::vector<long int>::const_iterator it;
+
+    // Check the support of the changed nodes in the order of their levels,
+    // so the support of a node is known when the nodes above it are
+    // checked. Every path that the change broke passes through a changed
+    // node, and only the nodes above a node that lost its support may have
+    // depended on it.
+    m_heap.clear();
+    m_cycle.clear();
+    m_queue.clear();
+    for (it = m_seeds.begin(); it != m_seeds.end(); ++it) {
+        if (level[*it] >= 0) {
+            m_mark[*it] |= MARK_CYCLE;
+            m_cycle.push_back(*it);
+            m_heap.push_back(std::make_pair(level[*it], *it));
+        }
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), later);
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), later);
+        x = m_heap.back().second;
+        m_heap.pop_back();
+
+        if (isFree(matching, x)) {
+            level[x] = 0;
+            continue;
+        }
+
+        k = stepCount(digraph, x, !forward);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, !forward);
+            if (y != -1 && level[y] >= 0 && level[y] < level[x] &&
+                    !(m_mark[y] & MARK_REMOVED))
+                break;
+        }
+        if (i < k)
+            continue;
+
+        m_mark[x] |= MARK_REMOVED;
+        m_queue.push_back(x);
+
+        k = stepCount(digraph, x, forward);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, forward);
+            if (y != -1 && level[y] > level[x] && !(m_mark[y] & MARK_CYCLE)) {
+                m_mark[y] |= MARK_CYCLE;
+                m_cycle.push_back(y);
+                m_heap.push_back(std::make_pair(level[y], y));
+                std::push_heap(m_heap.begin(), m_heap.end(), later);
+            }
+        }
+    }
+    for (it = m_cycle.begin(); it != m_cycle.end(); ++it)
+        m_mark[*it] &= ~MARK_CYCLE;
+    for (it = m_queue.begin(); it != m_queue.end(); ++it)
+        level[*it] = -1;
+
+    // Derive the nodes that lost their support again if they have a
+    // neighbor that is still reached
+    m_frontier.clear();
+    for (it = m_queue.begin(); it != m_queue.end(); ++it) {
+        x = *it;
+        k = stepCount(digraph, x, !forward);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, !forward);
+            if (y != -1 && level[y] >= 0) {
+                level[x] = level[y] + 1;
+                m_frontier.push_back(x);
+                break;
+            }
+        }
+    }
+
+    // New edges may only lead out of the reached set at the changed nodes,
+    // and only the changed nodes may have become free
+    for (it = m_seeds.begin(); it != m_seeds.end(); ++it) {
+        x = *it;
+        if (level[x] < 0) {
+            if (isFree(matching, x)) {
+                level[x] = 0;
+                m_frontier.push_back(x);
+            }
+        } else if (!(m_mark[x] & MARK_REMOVED)) {
+            k = stepCount(digraph, x, forward);
+            for (i = 0; i < k; i++) {
+                y = step(digraph, x, i, forward);
+                if (y != -1 && level[y] < 0) {
+                    level[y] = level[x] + 1;
+                    m_frontier.push_back(y);
+                }
+            }
+        }
+    }
+    spread(digraph, level, forward, m_frontier);
+
+    // Record the changes
+    for (it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (level[*it] < 0)
+            changed.push_back(*it);
+    }
+    for (it = m_frontier.begin(); it != m_frontier.end(); ++it) {
+        if (!(m_mark[*it] & MARK_REMOVED))
+            changed.push_back(*it);
+    }
+    for (it = m_queue.begin(); it != m_queue.end(); ++it)
+        m_mark[*it] &= ~MARK_REMOVED;
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::updateComponents(const AlternatingGraph<G>& digraph) {
+    long int x, y;
+    std::vector<long int>::const_iterator it;
+    const std::vector<long int>* lists[] = {
+        &m_seeds, &m_changedForward, &m_changedBackward
+    };
+
+    // Collect the components that may split: the ones with a changed node
+    // and the ones that lost nodes to the searches. Their core members are
+    // relabeled along with the nodes that joined the core.
+    m_region.clear();
+    m_leaving.clear();
+    m_roots.clear();
+    for (size_t j = 0; j < sizeof(lists) / sizeof(lists[0]); j++) {
+        for (it = lists[j]->begin(); it != lists[j]->end(); ++it) {
+            x = *it;
+            if (m_mark[x] & MARK_REGION)
+                continue;
+
+            if (m_component[x] == -1) {
+                if (isCore(x)) {
+                    m_mark[x] |= MARK_REGION;
+                    m_region.push_back(x);
+                    m_roots.push_back(x);
+                }
+                continue;
+            }
+
+            y = x;
+            do {
+                m_mark[y] |= MARK_REGION;
+                if (isCore(y)) {
+                    m_region.push_back(y);
+                    if (m_mark[y] & MARK_SEED)
+                        m_roots.push_back(y);
+                } else {
+                    m_leaving.push_back(y);
+                }
+                y = m_nextMember[y];
+            } while (y != x);
+        }
+    }
+    for (it = m_leaving.begin(); it != m_leaving.end(); ++it) {
+        m_component[*it] = -1;
+        m_nextMember[*it] = *it;
+    }
+
+    // Components may merge along cycles through the roots
+    addCycleRegion(digraph);
+
+    for (it = m_region.begin(); it != m_region.end(); ++it)
+        m_mark[*it] &= ~MARK_REGION;
+    for (it = m_leaving.begin(); it != m_leaving.end(); ++it)
+        m_mark[*it] &= ~MARK_REGION;
+
+    relabel(digraph);
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::addCycleRegion(const AlternatingGraph<G>& digraph) {
+    long int x, y, i, k;
+    size_t downstreamHead = 0, upstreamHead = 0, head;
+    std::vector<long int>& downstream = m_queue;
+    std::vector<long int>& upstream = m_frontier;
+    std::vector<long int>::const_iterator it;
+    bool forward;
+    signed char bound;
+
+    if (m_roots.empty())
+        return;
+
+    downstream.clear();
+    upstream.clear();
+    for (it = m_roots.begin(); it != m_roots.end(); ++it) {
+        m_mark[*it] |= MARK_DOWNSTREAM | MARK_UPSTREAM;
+        downstream.push_back(*it);
+        upstream.push_back(*it);
+    }
+
+    // Search downstream and upstream of the roots within the core in
+    // lockstep until one of the searches is exhausted
+    while (downstreamHead < downstream.size() && upstreamHead < upstream.size()) {
+        x = downstream[downstreamHead++];
+        k = digraph.outCandidates(x);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, true);
+            if (y != -1 && isCore(y) && !(m_mark[y] & MARK_DOWNSTREAM)) {
+                m_mark[y] |= MARK_DOWNSTREAM;
+                downstream.push_back(y);
+            }
+        }
+
+        x = upstream[upstreamHead++];
+        k = digraph.inCandidates(x);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, false);
+            if (y != -1 && isCore(y) && !(m_mark[y] & MARK_UPSTREAM)) {
+                m_mark[y] |= MARK_UPSTREAM;
+                upstream.push_back(y);
+            }
+        }
+    }
+
+    // Search the other way within the nodes found by the exhausted search
+    forward = downstreamHead < downstream.size();
+    bound = forward ? MARK_UPSTREAM : MARK_DOWNSTREAM;
+    m_cycle.clear();
+    for (it = m_roots.begin(); it != m_roots.end(); ++it) {
+        m_mark[*it] |= MARK_CYCLE;
+        m_cycle.push_back(*it);
+    }
+    for (head = 0; head < m_cycle.size(); head++) {
+        x = m_cycle[head];
+        k = stepCount(digraph, x, forward);
+        for (i = 0; i < k; i++) {
+            y = step(digraph, x, i, forward);
+            if (y != -1 && (m_mark[y] & bound) && !(m_mark[y] & MARK_CYCLE)) {
+                m_mark[y] |= MARK_CYCLE;
+                m_cycle.push_back(y);
+            }
+        }
+    }
+
+    for (it = m_cycle.begin(); it != m_cycle.end(); ++it) {
+        if (!(m_mark[*it] & MARK_REGION)) {
+            m_mark[*it] |= MARK_REGION;
+            m_region.push_back(*it);
+        }
+    }
+
+    for (it = downstream.begin(); it != downstream.end(); ++it)
+        m_mark[*it] &= ~(MARK_DOWNSTREAM | MARK_UPSTREAM | MARK_CYCLE);
+    for (it = upstream.begin(); it != upstream.end(); ++it)
+        m_mark[*it] &= ~(MARK_DOWNSTREAM | MARK_UPSTREAM | MARK_CYCLE);
+    for (it = m_cycle.begin(); it != m_cycle.end(); ++it)
+        m_mark[*it] &= ~(MARK_DOWNSTREAM | MARK_UPSTREAM | MARK_CYCLE);
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::relabel(const AlternatingGraph<G>& digraph) {
+    long int i, c, x, count, size = m_region.size();
+    std::vector<long int> membership;
+
+    for (i = 0; i < size; i++)
+        m_local[m_region[i]] = i;
+
+    // The region is the whole core after a reset, which is worth splitting
+    // between the threads; small regions are left to Tarjan's algorithm
+    count = parallelStronglyConnectedComponents(
+            InducedDigraph<AlternatingGraph<G> >(digraph, m_region, m_local), membership);
+
+    std::vector<long int> firstMember(count, -1), lastMember(count, -1);
+    for (i = 0; i < size; i++) {
+        x = m_region[i];
+        c = membership[i];
+        m_component[x] = m_componentCount + c;
+        if (firstMember[c] == -1)
+            firstMember[c] = x;
+        else
+            m_nextMember[lastMember[c]] = x;
+        lastMember[c] = x;
+    }
+    for (c = 0; c < count; c++)
+        m_nextMember[lastMember[c]] = firstMember[c];
+    m_componentCount += count;
+
+    for (i = 0; i < size; i++)
+        m_local[m_region[i]] = -1;
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::countEdges(const AlternatingGraph<G>& digraph, long int x,
+        long int* counts) const {
+    long int i, k, y, edge;
+    bool first = x < m_n;
+
+    counts[0] = counts[1] = counts[2] = 0;
+
+    k = digraph.outCandidates(x);
+    for (i = 0; i < k; i++) {
+        y = digraph.outEntry(x, i, &edge);
+        if (y == -1)
+            continue;
+        counts[classOf(x, y, first)]++;
+        first = false;
+    }
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::recount(const AlternatingGraph<G>& digraph, long int x) {
+    long int* counts = &m_nodeCounts[3*x];
+    long int j;
+
+    for (j = 0; j < 3; j++)
+        m_counts[j] -= counts[j];
+    countEdges(digraph, x, counts);
+    for (j = 0; j < 3; j++)
+        m_counts[j] += counts[j];
+}
+
+template <typename G>
+void LiuEdgeClassTracker<G>::updateCounts(const AlternatingGraph<G>& digraph) {
+    std::vector<long int>::const_iterator it;
+
+    if (!m_directed)
+        return;
+
+    // The class of an edge depends on the forward label of its source, the
+    // backward label of its target and the components of both
+    m_queue.clear();
+    for (it = m_seeds.begin(); it != m_seeds.end(); ++it)
+        touch(*it);
+    for (it = m_changedForward.begin(); it != m_changedForward.end(); ++it)
+        touch(*it);
+    for (it = m_changedBackward.begin(); it != m_changedBackward.end(); ++it)
+        touchSources(digraph, *it);
+    for (it = m_region.begin(); it != m_region.end(); ++it) {
+        touch(*it);
+        touchSources(digraph, *it);
+    }
+    for (it = m_leaving.begin(); it != m_leaving.end(); ++it) {
+        touch(*it);
+        touchSources(digraph, *it);
+    }
+
+    for (it = m_queue.begin(); it != m_queue.end(); ++it) {
+        recount(digraph, *it);
+        m_mark[*it] &= ~MARK_COUNTED;
+    }
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_EDGE_CLASSES_H
@@ -0,0 +1,243 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_EGO_H
+#define NETCTRL_KERNEL_EGO_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <netctrl/kernel/matching.h>
+#include <netctrl/util/directed_matching.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Masked view of the ego network of a vertex
+/**
+ * The ego network of radius k of a vertex is the subgraph induced by the
+ * vertices that are at most k steps away from it, ignoring the directions
+ * of the edges. The view does not copy the subgraph: it renumbers the
+ * vertices of the ego network from zero and forwards the adjacency queries
+ * to the underlying graph, translating the neighbors on the fly. Neighbors
+ * that are outside the ego network are reported as -1; see the description
+ * of masked views in \c netctrl/kernel.h.
+ *
+ * The view keeps a table of size n that maps the vertices of the underlying
+ * graph to the vertices of the view, so it should be reused for many ego
+ * networks, e.g. one view per thread. Moving the view to another ego network
+ * costs time proportional to the size of the old and the new ego network.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class EgoView {
+private:
+    /// The underlying graph
+    const G& m_graph;
+
+    /// The vertices of the ego network, in order of their distance
+    std::vector<long int> m_vertices;
+
+    /// Index of each vertex of the underlying graph in the view, or -1
+    std::vector<long int> m_localIds;
+
+public:
+    /// Constructs an empty view over the given graph
+    explicit EgoView(const G& graph)
+        : m_graph(graph), m_vertices(), m_localIds(graph.vertexCount(), -1) {}
+
+    /// Moves the view to the ego network of the given vertex
+    void assign(long int center, long int radius) {
+        long int head, layerEnd, distance, i, k;
+
+        clear();
+        add(center);
+        for (head = 0, distance = 0; distance < radius; distance++) {
+            layerEnd = m_vertices.size();
+            for (; head < layerEnd; head++) {
+                long int v = m_vertices[head];
+                k = m_graph.outDegree(v);
+                for (i = 0; i < k; i++)
+                    add(m_graph.outNeighbor(v, i));
+                if (m_graph.isDirected()) {
+                    k = m_graph.inDegree(v);
+                    for (i = 0; i < k; i++)
+                        add(m_graph.inNeighbor(v, i));
+                }
+            }
+            if (head == static_cast<long int>(m_vertices.size()))
+                break;
+        }
+    }
+
+    /// Removes all the vertices from the view
+    void clear() {
+        std::vector<long int>::const_iterator it;
+        for (it = m_vertices.begin(); it != m_vertices.end(); ++it)
+            m_localIds[*it] = -1;
+        m_vertices.clear();
+    }
+
+    /// Returns the vertex of the underlying graph for a vertex of the view
+    long int globalId(long int v) const {
+        return m_vertices[v];
+    }
+
+    /// Returns the vertex of the view for a vertex of the underlying graph, or -1
+    long int localId(long int v) const {
+        return m_localIds[v];
+    }
+
+    // Methods required by the graph concept; see netctrl/kernel.h
+
+    long int edgeCount() const {
+        return m_graph.edgeCount();
+    }
+
+    long int inDegree(long int v) const {
+        return m_graph.inDegree(m_vertices[v]);
+    }
+
+    long int inEdge(long int v, long int i) const {
+        return m_graph.inEdge(m_vertices[v], i);
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        return m_localIds[m_graph.inNeighbor(m_vertices[v], i)];
+    }
+
+    bool isDirected() const {
+        return m_graph.isDirected();
+    }
+
+    long int outDegree(long int v) const {
+        return m_graph.outDegree(m_vertices[v]);
+    }
+
+    long int outEdge(long int v, long int i) const {
+        return m_graph.outEdge(m_vertices[v], i);
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        return m_localIds[m_graph.outNeighbor(m_vertices[v], i)];
+    }
+
+    long int vertexCount() const {
+        return m_vertices.size();
+    }
+
+private:
+    /// Adds a vertex of the underlying graph to the view if it is not there yet
+    void add(long int v) {
+        if (m_localIds[v] < 0) {
+            m_localIds[v] = m_vertices.size();
+            m_vertices.push_back(v);
+        }
+    }
+};
+
+/// Orders the vertices of a graph so that consecutive vertices are close
+/**
+ * The order is a breadth-first search order ignoring edge directions,
+ * started from each unvisited vertex in turn.
+ */
+template <typename G>
+void localityOrder(const G& graph, std::vector<long int>& order) {
+    long int i, k, start, head, n = graph.vertexCount();
+    std::vector<bool> visited(n, false);
+
+    order.clear();
+    order.reserve(n);
+    for (start = 0; start < n; start++) {
+        if (visited[start])
+            continue;
+
+        visited[start] = true;
+        order.push_back(start);
+        for (head = order.size() - 1; head < static_cast<long int>(order.size()); head++) {
+            long int v = order[head];
+            k = graph.outDegree(v);
+            for (i = 0; i < k; i++) {
+                long int w = graph.outNeighbor(v, i);
+                if (!visited[w]) {
+                    visited[w] = true;
+                    order.push_back(w);
+                }
+            }
+            k = graph.inDegree(v);
+            for (i = 0; i < k; i++) {
+                long int w = graph.inNeighbor(v, i);
+                if (!visited[w]) {
+                    visited[w] = true;
+                    order.push_back(w);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * \brief Calculates the number of driver nodes in the model of Liu et al
+ *        for the ego network of every vertex.
+ *
+ * The ego networks are processed on all the threads of the library (see
+ * \c setThreadCount()), each thread having its own \c EgoView and matching
+ * workspace. The vertices are handed out in blocks of consecutive vertices
+ * of a breadth-first search order, so consecutive ego networks of a thread
+ * overlap heavily and mostly touch memory that is already in the cache.
+ *
+ * The matching of the previous ego network is not reused as a warm start:
+ * the greedy initial matching is usually maximum already for ego networks,
+ * so the single search that proves maximality dominates either way.
+ *
+ * \param  graph        the graph; must satisfy the graph concept described
+ *                      in \c netctrl/kernel.h
+ * \param  radius       the radius of the ego networks
+ * \param  driverCounts the number of driver nodes in the ego network of each
+ *                      vertex is returned here; at least one, as in the
+ *                      Liu model
+ * \param  egoSizes     if not null, the number of vertices in the ego
+ *                      network of each vertex is returned here
+ */
+template <typename G>
+void egoDriverCounts(const G& graph, long int radius,
+        std::vector<long int>& driverCounts, std::vector<long int>* egoSizes = 0) {
+    const long int blockSize = 256;
+    long int n = graph.vertexCount();
+    long int numBlocks = (n + blockSize - 1) / blockSize;
+    std::vector<long int> order;
+    std::atomic<long int> nextBlock(0);
+
+    localityOrder(graph, order);
+    driverCounts.resize(n);
+    if (egoSizes)
+        egoSizes->resize(n);
+
+    parallelFor(0, std::min<long int>(threadCount(), numBlocks), [&](long int) {
+        EgoView<G> view(graph);
+        MatchingEngine<EgoView<G> > engine;
+        DirectedMatching matching;
+        long int block, i;
+
+        while ((block = nextBlock.fetch_add(1)) < numBlocks) {
+            long int end = std::min(n, (block + 1) * blockSize);
+
+            for (i = block * blockSize; i < end; i++) {
+                long int center = order[i], size;
+
+                view.assign(center, radius);
+                size = view.vertexCount();
+
+                matching = DirectedMatching();
+                long int matched = engine.run(view, matching);
+                driverCounts[center] = std::max(size - matched, 1L);
+                if (egoSizes)
+                    (*egoSizes)[center] = size;
+            }
+        }
+    });
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_EGO_H
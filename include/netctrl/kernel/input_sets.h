@@ -0,0 +1,417 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_INPUT_SETS_H
+#define NETCTRL_KERNEL_INPUT_SETS_H
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <netctrl/kernel/matching.h>
+#include <netctrl/kernel/scc.h>
+#include <netctrl/util/directed_matching.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Masked view of a graph where a set of input vertices cannot be matched
+/**
+ * The vertices of the input set receive input signals directly, so they do
+ * not need to be matched by any other vertex. The view hides the inbound
+ * edges of the input vertices, i.e. their bottom copies in the bipartite
+ * representation used by \c MatchingEngine; everything else is forwarded
+ * to the underlying graph. Hidden neighbors are reported as -1; see the
+ * description of masked views in \c netctrl/kernel.h.
+ *
+ * The view keeps a mask of size n, so it should be reused for many input
+ * sets, e.g. one view per thread. Moving the view to another input set
+ * costs time proportional to the size of the old and the new set.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class InputSetView {
+private:
+    /// The underlying graph
+    const G& m_graph;
+
+    /// The vertices of the input set, without duplicates
+    std::vector<long int> m_inputs;
+
+    /// Whether each vertex of the underlying graph is an input
+    std::vector<bool> m_isInput;
+
+public:
+    /// Constructs a view over the given graph with no inputs
+    explicit InputSetView(const G& graph)
+        : m_graph(graph), m_inputs(), m_isInput(graph.vertexCount(), false) {}
+
+    /// Moves the view to the given input set; duplicates are ignored
+    void assign(const long int* first, const long int* last) {
+        clear();
+        for (; first != last; ++first) {
+            if (!m_isInput[*first]) {
+                m_isInput[*first] = true;
+                m_inputs.push_back(*first);
+            }
+        }
+    }
+
+    /// Removes all the inputs from the view
+    void clear() {
+        std::vector<long int>::const_iterator it;
+        for (it = m_inputs.begin(); it != m_inputs.end(); ++it)
+            m_isInput[*it] = false;
+        m_inputs.clear();
+    }
+
+    /// Returns the vertices of the input set, without duplicates
+    const std::vector<long int>& inputs() const {
+        return m_inputs;
+    }
+
+    /// Returns whether the given vertex is an input
+    bool isInput(long int v) const {
+        return m_isInput[v];
+    }
+
+    // Methods required by the graph concept; see netctrl/kernel.h
+
+    long int edgeCount() const {
+        return m_graph.edgeCount();
+    }
+
+    long int inDegree(long int v) const {
+        return m_graph.inDegree(v);
+    }
+
+    long int inEdge(long int v, long int i) const {
+        return m_graph.inEdge(v, i);
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        return m_isInput[v] ? -1 : m_graph.inNeighbor(v, i);
+    }
+
+    bool isDirected() const {
+        return m_graph.isDirected();
+    }
+
+    long int outDegree(long int v) const {
+        return m_graph.outDegree(v);
+    }
+
+    long int outEdge(long int v, long int i) const {
+        return m_graph.outEdge(v, i);
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        long int w = m_graph.outNeighbor(v, i);
+        return m_isInput[w] ? -1 : w;
+    }
+
+    long int vertexCount() const {
+        return m_graph.vertexCount();
+    }
+};
+
+/// The graph concept seen through the interface of \c AlternatingGraph
+/**
+ * Lets \c stronglyConnectedComponents() run on the original edges of a
+ * graph instead of an implicit one.
+ */
+template <typename G>
+class ForwardDigraph {
+private:
+    /// The underlying graph
+    const G& m_graph;
+
+public:
+    explicit ForwardDigraph(const G& graph) : m_graph(graph) {}
+
+    /// Returns the number of nodes, i.e. the number of vertices
+    long int nodeCount() const {
+        return m_graph.vertexCount();
+    }
+
+    /// Returns the number of outbound edge candidates of the given node
+    long int outCandidates(long int x) const {
+        return m_graph.outDegree(x);
+    }
+
+    /// Returns the target of the i-th outbound edge of the given node
+    long int outEntry(long int x, long int i, long int* edge) const {
+        *edge = m_graph.outEdge(x, i);
+        return m_graph.outNeighbor(x, i);
+    }
+};
+
+/// The verdict on a candidate input set; see \c InputSetVerifier
+struct InputSetCheck {
+    /// The number of distinct vertices in the input set
+    long int inputCount;
+
+    /// The number of vertices outside the input set that a maximum matching
+    /// constrained to leave the inputs unmatched leaves unmatched as well;
+    /// each of them needs an input of its own
+    long int deficiency;
+
+    /// The number of source components of the graph (strongly connected
+    /// components without inbound edges from other components) that contain
+    /// no input; the vertices of these cannot be reached from the inputs
+    long int uncoveredSources;
+
+    InputSetCheck() : inputCount(0), deficiency(0), uncoveredSources(0) {}
+
+    /// Returns whether the input set makes the graph structurally controllable
+    bool controllable() const {
+        return deficiency == 0 && uncoveredSources == 0;
+    }
+};
+
+/**
+ * \brief Checks whether many candidate sets of input vertices make a graph
+ *        structurally controllable.
+ *
+ * Driving the vertices of a set S directly makes the linear dynamics of
+ * Liu et al structurally controllable if and only if every other vertex is
+ * matched by some vertex in a matching that leaves S unmatched, and every
+ * vertex can be reached from S. The first condition is checked with a
+ * maximum matching of \c InputSetView; the number of vertices it leaves
+ * unmatched outside S is the \em deficiency of the set. The second one
+ * holds if and only if S meets every source component of the graph.
+ *
+ * A maximum matching of the whole graph is computed once (or taken from the
+ * caller) and each check starts from it: the pairs of the vertices in S are
+ * removed, which frees their mates, and augmenting paths can only start
+ * from those mates, so \c MatchingEngine::repairLocally() searches from
+ * them alone. Mates that have no alternating path to a free vertex in the
+ * maximum matching are skipped: the inputs they were matched to are matched
+ * in every maximum matching, so each of them costs a pair no matter what.
+ * The lengths of these paths also guide the other searches, which would
+ * otherwise wander through much of the graph on sparse graphs whose maximum
+ * matchings leave many vertices free. The changes are undone afterwards, so
+ * each check costs time proportional to the size of S and the part of the
+ * graph that its augmenting path searches explore, not to the size of the
+ * graph. The source components are also found once.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class InputSetVerifier {
+private:
+    /// The graph
+    const G& m_graph;
+
+    /// A maximum matching of the graph
+    DirectedMatching m_matching;
+
+    /// The number of matched pairs in \c m_matching
+    long int m_matchedCount;
+
+    /// The length of a shortest alternating path from each top vertex to a
+    /// free bottom vertex in \c m_matching, or -1 if there is none
+    std::vector<long int> m_distances;
+
+    /// The index of the source component of each vertex, or -1 if its
+    /// strongly connected component has inbound edges from other ones
+    std::vector<long int> m_sourceComponent;
+
+    /// The number of source components
+    long int m_sourceCount;
+
+    InputSetVerifier(const InputSetVerifier&);
+    InputSetVerifier& operator=(const InputSetVerifier&);
+
+public:
+    /**
+     * \brief Prepares the verification of input sets of a graph.
+     *
+     * \param  graph     the graph; must outlive the verifier
+     * \param  matching  a maximum matching of the graph to start from, e.g.
+     *                   the one of a \c LiuControllabilityModel; if null or
+     *                   not defined on the vertices of the graph, one is
+     *                   calculated
+     */
+    explicit InputSetVerifier(const G& graph, const DirectedMatching* matching = 0);
+
+    /// Returns the number of matched pairs in a maximum matching of the graph
+    long int matchedCount() const {
+        return m_matchedCount;
+    }
+
+    /// Returns the number of source components of the graph
+    long int sourceCount() const {
+        return m_sourceCount;
+    }
+
+    /**
+     * \brief Checks a list of candidate input sets.
+     *
+     * The candidates are processed on all the threads of the library (see
+     * \c setThreadCount()), each thread having its own copy of the maximum
+     * matching, its own \c InputSetView and its own matching workspace. The
+     * candidates are handed out in small blocks since their costs can be
+     * very different.
+     *
+     * \param  inputs   the vertices of all the candidates one after the other
+     * \param  offsets  the index of the first vertex of each candidate in
+     *                  \c inputs, followed by the size of \c inputs
+     * \param  results  the verdict on each candidate is returned here
+     */
+    void verify(const std::vector<long int>& inputs, const std::vector<long int>& offsets,
+            std::vector<InputSetCheck>& results) const;
+};
+
+
+/*************************************************************************/
+
+
+template <typename G>
+InputSetVerifier<G>::InputSetVerifier(const G& graph, const DirectedMatching* matching)
+    : m_graph(graph), m_matching(), m_matchedCount(0), m_distances(),
+    m_sourceComponent(), m_sourceCount(0) {
+    long int u, v, i, k, numComponents, n = graph.vertexCount();
+    std::vector<long int> membership, sourceIds, queue;
+    size_t head;
+    std::vector<bool> hasInbound;
+
+    if (matching != 0 && matching->size() == n) {
+        m_matching = *matching;
+        for (u = 0; u < n; u++) {
+            if (m_matching.isMatching(u))
+                m_matchedCount++;
+        }
+    } else {
+        m_matchedCount = maximumMatching(graph, m_matching);
+    }
+
+    // Backward alternating search from the free bottom vertices. If the
+    // mate of a bottom vertex cannot reach any of them, the bottom vertex
+    // is matched in every maximum matching, so leaving it unmatched costs
+    // one matched pair whatever the other inputs are, and the search for
+    // an augmenting path from its mate is bound to fail.
+    // The distances also guide the searches towards the free vertices.
+    m_distances.assign(n, -1);
+    for (v = 0; v < n; v++) {
+        if (m_matching.isMatched(v))
+            continue;
+        k = graph.inDegree(v);
+        for (i = 0; i < k; i++) {
+            u = graph.inNeighbor(v, i);
+            if (u >= 0 && m_distances[u] < 0) {
+                m_distances[u] = 0;
+                queue.push_back(u);
+            }
+        }
+    }
+    for (head = 0; head < queue.size(); head++) {
+        v = m_matching.matchOut(queue[head]);
+        if (v == -1)
+            continue;
+        k = graph.inDegree(v);
+        for (i = 0; i < k; i++) {
+            u = graph.inNeighbor(v, i);
+            if (u >= 0 && m_distances[u] < 0) {
+                m_distances[u] = m_distances[queue[head]] + 1;
+                queue.push_back(u);
+            }
+        }
+    }
+
+    // A strongly connected component is a source component if no edge
+    // enters it from another component
+    numComponents = stronglyConnectedComponents(ForwardDigraph<G>(graph), membership);
+    hasInbound.assign(numComponents, false);
+    for (u = 0; u < n; u++) {
+        k = graph.outDegree(u);
+        for (i = 0; i < k; i++) {
+            v = graph.outNeighbor(u, i);
+            if (membership[v] != membership[u])
+                hasInbound[membership[v]] = true;
+        }
+    }
+
+    sourceIds.assign(numComponents, -1);
+    for (i = 0; i < numComponents; i++) {
+        if (!hasInbound[i])
+            sourceIds[i] = m_sourceCount++;
+    }
+    m_sourceComponent.resize(n);
+    for (u = 0; u < n; u++)
+        m_sourceComponent[u] = sourceIds[membership[u]];
+}
+
+template <typename G>
+void InputSetVerifier<G>::verify(const std::vector<long int>& inputs,
+        const std::vector<long int>& offsets, std::vector<InputSetCheck>& results) const {
+    const long int blockSize = 16;
+    long int numCandidates = offsets.empty() ? 0 : offsets.size() - 1;
+    long int numBlocks = (numCandidates + blockSize - 1) / blockSize;
+    std::atomic<long int> nextBlock(0);
+
+    results.assign(numCandidates, InputSetCheck());
+
+    parallelFor(0, std::min<long int>(threadCount(), numBlocks), [&](long int) {
+        InputSetView<G> view(m_graph);
+        MatchingEngine<InputSetView<G> > engine;
+        DirectedMatching matching(m_matching);
+        std::vector<long int> changed, starts, flipped, seenSources(m_sourceCount, -1);
+        std::vector<long int>::const_iterator it;
+        long int block, c, u, v, covered;
+
+        while ((block = nextBlock.fetch_add(1)) < numBlocks) {
+            long int end = std::min(numCandidates, (block + 1) * blockSize);
+
+            for (c = block * blockSize; c < end; c++) {
+                InputSetCheck& result = results[c];
+
+                view.assign(inputs.data() + offsets[c], inputs.data() + offsets[c+1]);
+                const std::vector<long int>& set = view.inputs();
+
+                // The inputs must stay unmatched; their mates are the only
+                // free vertices that augmenting paths can start from, and
+                // only if they could reach a free vertex before
+                changed.clear();
+                starts.clear();
+                covered = 0;
+                for (it = set.begin(); it != set.end(); ++it) {
+                    u = matching.matchIn(*it);
+                    if (u != -1) {
+                        matching.unmatch(u, *it);
+                        changed.push_back(u);
+                        if (m_distances[u] >= 0)
+                            starts.push_back(u);
+                    }
+
+                    v = m_sourceComponent[*it];
+                    if (v >= 0 && seenSources[v] != c) {
+                        seenSources[v] = c;
+                        covered++;
+                    }
+                }
+
+                flipped.clear();
+                long int matched = m_matchedCount - changed.size() +
+                    engine.repairLocally(view, matching, starts, &flipped, &m_distances);
+                changed.insert(changed.end(), flipped.begin(), flipped.end());
+
+                result.inputCount = set.size();
+                result.deficiency = m_graph.vertexCount() - result.inputCount - matched;
+                result.uncoveredSources = m_sourceCount - covered;
+
+                // Restore the maximum matching; every pair that changed
+                // belongs to a top vertex that was freed or flipped
+                for (it = changed.begin(); it != changed.end(); ++it)
+                    matching.unmatch(*it, matching.matchOut(*it));
+                for (it = changed.begin(); it != changed.end(); ++it)
+                    matching.setMatch(*it, m_matching.matchOut(*it));
+            }
+        }
+
+        view.clear();
+    });
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_INPUT_SETS_H
@@ -0,0 +1,790 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_MATCHING_H
+#define NETCTRL_KERNEL_MATCHING_H
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <netctrl/util/directed_matching.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Hopcroft-Karp maximum matching on the bipartite representation of a graph
+/**
+ * The bipartite graph is implicit: the "top" copy of each vertex u is
+ * connected to the "bottom" copy of each outbound neighbor of u. A maximum
+ * matching of this bipartite graph is a maximum \c DirectedMatching of the
+ * original graph in the sense of Liu et al.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h;
+ * masked views are supported. The engine keeps its workspace between calls
+ * so it can be reused for many graphs of similar size without reallocating.
+ * The engine is not copyable; each thread needs its own.
+ */
+template <typename G>
+class MatchingEngine {
+private:
+    /// BFS layer of each top vertex in the current phase
+    std::vector<long int> m_layer;
+
+    /// Queue of the BFS
+    std::vector<long int> m_queue;
+
+    /// Stack of top vertices in the DFS
+    std::vector<long int> m_stack;
+
+    /// Index of the next outbound edge to try for each top vertex in the DFS
+    std::vector<long int> m_cursor;
+
+    /// Index of the next outbound edge to check for a free bottom vertex,
+    /// for each top vertex in the repair
+    std::vector<long int> m_lookahead;
+
+    /// State of each bottom vertex in the repair: 0 if not visited, 1 if
+    /// visited by the current search, 2 if it is known to lead nowhere
+    std::vector<signed char> m_state;
+
+    /// Bottom vertices visited by the current search in the repair, preceded
+    /// by the ones that earlier searches of the same repair left dead
+    std::vector<long int> m_visited;
+
+    /// Top vertices whose lookahead may have been advanced in the repair
+    std::vector<long int> m_touched;
+
+    /// Free top vertices that the local repair searches from
+    std::vector<long int> m_candidates;
+
+    /// Round in which each bottom vertex was last claimed by a parallel search
+    std::unique_ptr<std::atomic<long int>[]> m_claims;
+
+    /// Number of entries in \c m_claims
+    long int m_claimCount;
+
+    /// Index of the current round of parallel searches
+    long int m_round;
+
+    /// Whether \c m_layer, \c m_state and \c m_lookahead are all zero, so
+    /// the local repair does not have to clear them
+    bool m_clean;
+
+    MatchingEngine(const MatchingEngine&);
+    MatchingEngine& operator=(const MatchingEngine&);
+
+public:
+    /// Constructs a matching engine with an empty workspace
+    MatchingEngine() : m_layer(), m_queue(), m_stack(), m_cursor(), m_lookahead(),
+        m_state(), m_visited(), m_touched(), m_candidates(), m_claims(),
+        m_claimCount(0), m_round(0), m_clean(false) {}
+
+    /**
+     * \brief Extends a matching to a maximum matching.
+     *
+     * If the matching is not defined on the same number of vertices as the
+     * graph, it is replaced by a greedy initial matching first. Otherwise
+     * it is used as a warm start and it is augmented until it becomes
+     * maximum. Each pair of the initial matching must correspond to an
+     * edge of the graph.
+     *
+     * \return the number of matched pairs
+     */
+    long int run(const G& graph, DirectedMatching& matching);
+
+    /**
+     * \brief Repairs a matching that was maximum on a slightly different
+     *        graph to a maximum matching of this graph.
+     *
+     * Each pair of the matching must correspond to an edge of the graph;
+     * pairs on edges that do not exist any more must be removed before.
+     * The repair searches for an augmenting path from each free top vertex
+     * once, with a depth-first search that looks for a free bottom vertex
+     * among the neighbors of each top vertex first. If there is no
+     * augmenting path from a vertex, there will not be any after augmenting
+     * along other paths either, and neither will there be one through any
+     * of the bottom vertices that the failed search visited; these are
+     * skipped by all the later searches. A single pass is therefore enough,
+     * and failed searches cost linear time in total.
+     *
+     * The searches from the vertices that were free in the original maximum
+     * matching usually fail, so they run first to rule out as much of the
+     * graph as possible; the vertices that became free when the matching
+     * was changed run last.
+     *
+     * \param  graph    the graph
+     * \param  matching the matching to repair
+     * \param  changed  the top vertices whose pairs were removed from the
+     *                  original maximum matching
+     * \return the number of matched pairs
+     */
+    long int repair(const G& graph, DirectedMatching& matching,
+            const std::vector<long int>& changed);
+
+    /**
+     * \brief Repairs a maximum matching after a batch of edge insertions and
+     *        deletions, searching only where the batch made a difference.
+     *
+     * Each pair of the matching must correspond to an edge of the graph;
+     * pairs on deleted edges must be removed before. An augmenting path
+     * that did not exist before the batch must start from a top vertex
+     * whose pair was removed, end at a bottom vertex whose pair was
+     * removed, or use an inserted edge. The free top vertices that can
+     * start such a path are found by a backward alternating search from
+     * the given vertices, and only these are searched for augmenting paths:
+     * first in rounds of parallel searches on the threads of the library
+     * (see \c setThreadCount()), where each bottom vertex is claimed by one
+     * search per round so the paths found are vertex-disjoint, then once
+     * more as in \c repair() for the vertices that are still free. The
+     * rounds stop when they find fewer paths than there are threads.
+     *
+     * The cost depends on the part of the graph that the backward search
+     * reaches, not on the size of the graph, except when the number of
+     * vertices changes between calls.
+     *
+     * \param  graph    the graph after the batch
+     * \param  matching the matching to repair
+     * \param  sources  the top vertices whose pairs were removed and the
+     *                  sources of the inserted edges (in undirected graphs,
+     *                  both endpoints of the inserted edges)
+     * \param  targets  the bottom vertices whose pairs were removed
+     * \param  flipped  if not null, the top vertices whose pairs were
+     *                  changed by the augmenting paths are appended here;
+     *                  their new pairs cover all the bottom vertices whose
+     *                  pairs were changed
+     * \return the number of augmenting paths found
+     */
+    long int repairAround(const G& graph, DirectedMatching& matching,
+            const std::vector<long int>& sources, const std::vector<long int>& targets,
+            std::vector<long int>* flipped = 0);
+
+    /**
+     * \brief Repairs a maximum matching from a few free top vertices only,
+     *        on the calling thread.
+     *
+     * This is the sequential part of \c repairAround() without the backward
+     * search: the caller must know that every augmenting path starts from
+     * one of the given vertices, e.g. because they lost their pairs when
+     * the graph was restricted to a masked view that hides some bottom
+     * vertices. Each vertex is searched once as in \c repair(). A
+     * successful search may wander far from the nearest free bottom vertex,
+     * and whatever it visited has to be explored again by the next search;
+     * if \c distances is given, each top vertex therefore tries the mates
+     * that are closer to a free bottom vertex first. The hint only changes
+     * the running time, not the result. The workspace is only cleared where
+     * the searches went, so many small repairs on the same graph cost time
+     * proportional to the part of the graph they explore. Unlike
+     * \c repairAround(), it never starts other threads, so separate engines
+     * can repair separate matchings in parallel.
+     *
+     * \param  graph    the graph
+     * \param  matching the matching to repair
+     * \param  starts   the top vertices to search from; matched ones are
+     *                  skipped
+     * \param  flipped  if not null, the top vertices whose pairs were
+     *                  changed by the augmenting paths are appended here
+     * \param  distances if not null, the length of a shortest alternating
+     *                  path from each top vertex to a free bottom vertex,
+     *                  or -1 if there is none, e.g. in the maximum matching
+     *                  that \c matching was derived from
+     * \return the number of augmenting paths found
+     */
+    long int repairLocally(const G& graph, DirectedMatching& matching,
+            const std::vector<long int>& starts, std::vector<long int>* flipped = 0,
+            const std::vector<long int>* distances = 0);
+
+private:
+    /// Builds the layered graph for the next phase
+    /**
+     * \return  the length of the shortest augmenting paths, or -1 if there
+     *          are no augmenting paths any more
+     */
+    long int buildLayers(const G& graph, const DirectedMatching& matching);
+
+    /// Tries to find an augmenting path from the given free top vertex
+    bool augmentFrom(const G& graph, DirectedMatching& matching, long int start,
+            long int length);
+
+    /// Tries to find an augmenting path from the given free top vertex in the repair
+    bool repairFrom(const G& graph, DirectedMatching& matching, long int start);
+
+    /// Tries to find an augmenting path from the given free top vertex in the
+    /// local repair, descending to the mates closer to a free bottom vertex
+    /// first if \c distances is not null
+    bool repairGuidedFrom(const G& graph, DirectedMatching& matching, long int start,
+            const std::vector<long int>* distances);
+
+    /// Searches for augmenting paths from the candidates in parallel rounds
+    /**
+     * The candidates that are still free afterwards are left in
+     * \c m_candidates. The top vertices on the paths are appended to
+     * \c flipped unless it is null.
+     *
+     * \return the number of augmenting paths found
+     */
+    long int augmentInParallel(const G& graph, DirectedMatching& matching,
+            std::vector<long int>* flipped);
+
+    /// Tries to find an augmenting path from the given free top vertex
+    /// through bottom vertices that no other search claimed in this round
+    bool augmentClaimed(const G& graph, DirectedMatching& matching, long int start,
+            std::vector<std::pair<long int, long int> >& stack);
+
+    /// Claims a bottom vertex for the calling search in the current round
+    bool claim(long int v) {
+        long int round = m_claims[v].load(std::memory_order_relaxed);
+        return round != m_round && m_claims[v].compare_exchange_strong(round, m_round);
+    }
+};
+
+/// Convenience function that runs a \c MatchingEngine on a graph
+template <typename G>
+long int maximumMatching(const G& graph, DirectedMatching& matching) {
+    MatchingEngine<G> engine;
+    return engine.run(graph, matching);
+}
+
+/// Calculates the structural rank of the adjacency matrix of a graph
+/**
+ * The structural rank of a matrix is the largest rank that a matrix with the
+ * same nonzero pattern can have; it is the size of a maximum matching of the
+ * bipartite graph of its rows and columns. The number of driver nodes in the
+ * model of Liu et al is the number of vertices minus the structural rank.
+ *
+ * Rectangular matrices with r rows and c columns can be handled by a graph
+ * with max(r, c) vertices that has an edge from row i to column j for every
+ * nonzero entry; the extra isolated vertices do not change the matching.
+ */
+template <typename G>
+long int structuralRank(const G& graph) {
+    DirectedMatching matching;
+    return maximumMatching(graph, matching);
+}
+
+
+/*************************************************************************/
+
+
+template <typename G>
+long int MatchingEngine<G>::run(const G& graph, DirectedMatching& matching) {
+    long int u, i, k, v, n = graph.vertexCount(), length, result = 0;
+
+    if (matching.size() != n) {
+        // Greedy initialization
+        matching = DirectedMatching(n);
+        for (u = 0; u < n; u++) {
+            k = graph.outDegree(u);
+            for (i = 0; i < k; i++) {
+                v = graph.outNeighbor(u, i);
+                if (v >= 0 && !matching.isMatched(v)) {
+                    matching.setMatch(u, v);
+                    break;
+                }
+            }
+        }
+    }
+
+    m_layer.resize(n);
+    m_cursor.resize(n);
+    m_clean = false;
+
+    while ((length = buildLayers(graph, matching)) >= 0) {
+        std::fill(m_cursor.begin(), m_cursor.end(), 0);
+        for (u = 0; u < n; u++) {
+            if (!matching.isMatching(u) && m_layer[u] == 0)
+                augmentFrom(graph, matching, u, length);
+        }
+    }
+
+    for (u = 0; u < n; u++) {
+        if (matching.isMatching(u))
+            result++;
+    }
+
+    return result;
+}
+
+template <typename G>
+long int MatchingEngine<G>::repair(const G& graph, DirectedMatching& matching,
+        const std::vector<long int>& changed) {
+    long int u, n = graph.vertexCount(), result = 0;
+    std::vector<long int>::const_iterator it;
+
+    m_cursor.resize(n);
+    m_lookahead.assign(n, 0);
+    m_state.assign(n, 0);
+    m_visited.clear();
+    m_touched.clear();
+    m_clean = false;
+
+    // The free vertices that were also free in the original matching come
+    // first; m_layer marks the changed ones so they can be skipped here
+    m_layer.assign(n, 0);
+    for (it = changed.begin(); it != changed.end(); ++it)
+        m_layer[*it] = 1;
+    for (u = 0; u < n; u++) {
+        if (!matching.isMatching(u) && m_layer[u] == 0)
+            repairFrom(graph, matching, u);
+    }
+    for (it = changed.begin(); it != changed.end(); ++it) {
+        if (!matching.isMatching(*it))
+            repairFrom(graph, matching, *it);
+    }
+
+    for (u = 0; u < n; u++) {
+        if (matching.isMatching(u))
+            result++;
+    }
+
+    return result;
+}
+
+template <typename G>
+bool MatchingEngine<G>::repairFrom(const G& graph, DirectedMatching& matching,
+        long int start) {
+    long int u, v, w, k, previous, level;
+    bool found = false;
+    std::vector<long int>::const_iterator it;
+
+    size_t first = m_visited.size();
+
+    m_stack.clear();
+    m_stack.push_back(start);
+    m_cursor[start] = 0;
+
+    while (!m_stack.empty()) {
+        u = m_stack.back();
+        k = graph.outDegree(u);
+        if (m_lookahead[u] == 0)
+            m_touched.push_back(u);
+
+        // Bottom vertices never become free again, so the lookahead of each
+        // top vertex passes over each edge only once during the repair
+        for (v = -1; m_lookahead[u] < k; m_lookahead[u]++) {
+            w = graph.outNeighbor(u, m_lookahead[u]);
+            if (w >= 0 && !matching.isMatched(w)) {
+                v = w;
+                break;
+            }
+        }
+
+        if (v >= 0) {
+            // Found an augmenting path; flip the edges along the stack
+            for (level = m_stack.size() - 1; level >= 0; level--) {
+                u = m_stack[level];
+                previous = matching.matchOut(u);
+                matching.setMatch(u, v);
+                v = previous;
+            }
+            found = true;
+            break;
+        }
+
+        // Descend to the mate of the next bottom vertex not visited yet
+        for (w = -1; w < 0 && m_cursor[u] < k; ) {
+            v = graph.outNeighbor(u, m_cursor[u]++);
+            if (v < 0 || m_state[v] != 0)
+                continue;
+            m_state[v] = 1;
+            m_visited.push_back(v);
+            w = matching.matchIn(v);
+        }
+
+        if (w >= 0) {
+            m_cursor[w] = 0;
+            m_stack.push_back(w);
+        } else {
+            m_stack.pop_back();
+        }
+    }
+
+    // The bottom vertices visited by a failed search lead nowhere; those
+    // visited by a successful one may be visited again
+    for (it = m_visited.begin() + first; it != m_visited.end(); ++it)
+        m_state[*it] = found ? 0 : 2;
+    if (found)
+        m_visited.resize(first);
+
+    return found;
+}
+
+template <typename G>
+long int MatchingEngine<G>::repairAround(const G& graph, DirectedMatching& matching,
+        const std::vector<long int>& sources, const std::vector<long int>& targets,
+        std::vector<long int>* flipped) {
+    long int i, k, u, v, w, n = graph.vertexCount(), result = 0;
+    size_t head;
+    std::vector<long int>::const_iterator it;
+
+    if (!m_clean || static_cast<long int>(m_layer.size()) != n) {
+        m_layer.assign(n, 0);
+        m_state.assign(n, 0);
+        m_lookahead.assign(n, 0);
+        m_clean = true;
+    }
+    m_cursor.resize(n);
+
+    // Backward alternating search from the changes; m_layer marks the top
+    // vertices that were reached. A matched top vertex can only be reached
+    // through its mate from the other sources of edges that point there.
+    m_queue.clear();
+    m_candidates.clear();
+    for (it = sources.begin(); it != sources.end(); ++it) {
+        if (m_layer[*it] == 0) {
+            m_layer[*it] = 1;
+            m_queue.push_back(*it);
+        }
+    }
+    for (it = targets.begin(); it != targets.end(); ++it) {
+        k = graph.inDegree(*it);
+        for (i = 0; i < k; i++) {
+            w = graph.inNeighbor(*it, i);
+            if (w >= 0 && m_layer[w] == 0) {
+                m_layer[w] = 1;
+                m_queue.push_back(w);
+            }
+        }
+    }
+    for (head = 0; head < m_queue.size(); head++) {
+        u = m_queue[head];
+        v = matching.matchOut(u);
+        if (v == -1) {
+            m_candidates.push_back(u);
+            continue;
+        }
+
+        k = graph.inDegree(v);
+        for (i = 0; i < k; i++) {
+            w = graph.inNeighbor(v, i);
+            if (w >= 0 && m_layer[w] == 0) {
+                m_layer[w] = 1;
+                m_queue.push_back(w);
+            }
+        }
+    }
+    for (it = m_queue.begin(); it != m_queue.end(); ++it)
+        m_layer[*it] = 0;
+
+    // The candidates far from the changes were usually free before the
+    // batch and their searches usually fail, so they run first as in
+    // repair()
+    std::reverse(m_candidates.begin(), m_candidates.end());
+
+    // The candidates usually run into each other when there are many of
+    // them, so most of the paths are found in parallel and the rest of the
+    // candidates are searched one by one, without ever searching the same
+    // dead end twice
+    if (threadCount() > 1)
+        result += augmentInParallel(graph, matching, flipped);
+
+    m_visited.clear();
+    m_touched.clear();
+    for (it = m_candidates.begin(); it != m_candidates.end(); ++it) {
+        if (!matching.isMatching(*it) && repairFrom(graph, matching, *it)) {
+            // repairFrom() leaves the path on the stack
+            if (flipped)
+                flipped->insert(flipped->end(), m_stack.begin(), m_stack.end());
+            result++;
+        }
+    }
+    for (it = m_visited.begin(); it != m_visited.end(); ++it)
+        m_state[*it] = 0;
+    for (it = m_touched.begin(); it != m_touched.end(); ++it)
+        m_lookahead[*it] = 0;
+
+    return result;
+}
+
+template <typename G>
+long int MatchingEngine<G>::repairLocally(const G& graph, DirectedMatching& matching,
+        const std::vector<long int>& starts, std::vector<long int>* flipped,
+        const std::vector<long int>* distances) {
+    long int n = graph.vertexCount(), result = 0;
+    std::vector<long int>::const_iterator it;
+
+    if (!m_clean || static_cast<long int>(m_layer.size()) != n) {
+        m_layer.assign(n, 0);
+        m_state.assign(n, 0);
+        m_lookahead.assign(n, 0);
+        m_clean = true;
+    }
+    m_cursor.resize(n);
+
+    m_visited.clear();
+    m_touched.clear();
+    for (it = starts.begin(); it != starts.end(); ++it) {
+        if (!matching.isMatching(*it) && repairGuidedFrom(graph, matching, *it, distances)) {
+            // repairGuidedFrom() leaves the path on the stack
+            if (flipped)
+                flipped->insert(flipped->end(), m_stack.begin(), m_stack.end());
+            result++;
+        }
+    }
+    for (it = m_visited.begin(); it != m_visited.end(); ++it)
+        m_state[*it] = 0;
+    for (it = m_touched.begin(); it != m_touched.end(); ++it)
+        m_lookahead[*it] = 0;
+
+    return result;
+}
+
+template <typename G>
+bool MatchingEngine<G>::repairGuidedFrom(const G& graph, DirectedMatching& matching,
+        long int start, const std::vector<long int>* distances) {
+    long int u, v, w, i, k, previous, level, distance;
+    bool found = false;
+    std::vector<long int>::const_iterator it;
+
+    size_t first = m_visited.size();
+
+    m_stack.clear();
+    m_stack.push_back(start);
+    m_cursor[start] = 0;
+
+    while (!m_stack.empty()) {
+        u = m_stack.back();
+        k = graph.outDegree(u);
+        if (m_lookahead[u] == 0)
+            m_touched.push_back(u);
+
+        for (v = -1; m_lookahead[u] < k; m_lookahead[u]++) {
+            w = graph.outNeighbor(u, m_lookahead[u]);
+            if (w >= 0 && !matching.isMatched(w)) {
+                v = w;
+                break;
+            }
+        }
+
+        if (v >= 0) {
+            // Found an augmenting path; flip the edges along the stack
+            for (level = m_stack.size() - 1; level >= 0; level--) {
+                u = m_stack[level];
+                previous = matching.matchOut(u);
+                matching.setMatch(u, v);
+                v = previous;
+            }
+            found = true;
+            break;
+        }
+
+        // The cursor passes over the edges twice: first it only takes the
+        // mates that are closer to a free bottom vertex than u, then the rest
+        distance = distances ? (*distances)[u] : -1;
+        for (w = -1; w < 0 && m_cursor[u] < 2 * k; ) {
+            i = m_cursor[u]++;
+            v = graph.outNeighbor(u, i < k ? i : i - k);
+            if (v < 0 || m_state[v] != 0)
+                continue;
+            w = matching.matchIn(v);
+            if (i < k && distance >= 0 && ((*distances)[w] < 0 || (*distances)[w] >= distance)) {
+                w = -1;
+                continue;
+            }
+            m_state[v] = 1;
+            m_visited.push_back(v);
+        }
+
+        if (w >= 0) {
+            m_cursor[w] = 0;
+            m_stack.push_back(w);
+        } else {
+            m_stack.pop_back();
+        }
+    }
+
+    // The bottom vertices visited by a failed search lead nowhere; those
+    // visited by a successful one may be visited again
+    for (it = m_visited.begin() + first; it != m_visited.end(); ++it)
+        m_state[*it] = found ? 0 : 2;
+    if (found)
+        m_visited.resize(first);
+
+    return found;
+}
+
+template <typename G>
+long int MatchingEngine<G>::augmentInParallel(const G& graph, DirectedMatching& matching,
+        std::vector<long int>* flipped) {
+    long int i, n = graph.vertexCount(), numWorkers, found, result = 0;
+
+    if (m_claimCount != n) {
+        m_claims.reset(new std::atomic<long int>[n]);
+        for (i = 0; i < n; i++)
+            m_claims[i].store(0, std::memory_order_relaxed);
+        m_claimCount = n;
+        m_round = 0;
+    }
+
+    numWorkers = threadCount();
+    std::vector<std::vector<long int> > flippedByWorker(numWorkers);
+    do {
+        long int numCandidates = m_candidates.size();
+        std::vector<char> success(numCandidates, 0);
+        std::atomic<long int> next(0);
+
+        // Each bottom vertex is claimed by at most one search per round, so
+        // the searches flip disjoint parts of the matching and never read
+        // the parts that the others may be writing
+        m_round++;
+        parallelFor(0, std::min(numWorkers, numCandidates), [&](long int worker) {
+            std::vector<std::pair<long int, long int> > stack;
+            std::vector<std::pair<long int, long int> >::const_iterator it;
+            long int index;
+            while ((index = next.fetch_add(1)) < numCandidates) {
+                success[index] = augmentClaimed(graph, matching, m_candidates[index],
+                        stack);
+                if (success[index] && flipped) {
+                    // augmentClaimed() leaves the path on the stack
+                    for (it = stack.begin(); it != stack.end(); ++it)
+                        flippedByWorker[worker].push_back(it->first);
+                }
+            }
+        });
+
+        for (i = 0, found = 0; i < numCandidates; i++) {
+            if (success[i])
+                found++;
+            else
+                m_candidates[i - found] = m_candidates[i];
+        }
+        m_candidates.resize(numCandidates - found);
+        result += found;
+    } while (found >= numWorkers && !m_candidates.empty());
+
+    if (flipped) {
+        for (i = 0; i < numWorkers; i++)
+            flipped->insert(flipped->end(), flippedByWorker[i].begin(),
+                    flippedByWorker[i].end());
+    }
+
+    return result;
+}
+
+template <typename G>
+bool MatchingEngine<G>::augmentClaimed(const G& graph, DirectedMatching& matching,
+        long int start, std::vector<std::pair<long int, long int> >& stack) {
+    long int u, v, w, previous, level, index;
+
+    stack.clear();
+    stack.push_back(std::make_pair(start, 0L));
+
+    while (!stack.empty()) {
+        u = stack.back().first;
+        index = stack.back().second++;
+        if (index >= graph.outDegree(u)) {
+            stack.pop_back();
+            continue;
+        }
+
+        v = graph.outNeighbor(u, index);
+        if (v < 0 || !claim(v))
+            continue;
+
+        w = matching.matchIn(v);
+        if (w == -1) {
+            // Found an augmenting path; flip the edges along the stack
+            for (level = stack.size() - 1; level >= 0; level--) {
+                u = stack[level].first;
+                previous = matching.matchOut(u);
+                matching.setMatch(u, v);
+                v = previous;
+            }
+            return true;
+        }
+
+        stack.push_back(std::make_pair(w, 0L));
+    }
+
+    return false;
+}
+
+template <typename G>
+long int MatchingEngine<G>::buildLayers(const G& graph, const DirectedMatching& matching) {
+    const long int infinity = std::numeric_limits<long int>::max();
+    long int u, w, i, k, n = graph.vertexCount(), head, result = infinity;
+
+    m_queue.clear();
+    for (u = 0; u < n; u++) {
+        if (matching.isMatching(u)) {
+            m_layer[u] = infinity;
+        } else {
+            m_layer[u] = 0;
+            m_queue.push_back(u);
+        }
+    }
+
+    for (head = 0; head < static_cast<long int>(m_queue.size()); head++) {
+        u = m_queue[head];
+        if (m_layer[u] >= result)
+            break;
+
+        k = graph.outDegree(u);
+        for (i = 0; i < k; i++) {
+            w = graph.outNeighbor(u, i);
+            if (w < 0)
+                continue;
+
+            w = matching.matchIn(w);
+            if (w == -1) {
+                if (result == infinity)
+                    result = m_layer[u] + 1;
+            } else if (m_layer[w] == infinity) {
+                m_layer[w] = m_layer[u] + 1;
+                m_queue.push_back(w);
+            }
+        }
+    }
+
+    return result == infinity ? -1 : result;
+}
+
+template <typename G>
+bool MatchingEngine<G>::augmentFrom(const G& graph, DirectedMatching& matching,
+        long int start, long int length) {
+    const long int infinity = std::numeric_limits<long int>::max();
+    long int u, v, w, previous, level;
+
+    m_stack.clear();
+    m_stack.push_back(start);
+
+    while (!m_stack.empty()) {
+        u = m_stack.back();
+        if (m_cursor[u] >= graph.outDegree(u)) {
+            // Dead end; make sure that we do not try u again in this phase
+            m_layer[u] = infinity;
+            m_stack.pop_back();
+            continue;
+        }
+
+        v = graph.outNeighbor(u, m_cursor[u]++);
+        if (v < 0)
+            continue;
+
+        w = matching.matchIn(v);
+        if (w == -1) {
+            if (m_layer[u] + 1 != length)
+                continue;
+
+            // Found an augmenting path; flip the edges along the stack from
+            // the end so setMatch() never has to unmatch a fresh pair
+            for (level = m_stack.size() - 1; level >= 0; level--) {
+                u = m_stack[level];
+                previous = matching.matchOut(u);
+                matching.setMatch(u, v);
+                m_layer[u] = infinity;
+                v = previous;
+            }
+            return true;
+        }
+
+        if (m_layer[w] == m_layer[u] + 1)
+            m_stack.push_back(w);
+    }
+
+    return false;
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_MATCHING_H
@@ -0,0 +1,656 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_SCC_H
+#define NETCTRL_KERNEL_SCC_H
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Subgraph of an implicit directed graph induced by a set of nodes
+/**
+ * The nodes of the subgraph are numbered by their position in the node
+ * list, and \c local maps each node of the original graph to its number in
+ * the subgraph or to -1 if it is not part of it. Entries leading out of the
+ * subgraph are reported as -1, so the subgraph can be passed to
+ * \c stronglyConnectedComponents() or anything else that expects the
+ * interface of \c AlternatingGraph.
+ */
+template <typename D>
+class InducedDigraph {
+private:
+    /// The original graph
+    const D& m_digraph;
+
+    /// The nodes of the subgraph
+    const std::vector<long int>& m_nodes;
+
+    /// The number of each node of the original graph in the subgraph
+    const std::vector<long int>& m_local;
+
+public:
+    /// Constructs the subgraph induced by the given nodes
+    InducedDigraph(const D& digraph, const std::vector<long int>& nodes,
+            const std::vector<long int>& local)
+        : m_digraph(digraph), m_nodes(nodes), m_local(local) {}
+
+    /// Returns the number of nodes in the subgraph
+    long int nodeCount() const {
+        return m_nodes.size();
+    }
+
+    /// Returns the number of inbound edge candidates of the given node
+    long int inCandidates(long int x) const {
+        return m_digraph.inCandidates(m_nodes[x]);
+    }
+
+    /// Returns the source of the i-th inbound edge candidate of the given node
+    long int inEntry(long int x, long int i, long int* edge) const {
+        long int y = m_digraph.inEntry(m_nodes[x], i, edge);
+        return y == -1 ? -1 : m_local[y];
+    }
+
+    /// Returns the number of outbound edge candidates of the given node
+    long int outCandidates(long int x) const {
+        return m_digraph.outCandidates(m_nodes[x]);
+    }
+
+    /// Returns the target of the i-th outbound edge candidate of the given node
+    long int outEntry(long int x, long int i, long int* edge) const {
+        long int y = m_digraph.outEntry(m_nodes[x], i, edge);
+        return y == -1 ? -1 : m_local[y];
+    }
+};
+
+/**
+ * \brief Calculates the strongly connected components of an implicit
+ *        directed graph using an iterative variant of Tarjan's algorithm.
+ *
+ * \c D must provide \c nodeCount(), \c outCandidates(x) and
+ * <tt>outEntry(x, i, &edge)</tt> like \c AlternatingGraph does; entries
+ * for which \c outEntry() returns -1 are skipped.
+ *
+ * \param  digraph     the directed graph
+ * \param  membership  the component index of each node is returned here
+ * \return the number of strongly connected components
+ */
+template <typename D>
+long int stronglyConnectedComponents(const D& digraph, std::vector<long int>& membership) {
+    long int n = digraph.nodeCount(), counter = 0, componentCount = 0;
+    long int root, x, y, i, edge;
+    std::vector<long int> index(n, -1), lowLink(n), cursor(n, 0);
+    std::vector<long int> callStack, componentStack;
+    std::vector<bool> onStack(n, false);
+
+    membership.assign(n, -1);
+
+    for (root = 0; root < n; root++) {
+        if (index[root] != -1)
+            continue;
+
+        callStack.push_back(root);
+        while (!callStack.empty()) {
+            x = callStack.back();
+
+            if (index[x] == -1) {
+                index[x] = lowLink[x] = counter++;
+                componentStack.push_back(x);
+                onStack[x] = true;
+            }
+
+            // Advance to the next unvisited successor of x
+            y = -1;
+            while (cursor[x] < digraph.outCandidates(x)) {
+                i = cursor[x]++;
+                y = digraph.outEntry(x, i, &edge);
+                if (y == -1)
+                    continue;
+                if (index[y] == -1)
+                    break;
+                if (onStack[y] && index[y] < lowLink[x])
+                    lowLink[x] = index[y];
+                y = -1;
+            }
+
+            if (y != -1) {
+                callStack.push_back(y);
+                continue;
+            }
+
+            // All successors of x are done; pop it and propagate its low-link
+            callStack.pop_back();
+            if (!callStack.empty() && lowLink[x] < lowLink[callStack.back()])
+                lowLink[callStack.back()] = lowLink[x];
+
+            if (lowLink[x] == index[x]) {
+                do {
+                    y = componentStack.back();
+                    componentStack.pop_back();
+                    onStack[y] = false;
+                    membership[y] = componentCount;
+                } while (y != x);
+                componentCount++;
+            }
+        }
+    }
+
+    return componentCount;
+}
+
+/**
+ * \brief Calculates the strongly connected components of an implicit
+ *        directed graph on the threads of the library.
+ *
+ * This is the Multistep algorithm of Slota, Rajamanickam and Madduri
+ * (IPDPS 2014), which suits the graphs seen here: one giant component and
+ * a great many tiny ones.
+ *
+ * -# Nodes without inbound or outbound edges are components on their
+ *    own. They are trimmed in parallel, and so are the nodes that lose
+ *    their last inbound or outbound edge to the trimmed ones, until only
+ *    nodes on cycles (and between them) are left.
+ * -# The component of the node with the most edges, usually the giant
+ *    one, is the intersection of a parallel forward and a parallel
+ *    backward search from it (the forward-backward step).
+ * -# The rest is split by coloring: each node takes the largest node index
+ *    that can reach it, spread along the edges in parallel until nothing
+ *    changes. A node that keeps its own index is the root of a color, and
+ *    its component consists of the nodes of its color that it is reached
+ *    from, found by a backward search within the color. The colors are
+ *    disjoint, so the searches of all the roots run in parallel. Each
+ *    round removes at least one component, but possibly only one, and the
+ *    colors of a deep graph take many steps to settle, so the rounds go
+ *    on only while there are enough nodes left to keep the threads busy,
+ *    each round removes a fair share of them and the colors settle
+ *    within a bounded amount of work.
+ * -# The remaining nodes are handed to \c stronglyConnectedComponents().
+ *
+ * Each component is labeled in a shared array by one of its nodes, and
+ * the labels are numbered from zero in the order of the smallest node of
+ * each component at the end, so the result does not depend on the number
+ * of threads or their timing. Small graphs and single-threaded runs go to
+ * \c stronglyConnectedComponents() directly.
+ *
+ * \c D must provide \c inCandidates() and \c inEntry() in addition to
+ * what \c stronglyConnectedComponents() needs, and its methods must be
+ * safe to call from several threads at once; \c AlternatingGraph and
+ * \c InducedDigraph are.
+ */
+template <typename D>
+class ParallelComponentFinder {
+private:
+    /// The graph
+    const D& m_digraph;
+
+    /// The number of nodes
+    long int m_n;
+
+    /// Whether each node is still unassigned to a component
+    std::vector<signed char> m_alive;
+
+    /// The unassigned nodes
+    std::vector<long int> m_nodes;
+
+    /// The node that labels the component of each node, or -1
+    std::vector<long int> m_label;
+
+    /// The color of each node in the coloring rounds
+    std::unique_ptr<std::atomic<long int>[]> m_color;
+
+    /// Search flags of each node: which searches reached it in the
+    /// forward-backward step, and whether it is queued in the coloring
+    std::unique_ptr<std::atomic<unsigned char>[]> m_flags;
+
+    ParallelComponentFinder(const ParallelComponentFinder&);
+    ParallelComponentFinder& operator=(const ParallelComponentFinder&);
+
+public:
+    /// The number of nodes below which the rest is left to Tarjan's algorithm
+    enum { SERIAL_THRESHOLD = 16384 };
+
+    /// The rest is also left to Tarjan's algorithm when a coloring round
+    /// removes fewer than one in this many of the remaining nodes
+    enum { MIN_PROGRESS = 8 };
+
+    /// A coloring round gives up when the colors were spread from this
+    /// many times as many nodes as there are left; the colors of a deep
+    /// graph grow one level at a time, which takes quadratic work
+    enum { COLOR_BUDGET = 8 };
+
+    /// Constructs a finder for the given graph
+    explicit ParallelComponentFinder(const D& digraph) : m_digraph(digraph),
+        m_n(digraph.nodeCount()), m_alive(), m_nodes(), m_label(), m_color(),
+        m_flags() {}
+
+    /**
+     * \brief Calculates the strongly connected components.
+     *
+     * \param  membership  the component index of each node is returned here
+     * \return the number of strongly connected components
+     */
+    long int run(std::vector<long int>& membership);
+
+private:
+    /// Calls <tt>body(begin, end, worker)</tt> for consecutive ranges of
+    /// indices from zero to \c count, on the threads of the library; each
+    /// worker has its own index below \c threadCount()
+    template <typename Function>
+    static void forEachBlock(long int count, long int blockSize, Function body);
+
+    /// Returns the number of edges of a node from or to other live nodes
+    long int liveDegree(long int x, bool forward) const;
+
+    /// Assigns the nodes that are not on any cycle to their own components
+    void trim();
+
+    /// Assigns the component of the node with the most edges
+    void forwardBackward();
+
+    /// Marks the nodes reachable from a node with the given flag
+    void search(long int start, bool forward, unsigned char flag);
+
+    /// Assigns the components of the roots of a coloring
+    /**
+     * \return \c false if the coloring was given up before any component
+     *         was assigned
+     */
+    bool color();
+
+    /// Assigns the remaining nodes with Tarjan's algorithm
+    void finishSerially();
+
+    /// Removes the assigned nodes from the live ones
+    void compact();
+};
+
+/// Convenience function that runs a \c ParallelComponentFinder on a graph
+template <typename D>
+long int parallelStronglyConnectedComponents(const D& digraph,
+        std::vector<long int>& membership) {
+    ParallelComponentFinder<D> finder(digraph);
+    return finder.run(membership);
+}
+
+
+/*************************************************************************/
+
+
+template <typename D>
+long int ParallelComponentFinder<D>::run(std::vector<long int>& membership) {
+    long int x, r, before, count = 0;
+
+    if (threadCount() <= 1 || m_n < SERIAL_THRESHOLD)
+        return stronglyConnectedComponents(m_digraph, membership);
+
+    m_alive.assign(m_n, 1);
+    m_label.assign(m_n, -1);
+    m_nodes.resize(m_n);
+    for (x = 0; x < m_n; x++)
+        m_nodes[x] = x;
+    m_color.reset(new std::atomic<long int>[m_n]);
+    m_flags.reset(new std::atomic<unsigned char>[m_n]);
+
+    trim();
+    if (static_cast<long int>(m_nodes.size()) >= SERIAL_THRESHOLD)
+        forwardBackward();
+    // A round may remove as little as one component, e.g. on a chain of
+    // small cycles, so the rounds stop as soon as they stall
+    while (static_cast<long int>(m_nodes.size()) >= SERIAL_THRESHOLD) {
+        before = m_nodes.size();
+        if (!color())
+            break;
+        if (before - static_cast<long int>(m_nodes.size()) < before / MIN_PROGRESS)
+            break;
+    }
+    finishSerially();
+
+    // Number the components in the order of their smallest nodes; the
+    // labels of the components found by Tarjan's algorithm come after the
+    // node indices
+    std::vector<long int> index(2 * m_n, -1);
+    membership.resize(m_n);
+    for (x = 0; x < m_n; x++) {
+        r = m_label[x];
+        if (index[r] == -1)
+            index[r] = count++;
+        membership[x] = index[r];
+    }
+
+    m_alive.clear();
+    m_label.clear();
+    m_color.reset();
+    m_flags.reset();
+
+    return count;
+}
+
+template <typename D>
+template <typename Function>
+void ParallelComponentFinder<D>::forEachBlock(long int count, long int blockSize,
+        Function body) {
+    long int numBlocks = (count + blockSize - 1) / blockSize;
+    std::atomic<long int> nextBlock(0);
+
+    parallelFor(0, std::min<long int>(threadCount(), numBlocks), [&](long int worker) {
+        long int block;
+        while ((block = nextBlock.fetch_add(1)) < numBlocks)
+            body(block * blockSize, std::min(count, (block + 1) * blockSize), worker);
+    });
+}
+
+template <typename D>
+long int ParallelComponentFinder<D>::liveDegree(long int x, bool forward) const {
+    long int i, y, edge, k, result = 0;
+
+    k = forward ? m_digraph.outCandidates(x) : m_digraph.inCandidates(x);
+    for (i = 0; i < k; i++) {
+        y = forward ? m_digraph.outEntry(x, i, &edge) : m_digraph.inEntry(x, i, &edge);
+        if (y != -1 && y != x && m_alive[y])
+            result++;
+    }
+
+    return result;
+}
+
+template <typename D>
+void ParallelComponentFinder<D>::trim() {
+    const long int blockSize = 1024;
+    long int numWorkers = threadCount(), w;
+    std::unique_ptr<std::atomic<long int>[]> inDegrees(new std::atomic<long int>[m_n]);
+    std::unique_ptr<std::atomic<long int>[]> outDegrees(new std::atomic<long int>[m_n]);
+    std::vector<long int> frontier, trimmed;
+    std::vector<std::vector<long int> > next(numWorkers);
+
+    // The number of edges of each node from and to other nodes; the nodes
+    // without either kind are trimmed first
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            inDegrees[x].store(liveDegree(x, false), std::memory_order_relaxed);
+            outDegrees[x].store(liveDegree(x, true), std::memory_order_relaxed);
+            m_flags[x].store(0, std::memory_order_relaxed);
+        }
+    });
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int worker) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            if (inDegrees[x].load(std::memory_order_relaxed) == 0 ||
+                    outDegrees[x].load(std::memory_order_relaxed) == 0) {
+                m_flags[x].store(1, std::memory_order_relaxed);
+                next[worker].push_back(x);
+            }
+        }
+    });
+
+    // Trimming a node may leave its neighbors without inbound or outbound
+    // edges; each node is queued by the thread that took its last edge
+    for (;;) {
+        frontier.clear();
+        for (w = 0; w < numWorkers; w++) {
+            frontier.insert(frontier.end(), next[w].begin(), next[w].end());
+            next[w].clear();
+        }
+        if (frontier.empty())
+            break;
+        trimmed.insert(trimmed.end(), frontier.begin(), frontier.end());
+
+        forEachBlock(frontier.size(), blockSize, [&](long int begin, long int end, long int worker) {
+            long int i, j, k, x, y, edge;
+            for (j = begin; j < end; j++) {
+                x = frontier[j];
+                k = m_digraph.outCandidates(x);
+                for (i = 0; i < k; i++) {
+                    y = m_digraph.outEntry(x, i, &edge);
+                    if (y != -1 && y != x && m_alive[y] && inDegrees[y].fetch_sub(1) == 1 &&
+                            !m_flags[y].exchange(1))
+                        next[worker].push_back(y);
+                }
+                k = m_digraph.inCandidates(x);
+                for (i = 0; i < k; i++) {
+                    y = m_digraph.inEntry(x, i, &edge);
+                    if (y != -1 && y != x && m_alive[y] && outDegrees[y].fetch_sub(1) == 1 &&
+                            !m_flags[y].exchange(1))
+                        next[worker].push_back(y);
+                }
+            }
+        });
+    }
+
+    forEachBlock(trimmed.size(), blockSize, [&](long int begin, long int end, long int) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = trimmed[j];
+            m_alive[x] = 0;
+            m_label[x] = x;
+        }
+    });
+    compact();
+}
+
+template <typename D>
+void ParallelComponentFinder<D>::forwardBackward() {
+    const long int blockSize = 1024;
+    long int pivot = -1, numWorkers = threadCount(), w;
+    std::vector<long int> best(numWorkers, -1);
+    std::vector<double> bestScore(numWorkers, -1.0);
+    double pivotScore = -1.0;
+
+    // The node with the most edges is most likely in the giant component
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int worker) {
+        long int j, x;
+        double score;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            score = static_cast<double>(m_digraph.outCandidates(x)) * m_digraph.inCandidates(x);
+            if (score > bestScore[worker] ||
+                    (score == bestScore[worker] && x < best[worker])) {
+                bestScore[worker] = score;
+                best[worker] = x;
+            }
+            m_flags[x].store(0, std::memory_order_relaxed);
+        }
+    });
+    for (w = 0; w < numWorkers; w++) {
+        if (best[w] != -1 && (bestScore[w] > pivotScore ||
+                    (bestScore[w] == pivotScore && best[w] < pivot))) {
+            pivot = best[w];
+            pivotScore = bestScore[w];
+        }
+    }
+
+    search(pivot, true, 1);
+    search(pivot, false, 2);
+
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            if (m_flags[x].load(std::memory_order_relaxed) == 3) {
+                m_alive[x] = 0;
+                m_label[x] = pivot;
+            }
+        }
+    });
+    compact();
+}
+
+template <typename D>
+void ParallelComponentFinder<D>::search(long int start, bool forward, unsigned char flag) {
+    const long int blockSize = 256;
+    long int numWorkers = threadCount(), w;
+    std::vector<long int> frontier(1, start);
+    std::vector<std::vector<long int> > next(numWorkers);
+
+    m_flags[start].fetch_or(flag);
+    while (!frontier.empty()) {
+        forEachBlock(frontier.size(), blockSize, [&](long int begin, long int end, long int worker) {
+            long int i, j, k, x, y, edge;
+            for (j = begin; j < end; j++) {
+                x = frontier[j];
+                k = forward ? m_digraph.outCandidates(x) : m_digraph.inCandidates(x);
+                for (i = 0; i < k; i++) {
+                    y = forward ? m_digraph.outEntry(x, i, &edge) : m_digraph.inEntry(x, i, &edge);
+                    if (y == -1 || !m_alive[y] ||
+                            (m_flags[y].load(std::memory_order_relaxed) & flag))
+                        continue;
+                    if (!(m_flags[y].fetch_or(flag) & flag))
+                        next[worker].push_back(y);
+                }
+            }
+        });
+
+        frontier.clear();
+        for (w = 0; w < numWorkers; w++) {
+            frontier.insert(frontier.end(), next[w].begin(), next[w].end());
+            next[w].clear();
+        }
+    }
+}
+
+template <typename D>
+bool ParallelComponentFinder<D>::color() {
+    const long int blockSize = 256;
+    long int numWorkers = threadCount(), w, work = 0;
+    long int budget = COLOR_BUDGET * static_cast<long int>(m_nodes.size());
+    std::vector<long int> frontier(m_nodes), roots;
+    std::vector<std::vector<long int> > next(numWorkers);
+    std::vector<long int>::const_iterator it;
+
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            m_color[x].store(x, std::memory_order_relaxed);
+            m_flags[x].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    // Spread the largest colors along the edges; a node is queued again
+    // whenever its color grows
+    while (!frontier.empty()) {
+        work += frontier.size();
+        if (work > budget)
+            return false;
+
+        forEachBlock(frontier.size(), blockSize, [&](long int begin, long int end, long int worker) {
+            long int i, j, k, x, y, c, old, edge;
+            for (j = begin; j < end; j++) {
+                x = frontier[j];
+                c = m_color[x].load(std::memory_order_relaxed);
+                k = m_digraph.outCandidates(x);
+                for (i = 0; i < k; i++) {
+                    y = m_digraph.outEntry(x, i, &edge);
+                    if (y == -1 || !m_alive[y])
+                        continue;
+                    old = m_color[y].load(std::memory_order_relaxed);
+                    while (old < c && !m_color[y].compare_exchange_weak(old, c))
+                        ;
+                    if (old < c && !m_flags[y].exchange(1))
+                        next[worker].push_back(y);
+                }
+            }
+        });
+
+        frontier.clear();
+        for (w = 0; w < numWorkers; w++) {
+            frontier.insert(frontier.end(), next[w].begin(), next[w].end());
+            next[w].clear();
+        }
+        for (it = frontier.begin(); it != frontier.end(); ++it)
+            m_flags[*it].store(0, std::memory_order_relaxed);
+    }
+
+    // The roots keep their own colors
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int worker) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            if (m_color[x].load(std::memory_order_relaxed) == x)
+                next[worker].push_back(x);
+        }
+    });
+    for (w = 0; w < numWorkers; w++) {
+        roots.insert(roots.end(), next[w].begin(), next[w].end());
+        next[w].clear();
+    }
+
+    // The component of each root is what reaches it within its color; the
+    // searches of different roots never meet, and only the search of a
+    // color reads or writes the labels of its nodes
+    forEachBlock(roots.size(), 1, [&](long int begin, long int end, long int worker) {
+        std::vector<long int>& queue = next[worker];
+        long int i, j, k, r, x, y, edge;
+        size_t head;
+
+        for (j = begin; j < end; j++) {
+            r = roots[j];
+            queue.clear();
+            queue.push_back(r);
+            m_label[r] = r;
+            for (head = 0; head < queue.size(); head++) {
+                x = queue[head];
+                k = m_digraph.inCandidates(x);
+                for (i = 0; i < k; i++) {
+                    y = m_digraph.inEntry(x, i, &edge);
+                    if (y == -1 || !m_alive[y] ||
+                            m_color[y].load(std::memory_order_relaxed) != r ||
+                            m_label[y] != -1)
+                        continue;
+                    m_label[y] = r;
+                    queue.push_back(y);
+                }
+            }
+        }
+    });
+
+    forEachBlock(m_nodes.size(), blockSize, [&](long int begin, long int end, long int) {
+        long int j, x;
+        for (j = begin; j < end; j++) {
+            x = m_nodes[j];
+            if (m_label[x] != -1)
+                m_alive[x] = 0;
+        }
+    });
+    compact();
+
+    return true;
+}
+
+template <typename D>
+void ParallelComponentFinder<D>::finishSerially() {
+    long int i, size = m_nodes.size();
+    std::vector<long int> local(m_n, -1), membership;
+
+    if (size == 0)
+        return;
+
+    for (i = 0; i < size; i++)
+        local[m_nodes[i]] = i;
+    stronglyConnectedComponents(InducedDigraph<D>(m_digraph, m_nodes, local), membership);
+    for (i = 0; i < size; i++) {
+        m_label[m_nodes[i]] = m_n + membership[i];
+        m_alive[m_nodes[i]] = 0;
+    }
+    m_nodes.clear();
+}
+
+template <typename D>
+void ParallelComponentFinder<D>::compact() {
+    std::vector<long int>::iterator it, out;
+
+    for (it = out = m_nodes.begin(); it != m_nodes.end(); ++it) {
+        if (m_alive[*it])
+            *out++ = *it;
+    }
+    m_nodes.erase(out, m_nodes.end());
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_SCC_H
@@ -0,0 +1,242 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_SPARSE_RANK_H
+#define NETCTRL_KERNEL_SPARSE_RANK_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace netctrl {
+
+/// Square sparse real matrix stored in compressed sparse row format
+/**
+ * Row \c i consists of the entries at positions <tt>offsets[i]</tt> to
+ * <tt>offsets[i+1]-1</tt> of \c columns and \c values. Column indices
+ * within a row are distinct.
+ */
+struct SparseMatrix {
+    long int size;
+    std::vector<long int> offsets;
+    std::vector<long int> columns;
+    std::vector<double> values;
+
+    SparseMatrix() : size(0), offsets(1, 0), columns(), values() {}
+};
+
+/// Absolute value that works for both real and complex scalars
+inline double magnitude(double x) {
+    return std::fabs(x);
+}
+
+/// Absolute value that works for both real and complex scalars
+inline double magnitude(const std::complex<double>& x) {
+    return std::abs(x);
+}
+
+/// Incremental rank-revealing elimination of sparse rows
+/**
+ * Rows are added one by one; each row is reduced against the rows that
+ * were found to be independent earlier (the \em basis). If the remainder
+ * is not numerically zero, it becomes a new basis row with its entry of
+ * largest magnitude as the pivot; otherwise the row is a linear
+ * combination of the previous rows.
+ *
+ * Every basis row is zero in the pivot columns of all the earlier basis
+ * rows, so a row can be reduced by visiting the basis rows in the order
+ * they were added, and only those whose pivot column is nonzero in the
+ * row. These are kept in a heap, and the row being reduced is stored in a
+ * sparse accumulator, so the cost depends on the fill-in only and not on
+ * the size of the matrix.
+ *
+ * \c T is the scalar type; \c double or <tt>std::complex<double></tt>.
+ */
+template <typename T>
+class SparseRowEliminator {
+private:
+    typedef std::vector<std::pair<long int, T> > SparseRow;
+
+    /// Entries below this magnitude are treated as zero
+    double m_tolerance;
+
+    /// The basis rows, in the order they were added
+    std::vector<SparseRow> m_basis;
+
+    /// The pivot column of each basis row
+    std::vector<long int> m_pivotColumns;
+
+    /// The pivot value of each basis row
+    std::vector<T> m_pivotValues;
+
+    /// Index of the basis row that owns each column as a pivot, or -1
+    std::vector<long int> m_pivotOwners;
+
+    /// Values of the sparse accumulator
+    std::vector<T> m_values;
+
+    /// Whether each column is in the pattern of the sparse accumulator
+    std::vector<bool> m_occupied;
+
+    /// Columns that are in the pattern of the sparse accumulator
+    std::vector<long int> m_pattern;
+
+    /// Heap of basis rows to be used for the reduction of the current row
+    std::vector<long int> m_heap;
+
+public:
+    /// Constructs an eliminator for rows of the given length
+    SparseRowEliminator(long int size, double tolerance)
+        : m_tolerance(tolerance), m_basis(), m_pivotColumns(), m_pivotValues(),
+        m_pivotOwners(size, -1), m_values(size), m_occupied(size, false),
+        m_pattern(), m_heap() {}
+
+    /// Adds a row to the eliminator
+    /**
+     * \param  columns  the column indices of the nonzero entries; must be
+     *                  distinct
+     * \param  values   the values of the nonzero entries
+     * \param  count    the number of nonzero entries
+     * \return \c true if the row is linearly independent of the rows added
+     *         so far, \c false otherwise
+     */
+    bool addRow(const long int* columns, const T* values, long int count) {
+        long int i, column, owner;
+        size_t j;
+
+        m_pattern.clear();
+        m_heap.clear();
+        for (i = 0; i < count; i++)
+            touch(columns[i], values[i]);
+
+        // Reduce the row with the basis rows in the order they were added
+        while (!m_heap.empty()) {
+            std::pop_heap(m_heap.begin(), m_heap.end(), std::greater<long int>());
+            owner = m_heap.back();
+            m_heap.pop_back();
+
+            column = m_pivotColumns[owner];
+            T factor = m_values[column] / m_pivotValues[owner];
+            const SparseRow& row = m_basis[owner];
+            for (j = 0; j < row.size(); j++)
+                touch(row[j].first, -factor * row[j].second);
+            m_values[column] = T(0);
+        }
+
+        // Find the pivot of the remainder
+        double largest = 0.0;
+        column = -1;
+        for (j = 0; j < m_pattern.size(); j++) {
+            double value = magnitude(m_values[m_pattern[j]]);
+            if (value > largest) {
+                largest = value;
+                column = m_pattern[j];
+            }
+        }
+
+        bool independent = column >= 0 && largest > m_tolerance;
+        if (independent) {
+            SparseRow row;
+            for (j = 0; j < m_pattern.size(); j++) {
+                i = m_pattern[j];
+                if (magnitude(m_values[i]) > m_tolerance * 1e-3)
+                    row.push_back(std::make_pair(i, m_values[i]));
+            }
+            m_pivotOwners[column] = m_basis.size();
+            m_pivotColumns.push_back(column);
+            m_pivotValues.push_back(m_values[column]);
+            m_basis.push_back(SparseRow());
+            m_basis.back().swap(row);
+        }
+
+        // Clear the sparse accumulator
+        for (j = 0; j < m_pattern.size(); j++) {
+            m_values[m_pattern[j]] = T(0);
+            m_occupied[m_pattern[j]] = false;
+        }
+
+        return independent;
+    }
+
+    /// Returns the number of linearly independent rows added so far
+    long int rank() const {
+        return m_basis.size();
+    }
+
+private:
+    /// Adds a value to the given column of the sparse accumulator
+    void touch(long int column, const T& value) {
+        if (!m_occupied[column]) {
+            m_occupied[column] = true;
+            m_pattern.push_back(column);
+            m_values[column] = value;
+            if (m_pivotOwners[column] >= 0) {
+                m_heap.push_back(m_pivotOwners[column]);
+                std::push_heap(m_heap.begin(), m_heap.end(), std::greater<long int>());
+            }
+        } else {
+            m_values[column] += value;
+        }
+    }
+};
+
+/**
+ * \brief Calculates the rank deficiency of <tt>lambda*I - A</tt> for a
+ *        sparse matrix A.
+ *
+ * The rank deficiency is the geometric multiplicity of \c lambda as an
+ * eigenvalue of A (zero if it is not an eigenvalue).
+ *
+ * \param  matrix      the matrix A
+ * \param  lambda      the scalar; <tt>double</tt> or
+ *                     <tt>std::complex<double></tt>
+ * \param  tolerance   remainders below this magnitude are treated as zero
+ * \param  dependent   if not null, the indices of the rows that are linear
+ *                     combinations of the preceding rows are returned here
+ * \return the rank deficiency
+ */
+template <typename T>
+long int rankDeficiency(const SparseMatrix& matrix, const T& lambda,
+        double tolerance, std::vector<long int>* dependent = 0) {
+    long int i, k, n = matrix.size;
+    SparseRowEliminator<T> eliminator(n, tolerance);
+    std::vector<long int> columns;
+    std::vector<T> values;
+
+    if (dependent)
+        dependent->clear();
+
+    for (i = 0; i < n; i++) {
+        bool hasDiagonal = false;
+
+        columns.clear();
+        values.clear();
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++) {
+            columns.push_back(matrix.columns[k]);
+            if (matrix.columns[k] == i) {
+                values.push_back(lambda - matrix.values[k]);
+                hasDiagonal = true;
+            } else {
+                values.push_back(T(-matrix.values[k]));
+            }
+        }
+        if (!hasDiagonal && lambda != T(0)) {
+            columns.push_back(i);
+            values.push_back(lambda);
+        }
+
+        if (!eliminator.addRow(columns.empty() ? 0 : &columns[0],
+                    values.empty() ? 0 : &values[0], columns.size())) {
+            if (dependent)
+                dependent->push_back(i);
+        }
+    }
+
+    return n - eliminator.rank();
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_SPARSE_RANK_H
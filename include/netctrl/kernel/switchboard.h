@@ -0,0 +1,538 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_SWITCHBOARD_H
+#define NETCTRL_KERNEL_SWITCHBOARD_H
+
+#include <algorithm>
+#include <vector>
+#include <igraph/cpp/vector_int.h>
+#include <netctrl/model/controllability.h>
+#include <netctrl/util/kernels.h>
+
+namespace netctrl {
+
+/// Returns the number of outbound edges of a vertex that are not masked
+/**
+ * This is simply the out-degree of the vertex; masked views overload it
+ * to skip the edges that lead out of the view.
+ */
+template <typename G>
+long int visibleOutDegree(const G& graph, long int v) {
+    return graph.outDegree(v);
+}
+
+/// Returns the number of inbound edges of a vertex that are not masked
+/**
+ * This is simply the in-degree of the vertex; masked views overload it
+ * to skip the edges that come from outside the view.
+ */
+template <typename G>
+long int visibleInDegree(const G& graph, long int v) {
+    return graph.inDegree(v);
+}
+
+/**
+ * \brief Finds the driver nodes of a graph in the switchboard model.
+ *
+ * Driver nodes are the divergent nodes (more outbound than inbound edges)
+ * plus one node from each non-trivial weakly connected component that
+ * consists of balanced nodes only. Divergent nodes come first in the
+ * result, followed by the balanced nodes, both in increasing order.
+ *
+ * \param  graph        the graph; must satisfy the graph concept described
+ *                      in \c netctrl/kernel.h. Masked views are supported.
+ * \param  driverNodes  the driver nodes are returned here
+ * \param  pDegreeClasses  if not null, the class of each node is returned
+ *                      here as in \c classifyDegrees(): positive for
+ *                      divergent nodes, zero for balanced ones and negative
+ *                      for the rest
+ */
+template <typename G>
+void findSwitchboardDriverNodes(const G& graph, igraph::VectorInt& driverNodes,
+        std::vector<signed char>* pDegreeClasses = 0) {
+    long int i, j, k, u, v, n = graph.vertexCount();
+    std::vector<igraph::integer_t> outDegrees(n), inDegrees(n);
+    std::vector<signed char> localDegreeClasses;
+    std::vector<signed char>& degreeClasses =
+        pDegreeClasses ? *pDegreeClasses : localDegreeClasses;
+    long int balancedCount = 0;
+
+    driverNodes.clear();
+    degreeClasses.resize(n);
+    if (n == 0)
+        return;
+
+    // Find divergent nodes, count balanced nodes
+    for (i = 0; i < n; i++) {
+        outDegrees[i] = visibleOutDegree(graph, i);
+        inDegrees[i] = visibleInDegree(graph, i);
+    }
+    balancedCount = classifyDegrees(&outDegrees[0], &inDegrees[0], &degreeClasses[0], n);
+    for (i = 0; i < n; i++) {
+        if (degreeClasses[i] > 0)
+            driverNodes.push_back(i);
+    }
+
+    if (balancedCount == 0)
+        return;
+
+    // Find the weakly connected components consisting of balanced nodes
+    // only. Each component is explored from its smallest node.
+    std::vector<bool> visited(n, false);
+    std::vector<long int> queue;
+    for (i = 0; i < n; i++) {
+        if (visited[i] || degreeClasses[i] != 0)
+            continue;
+
+        bool balanced = true;
+        size_t head;
+
+        queue.clear();
+        queue.push_back(i);
+        visited[i] = true;
+        for (head = 0; head < queue.size(); head++) {
+            u = queue[head];
+            balanced = balanced && degreeClasses[u] == 0;
+
+            k = graph.outDegree(u);
+            for (j = 0; j < k; j++) {
+                v = graph.outNeighbor(u, j);
+                if (v >= 0 && !visited[v]) {
+                    visited[v] = true;
+                    queue.push_back(v);
+                }
+            }
+            k = graph.inDegree(u);
+            for (j = 0; j < k; j++) {
+                v = graph.inNeighbor(u, j);
+                if (v >= 0 && !visited[v]) {
+                    visited[v] = true;
+                    queue.push_back(v);
+                }
+            }
+        }
+
+        if (balanced)
+            driverNodes.push_back(i);
+    }
+}
+
+/// Returns the class of a single node as in \c classifyDegrees()
+template <typename G>
+signed char degreeClass(const G& graph, long int v) {
+    igraph::integer_t outDegree = visibleOutDegree(graph, v);
+    igraph::integer_t inDegree = visibleInDegree(graph, v);
+    signed char result;
+    classifyDegrees(&outDegree, &inDegree, &result, 1);
+    return result;
+}
+
+/**
+ * \brief Finds the node that represents the weakly connected component of
+ *        a node among the driver nodes of the switchboard model, if any.
+ *
+ * The component is explored breadth-first from the given node, and the
+ * search stops at the first node that is not balanced, so components with
+ * unbalanced nodes near the start are cheap to rule out. Several nodes may
+ * be queried with the same \c owners vector; a search that runs into a
+ * node visited by an earlier search stops as well, since that search did
+ * not cover the whole component, so it must have stopped at an unbalanced
+ * node.
+ *
+ * \param  graph          the graph
+ * \param  degreeClasses  the class of each node, see \c classifyDegrees()
+ * \param  start          the node whose component is needed
+ * \param  owners         one plus the node that each node was visited from;
+ *                        zero for the nodes that were not visited yet
+ * \param  queue          the visited nodes are appended here so the caller
+ *                        can clear their entries in \c owners
+ * \return the smallest node of the component if it consists of balanced
+ *         nodes only, -1 otherwise
+ */
+template <typename G>
+long int findBalancedComponentRoot(const G& graph,
+        const std::vector<signed char>& degreeClasses, long int start,
+        std::vector<long int>& owners, std::vector<long int>& queue) {
+    long int i, j, k, u, v, root = start, owner = start + 1;
+    size_t head = queue.size();
+
+    if (owners[start] != 0 || degreeClasses[start] != 0)
+        return -1;
+
+    owners[start] = owner;
+    queue.push_back(start);
+    for (; head < queue.size(); head++) {
+        u = queue[head];
+        if (degreeClasses[u] != 0)
+            return -1;
+        root = std::min(root, u);
+
+        // Outbound edges first, then inbound ones
+        for (i = 0; i < 2; i++) {
+            k = i == 0 ? graph.outDegree(u) : graph.inDegree(u);
+            for (j = 0; j < k; j++) {
+                v = i == 0 ? graph.outNeighbor(u, j) : graph.inNeighbor(u, j);
+                if (v < 0 || owners[v] == owner)
+                    continue;
+                if (owners[v] != 0)
+                    return -1;
+                owners[v] = owner;
+                queue.push_back(v);
+            }
+        }
+    }
+
+    return root;
+}
+
+/// Decomposes the edges of a graph into walks as in the switchboard model
+/**
+ * The builder keeps track of the edges that were already used by previous
+ * walks and of the number of unused outbound and inbound edges of each
+ * node. It also remembers where the scan for an unused outbound edge
+ * stopped the last time for each node, so the total cost of all the walks
+ * is linear in the number of edges.
+ *
+ * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+ */
+template <typename G>
+class WalkBuilder {
+private:
+    /// The graph being decomposed
+    const G& m_graph;
+
+    /// Whether each edge has been used by a walk already
+    std::vector<bool> m_edgeUsed;
+
+    /// Index of the first outbound edge of each node that may be unused
+    std::vector<long int> m_cursor;
+
+    /// Number of unused outbound edges of each node
+    std::vector<long int> m_outDegrees;
+
+    /// Number of unused inbound edges of each node
+    std::vector<long int> m_inDegrees;
+
+public:
+    /// Constructs a builder where all the edges of the graph are unused
+    explicit WalkBuilder(const G& graph)
+        : m_graph(graph), m_edgeUsed(graph.edgeCount(), false),
+        m_cursor(graph.vertexCount(), 0), m_outDegrees(graph.vertexCount()),
+        m_inDegrees(graph.vertexCount()) {
+        long int i, n = graph.vertexCount();
+        for (i = 0; i < n; i++) {
+            m_outDegrees[i] = graph.outDegree(i);
+            m_inDegrees[i] = graph.inDegree(i);
+        }
+    }
+
+    /**
+     * \brief Starts a walk from the given node following arbitrary unused
+     *        edges until it gets stuck.
+     *
+     * For undirected graphs, the walk is traversed backwards as well since
+     * each edge can be used in both directions.
+     *
+     * \param  start  the node to start the walk from
+     * \param  walk   the nodes of the walk are returned here, \em without
+     *                the node where the walk got stuck
+     * \return the node where the walk got stuck. If it is equal to \c start,
+     *         the walk is closed (or empty if \c walk is empty).
+     */
+    long int follow(long int start, igraph::VectorInt& walk) {
+        long int v, w, degree;
+
+        walk.clear();
+
+        v = start;
+        while (true) {
+            // Find an outbound edge that has not been used yet
+            degree = m_graph.outDegree(v);
+            while (m_cursor[v] < degree && m_edgeUsed[m_graph.outEdge(v, m_cursor[v])])
+                m_cursor[v]++;
+
+            // Did we get stuck? If so, break out of the loop.
+            if (m_cursor[v] == degree)
+                break;
+
+            // Add v to the walk
+            walk.push_back(v);
+
+            // Mark the edge as used and step to the node it is pointing to.
+            // Also update the degree vectors
+            m_edgeUsed[m_graph.outEdge(v, m_cursor[v])] = true;
+            m_outDegrees[v]--;
+            v = m_graph.outNeighbor(v, m_cursor[v]);
+            m_inDegrees[v]--;
+        }
+
+        // If the graph is undirected, we can traverse the path backwards (we
+        // are essentially using each edge in both directions)
+        if (!m_graph.isDirected()) {
+            walk.push_back(v);
+            v = walk.size();
+            for (w = v - 1; w > 0; ) {
+                m_outDegrees[walk[w]]--;
+                w--;
+                if (w == 0) {
+                    break;
+                }
+                walk.push_back(walk[w]);
+                m_inDegrees[walk[w]]--;
+            }
+            m_inDegrees[walk[0]]--;
+
+            v = walk[0];
+        }
+
+        return v;
+    }
+
+    /// Returns the number of unused inbound edges of the given node
+    long int remainingInDegree(long int v) const {
+        return m_inDegrees[v];
+    }
+
+    /// Returns the number of unused outbound edges of the given node
+    long int remainingOutDegree(long int v) const {
+        return m_outDegrees[v];
+    }
+};
+
+/**
+ * \brief Checks whether a vertex is part of a non-trivial balanced component
+ *        after removing its edge to another vertex.
+ *
+ * This is a helper of \c switchboardDriverChanges(). The components are
+ * weakly connected components that are explored from \c v while treating
+ * \c u as if it was not there; pass -1 as \c u to keep all the vertices.
+ *
+ * \param  graph        the graph
+ * \param  v            the vertex to check
+ * \param  u            the other endpoint of the removed edge, or -1
+ * \param  degreeDiffs  the in-degree minus the out-degree of each vertex
+ *                      after the removal
+ * \param  visited      workspace of size n that must be all \c false; it
+ *                      is restored before returning
+ * \param  queue        workspace for the breadth-first search
+ */
+template <typename G>
+bool isInBalancedComponentExcept(const G& graph, long int v, long int u,
+        const std::vector<long int>& degreeDiffs, std::vector<bool>& visited,
+        std::vector<long int>& queue) {
+    long int i, k, w, neighborCount = 0, neighbor = -1;
+    bool directed = graph.isDirected(), result = true;
+    size_t head;
+
+    // Is v balanced? If not, we can return early
+    if (degreeDiffs[v] != 0)
+        return false;
+
+    // Does v have any neighbors apart from u? If not, v is in a trivial
+    // balanced component, so we return false
+    k = graph.outDegree(v);
+    for (i = 0; i < k && neighborCount < 2; i++) {
+        if ((w = graph.outNeighbor(v, i)) >= 0) {
+            neighborCount++;
+            neighbor = w;
+        }
+    }
+    k = directed ? graph.inDegree(v) : 0;
+    for (i = 0; i < k && neighborCount < 2; i++) {
+        if ((w = graph.inNeighbor(v, i)) >= 0) {
+            neighborCount++;
+            neighbor = w;
+        }
+    }
+    if (neighborCount == 0 || (neighborCount == 1 && neighbor == u))
+        return false;
+
+    queue.clear();
+    queue.push_back(v);
+    visited[v] = true;
+    if (u >= 0)
+        visited[u] = true;
+
+    for (head = 0; result && head < queue.size(); head++) {
+        v = queue[head];
+        k = graph.outDegree(v);
+        for (i = 0; result && i < k; i++) {
+            w = graph.outNeighbor(v, i);
+            if (w < 0 || visited[w])
+                continue;
+            visited[w] = true;
+            queue.push_back(w);
+            result = degreeDiffs[w] == 0;
+        }
+        k = directed ? graph.inDegree(v) : 0;
+        for (i = 0; result && i < k; i++) {
+            w = graph.inNeighbor(v, i);
+            if (w < 0 || visited[w])
+                continue;
+            visited[w] = true;
+            queue.push_back(w);
+            result = degreeDiffs[w] == 0;
+        }
+    }
+
+    for (head = 0; head < queue.size(); head++)
+        visited[queue[head]] = false;
+    if (u >= 0)
+        visited[u] = false;
+
+    return result;
+}
+
+/**
+ * \brief Calculates how the number of driver nodes in the switchboard model
+ *        changes when each edge of a graph is removed, and reports the
+ *        change to a visitor.
+ *
+ * The visitor is called as <tt>visitor(edge, change)</tt> exactly once for
+ * each edge. No per-edge state is kept for directed graphs; undirected
+ * edges are seen from both endpoints, so they are marked when they are
+ * seen for the first time.
+ *
+ * \param  graph    the graph; must satisfy the graph concept described in
+ *                  \c netctrl/kernel.h. Masked views are supported.
+ * \param  visitor  the function to call for each edge
+ */
+template <typename G, typename Visitor>
+void visitSwitchboardDriverChanges(const G& graph, Visitor visitor) {
+    long int i, k, u, v, e, change, n = graph.vertexCount();
+    bool directed = graph.isDirected();
+    std::vector<long int> degreeDiffs(n), queue;
+    std::vector<bool> visited(n, false), seen(directed ? 0 : graph.edgeCount(), false);
+
+    for (u = 0; u < n; u++)
+        degreeDiffs[u] = visibleInDegree(graph, u) - visibleOutDegree(graph, u);
+
+    // Each edge is seen from its source; undirected edges are seen from both
+    // endpoints, but the result does not depend on the orientation then
+    for (u = 0; u < n; u++) {
+        k = graph.outDegree(u);
+        for (i = 0; i < k; i++) {
+            v = graph.outNeighbor(u, i);
+            if (v < 0)
+                continue;
+            e = graph.outEdge(u, i);
+            if (!directed) {
+                if (seen[e])
+                    continue;
+                seen[e] = true;
+            }
+
+            change = 0;
+            if (degreeDiffs[u] == -1) {
+                // source vertex will become balanced instead of divergent
+                change--;
+            }
+            if (degreeDiffs[v] == 0) {
+                // target vertex will become divergent instead of balanced
+                change++;
+            }
+
+            // Treating special cases
+            if (degreeDiffs[u] == 0 && degreeDiffs[v] == 0) {
+                // u and v may potentially have been part of a balanced
+                // component. In this case, the component already has a
+                // driver node before the removal, so we will have to
+                // decrease the change by 1
+                if (isInBalancedComponentExcept(graph, u, -1, degreeDiffs, visited, queue))
+                    change--;
+            }
+            if (degreeDiffs[v] == 1) {
+                // v is convergent but will become balanced. If all its
+                // neighbors are balanced (except u), we may suspect that it
+                // becomes part of a balanced component, which will require
+                // one more driver node, so we will have to increase the
+                // change by 1
+                degreeDiffs[v]--; degreeDiffs[u]++;
+                if (isInBalancedComponentExcept(graph, v, u, degreeDiffs, visited, queue))
+                    change++;
+                degreeDiffs[v]++; degreeDiffs[u]--;
+            }
+            if (degreeDiffs[u] == -1) {
+                // u is divergent but will become balanced. If all its
+                // neighbors are balanced (except v), we may suspect that it
+                // becomes part of a balanced component, which will require
+                // one more driver node, so we will have to increase the
+                // change by 1
+                degreeDiffs[v]--; degreeDiffs[u]++;
+                if (isInBalancedComponentExcept(graph, u, v, degreeDiffs, visited, queue))
+                    change++;
+                degreeDiffs[v]++; degreeDiffs[u]--;
+            }
+
+            visitor(e, change);
+        }
+    }
+}
+
+/**
+ * \brief Calculates how the number of driver nodes in the switchboard model
+ *        changes when each edge of a graph is removed.
+ *
+ * \param  graph   the graph; must satisfy the graph concept described in
+ *                 \c netctrl/kernel.h. Masked views are supported.
+ * \param  result  the change in the number of driver nodes after removing
+ *                 each edge is returned here
+ */
+template <typename G>
+void switchboardDriverChanges(const G& graph, igraph::VectorInt& result) {
+    result.resize(graph.edgeCount());
+    std::fill(result.begin(), result.end(), 0);
+    visitSwitchboardDriverChanges(graph, [&result](long int edge, long int change) {
+        result[edge] = change;
+    });
+}
+
+/// Returns the edge class of the switchboard model for a change in the number of driver nodes
+inline EdgeClass switchboardEdgeClass(long int change) {
+    if (change < 0)
+        return EDGE_DISTINGUISHED;
+    return change == 0 ? EDGE_REDUNDANT : EDGE_CRITICAL;
+}
+
+/**
+ * \brief Classifies the edges of a graph according to the switchboard model.
+ *
+ * An edge is distinguished if removing it decreases the number of driver
+ * nodes, redundant if the number of driver nodes stays the same and
+ * critical if it increases.
+ *
+ * \param  graph   the graph; must satisfy the graph concept described in
+ *                 \c netctrl/kernel.h. Masked views are supported.
+ * \param  result  the class of each edge is returned here
+ */
+template <typename G>
+void classifySwitchboardEdges(const G& graph, std::vector<EdgeClass>& result) {
+    result.assign(graph.edgeCount(), EDGE_REDUNDANT);
+    visitSwitchboardDriverChanges(graph, [&result](long int edge, long int change) {
+        result[edge] = switchboardEdgeClass(change);
+    });
+}
+
+/**
+ * \brief Counts the edges of a graph in each class of the switchboard model.
+ *
+ * The edges are counted as they are classified, so the classes of the
+ * individual edges are never stored.
+ *
+ * \param  graph   the graph; must satisfy the graph concept described in
+ *                 \c netctrl/kernel.h. Masked views are supported.
+ * \param  counts  array of <tt>EDGE_DISTINGUISHED + 1</tt> elements; the
+ *                 number of edges in each class is returned here, indexed
+ *                 by the class
+ */
+template <typename G>
+void countSwitchboardEdgeClasses(const G& graph, long int* counts) {
+    std::fill(counts, counts + EDGE_DISTINGUISHED + 1, 0);
+    visitSwitchboardDriverChanges(graph, [counts](long int, long int change) {
+        counts[switchboardEdgeClass(change)]++;
+    });
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_SWITCHBOARD_H
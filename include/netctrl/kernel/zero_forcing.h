@@ -0,0 +1,368 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_KERNEL_ZERO_FORCING_H
+#define NETCTRL_KERNEL_ZERO_FORCING_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <netctrl/util/bitset.h>
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+/// Simple directed graph in the form needed by the zero forcing engine
+/**
+ * Stores the distinct outbound and inbound neighbors of each vertex in
+ * compressed sparse row arrays, without loops. Loops do not matter for
+ * zero forcing, and multiple edges would break the counting of the white
+ * neighbors in \c ZeroForcingEngine. The graph is built once and shared by
+ * all the engines that work on it.
+ */
+class ForcingGraph {
+private:
+    std::vector<long int> m_outOffsets, m_outTargets;
+    std::vector<long int> m_inOffsets, m_inSources;
+
+public:
+    /// Builds the forcing graph of a graph
+    /**
+     * \c G must satisfy the graph concept described in \c netctrl/kernel.h.
+     */
+    template <typename G>
+    explicit ForcingGraph(const G& graph);
+
+    long int inDegree(long int v) const {
+        return m_inOffsets[v+1] - m_inOffsets[v];
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        return m_inSources[m_inOffsets[v] + i];
+    }
+
+    long int outDegree(long int v) const {
+        return m_outOffsets[v+1] - m_outOffsets[v];
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        return m_outTargets[m_outOffsets[v] + i];
+    }
+
+    long int vertexCount() const {
+        return m_outOffsets.size() - 1;
+    }
+};
+
+/// Propagation of the zero forcing color change rule
+/**
+ * Vertices are either black or white. A black vertex with exactly one white
+ * outbound neighbor \em forces that neighbor to become black. A set of
+ * vertices is a \em zero \em forcing \em set if coloring them black and
+ * applying the rule repeatedly turns every vertex black.
+ *
+ * The engine keeps the number of white outbound neighbors of every vertex
+ * and a queue of black vertices that may force, so a complete propagation
+ * costs time linear in the size of the graph no matter how many vertices
+ * are colored one by one. The black vertices are kept in a \c Bitset.
+ */
+class ZeroForcingEngine {
+private:
+    /// The graph being colored
+    const ForcingGraph& m_graph;
+
+    /// The set of black vertices
+    Bitset m_black;
+
+    /// The number of black vertices
+    long int m_blackCount;
+
+    /// The number of white outbound neighbors of each vertex
+    std::vector<long int> m_whiteCounts;
+
+    /// Black vertices that may have exactly one white outbound neighbor
+    std::vector<long int> m_forcing;
+
+    /// Black vertices that may have exactly two white outbound neighbors
+    std::vector<long int> m_pairs;
+
+public:
+    /// Constructs an engine where all the vertices are white
+    explicit ZeroForcingEngine(const ForcingGraph& graph)
+        : m_graph(graph), m_black(graph.vertexCount()), m_blackCount(0),
+        m_whiteCounts(graph.vertexCount()), m_forcing(), m_pairs() {
+        reset();
+    }
+
+    /// Colors the given vertex black and propagates the color change rule
+    void color(long int v) {
+        if (m_black.test(v))
+            return;
+        blacken(v);
+        propagate();
+    }
+
+    /// Returns whether all the vertices are black
+    bool isComplete() const {
+        return m_blackCount == m_graph.vertexCount();
+    }
+
+    /// Returns whether the given set of vertices is a zero forcing set
+    bool isForcingSet(const std::vector<long int>& vertices) {
+        std::vector<long int>::const_iterator it;
+
+        reset();
+        for (it = vertices.begin(); it != vertices.end(); ++it)
+            color(*it);
+
+        return isComplete();
+    }
+
+    /**
+     * \brief Builds a zero forcing set with a randomized greedy heuristic.
+     *
+     * Vertices without inbound neighbors are added first as nothing can
+     * force them. After that, whenever a black vertex has exactly two white
+     * outbound neighbors, one of them is added at random, which makes the
+     * black vertex force the other one. Otherwise the next white vertex of a
+     * random permutation is added.
+     *
+     * \param  rng     the random number generator to use
+     * \param  result  the zero forcing set is returned here, in the order
+     *                 the vertices were added
+     */
+    template <typename RNG>
+    void randomForcingSet(RNG& rng, std::vector<long int>& result) {
+        long int i, n = m_graph.vertexCount(), cursor = 0;
+        std::vector<long int> order(n);
+
+        reset();
+        result.clear();
+
+        for (i = 0; i < n; i++) {
+            order[i] = i;
+            if (m_graph.inDegree(i) == 0) {
+                color(i);
+                result.push_back(i);
+            }
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+
+        while (!isComplete()) {
+            long int v = -1;
+
+            while (v < 0 && !m_pairs.empty()) {
+                long int u = m_pairs.back();
+                m_pairs.pop_back();
+                if (m_whiteCounts[u] == 2)
+                    v = whiteNeighbor(u, rng() % 2);
+            }
+
+            while (v < 0) {
+                if (!m_black.test(order[cursor]))
+                    v = order[cursor];
+                cursor++;
+            }
+
+            color(v);
+            result.push_back(v);
+        }
+    }
+
+    /// Turns all the vertices white
+    void reset() {
+        long int i, n = m_graph.vertexCount();
+
+        m_black.clear();
+        m_blackCount = 0;
+        for (i = 0; i < n; i++)
+            m_whiteCounts[i] = m_graph.outDegree(i);
+        m_forcing.clear();
+        m_pairs.clear();
+    }
+
+private:
+    /// Colors a vertex black without propagating the color change rule
+    void blacken(long int v) {
+        long int i, k = m_graph.inDegree(v);
+
+        m_black.set(v);
+        m_blackCount++;
+        for (i = 0; i < k; i++) {
+            long int u = m_graph.inNeighbor(v, i);
+            m_whiteCounts[u]--;
+            if (m_black.test(u))
+                enqueue(u);
+        }
+        enqueue(v);
+    }
+
+    /// Remembers a black vertex if it may force now or after one more step
+    void enqueue(long int v) {
+        if (m_whiteCounts[v] == 1)
+            m_forcing.push_back(v);
+        else if (m_whiteCounts[v] == 2)
+            m_pairs.push_back(v);
+    }
+
+    /// Applies the color change rule until no black vertex can force
+    void propagate() {
+        while (!m_forcing.empty()) {
+            long int u = m_forcing.back();
+            m_forcing.pop_back();
+            if (m_whiteCounts[u] == 1)
+                blacken(whiteNeighbor(u, 0));
+        }
+    }
+
+    /// Returns the index-th white outbound neighbor of a vertex
+    long int whiteNeighbor(long int v, long int index) const {
+        long int i, k = m_graph.outDegree(v);
+
+        for (i = 0; i < k; i++) {
+            long int w = m_graph.outNeighbor(v, i);
+            if (!m_black.test(w) && index-- == 0)
+                return w;
+        }
+
+        return -1;
+    }
+};
+
+/**
+ * \brief Finds a small zero forcing set with randomized restarts in
+ *        parallel.
+ *
+ * Each restart runs \c ZeroForcingEngine::randomForcingSet() with its own
+ * seed derived from \c seed and the index of the restart; the restarts are
+ * distributed among the threads of the library (see \c setThreadCount()).
+ * The smallest set wins; ties are broken by the index of the restart, so
+ * the result does not depend on the number of threads unless the time
+ * budget runs out.
+ *
+ * \param  graph       the graph
+ * \param  restarts    the number of restarts; at least one restart is done
+ * \param  timeBudget  no new restarts are started after this many seconds;
+ *                     zero or negative values mean no limit
+ * \param  seed        seed of the random number generators
+ * \param  result      the zero forcing set is returned here, in the order
+ *                     the vertices were added
+ */
+inline void findZeroForcingSet(const ForcingGraph& graph, long int restarts,
+        double timeBudget, unsigned long int seed, std::vector<long int>& result) {
+    typedef std::chrono::steady_clock Clock;
+
+    long int i, numWorkers = std::max(1L, std::min<long int>(threadCount(), restarts));
+    std::vector<std::vector<long int> > bestSets(numWorkers);
+    std::vector<long int> bestIndices(numWorkers, -1);
+    std::atomic<long int> next(0);
+    Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeBudget));
+
+    parallelFor(0, numWorkers, [&](long int worker) {
+        ZeroForcingEngine engine(graph);
+        std::vector<long int> current;
+        long int index;
+
+        while ((index = next.fetch_add(1)) < std::max(1L, restarts)) {
+            if (index > 0 && timeBudget > 0 && Clock::now() >= deadline)
+                break;
+
+            std::mt19937 rng(seed + index);
+            engine.randomForcingSet(rng, current);
+            if (bestIndices[worker] < 0 || current.size() < bestSets[worker].size()) {
+                bestSets[worker].swap(current);
+                bestIndices[worker] = index;
+            }
+        }
+    });
+
+    long int best = -1;
+    for (i = 0; i < numWorkers; i++) {
+        if (bestIndices[i] < 0)
+            continue;
+        if (best < 0 || bestSets[i].size() < bestSets[best].size() ||
+                (bestSets[i].size() == bestSets[best].size() &&
+                 bestIndices[i] < bestIndices[best]))
+            best = i;
+    }
+
+    result.swap(bestSets[best]);
+}
+
+/**
+ * \brief Removes vertices from a zero forcing set as long as it remains a
+ *        zero forcing set.
+ *
+ * Vertices are tried in reverse order, so the ones that were added last by
+ * \c findZeroForcingSet() are tried first. Each try is a full propagation.
+ *
+ * \param  graph       the graph
+ * \param  vertices    the zero forcing set; the pruned set is returned here
+ * \param  timeBudget  no new tries are started after this many seconds;
+ *                     zero or negative values mean no limit
+ */
+inline void pruneZeroForcingSet(const ForcingGraph& graph,
+        std::vector<long int>& vertices, double timeBudget) {
+    typedef std::chrono::steady_clock Clock;
+
+    ZeroForcingEngine engine(graph);
+    std::vector<long int> trial;
+    long int i;
+    Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeBudget));
+
+    for (i = vertices.size() - 1; i >= 0; i--) {
+        if (timeBudget > 0 && Clock::now() >= deadline)
+            break;
+
+        trial = vertices;
+        trial.erase(trial.begin() + i);
+        if (engine.isForcingSet(trial))
+            vertices.swap(trial);
+    }
+}
+
+
+/*************************************************************************/
+
+
+template <typename G>
+ForcingGraph::ForcingGraph(const G& graph)
+    : m_outOffsets(1, 0), m_outTargets(), m_inOffsets(), m_inSources() {
+    long int i, k, v, n = graph.vertexCount();
+    std::vector<long int> marks(n, -1);
+
+    // Distinct outbound neighbors without loops
+    for (v = 0; v < n; v++) {
+        marks[v] = v;
+        k = graph.outDegree(v);
+        for (i = 0; i < k; i++) {
+            long int w = graph.outNeighbor(v, i);
+            if (marks[w] != v) {
+                marks[w] = v;
+                m_outTargets.push_back(w);
+            }
+        }
+        m_outOffsets.push_back(m_outTargets.size());
+    }
+
+    // The inbound lists are the transpose of the outbound lists
+    m_inOffsets.assign(n + 1, 0);
+    m_inSources.resize(m_outTargets.size());
+    for (i = 0; i < static_cast<long int>(m_outTargets.size()); i++)
+        m_inOffsets[m_outTargets[i] + 1]++;
+    for (v = 0; v < n; v++)
+        m_inOffsets[v + 1] += m_inOffsets[v];
+
+    std::vector<long int> positions(m_inOffsets.begin(), m_inOffsets.end() - 1);
+    for (v = 0; v < n; v++) {
+        for (k = m_outOffsets[v]; k < m_outOffsets[v+1]; k++)
+            m_inSources[positions[m_outTargets[k]]++] = v;
+    }
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_KERNEL_ZERO_FORCING_H
@@ -3,9 +3,14 @@
 #ifndef NETCTRL_MODEL_H
 #define NETCTRL_MODEL_H
 
+#include <netctrl/model/control_energy.h>
 #include <netctrl/model/controllability.h>
+#include <netctrl/model/dominating_set.h>
+#include <netctrl/model/exact.h>
 #include <netctrl/model/liu.h>
+#include <netctrl/model/snapshot.h>
 #include <netctrl/model/switchboard.h>
+#include <netctrl/model/zero_forcing.h>
 
 #endif
 
@@ -0,0 +1,45 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_MODEL_CONTROL_ENERGY_H
+#define NETCTRL_MODEL_CONTROL_ENERGY_H
+
+#include <igraph/cpp/graph.h>
+#include <netctrl/kernel/control_energy.h>
+#include <netctrl/kernel/sparse_rank.h>
+#include <netctrl/model/controllability.h>
+
+namespace netctrl {
+
+/**
+ * \brief Constructs the weighted adjacency matrix of the linear dynamics on
+ *        a graph.
+ *
+ * <tt>A[v][u]</tt> is the total weight of the edges from u to v, taken from
+ * the \c weight edge attribute (1 if there is none). Undirected edges
+ * contribute in both directions.
+ *
+ * \param  graph   the graph
+ * \param  matrix  the matrix is returned here
+ * \return \c true if the matrix is symmetric
+ * \throws std::runtime_error if a weight is not numeric
+ */
+bool weightedAdjacencyMatrix(igraph::Graph& graph, SparseMatrix& matrix);
+
+/**
+ * \brief Estimates the control energy needed by the driver nodes of a model.
+ *
+ * The driver nodes of the last calculation of the model are the inputs of
+ * the discrete-time linear dynamics on the weighted adjacency matrix of its
+ * graph; see \c estimateGramian() for the estimates and their cost. The
+ * sparse products use the threads of the library.
+ *
+ * \param  model    the model after a successful calculation
+ * \param  result   the estimates are returned here
+ * \param  options  the parameters of the estimates
+ */
+void estimateControlEnergy(const ControllabilityModel& model, GramianEstimate& result,
+        const GramianOptions& options = GramianOptions());
+
+}       // end of namespace
+
+#endif  // NETCTRL_MODEL_CONTROL_ENERGY_H
@@ -6,6 +6,7 @@
 #include <igraph/cpp/graph.h>
 #include <igraph/cpp/vertex_selector.h>
 #include <string>
+#include <netctrl/util/edge_updates.h>
 
 namespace netctrl {
 
@@ -45,6 +46,21 @@ public:
      */
     virtual void calculate() = 0;
 
+    /**
+     * \brief Applies a batch of edge insertions and deletions to the graph
+     *        and updates the results of the last calculation.
+     *
+     * The default implementation modifies the graph and calculates
+     * everything again; subclasses may override it to repair their results
+     * only where the graph has changed. The results are calculated from
+     * scratch if \c calculate() has not been called yet.
+     *
+     * \param  updates  the edges to insert and delete
+     * \return the number of deletions that were ignored because there was
+     *         no such edge
+     */
+    virtual long int updateEdges(const EdgeUpdates& updates);
+
     /**
      * \brief Returns a vector which shows how would the number of driver nodes
      *        change after the removal of a given edge.
@@ -91,6 +107,19 @@ public:
      */
     virtual std::vector<EdgeClass> edgeClasses() const;
 
+    /**
+     * \brief Returns the number of edges in each edge class.
+     *
+     * The default implementation counts the result of \c edgeClasses();
+     * subclasses may override it to count the edges without classifying
+     * each of them in memory.
+     *
+     * \returns  a vector with <tt>EDGE_DISTINGUISHED + 1</tt> elements,
+     *           indexed by \c EdgeClass, or an empty vector if the operation
+     *           is not implemented for a given model.
+     */
+    virtual std::vector<long int> edgeClassCounts() const;
+
     /// Returns the graph on which the controllability model will operate
     virtual igraph::Graph* graph() const {
         return m_pGraph;
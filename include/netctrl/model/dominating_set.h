@@ -0,0 +1,73 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_MODEL_DOMINATING_SET_H
+#define NETCTRL_MODEL_DOMINATING_SET_H
+
+#include <igraph/cpp/vector_int.h>
+#include <netctrl/model/controllability.h>
+
+namespace netctrl {
+
+/// Controllability model based on dominating sets
+/**
+ * In this model, every driver node controls itself and its outbound
+ * neighbors directly, so the driver nodes must form a dominating set of the
+ * graph. Finding a minimum dominating set is NP-hard, so the model uses a
+ * greedy construction, whose choices are made on a single thread, followed
+ * by randomized local search in several threads (see \c setThreadCount())
+ * until the time budget runs out or the searches stop improving. The result is therefore an upper bound on the
+ * size of the minimum dominating set.
+ */
+class DominatingSetControllabilityModel : public ControllabilityModel {
+private:
+    /// The list of driver nodes that was calculated
+    igraph::VectorInt m_driverNodes;
+
+    /// The maximum running time of the local search, in seconds
+    double m_timeBudget;
+
+    /// Seed of the random number generators of the local search
+    unsigned long int m_seed;
+
+public:
+    /// Constructs a model that will operate on the given graph
+    DominatingSetControllabilityModel(igraph::Graph* pGraph = 0)
+        : ControllabilityModel(pGraph), m_driverNodes(), m_timeBudget(1.0),
+        m_seed(0) {
+    }
+
+    virtual void calculate();
+    virtual ControllabilityModel* clone();
+    virtual float controllability() const;
+    virtual std::vector<ControlPath*> controlPaths() const;
+    virtual igraph::VectorInt driverNodes() const;
+    virtual void setGraph(igraph::Graph* graph);
+
+    /// Sets the seed of the random number generators of the local search
+    void setSeed(unsigned long int seed) {
+        m_seed = seed;
+    }
+
+    /// Returns the seed of the random number generators of the local search
+    unsigned long int seed() const {
+        return m_seed;
+    }
+
+    /// Sets the maximum running time of the local search, in seconds
+    /**
+     * Zero or negative values mean no limit; the local search then runs
+     * until it stops improving.
+     */
+    void setTimeBudget(double seconds) {
+        m_timeBudget = seconds;
+    }
+
+    /// Returns the maximum running time of the local search, in seconds
+    double timeBudget() const {
+        return m_timeBudget;
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_MODEL_DOMINATING_SET_H
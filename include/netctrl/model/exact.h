@@ -0,0 +1,102 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_MODEL_EXACT_H
+#define NETCTRL_MODEL_EXACT_H
+
+#include <complex>
+#include <string>
+#include <vector>
+#include <igraph/cpp/vector_int.h>
+#include <netctrl/kernel/sparse_rank.h>
+#include <netctrl/model/controllability.h>
+
+namespace netctrl {
+
+/// Exact controllability model of Yuan et al
+/**
+ * In this model, the minimum number of driver nodes of the linear system
+ * <tt>dx/dt = Ax + Bu</tt> is the maximum geometric multiplicity of the
+ * eigenvalues of the weighted adjacency matrix A, where <tt>A[i][j]</tt> is
+ * the weight of the edge from j to i. Unlike the structural model of Liu et
+ * al, this works for undirected networks and for networks with given
+ * (i.e. not generic) edge weights.
+ *
+ * The eigenvalues are calculated with LAPACK on a dense copy of A. The
+ * distinct eigenvalues are the candidates; the geometric multiplicity of a
+ * candidate is the rank deficiency of <tt>lambda*I - A</tt>, calculated with
+ * sparse rank-revealing elimination in parallel for the candidates. The
+ * driver nodes are the rows of <tt>lambda*I - A</tt> that are linearly
+ * dependent on the other rows for the eigenvalue with the largest geometric
+ * multiplicity. As in the paper, the number of driver nodes is exact, but
+ * the driver nodes themselves are only guaranteed to satisfy the rank
+ * condition for that eigenvalue; other eigenvalues may need further nodes
+ * when the inputs are restricted to single nodes.
+ *
+ * The following shortcuts avoid most of the numerical work:
+ *
+ * - The geometric multiplicity of an eigenvalue is at most its algebraic
+ *   multiplicity, so candidates that cannot beat the best multiplicity
+ *   found so far are skipped.
+ *
+ * - The multiplicity of the zero eigenvalue is at least the number of
+ *   driver nodes in the structural model (n minus the size of a maximum
+ *   matching), which is known before any numerics.
+ *
+ * - If A is symmetric, it is diagonalizable, so the geometric
+ *   multiplicities are equal to the algebraic ones and only the driver
+ *   nodes need an elimination.
+ *
+ * The edge weights are taken from the edge attribute named \c "weight" if
+ * it exists; otherwise all the weights are equal to 1.
+ */
+class ExactControllabilityModel : public ControllabilityModel {
+private:
+    /// The list of driver nodes that was calculated
+    igraph::VectorInt m_driverNodes;
+
+    /// The eigenvalue whose geometric multiplicity determined the driver nodes
+    std::complex<double> m_criticalEigenvalue;
+
+    /// Tolerance used when grouping eigenvalues and deciding about ranks
+    double m_tolerance;
+
+public:
+    /// Constructs a model that will operate on the given graph
+    ExactControllabilityModel(igraph::Graph* pGraph = 0)
+        : ControllabilityModel(pGraph), m_driverNodes(),
+        m_criticalEigenvalue(0.0), m_tolerance(1e-8) {
+    }
+
+    virtual void calculate();
+    virtual ControllabilityModel* clone();
+    virtual float controllability() const;
+    virtual std::vector<ControlPath*> controlPaths() const;
+    virtual igraph::VectorInt driverNodes() const;
+    virtual void setGraph(igraph::Graph* graph);
+
+    /// Returns the eigenvalue with the largest geometric multiplicity
+    std::complex<double> criticalEigenvalue() const {
+        return m_criticalEigenvalue;
+    }
+
+    /// Sets the relative tolerance of the numerical calculations
+    void setTolerance(double tolerance) {
+        m_tolerance = tolerance;
+    }
+
+    /// Returns the relative tolerance of the numerical calculations
+    double tolerance() const {
+        return m_tolerance;
+    }
+
+protected:
+    /// Constructs the weighted adjacency matrix of the graph
+    /**
+     * \return \c true if the matrix is symmetric
+     */
+    bool constructMatrix(SparseMatrix& matrix) const;
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_MODEL_EXACT_H
@@ -4,11 +4,73 @@
 #define NETCTRL_MODEL_LIU_H
 
 #include <igraph/cpp/vector_int.h>
+#include <netctrl/kernel/edge_classes.h>
+#include <netctrl/kernel/matching.h>
 #include <netctrl/model/controllability.h>
+#include <netctrl/util/adjacency_view.h>
 #include <netctrl/util/directed_matching.h>
 
 namespace netctrl {
 
+/**
+ * \brief Control profile of a network: the driver nodes of the Liu model
+ *        split by what makes them necessary.
+ *
+ * Following Ruths and Ruths, source nodes (without inbound edges) always
+ * need a driver of their own. Sink nodes (without outbound edges) cannot
+ * pass the signal further, so the sinks in excess of the sources are
+ * external dilations that need drivers too. The remaining driver nodes are
+ * internal dilations, where a node has more successors than paths reaching
+ * it. The profile is derived from the degrees and the driver count alone,
+ * so it needs no extra matching.
+ */
+struct ControlProfile {
+    /// The number of driver nodes that are sources
+    long int sources;
+
+    /// The number of driver nodes due to the surplus of sinks over sources
+    long int externalDilations;
+
+    /// The number of the other driver nodes
+    long int internalDilations;
+
+    /// Creates an empty profile
+    ControlProfile() : sources(0), externalDilations(0), internalDilations(0) {}
+
+    /// Creates the profile of a network with the given number of sources,
+    /// sinks and driver nodes
+    ControlProfile(long int numSources, long int numSinks, long int numDriverNodes)
+        : sources(numSources),
+        externalDilations(numSinks > numSources ? numSinks - numSources : 0),
+        internalDilations(numDriverNodes - sources - externalDilations) {}
+
+    /// Returns the number of driver nodes
+    long int driverNodeCount() const {
+        return sources + externalDilations + internalDilations;
+    }
+
+    /// Returns the fraction of the driver nodes that are sources
+    double sourceFraction() const {
+        return fraction(sources);
+    }
+
+    /// Returns the fraction of the driver nodes due to external dilations
+    double externalDilationFraction() const {
+        return fraction(externalDilations);
+    }
+
+    /// Returns the fraction of the driver nodes due to internal dilations
+    double internalDilationFraction() const {
+        return fraction(internalDilations);
+    }
+
+private:
+    double fraction(long int count) const {
+        long int total = driverNodeCount();
+        return total > 0 ? count / static_cast<double>(total) : 0.0;
+    }
+};
+
 /// Controllability model of Liu et al
 class LiuControllabilityModel : public ControllabilityModel {
 private:
@@ -18,14 +80,37 @@ private:
     /// The matching that corresponds to the current driver node configuration
     DirectedMatching m_matching;
 
+    /// The matching that the next calculation starts from; empty if the
+    /// calculation should start from scratch
+    DirectedMatching m_warmStartMatching;
+
+    /// The vertices whose pairs were removed from the warm start matching
+    std::vector<long int> m_warmStartChanges;
+
     /// The list of control paths that was calculated
     std::vector<ControlPath*> m_controlPaths;
 
+    /// The control profile of the driver nodes that were calculated
+    ControlProfile m_controlProfile;
+
+    /// The matching engine that repairs the matching after edge updates;
+    /// it keeps its workspace between the batches
+    MatchingEngine<AdjacencyView> m_matchingEngine;
+
+    /// The labels that the edge classes are derived from; calculated when
+    /// the edge classes are first requested and maintained afterwards
+    mutable LiuEdgeClassTracker<AdjacencyView> m_edgeClassTracker;
+
+    /// The nodes of the alternating graph that the edge updates changed
+    /// since the edge classes were last brought up to date
+    mutable std::vector<long int> m_edgeClassChanges;
+
 public:
     /// Constructs a model that will operate on the given graph
     LiuControllabilityModel(igraph::Graph* pGraph = 0)
         : ControllabilityModel(pGraph), m_driverNodes(), m_matching(),
-        m_controlPaths() {
+        m_warmStartMatching(), m_warmStartChanges(), m_controlPaths(),
+        m_controlProfile(), m_matchingEngine(), m_edgeClassTracker(), m_edgeClassChanges() {
     }
 
     /// Destroys the model
@@ -37,24 +122,69 @@ public:
     virtual std::vector<ControlPath*> controlPaths() const;
     virtual igraph::VectorInt driverNodes() const;
     virtual std::vector<EdgeClass> edgeClasses() const;
+    virtual std::vector<long int> edgeClassCounts() const;
+
+    /// Returns the control profile after a successful calculation
+    /**
+     * The profile is computed in the same pass over the vertices that
+     * collects the driver nodes, both in \c calculate() and after the edge
+     * updates.
+     */
+    const ControlProfile& controlProfile() const {
+        return m_controlProfile;
+    }
+
+    /**
+     * \brief Applies a batch of edge insertions and deletions and repairs
+     *        the maximum matching.
+     *
+     * The pairs of the matching whose edges were deleted are removed, then
+     * the matching is augmented with \c MatchingEngine::repairAround(),
+     * which only searches from the free vertices that the batch may have
+     * connected to a free vertex on the other side. The driver nodes and
+     * the control paths are rebuilt from the repaired matching. The warm
+     * start matching, if any, is discarded.
+     *
+     * If the edge classes were requested before, the nodes of the
+     * alternating graph that the batch changed are recorded, and the next
+     * request only relabels the region that they affect; see
+     * \c LiuEdgeClassTracker.
+     */
+    virtual long int updateEdges(const EdgeUpdates& updates);
 
     DirectedMatching* matching();
     const DirectedMatching* matching() const;
 
     virtual void setGraph(igraph::Graph* graph);
 
+    /// Sets the matching that the calculations should start from
+    /**
+     * The matching is typically a maximum matching of an earlier version of
+     * the graph, without the pairs whose edges do not exist any more. It
+     * must be defined on the vertices of the current graph and each of its
+     * pairs must correspond to an edge of the graph. The calculations
+     * repair it to a maximum matching with \c MatchingEngine::repair()
+     * instead of building one from scratch, which is much faster when only
+     * a small part of the graph has changed. Pass an empty matching to
+     * start from scratch again; changing the graph also does that.
+     *
+     * \param  matching  the matching to start from
+     * \param  changes   the vertices whose pairs were removed from the
+     *                   original matching
+     */
+    void setWarmStartMatching(const DirectedMatching& matching,
+            const std::vector<long int>& changes);
+
 protected:
+    /// Finds the driver nodes and the control paths from the current matching
+    void calculateControlPaths();
+
     /// Removes all the control paths from the previous run (if any)
     void clearControlPaths();
 
-    /// Constructs the bipartite graph on which the matching will be searched.
-    /**
-     * \param  directed  whether the bipartite graph should be directed.
-     *                   If this is true, matched edges in the current matching
-     *                   will be oriented from top to bottom and the rest will
-     *                   be oriented from bottom to top.
-     */
-    igraph::Graph constructBipartiteGraph(bool directed=false) const;
+    /// Brings the labels of the edge classes up to date with the graph and
+    /// the matching
+    void updateEdgeClasses(const AdjacencyView& adjacency) const;
 };
 
 /// Control path that represents a stem
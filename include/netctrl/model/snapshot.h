@@ -0,0 +1,286 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_MODEL_SNAPSHOT_H
+#define NETCTRL_MODEL_SNAPSHOT_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <netctrl/model/controllability.h>
+#include <netctrl/util/epoch.h>
+#include <netctrl/util/shared_chunks.h>
+
+namespace netctrl {
+
+/// Parts of the results of a model that a snapshot contains
+typedef enum {
+    SNAPSHOT_DRIVER_NODES = 1,
+    SNAPSHOT_EDGE_CLASSES = 2,
+    SNAPSHOT_CONTROL_PATHS = 4,
+    SNAPSHOT_ALL = 7
+} SnapshotContents;
+
+/**
+ * \brief Immutable copy of the results of a controllability model for a
+ *        given version of the graph.
+ *
+ * The snapshot does not refer to the model or to the graph, so it can be
+ * read from any number of threads while the model is being updated. The
+ * edge classes are indexed by the edge IDs of the graph at the time the
+ * snapshot was taken; the endpoints of those edges are copied as well.
+ *
+ * The arrays of the snapshot are \c SharedChunks: the parts that did not
+ * change since the previous snapshot are shared with it instead of being
+ * copied. Taking a snapshot still reads the whole results of the model,
+ * which the models return as complete vectors, but after a small batch
+ * of updates it allocates and copies only the chunks that the batch
+ * touched.
+ */
+class ControllabilitySnapshot {
+private:
+    /// The version of the results, counted by the publisher
+    long int m_version;
+
+    /// The number of vertices of the graph
+    long int m_vertexCount;
+
+    /// The controllability measure of the model
+    float m_controllability;
+
+    /// The number of driver nodes
+    long int m_driverNodeCount;
+
+    /// The driver nodes; empty if not captured
+    SharedChunks<long int> m_driverNodes;
+
+    /// The source and target vertices of the edges, interleaved; empty if
+    /// the edge classes were not captured
+    SharedChunks<long int> m_edges;
+
+    /// The class of each edge; empty if not captured or not supported by
+    /// the model
+    SharedChunks<EdgeClass> m_edgeClasses;
+
+    /// The nodes of the control paths one after the other
+    SharedChunks<long int> m_pathNodes;
+
+    /// The index of the first node of each control path in \c m_pathNodes,
+    /// followed by the total number of nodes
+    SharedChunks<long int> m_pathOffsets;
+
+    /// The index of the type of each control path in \c m_pathTypes
+    SharedChunks<long int> m_pathTypeIndices;
+
+    /// The distinct names of the control path types
+    std::vector<std::string> m_pathTypes;
+
+    /// Whether the control paths of each type need an input signal
+    std::vector<bool> m_pathTypeNeedsInput;
+
+public:
+    /**
+     * \brief Copies the current results of a model.
+     *
+     * \param  model     the model after a successful calculation
+     * \param  version   the version number of the snapshot
+     * \param  contents  the parts of the results to copy, a combination of
+     *                   \c SnapshotContents flags; the number of driver
+     *                   nodes and the controllability are always copied
+     * \param  previous  an earlier snapshot whose unchanged parts are
+     *                   shared instead of being copied; may be null
+     */
+    ControllabilitySnapshot(const ControllabilityModel& model, long int version,
+            int contents = SNAPSHOT_ALL, const ControllabilitySnapshot* previous = 0);
+
+    /// Returns the version number of the snapshot
+    long int version() const {
+        return m_version;
+    }
+
+    /// Returns the number of vertices of the graph
+    long int vertexCount() const {
+        return m_vertexCount;
+    }
+
+    /// Returns the number of edges of the graph, if the edges were captured
+    long int edgeCount() const {
+        return m_edges.size() / 2;
+    }
+
+    /// Returns the controllability measure of the model
+    float controllability() const {
+        return m_controllability;
+    }
+
+    /// Returns the number of driver nodes
+    long int driverNodeCount() const {
+        return m_driverNodeCount;
+    }
+
+    /// Returns the driver nodes
+    const SharedChunks<long int>& driverNodes() const {
+        return m_driverNodes;
+    }
+
+    /// Returns the source vertex of the given edge
+    long int edgeSource(long int e) const {
+        return m_edges[2*e];
+    }
+
+    /// Returns the target vertex of the given edge
+    long int edgeTarget(long int e) const {
+        return m_edges[2*e+1];
+    }
+
+    /// Returns the class of each edge; empty if not available
+    const SharedChunks<EdgeClass>& edgeClasses() const {
+        return m_edgeClasses;
+    }
+
+    /// Returns the number of control paths
+    long int controlPathCount() const {
+        return m_pathTypeIndices.size();
+    }
+
+    /// Returns the number of nodes in the given control path
+    long int controlPathSize(long int i) const {
+        return m_pathOffsets[i+1] - m_pathOffsets[i];
+    }
+
+    /// Returns the k-th node of the given control path
+    long int controlPathNode(long int i, long int k) const {
+        return m_pathNodes[m_pathOffsets[i] + k];
+    }
+
+    /// Returns the user-friendly name of the type of the given control path
+    const std::string& controlPathName(long int i) const {
+        return m_pathTypes[m_pathTypeIndices[i]];
+    }
+
+    /// Returns whether the given control path needs an input signal
+    bool controlPathNeedsInputSignal(long int i) const {
+        return m_pathTypeNeedsInput[m_pathTypeIndices[i]];
+    }
+};
+
+/**
+ * \brief Publishes snapshots of a model to concurrent readers.
+ *
+ * The thread that updates the model calls \c publish() whenever the
+ * results are consistent again, e.g. after each batch of edge updates.
+ * Readers access the latest snapshot through a \c Reader and a \c Guard;
+ * they never block the updates and never wait for them, and a snapshot
+ * stays valid as long as the guard that found it exists. Replaced
+ * snapshots are deleted once no guard can refer to them any more, using
+ * an \c EpochDomain. Each snapshot shares the unchanged parts of its
+ * arrays with the previous one, and only the parts named in the contents
+ * of the publisher are copied at all; copy only what the readers need.
+ *
+ * \code
+ * SnapshotPublisher::Reader reader(publisher);    // once per thread
+ * ...
+ * {
+ *     SnapshotPublisher::Guard guard(reader);
+ *     if (guard->driverNodeCount() > 0) ...
+ * }
+ * \endcode
+ *
+ * The readers must be destroyed before the publisher.
+ */
+class SnapshotPublisher {
+private:
+    /// The domain of the readers and the replaced snapshots
+    EpochDomain m_domain;
+
+    /// The latest snapshot; null before the first publication
+    std::atomic<const ControllabilitySnapshot*> m_current;
+
+    /// The parts of the results copied into the snapshots
+    int m_contents;
+
+    /// The version of the latest snapshot
+    long int m_version;
+
+    /// Serializes the publications
+    std::mutex m_mutex;
+
+public:
+    class Guard;
+
+    /// A thread that reads the snapshots
+    class Reader {
+    private:
+        SnapshotPublisher& m_publisher;
+        EpochDomain::Reader m_reader;
+
+        friend class Guard;
+
+    public:
+        /// Registers a reader of the given publisher
+        explicit Reader(SnapshotPublisher& publisher)
+            : m_publisher(publisher), m_reader(publisher.m_domain) {}
+    };
+
+    /// Gives access to the latest snapshot while it exists
+    class Guard {
+    private:
+        EpochDomain::Guard m_guard;
+        const ControllabilitySnapshot* m_pSnapshot;
+
+    public:
+        /// Finds the latest snapshot on behalf of the given reader
+        explicit Guard(Reader& reader) : m_guard(reader.m_reader),
+            m_pSnapshot(reader.m_publisher.m_current.load()) {}
+
+        /// Returns the snapshot; null if nothing was published yet
+        const ControllabilitySnapshot* get() const {
+            return m_pSnapshot;
+        }
+
+        const ControllabilitySnapshot* operator->() const {
+            return m_pSnapshot;
+        }
+
+        const ControllabilitySnapshot& operator*() const {
+            return *m_pSnapshot;
+        }
+    };
+
+    /// Creates a publisher whose snapshots copy the given parts of the results
+    explicit SnapshotPublisher(int contents = SNAPSHOT_ALL)
+        : m_domain(), m_current(0), m_contents(contents), m_version(0), m_mutex() {}
+
+    /// Deletes the snapshots
+    ~SnapshotPublisher();
+
+    /**
+     * \brief Takes a snapshot of the current results of the model and makes
+     *        it the latest one.
+     *
+     * Must not be called concurrently with the updates of the model; the
+     * readers may run concurrently with both.
+     *
+     * \return the version of the new snapshot, starting from one
+     */
+    long int publish(const ControllabilityModel& model);
+
+    /// Returns the number of replaced snapshots that readers may still use
+    long int pendingCount() const {
+        return m_domain.pendingCount();
+    }
+
+    /// Returns the version of the latest snapshot; zero if there is none.
+    /// Readers should ask their snapshot instead.
+    long int version() const {
+        return m_version;
+    }
+
+private:
+    SnapshotPublisher(const SnapshotPublisher&);
+    SnapshotPublisher& operator=(const SnapshotPublisher&);
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_MODEL_SNAPSHOT_H
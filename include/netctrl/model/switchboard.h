@@ -3,7 +3,10 @@
 #ifndef NETCTRL_MODEL_SWITCHBOARD_H
 #define NETCTRL_MODEL_SWITCHBOARD_H
 
+#include <memory>
+#include <netctrl/kernel/switchboard.h>
 #include <netctrl/model/controllability.h>
+#include <netctrl/util/adjacency_view.h>
 #include <igraph/cpp/vector.h>
 #include <igraph/cpp/vector_bool.h>
 
@@ -30,11 +33,24 @@ private:
     /// Whether we are using the node-based or the edge-based measure
     ControllabilityMeasure m_controllabilityMeasure;
 
+    /// The class of each node in the last calculation, as returned by
+    /// \c classifyDegrees()
+    std::vector<signed char> m_degreeClasses;
+
+    /// Workspace of \c findBalancedComponentRoot() in the edge updates;
+    /// all zeros between the updates
+    std::vector<long int> m_componentOwners;
+
+    /// The control paths that pass through each node; built by the first
+    /// edge update after a calculation and maintained by the later ones
+    std::vector<std::vector<SwitchboardControlPath*> > m_controlPathsByNodes;
+
 public:
     /// Constructs a model that will operate on the given graph
     SwitchboardControllabilityModel(igraph::Graph* pGraph = 0)
         : ControllabilityModel(pGraph), m_driverNodes(), m_controlPaths(),
-          m_controllabilityMeasure(NODE_MEASURE)
+          m_controllabilityMeasure(NODE_MEASURE), m_degreeClasses(),
+          m_componentOwners(), m_controlPathsByNodes()
     {
     }
 
@@ -48,8 +64,32 @@ public:
     virtual std::vector<ControlPath*> controlPaths() const;
     virtual igraph::VectorInt driverNodes() const;
     virtual std::vector<EdgeClass> edgeClasses() const;
+    virtual std::vector<long int> edgeClassCounts() const;
     virtual void setGraph(igraph::Graph* graph);
 
+    /**
+     * \brief Applies a batch of edge insertions and deletions and updates
+     *        the driver nodes.
+     *
+     * Only the endpoints of the updated edges can change their degree
+     * classes, and only the weakly connected components around them can
+     * gain or lose their balanced root, so the rest of the driver nodes are
+     * kept. The components are explored before and after the update until
+     * the first unbalanced node.
+     *
+     * In directed graphs, only the walks through the endpoints of the
+     * updated edges are changed. The walk through a deleted edge is split
+     * there, and each inserted edge becomes a walk of its own. The ends of
+     * these pieces are where the degree surpluses changed, so a walk that
+     * now ends at a node where another one starts is joined with it
+     * (closing it if it is the same walk) until no node has both. Finally,
+     * the closed walks around the endpoints are merged into the paths they
+     * share a node with. The cost depends on the length of the walks that
+     * are changed, not on the size of the graph. The walks of undirected
+     * graphs are built again from scratch.
+     */
+    virtual long int updateEdges(const EdgeUpdates& updates);
+
     /// Returns the controllability measure used by the model
     ControllabilityMeasure controllabilityMeasure() const;
 
@@ -64,6 +104,9 @@ public:
     void setControllabilityMeasure(ControllabilityMeasure measure);
 
 protected:
+    /// Decomposes the edges into walks that start from the driver nodes
+    void calculateControlPaths();
+
     /// Removes all the control paths from the previous run (if any)
     void clearControlPaths();
 
@@ -73,33 +116,14 @@ private:
      * creates a control path out of it.
      *
      * \param  start      the node to start the walk from
-     * \param  edgeUsed   a vector where we can mark edges that have been used
-     *                    up for the current walk (or previous ones)
-     * \param  outDegrees the number of unused outbound edges for each node.
-     *                    Must be consistent with \c edgeUsed and is updated
-     *                    accordingly.
-     * \param  inDegrees  the number of unused inbound edges for each node.
-     *                    Must be consistent with \c edgeUsed and is updated
-     *                    accordingly.
+     * \param  walker     the walk builder that keeps track of the edges that
+     *                    have been used up for the current walk (or previous
+     *                    ones) and of the number of unused edges of each node
      * \return a newly allocated control path whose ownership is transferred to
      *         the caller
      */
     std::unique_ptr<SwitchboardControlPath> createControlPathFromNode(long int start,
-            igraph::VectorBool& edgeUsed, igraph::VectorInt& outDegrees,
-            igraph::VectorInt& inDegrees) const;
-    
-    /**
-     * Checks whether the given vertex v is part of a non-trivial
-     * balanced component.
-     */
-    bool isInBalancedComponent(long int v, const igraph::VectorInt& degreeDiffs) const;
-
-    /**
-     * Checks whether the given vertex v will be part of a non-trivial
-     * balanced component after removing its edge to vertex u.
-     */
-    bool isInBalancedComponentExcept(long int v, long int u,
-            const igraph::VectorInt& degreeDiffs) const;
+            WalkBuilder<AdjacencyView>& walker) const;
 };
 
 class ClosedWalk;
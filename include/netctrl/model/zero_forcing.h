@@ -0,0 +1,90 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_MODEL_ZERO_FORCING_H
+#define NETCTRL_MODEL_ZERO_FORCING_H
+
+#include <igraph/cpp/vector_int.h>
+#include <netctrl/model/controllability.h>
+
+namespace netctrl {
+
+/// Strong structural controllability model based on zero forcing sets
+/**
+ * Structural controllability in the sense of Liu et al holds for almost all
+ * choices of the edge weights; strong structural controllability holds for
+ * \em all nonzero edge weights (and arbitrary self-loops). A set of driver
+ * nodes makes the network strongly structurally controllable if and only if
+ * it is a zero forcing set of the graph (Monshizadeh et al), where a black
+ * node forces its only white outbound neighbor to become black.
+ *
+ * Finding a minimum zero forcing set is NP-hard, so the model runs a
+ * randomized greedy heuristic many times in several threads (see
+ * \c setThreadCount()), keeps the smallest set and then removes the nodes
+ * that are not needed. Each run is linear in the size of the graph.
+ */
+class ZeroForcingControllabilityModel : public ControllabilityModel {
+private:
+    /// The list of driver nodes that was calculated
+    igraph::VectorInt m_driverNodes;
+
+    /// The number of randomized restarts
+    long int m_restarts;
+
+    /// The maximum running time of the restarts and the pruning, in seconds
+    double m_timeBudget;
+
+    /// Seed of the random number generators of the restarts
+    unsigned long int m_seed;
+
+public:
+    /// Constructs a model that will operate on the given graph
+    ZeroForcingControllabilityModel(igraph::Graph* pGraph = 0)
+        : ControllabilityModel(pGraph), m_driverNodes(), m_restarts(1000),
+        m_timeBudget(1.0), m_seed(0) {
+    }
+
+    virtual void calculate();
+    virtual ControllabilityModel* clone();
+    virtual float controllability() const;
+    virtual std::vector<ControlPath*> controlPaths() const;
+    virtual igraph::VectorInt driverNodes() const;
+    virtual void setGraph(igraph::Graph* graph);
+
+    /// Sets the number of randomized restarts
+    void setRestarts(long int restarts) {
+        m_restarts = restarts;
+    }
+
+    /// Returns the number of randomized restarts
+    long int restarts() const {
+        return m_restarts;
+    }
+
+    /// Sets the seed of the random number generators of the restarts
+    void setSeed(unsigned long int seed) {
+        m_seed = seed;
+    }
+
+    /// Returns the seed of the random number generators of the restarts
+    unsigned long int seed() const {
+        return m_seed;
+    }
+
+    /// Sets the maximum running time of the restarts and the pruning, in seconds
+    /**
+     * Zero or negative values mean no limit; all the restarts are done and
+     * all the nodes are tried in the pruning.
+     */
+    void setTimeBudget(double seconds) {
+        m_timeBudget = seconds;
+    }
+
+    /// Returns the maximum running time of the restarts and the pruning, in seconds
+    double timeBudget() const {
+        return m_timeBudget;
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_MODEL_ZERO_FORCING_H
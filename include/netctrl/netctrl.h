@@ -3,6 +3,7 @@
 #ifndef NETCTRL_NETCTRL_H
 #define NETCTRL_NETCTRL_H
 
+#include <netctrl/kernel.h>
 #include <netctrl/model.h>
 #include <netctrl/util.h>
 
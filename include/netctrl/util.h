@@ -3,7 +3,17 @@
 #ifndef NETCTRL_UTIL_H
 #define NETCTRL_UTIL_H
 
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/bitset.h>
+#include <netctrl/util/cpu.h>
+#include <netctrl/util/csr_graph.h>
 #include <netctrl/util/directed_matching.h>
+#include <netctrl/util/edge_updates.h>
+#include <netctrl/util/epoch.h>
+#include <netctrl/util/kernels.h>
+#include <netctrl/util/parallel.h>
+#include <netctrl/util/profiler.h>
+#include <netctrl/util/shared_chunks.h>
 
 #endif
 
@@ -0,0 +1,139 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_ADJACENCY_VIEW_H
+#define NETCTRL_UTIL_ADJACENCY_VIEW_H
+
+#include <igraph/cpp/graph.h>
+
+namespace netctrl {
+
+/// Read-only adjacency view over the internal edge lists of an igraph graph
+/**
+ * An \c igraph_t stores the endpoints of the edges in \c from and \c to,
+ * and the edge IDs sorted by source and by target in \c oi and \c ii.
+ * \c os and \c is hold the starting offsets of each vertex in \c oi and
+ * \c ii, respectively. Together they form an implicit CSR representation
+ * of the graph in both directions. This class iterates over these arrays
+ * directly instead of copying the incident edges or neighbors of a vertex
+ * into a new vector on every query.
+ *
+ * For undirected graphs, each edge appears either in the "out" or in the
+ * "in" list of each of its endpoints depending on which one is larger, so
+ * both directions are served by concatenating the two lists. For directed
+ * graphs, \c degree(), \c edge() and \c neighbor() do the same to provide
+ * the incident edges in both directions.
+ *
+ * The view is invalidated when the underlying graph is modified.
+ */
+class AdjacencyView {
+private:
+    /// The graph being viewed
+    const igraph_t* m_pGraph;
+
+public:
+    /// Constructs a view over the given graph
+    explicit AdjacencyView(const igraph_t* graph) : m_pGraph(graph) {}
+
+    /// Returns the number of edges incident on the given vertex in any direction
+    long int degree(long int v) const {
+        return outListSize(v) + inListSize(v);
+    }
+
+    /// Returns the ID of the i-th edge incident on the given vertex in any direction
+    long int edge(long int v, long int i) const {
+        long int k = outListSize(v);
+        return i < k ? outListEdge(v, i) : inListEdge(v, i - k);
+    }
+
+    /// Returns the number of edges in the graph
+    long int edgeCount() const {
+        return m_pGraph->from.end - m_pGraph->from.stor_begin;
+    }
+
+    /// Returns the source vertex of the given edge
+    long int edgeSource(long int e) const {
+        return VECTOR(m_pGraph->from)[e];
+    }
+
+    /// Returns the target vertex of the given edge
+    long int edgeTarget(long int e) const {
+        return VECTOR(m_pGraph->to)[e];
+    }
+
+    /// Returns the i-th inbound edge of the given vertex
+    long int inEdge(long int v, long int i) const {
+        return m_pGraph->directed ? inListEdge(v, i) : edge(v, i);
+    }
+
+    /// Returns the number of inbound edges of the given vertex
+    long int inDegree(long int v) const {
+        return m_pGraph->directed ? inListSize(v) : degree(v);
+    }
+
+    /// Returns the source of the i-th inbound edge of the given vertex
+    long int inNeighbor(long int v, long int i) const {
+        return m_pGraph->directed ? edgeSource(inListEdge(v, i)) : neighbor(v, i);
+    }
+
+    /// Returns whether the graph is directed
+    bool isDirected() const {
+        return m_pGraph->directed;
+    }
+
+    /// Returns the other endpoint of the i-th edge incident on the given vertex
+    long int neighbor(long int v, long int i) const {
+        long int k = outListSize(v);
+        return i < k ? edgeTarget(outListEdge(v, i)) : edgeSource(inListEdge(v, i - k));
+    }
+
+    /// Returns the endpoint of the given edge that is not equal to v
+    long int otherEndpoint(long int e, long int v) const {
+        long int u = edgeTarget(e);
+        return u == v ? edgeSource(e) : u;
+    }
+
+    /// Returns the i-th outbound edge of the given vertex
+    long int outEdge(long int v, long int i) const {
+        return m_pGraph->directed ? outListEdge(v, i) : edge(v, i);
+    }
+
+    /// Returns the number of outbound edges of the given vertex
+    long int outDegree(long int v) const {
+        return m_pGraph->directed ? outListSize(v) : degree(v);
+    }
+
+    /// Returns the target of the i-th outbound edge of the given vertex
+    long int outNeighbor(long int v, long int i) const {
+        return m_pGraph->directed ? edgeTarget(outListEdge(v, i)) : neighbor(v, i);
+    }
+
+    /// Returns the number of vertices in the graph
+    long int vertexCount() const {
+        return m_pGraph->n;
+    }
+
+private:
+    /// Returns the i-th edge whose target is v in the internal index
+    long int inListEdge(long int v, long int i) const {
+        return VECTOR(m_pGraph->ii)[VECTOR(m_pGraph->is)[v] + i];
+    }
+
+    /// Returns the number of edges whose target is v in the internal index
+    long int inListSize(long int v) const {
+        return VECTOR(m_pGraph->is)[v+1] - VECTOR(m_pGraph->is)[v];
+    }
+
+    /// Returns the i-th edge whose source is v in the internal index
+    long int outListEdge(long int v, long int i) const {
+        return VECTOR(m_pGraph->oi)[VECTOR(m_pGraph->os)[v] + i];
+    }
+
+    /// Returns the number of edges whose source is v in the internal index
+    long int outListSize(long int v) const {
+        return VECTOR(m_pGraph->os)[v+1] - VECTOR(m_pGraph->os)[v];
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_ADJACENCY_VIEW_H
@@ -0,0 +1,116 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_BITSET_H
+#define NETCTRL_UTIL_BITSET_H
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <netctrl/util/kernels.h>
+
+namespace netctrl {
+
+/// Fixed-size set of bits with word-level bulk operations
+/**
+ * Bulk operations (counting, set difference, union) are implemented by the
+ * dispatched kernels in \c netctrl/util/kernels.h so they can make use of
+ * wider vector units when the CPU has them. This makes the class suitable
+ * for frontier and visited sets in bitset-based breadth-first searches.
+ */
+class Bitset {
+private:
+    /// The words storing the bits
+    std::vector<uint64_t> m_words;
+
+    /// The number of bits in the set
+    size_t m_size;
+
+public:
+    /// Constructs a bitset with the given number of bits, all cleared
+    explicit Bitset(size_t size = 0)
+        : m_words((size + 63) / 64, 0), m_size(size) {}
+
+    /// Sets <tt>*this = a & ~b</tt> and returns the number of set bits
+    size_t assignAndNot(const Bitset& a, const Bitset& b) {
+        if (m_words.empty())
+            return 0;
+        return bitsetAndNot(&m_words[0], &a.m_words[0], &b.m_words[0], m_words.size());
+    }
+
+    /// Clears all the bits
+    void clear() {
+        std::fill(m_words.begin(), m_words.end(), 0);
+    }
+
+    /// Returns the number of set bits
+    size_t count() const {
+        return m_words.empty() ? 0 : bitsetCount(&m_words[0], m_words.size());
+    }
+
+    /// Returns the index of the first set bit at or after the given index
+    /**
+     * \return  the index of the next set bit or \c size() if there is none
+     */
+    size_t findNext(size_t index) const {
+        size_t word = index >> 6, n = m_words.size();
+        uint64_t bits;
+
+        if (index >= m_size)
+            return m_size;
+
+        bits = m_words[word] & (~static_cast<uint64_t>(0) << (index & 63));
+        while (bits == 0) {
+            if (++word >= n)
+                return m_size;
+            bits = m_words[word];
+        }
+
+        return std::min(m_size, (word << 6) + __builtin_ctzll(bits));
+    }
+
+    /// Sets <tt>*this |= other</tt> and returns the number of set bits
+    size_t merge(const Bitset& other) {
+        if (m_words.empty())
+            return 0;
+        return bitsetOr(&m_words[0], &other.m_words[0], m_words.size());
+    }
+
+    /// Clears the bit with the given index
+    void reset(size_t index) {
+        m_words[index >> 6] &= ~(static_cast<uint64_t>(1) << (index & 63));
+    }
+
+    /// Resizes the bitset; all the bits are cleared
+    void resize(size_t size) {
+        m_words.assign((size + 63) / 64, 0);
+        m_size = size;
+    }
+
+    /// Sets the bit with the given index
+    void set(size_t index) {
+        m_words[index >> 6] |= static_cast<uint64_t>(1) << (index & 63);
+    }
+
+    /// Returns the number of bits in the set
+    size_t size() const {
+        return m_size;
+    }
+
+    /// Returns whether the bit with the given index is set
+    bool test(size_t index) const {
+        return (m_words[index >> 6] >> (index & 63)) & 1;
+    }
+
+    /// Sets the bit with the given index and returns whether it was clear
+    bool testAndSet(size_t index) {
+        uint64_t mask = static_cast<uint64_t>(1) << (index & 63);
+        uint64_t& word = m_words[index >> 6];
+        bool result = (word & mask) == 0;
+        word |= mask;
+        return result;
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_BITSET_H
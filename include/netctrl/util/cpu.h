@@ -0,0 +1,38 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_CPU_H
+#define NETCTRL_UTIL_CPU_H
+
+#include <string>
+
+/**
+ * \def NETCTRL_DISPATCH
+ *
+ * Marks a hot kernel that should be compiled for several instruction set
+ * levels. The dynamic loader calls a resolver when the program starts; the
+ * resolver queries CPUID and binds the kernel to the best variant that the
+ * CPU supports. This allows portable release binaries built for baseline
+ * x86-64 to run AVX2 or AVX-512 code where it is available.
+ *
+ * Expands to nothing if the compiler does not support function
+ * multiversioning or if it was disabled with \c ENABLE_CPU_DISPATCH.
+ */
+#if defined(NETCTRL_HAVE_TARGET_CLONES) && (defined(__x86_64__) || defined(__i386__))
+#  define NETCTRL_DISPATCH \
+    __attribute__((target_clones("avx512f", "avx2", "sse4.2", "default")))
+#else
+#  define NETCTRL_DISPATCH
+#endif
+
+namespace netctrl {
+
+/// Returns the name of the instruction set level that dispatched kernels use
+/**
+ * The result is one of \c "avx512f", \c "avx2", \c "sse4.2" or \c "default",
+ * and it is always \c "default" if runtime dispatching is not available.
+ */
+std::string dispatchedInstructionSet();
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_CPU_H
@@ -0,0 +1,190 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_CSR_GRAPH_H
+#define NETCTRL_UTIL_CSR_GRAPH_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace netctrl {
+
+/// Read-only graph adaptor over raw compressed sparse row arrays
+/**
+ * This adaptor lets the kernels in \c netctrl/kernel.h operate on graphs
+ * that are stored in user-owned arrays without copying them. The arrays
+ * must outlive the view. \c Index is the integer type used in the arrays.
+ *
+ * The outbound edges of vertex \c v are stored at positions
+ * <tt>outOffsets[v]</tt> to <tt>outOffsets[v+1]-1</tt> of \c outTargets.
+ * The ID of the edge at position \c k is <tt>outEdges[k]</tt>, or simply
+ * \c k if \c outEdges is null. The inbound edges are described similarly by
+ * \c inOffsets, \c inSources and \c inEdges; \c inEdges is mandatory and
+ * must use the same edge IDs as the outbound arrays.
+ *
+ * For undirected graphs, every edge must appear in the outbound lists of
+ * both of its endpoints with the same ID; the inbound arrays may be null,
+ * in which case the outbound arrays are used in both directions.
+ */
+template <typename Index>
+class BasicCSRGraphView {
+private:
+    Index m_vertexCount, m_edgeCount;
+    bool m_directed;
+    const Index *m_outOffsets, *m_outTargets, *m_outEdges;
+    const Index *m_inOffsets, *m_inSources, *m_inEdges;
+
+public:
+    /// Constructs a view over the given arrays
+    BasicCSRGraphView(Index vertexCount, Index edgeCount, bool directed,
+            const Index* outOffsets, const Index* outTargets, const Index* outEdges,
+            const Index* inOffsets = 0, const Index* inSources = 0,
+            const Index* inEdges = 0)
+        : m_vertexCount(vertexCount), m_edgeCount(edgeCount), m_directed(directed),
+          m_outOffsets(outOffsets), m_outTargets(outTargets), m_outEdges(outEdges),
+          m_inOffsets(inOffsets), m_inSources(inSources), m_inEdges(inEdges) {
+        if (inOffsets == 0) {
+            if (directed)
+                throw std::invalid_argument("directed CSR views need inbound arrays");
+            m_inOffsets = outOffsets;
+            m_inSources = outTargets;
+            m_inEdges = outEdges;
+        } else if (inEdges == 0 && edgeCount > 0) {
+            throw std::invalid_argument("inbound edge IDs must be provided");
+        }
+    }
+
+    // Methods required by the graph concept; see netctrl/kernel.h
+
+    long int edgeCount() const {
+        return m_edgeCount;
+    }
+
+    long int inDegree(long int v) const {
+        return m_inOffsets[v+1] - m_inOffsets[v];
+    }
+
+    long int inEdge(long int v, long int i) const {
+        long int k = m_inOffsets[v] + i;
+        return m_inEdges ? static_cast<long int>(m_inEdges[k]) : k;
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        return m_inSources[m_inOffsets[v] + i];
+    }
+
+    bool isDirected() const {
+        return m_directed;
+    }
+
+    long int outDegree(long int v) const {
+        return m_outOffsets[v+1] - m_outOffsets[v];
+    }
+
+    long int outEdge(long int v, long int i) const {
+        long int k = m_outOffsets[v] + i;
+        return m_outEdges ? static_cast<long int>(m_outEdges[k]) : k;
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        return m_outTargets[m_outOffsets[v] + i];
+    }
+
+    long int vertexCount() const {
+        return m_vertexCount;
+    }
+};
+
+/// CSR view with \c long int indices
+typedef BasicCSRGraphView<long int> CSRGraphView;
+
+/// Graph stored in compressed sparse row format in both directions
+/**
+ * Unlike \c CSRGraphView, this class owns its arrays. It is meant for input
+ * readers that build the graph from scratch and for callers that have their
+ * graph as an edge list only. Undirected graphs store each edge in the lists
+ * of both of its endpoints and have no separate inbound arrays.
+ */
+class CSRGraph {
+private:
+    long int m_vertexCount;
+    bool m_directed;
+    std::vector<long int> m_outOffsets, m_outTargets, m_outEdges;
+    std::vector<long int> m_inOffsets, m_inSources, m_inEdges;
+
+public:
+    /// Constructs an empty graph with no vertices
+    CSRGraph() : m_vertexCount(0), m_directed(true),
+        m_outOffsets(1, 0), m_outTargets(), m_outEdges(),
+        m_inOffsets(1, 0), m_inSources(), m_inEdges() {}
+
+    /// Constructs a graph from an edge list
+    /**
+     * \param  vertexCount  the number of vertices
+     * \param  edges        the edge list; edge \c i goes from
+     *                      <tt>edges[2*i]</tt> to <tt>edges[2*i+1]</tt>
+     * \param  directed     whether the graph is directed
+     */
+    CSRGraph(long int vertexCount, const std::vector<long int>& edges, bool directed = true);
+
+    // Methods required by the graph concept; see netctrl/kernel.h
+
+    long int edgeCount() const {
+        return m_directed ? m_outTargets.size() : m_outTargets.size() / 2;
+    }
+
+    /// Returns the edge list of the graph in the format accepted by the constructor
+    std::vector<long int> edgeList() const;
+
+    long int inDegree(long int v) const {
+        return m_directed ? m_inOffsets[v+1] - m_inOffsets[v] : outDegree(v);
+    }
+
+    long int inEdge(long int v, long int i) const {
+        return m_directed ? m_inEdges[m_inOffsets[v] + i] : outEdge(v, i);
+    }
+
+    long int inNeighbor(long int v, long int i) const {
+        return m_directed ? m_inSources[m_inOffsets[v] + i] : outNeighbor(v, i);
+    }
+
+    bool isDirected() const {
+        return m_directed;
+    }
+
+    long int outDegree(long int v) const {
+        return m_outOffsets[v+1] - m_outOffsets[v];
+    }
+
+    long int outEdge(long int v, long int i) const {
+        return m_outEdges[m_outOffsets[v] + i];
+    }
+
+    long int outNeighbor(long int v, long int i) const {
+        return m_outTargets[m_outOffsets[v] + i];
+    }
+
+    long int vertexCount() const {
+        return m_vertexCount;
+    }
+
+    /// Returns a non-owning view of the graph
+    CSRGraphView view() const {
+        if (!m_directed) {
+            return CSRGraphView(m_vertexCount, edgeCount(), m_directed,
+                    &m_outOffsets[0], dataOrNull(m_outTargets), dataOrNull(m_outEdges));
+        }
+        return CSRGraphView(m_vertexCount, edgeCount(), m_directed,
+                &m_outOffsets[0], dataOrNull(m_outTargets), dataOrNull(m_outEdges),
+                &m_inOffsets[0], dataOrNull(m_inSources), dataOrNull(m_inEdges));
+    }
+
+private:
+    static const long int* dataOrNull(const std::vector<long int>& vec) {
+        return vec.empty() ? 0 : &vec[0];
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_CSR_GRAPH_H
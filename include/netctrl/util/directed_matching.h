@@ -3,6 +3,7 @@
 #ifndef NETCTRL_UTIL_DIRECTED_MATCHING_H
 #define NETCTRL_UTIL_DIRECTED_MATCHING_H
 
+#include <cassert>
 #include <igraph/cpp/vector_int.h>
 
 namespace netctrl {
@@ -24,6 +25,12 @@ public:
     /// Constructs an empty matching
     DirectedMatching() : m_outMapping(), m_inMapping() {}
 
+    /// Constructs a matching on the given number of nodes where all nodes are unmatched
+    explicit DirectedMatching(long int n) : m_outMapping(n), m_inMapping(n) {
+        m_outMapping.fill(-1);
+        m_inMapping.fill(-1);
+    }
+
     /// Constructs a matching
     /**
      * \param  vector     the vector that describes the matching
@@ -94,6 +101,13 @@ public:
         m_inMapping[v] = u;
     }
 
+    /**
+     * Returns the number of nodes the matching is defined on.
+     */
+    long int size() const {
+        return m_outMapping.size();
+    }
+
     /**
      * Destroys the matching between the two given nodes.
      *
@@ -0,0 +1,62 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_EDGE_UPDATES_H
+#define NETCTRL_UTIL_EDGE_UPDATES_H
+
+#include <vector>
+#include <igraph/cpp/graph.h>
+
+namespace netctrl {
+
+/// A batch of edge insertions and deletions
+/**
+ * The edges are given by the IDs of their endpoints; the vertices of the
+ * graph stay the same. The deletions are applied before the insertions, so
+ * deleting an edge and inserting it again in the same batch keeps it.
+ */
+struct EdgeUpdates {
+    /// The sources and targets of the inserted edges, interleaved
+    std::vector<long int> insertions;
+
+    /// The sources and targets of the deleted edges, interleaved. If there
+    /// are several edges between the same vertices, one of them is deleted
+    /// for each entry.
+    std::vector<long int> deletions;
+
+    EdgeUpdates() : insertions(), deletions() {}
+
+    /// Returns the number of inserted edges
+    long int insertionCount() const {
+        return insertions.size() / 2;
+    }
+
+    /// Returns the number of deleted edges
+    long int deletionCount() const {
+        return deletions.size() / 2;
+    }
+
+    /// Returns whether the batch contains no updates
+    bool empty() const {
+        return insertions.empty() && deletions.empty();
+    }
+};
+
+/**
+ * \brief Applies a batch of edge insertions and deletions to a graph.
+ *
+ * Deletions of edges that do not exist are ignored. The remaining edges
+ * keep their order, the inserted ones are appended at the end; igraph
+ * rebuilds its edge index once for the deletions and once for the
+ * insertions, so the cost is linear in the size of the graph no matter how
+ * large the batch is.
+ *
+ * \param  graph    the graph to modify
+ * \param  updates  the updates to apply
+ * \return the number of deletions that were ignored
+ * \throws std::invalid_argument if a vertex ID is out of range
+ */
+long int applyEdgeUpdates(igraph::Graph& graph, const EdgeUpdates& updates);
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_EDGE_UPDATES_H
@@ -0,0 +1,157 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_EPOCH_H
+#define NETCTRL_UTIL_EPOCH_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace netctrl {
+
+/**
+ * \brief Epoch-based reclamation of objects that concurrent readers may
+ *        still be using.
+ *
+ * Writers replace a shared object by publishing a new one through an atomic
+ * pointer and hand the old one to \c retire() instead of deleting it.
+ * Readers announce the epoch in which they started reading with a
+ * \c Guard; an object retired in a given epoch is only deleted when no
+ * reader announced that epoch or an earlier one. Readers never wait for
+ * the writers or for each other: entering and leaving a guard are single
+ * atomic stores into a slot of their own.
+ *
+ * Each reading thread registers a \c Reader once, which takes a lock; the
+ * guards of the reader must not be nested. A reader that stays in a guard
+ * for a long time holds back the deletion of every object retired since,
+ * but it does not hold back the writers.
+ */
+class EpochDomain {
+private:
+    /// Epoch announced by a reader; zero while it is outside a guard. The
+    /// slots are allocated one by one and padded to the size of a cache
+    /// line so that the readers do not write the same line.
+    struct Slot {
+        std::atomic<unsigned long> epoch;
+        bool used;
+        char padding[64 - sizeof(std::atomic<unsigned long>) - sizeof(bool)];
+
+        Slot() : epoch(0), used(false) {}
+    };
+
+    /// An object waiting to be deleted
+    struct Retired {
+        void* object;
+        void (*deleter)(void*);
+        unsigned long epoch;
+    };
+
+    /// The current epoch; starts from one
+    std::atomic<unsigned long> m_epoch;
+
+    /// The slots of the readers; never shrinks, so the readers can keep
+    /// pointers to their slots
+    std::vector<std::unique_ptr<Slot> > m_slots;
+
+    /// The objects that were retired but not deleted yet
+    std::vector<Retired> m_retired;
+
+    /// Lock of the slot list and the retired objects
+    mutable std::mutex m_mutex;
+
+    template <typename T>
+    static void deleteObject(void* object) {
+        delete static_cast<T*>(object);
+    }
+
+public:
+    /// A thread that reads the objects protected by the domain
+    class Reader {
+    private:
+        EpochDomain& m_domain;
+        Slot* m_pSlot;
+
+    public:
+        /// Registers a reader in the given domain
+        explicit Reader(EpochDomain& domain);
+
+        /// Releases the slot of the reader
+        ~Reader();
+
+        /// Announces that the reader starts reading in the current epoch
+        void enter() {
+            m_pSlot->epoch.store(m_domain.m_epoch.load());
+        }
+
+        /// Announces that the reader does not use any object any more
+        void exit() {
+            m_pSlot->epoch.store(0, std::memory_order_release);
+        }
+
+    private:
+        Reader(const Reader&);
+        Reader& operator=(const Reader&);
+    };
+
+    /// Keeps a reader inside the domain while it exists
+    class Guard {
+    private:
+        Reader& m_reader;
+
+    public:
+        explicit Guard(Reader& reader) : m_reader(reader) {
+            m_reader.enter();
+        }
+
+        ~Guard() {
+            m_reader.exit();
+        }
+
+    private:
+        Guard(const Guard&);
+        Guard& operator=(const Guard&);
+    };
+
+    /// Creates an empty domain
+    EpochDomain() : m_epoch(1), m_slots(), m_retired(), m_mutex() {}
+
+    /// Deletes every retired object; there must be no readers left
+    ~EpochDomain();
+
+    /**
+     * \brief Hands over an object that readers may still be using and
+     *        deletes the objects that no reader can see any more.
+     *
+     * The object must already be unreachable for readers that enter the
+     * domain from now on, i.e. the pointer through which they found it
+     * must have been replaced.
+     */
+    template <typename T>
+    void retire(const T* object) {
+        retire(const_cast<T*>(object), &deleteObject<T>);
+    }
+
+    /// Type-erased variant of \c retire()
+    void retire(void* object, void (*deleter)(void*));
+
+    /// Deletes the retired objects that no reader can see any more
+    /**
+     * \return the number of objects deleted
+     */
+    long int collect();
+
+    /// Returns the number of retired objects that are not deleted yet
+    long int pendingCount() const;
+
+private:
+    /// Deletes the retired objects that no reader can see; the lock must be held
+    long int collectLocked();
+
+    EpochDomain(const EpochDomain&);
+    EpochDomain& operator=(const EpochDomain&);
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_EPOCH_H
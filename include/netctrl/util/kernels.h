@@ -0,0 +1,77 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_KERNELS_H
+#define NETCTRL_UTIL_KERNELS_H
+
+#include <cstddef>
+#include <stdint.h>
+#include <igraph/cpp/vector_int.h>
+
+namespace netctrl {
+
+/**
+ * \file kernels.h
+ *
+ * Hot inner loops that are compiled for several instruction set levels;
+ * see \c NETCTRL_DISPATCH in \c netctrl/util/cpu.h for more details.
+ */
+
+/**
+ * \brief Classifies nodes by comparing their out- and in-degrees.
+ *
+ * \param  outDegrees  the out-degrees of the nodes
+ * \param  inDegrees   the in-degrees of the nodes
+ * \param  classes     output array where the class of each node will be
+ *                     written: 1 if the node is divergent (more outbound
+ *                     than inbound edges), 0 if it is balanced and has at
+ *                     least one edge, -1 otherwise
+ * \param  n           the number of nodes
+ * \return the number of balanced nodes with at least one edge
+ */
+long int classifyDegrees(const igraph::integer_t* outDegrees,
+        const igraph::integer_t* inDegrees, signed char* classes, long int n);
+
+/**
+ * \brief Selects the entries of an array whose absolute value exceeds a
+ *        threshold.
+ *
+ * \param  values     the array
+ * \param  n          the number of entries in the array
+ * \param  threshold  the threshold
+ * \param  indices    output array of size at least \c n where the indices
+ *                    of the selected entries are written in increasing order
+ * \return the number of selected entries
+ */
+long int selectAboveThreshold(const double* values, long int n, double threshold,
+        long int* indices);
+
+/// Same as above, for single precision values
+long int selectAboveThreshold(const float* values, long int n, float threshold,
+        long int* indices);
+
+/// Same as above, for bytes, which are treated as unsigned
+long int selectAboveThreshold(const uint8_t* values, long int n, uint8_t threshold,
+        long int* indices);
+
+/// Returns the number of set bits in the given array of words
+size_t bitsetCount(const uint64_t* words, size_t n);
+
+/**
+ * \brief Calculates <tt>dst = a & ~b</tt> word by word.
+ *
+ * \c dst may be the same as \c a or \c b.
+ *
+ * \return the number of set bits in the result
+ */
+size_t bitsetAndNot(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n);
+
+/**
+ * \brief Calculates <tt>dst |= a</tt> word by word.
+ *
+ * \return the number of set bits in the result
+ */
+size_t bitsetOr(uint64_t* dst, const uint64_t* a, size_t n);
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_KERNELS_H
@@ -0,0 +1,164 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_PARALLEL_H
+#define NETCTRL_UTIL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+/// Returns the number of threads that parallel kernels of the library use
+int threadCount();
+
+/// Sets the number of threads that parallel kernels of the library use
+/**
+ * Zero or negative values mean one thread per hardware thread of the
+ * machine. The default is one thread.
+ */
+void setThreadCount(int numThreads);
+
+/**
+ * \brief Calls a function for each index in a range, using the threads of
+ *        the library.
+ *
+ * The indices are handed out to the threads one by one, so the iterations
+ * may take very different amounts of time. The function must be safe to
+ * call concurrently for different indices. If any of the calls throws an
+ * exception, the remaining indices are skipped and the first exception is
+ * re-thrown in the calling thread. If the profiler is enabled, the other
+ * threads record the phase of the calling thread for their share of the
+ * work.
+ *
+ * \param  begin  the first index
+ * \param  end    the index after the last one
+ * \param  body   the function to call with each index
+ */
+template <typename Function>
+void parallelFor(long int begin, long int end, Function body) {
+    long int numThreads = threadCount(), i;
+
+    if (end - begin < numThreads)
+        numThreads = end - begin;
+
+    if (numThreads <= 1) {
+        for (i = begin; i < end; i++)
+            body(i);
+        return;
+    }
+
+    std::atomic<long int> next(begin);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    std::vector<std::thread> threads;
+
+    struct Worker {
+        static void run(std::atomic<long int>& next, long int end, Function& body,
+                std::exception_ptr& error, std::mutex& errorMutex) {
+            long int index;
+            try {
+                while ((index = next.fetch_add(1)) < end)
+                    body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error)
+                    error = std::current_exception();
+                next = end;
+            }
+        }
+
+        static void runInPhase(std::atomic<long int>& next, long int end, Function& body,
+                std::exception_ptr& error, std::mutex& errorMutex, const char* phase,
+                int slot) {
+            if (phase == 0) {
+                run(next, end, body, error, errorMutex);
+                return;
+            }
+
+            Profiler::setWorkerSlot(slot);
+            ScopedPhase scope(phase);
+            run(next, end, body, error, errorMutex);
+        }
+    };
+
+    const char* phase = Profiler::instance().isEnabled() ? Profiler::currentPhase() : 0;
+
+    for (i = 1; i < numThreads; i++) {
+        threads.push_back(std::thread(&Worker::runInPhase, std::ref(next), end,
+                    std::ref(body), std::ref(error), std::ref(errorMutex), phase,
+                    static_cast<int>(i)));
+    }
+    Worker::run(next, end, body, error, errorMutex);
+    for (i = 0; i < numThreads - 1; i++)
+        threads[i].join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/**
+ * \brief Point where a fixed number of threads wait for each other.
+ *
+ * \c wait() returns in all threads once the given number of threads have
+ * called it; the barrier can then be used again for the next step.
+ */
+class Barrier {
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_released;
+
+    /// The number of threads that wait for each other
+    long int m_size;
+
+    /// The number of threads waiting in the current step
+    long int m_waiting;
+
+    /// The number of steps completed so far
+    long int m_step;
+
+public:
+    /// Constructs a barrier for the given number of threads
+    explicit Barrier(long int size);
+
+    /// Waits until all the threads have reached the barrier
+    void wait();
+};
+
+/**
+ * \brief Runs a team of threads that work together on a task of many steps.
+ *
+ * Calls <tt>body(thread, numThreads, barrier)</tt> once in each of
+ * \c numThreads threads, where \c thread is the index of the thread in the
+ * team and \c barrier is a \c Barrier for the whole team. The team is
+ * started once and the threads synchronize with the barrier between the
+ * steps of the task, which is much cheaper than a \c parallelFor() for each
+ * step. The number of threads is limited to \c threadCount(). The body
+ * must not throw between two waits, or the other threads of the team wait
+ * forever.
+ *
+ * \param  numThreads  the number of threads needed
+ * \param  body        the function to call in each thread
+ */
+template <typename Function>
+void parallelTeam(long int numThreads, Function body) {
+    numThreads = std::max(1L, std::min<long int>(numThreads, threadCount()));
+
+    // A thread only takes a new index once its body returned, which needs
+    // all the others to have reached the barrier, so each index gets its
+    // own thread
+    Barrier barrier(numThreads);
+    parallelFor(0, numThreads, [&](long int thread) {
+        body(thread, numThreads, barrier);
+    });
+}
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_PARALLEL_H
@@ -0,0 +1,212 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_PROFILER_H
+#define NETCTRL_UTIL_PROFILER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <stdint.h>
+
+namespace netctrl {
+
+/// Hardware events counted by the profiler
+typedef enum {
+    COUNTER_CYCLES,
+    COUNTER_INSTRUCTIONS,
+    COUNTER_LLC_MISSES,
+    COUNTER_BRANCH_MISSES,
+    NUM_COUNTERS
+} HardwareCounter;
+
+/// Values of the hardware counters at a given point in time
+struct CounterValues {
+    uint64_t values[NUM_COUNTERS];
+    bool valid;
+
+    CounterValues() : valid(false) {
+        for (int i = 0; i < NUM_COUNTERS; i++)
+            values[i] = 0;
+    }
+};
+
+/// Accumulated statistics of a single phase in a single thread
+struct PhaseStatistics {
+    /// Number of times the phase was entered
+    long int calls;
+
+    /// Total wall clock time spent in the phase, in seconds
+    double seconds;
+
+    /// Total of the hardware counter deltas over the calls of the phase
+    uint64_t counters[NUM_COUNTERS];
+
+    /// Whether the hardware counters could be read at every phase boundary
+    bool hasCounters;
+
+    PhaseStatistics() : calls(0), seconds(0.0), hasCounters(true) {
+        for (int i = 0; i < NUM_COUNTERS; i++)
+            counters[i] = 0;
+    }
+};
+
+/// Process-wide collector of per-phase timings and hardware counters
+/**
+ * Phases are marked in the code with \c ScopedPhase objects. When the
+ * profiler is disabled (the default), a \c ScopedPhase costs a single
+ * branch. When it is enabled, each phase records its wall clock time and,
+ * if requested and supported by the kernel, the number of CPU cycles,
+ * retired instructions, last level cache misses and branch mispredictions
+ * of the calling thread, read with \c perf_event_open() on Linux.
+ *
+ * Statistics are accumulated separately for each phase and thread; nested
+ * phases are inclusive. The worker threads started by \c parallelFor()
+ * inside a phase record that phase as well, with their own counters, so
+ * the work done on the other threads is not lost. They are numbered by
+ * their position among the workers of \c parallelFor(): the same worker
+ * position always gets the same thread index, even though the threads
+ * themselves are started anew for each loop.
+ */
+class Profiler {
+public:
+    /// Accumulated statistics, indexed by phase name and thread index
+    typedef std::map<std::pair<std::string, int>, PhaseStatistics> PhaseMap;
+
+private:
+    /// Whether profiling is enabled
+    bool m_enabled;
+
+    /// Whether hardware counters should be read at phase boundaries
+    bool m_countersEnabled;
+
+    /// Accumulated statistics, indexed by phase name and thread index
+    PhaseMap m_phases;
+
+    /// Mutex guarding the accumulated statistics
+    mutable std::mutex m_mutex;
+
+    Profiler();
+
+public:
+    /// Returns the global profiler instance
+    static Profiler& instance();
+
+    /// Returns whether hardware counters are read at phase boundaries
+    bool areCountersEnabled() const {
+        return m_countersEnabled;
+    }
+
+    /// Returns whether profiling is enabled
+    bool isEnabled() const {
+        return m_enabled;
+    }
+
+    /// Adds the statistics of a single call of a phase
+    void record(const std::string& phase, double seconds,
+            const CounterValues& start, const CounterValues& end);
+
+    /// Removes all the accumulated statistics
+    void reset();
+
+    /// Enables or disables hardware counters
+    /**
+     * \return \c true if the counters are supported on this system (or if
+     *         they were disabled), \c false otherwise
+     */
+    bool setCountersEnabled(bool enabled);
+
+    /// Enables or disables profiling
+    void setEnabled(bool enabled) {
+        m_enabled = enabled;
+    }
+
+    /// Returns a copy of the statistics accumulated so far
+    /**
+     * The difference of two snapshots gives the statistics of the phases
+     * that were run between them.
+     */
+    PhaseMap snapshot() const;
+
+    /// Writes the accumulated statistics to the given stream in JSON format
+    void writeJSON(std::ostream& os) const;
+
+    /// Reads the hardware counters of the calling thread
+    /**
+     * The counters are opened lazily for each thread when this function is
+     * called the first time from that thread. \c values.valid is \c false
+     * if the counters are not available.
+     */
+    static void readCounters(CounterValues& values);
+
+    /// Returns the index of the calling thread in the profile
+    static int threadIndex();
+
+    /// Makes the calling thread report its phases as the worker at the
+    /// given position of \c parallelFor(), counted from one; the thread
+    /// that calls \c parallelFor() keeps its own index
+    static void setWorkerSlot(int slot);
+
+    /// Returns the innermost phase of the calling thread, or null
+    static const char* currentPhase();
+
+    /// Sets the innermost phase of the calling thread and returns the
+    /// previous one
+    static const char* swapCurrentPhase(const char* name);
+};
+
+/// Marks a profiled phase that lasts until the object goes out of scope
+class ScopedPhase {
+private:
+    /// Name of the phase; null if the profiler was disabled on entry
+    const char* m_name;
+
+    /// The phase that encloses this one in the same thread, or null
+    const char* m_parent;
+
+    /// Time when the phase was entered
+    std::chrono::steady_clock::time_point m_start;
+
+    /// Counter values when the phase was entered
+    CounterValues m_startCounters;
+
+    ScopedPhase(const ScopedPhase&);
+    ScopedPhase& operator=(const ScopedPhase&);
+
+public:
+    /// Enters the phase with the given name
+    explicit ScopedPhase(const char* name) : m_name(0), m_parent(0) {
+        Profiler& profiler = Profiler::instance();
+        if (!profiler.isEnabled())
+            return;
+
+        m_name = name;
+        m_parent = Profiler::swapCurrentPhase(name);
+        if (profiler.areCountersEnabled())
+            Profiler::readCounters(m_startCounters);
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    /// Leaves the phase and records its statistics
+    ~ScopedPhase() {
+        if (m_name == 0)
+            return;
+
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        CounterValues endCounters;
+        Profiler& profiler = Profiler::instance();
+        if (profiler.areCountersEnabled())
+            Profiler::readCounters(endCounters);
+
+        profiler.record(m_name,
+                std::chrono::duration<double>(end - m_start).count(),
+                m_startCounters, endCounters);
+        Profiler::swapCurrentPhase(m_parent);
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_PROFILER_H
@@ -0,0 +1,101 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef NETCTRL_UTIL_SHARED_CHUNKS_H
+#define NETCTRL_UTIL_SHARED_CHUNKS_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace netctrl {
+
+/**
+ * \brief Immutable array stored in fixed-size chunks that consecutive
+ *        versions of the array can share.
+ *
+ * \c assign() fills the array from a plain one. A chunk whose contents are
+ * the same as the chunk at the same position of a previous version is not
+ * copied; the new version refers to the chunk of the previous one instead.
+ * Versions that differ in a few places thus share most of their memory,
+ * and building a new version costs a comparison instead of an allocation
+ * and a copy for each unchanged chunk. The chunks are never modified once
+ * built, so a version can be read from any number of threads while the
+ * next one is being built.
+ */
+template <typename T>
+class SharedChunks {
+public:
+    /// The number of elements in a chunk
+    enum { CHUNK_SIZE = 4096 };
+
+private:
+    /// The chunks of the array; all but the last one are full
+    std::vector<std::shared_ptr<const std::vector<T> > > m_chunks;
+
+    /// The number of elements in the array
+    long int m_size;
+
+public:
+    /// Constructs an empty array
+    SharedChunks() : m_chunks(), m_size(0) {}
+
+    /**
+     * \brief Replaces the contents of the array.
+     *
+     * \param  data      the new elements
+     * \param  size      the number of new elements
+     * \param  previous  an earlier version whose equal chunks are shared
+     *                   instead of being copied; may be null or the array
+     *                   itself
+     * \return the number of chunks shared with \c previous
+     */
+    long int assign(const T* data, long int size, const SharedChunks* previous = 0) {
+        std::vector<std::shared_ptr<const std::vector<T> > > chunks;
+        long int i, begin, end, shared = 0;
+        long int numChunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        chunks.reserve(numChunks);
+        for (i = 0; i < numChunks; i++) {
+            begin = i * CHUNK_SIZE;
+            end = std::min<long int>(size, begin + CHUNK_SIZE);
+            if (previous != 0 && i < static_cast<long int>(previous->m_chunks.size())) {
+                const std::vector<T>& chunk = *previous->m_chunks[i];
+                if (static_cast<long int>(chunk.size()) == end - begin &&
+                        std::equal(data + begin, data + end, chunk.begin())) {
+                    chunks.push_back(previous->m_chunks[i]);
+                    shared++;
+                    continue;
+                }
+            }
+            chunks.push_back(std::make_shared<const std::vector<T> >(data + begin, data + end));
+        }
+
+        m_chunks.swap(chunks);
+        m_size = size;
+        return shared;
+    }
+
+    /// Replaces the contents of the array with those of a vector
+    long int assign(const std::vector<T>& data, const SharedChunks* previous = 0) {
+        return assign(data.empty() ? 0 : &data[0], data.size(), previous);
+    }
+
+    /// Returns whether the array is empty
+    bool empty() const {
+        return m_size == 0;
+    }
+
+    /// Returns the number of elements in the array
+    long int size() const {
+        return m_size;
+    }
+
+    /// Returns the element at the given index
+    const T& operator[](long int i) const {
+        return (*m_chunks[i / CHUNK_SIZE])[i % CHUNK_SIZE];
+    }
+};
+
+}       // end of namespace
+
+#endif  // NETCTRL_UTIL_SHARED_CHUNKS_H
@@ -0,0 +1,98 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <map>
+#include <stdexcept>
+#include <igraph/cpp/edge.h>
+#include <netctrl/model/control_energy.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+using namespace igraph;
+
+namespace {
+
+/// Converts an attribute value to a real number
+double attributeToReal(const any& value) {
+    if (value.type() == typeid(double))
+        return value.as<double>();
+    if (value.type() == typeid(float))
+        return value.as<float>();
+    if (value.type() == typeid(long int))
+        return value.as<long int>();
+    if (value.type() == typeid(int))
+        return value.as<int>();
+    if (value.type() == typeid(bool))
+        return value.as<bool>() ? 1.0 : 0.0;
+    throw std::runtime_error("edge weights must be numeric");
+}
+
+}          // end of anonymous namespace
+
+bool weightedAdjacencyMatrix(Graph& graph, SparseMatrix& matrix) {
+    long int i, k, n = graph.vcount(), m = graph.ecount();
+    AdjacencyView adjacency(graph.c_graph());
+    std::vector<std::map<long int, double> > rows(n);
+    std::map<long int, double>::const_iterator it;
+    bool directed = graph.isDirected();
+
+    // A[v][u] is the total weight of the edges from u to v
+    for (i = 0; i < m; i++) {
+        long int u = adjacency.edgeSource(i), v = adjacency.edgeTarget(i);
+        double weight = attributeToReal(graph.edge(i).getAttribute("weight", 1.0));
+
+        rows[v][u] += weight;
+        if (!directed && u != v)
+            rows[u][v] += weight;
+    }
+
+    matrix.size = n;
+    matrix.offsets.assign(1, 0);
+    matrix.columns.clear();
+    matrix.values.clear();
+    for (i = 0; i < n; i++) {
+        for (it = rows[i].begin(); it != rows[i].end(); ++it) {
+            if (it->second != 0) {
+                matrix.columns.push_back(it->first);
+                matrix.values.push_back(it->second);
+            }
+        }
+        matrix.offsets.push_back(matrix.columns.size());
+    }
+
+    if (!directed)
+        return true;
+
+    // A directed graph may still have a symmetric weight matrix
+    for (i = 0; i < n; i++) {
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++) {
+            it = rows[matrix.columns[k]].find(i);
+            if (it == rows[matrix.columns[k]].end() || it->second != matrix.values[k])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+void estimateControlEnergy(const ControllabilityModel& model, GramianEstimate& result,
+        const GramianOptions& options) {
+    if (model.graph() == 0)
+        throw std::runtime_error("the model must have a graph");
+
+    SparseMatrix matrix;
+    {
+        ScopedPhase phase("energy.matrix");
+        weightedAdjacencyMatrix(*model.graph(), matrix);
+    }
+
+    igraph::VectorInt driverNodes = model.driverNodes();
+    std::vector<long int> drivers(driverNodes.begin(), driverNodes.end());
+    {
+        ScopedPhase phase("energy.gramian");
+        estimateGramian(matrix, drivers, result, options);
+    }
+}
+
+}          // end of namespace
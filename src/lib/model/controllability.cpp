@@ -1,9 +1,19 @@
 /* vim:set ts=4 sw=4 sts=4 et: */
 
+#include <stdexcept>
 #include <netctrl/model/controllability.h>
 
 namespace netctrl {
 
+long int ControllabilityModel::updateEdges(const EdgeUpdates& updates) {
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    long int ignored = applyEdgeUpdates(*m_pGraph, updates);
+    calculate();
+    return ignored;
+}
+
 igraph::VectorInt ControllabilityModel::changesInDriverNodesAfterEdgeRemoval() const {
     return igraph::VectorInt();
 }
@@ -12,6 +22,20 @@ std::vector<EdgeClass> ControllabilityModel::edgeClasses() const {
     return std::vector<EdgeClass>();
 }
 
+std::vector<long int> ControllabilityModel::edgeClassCounts() const {
+    std::vector<EdgeClass> classes = edgeClasses();
+    std::vector<EdgeClass>::const_iterator it;
+    std::vector<long int> result;
+
+    if (classes.empty() && m_pGraph != 0 && m_pGraph->ecount() > 0)
+        return result;
+
+    result.resize(EDGE_DISTINGUISHED + 1, 0);
+    for (it = classes.begin(); it != classes.end(); ++it)
+        result[*it]++;
+    return result;
+}
+
 std::string edgeClassToString(EdgeClass klass) {
     switch (klass) {
         case EDGE_ORDINARY:
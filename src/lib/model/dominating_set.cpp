@@ -0,0 +1,68 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <stdexcept>
+#include <igraph/cpp/graph.h>
+#include <netctrl/kernel/dominating_set.h>
+#include <netctrl/model/dominating_set.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+using namespace igraph;
+
+void DominatingSetControllabilityModel::calculate() {
+    // Check if we have a graph
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    AdjacencyView adjacency(m_pGraph->c_graph());
+    std::vector<long int> members;
+    std::vector<long int>::const_iterator it;
+
+    {
+        ScopedPhase phase("dominating.greedy");
+        greedyDominatingSet(adjacency, members);
+    }
+
+    {
+        ScopedPhase phase("dominating.local_search");
+        improveDominatingSet(adjacency, members, m_timeBudget, m_seed);
+    }
+
+    m_driverNodes.clear();
+    for (it = members.begin(); it != members.end(); ++it)
+        m_driverNodes.push_back(*it);
+
+    // Cleanup: if there is no driver node, we must provide at least one
+    if (m_driverNodes.empty()) {
+        m_driverNodes.push_back(0);
+    }
+}
+
+ControllabilityModel* DominatingSetControllabilityModel::clone() {
+    DominatingSetControllabilityModel* result =
+        new DominatingSetControllabilityModel(m_pGraph);
+    result->setTimeBudget(m_timeBudget);
+    result->setSeed(m_seed);
+    return result;
+}
+
+float DominatingSetControllabilityModel::controllability() const {
+    return m_driverNodes.size() / static_cast<float>(m_pGraph->vcount());
+}
+
+std::vector<ControlPath*> DominatingSetControllabilityModel::controlPaths() const {
+    return std::vector<ControlPath*>();
+}
+
+igraph::VectorInt DominatingSetControllabilityModel::driverNodes() const {
+    return m_driverNodes;
+}
+
+void DominatingSetControllabilityModel::setGraph(igraph::Graph* graph) {
+    ControllabilityModel::setGraph(graph);
+    m_driverNodes.clear();
+}
+
+}          // end of namespace
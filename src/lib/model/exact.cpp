@@ -0,0 +1,373 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <igraph.h>
+#include <igraph/cpp/graph.h>
+#include <netctrl/kernel/matching.h>
+#include <netctrl/model/control_energy.h>
+#include <netctrl/model/exact.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/parallel.h>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+using namespace igraph;
+
+namespace {
+
+/// Candidate eigenvalue in the exact controllability model
+struct Candidate {
+    /// Representative value of a cluster of computed eigenvalues
+    std::complex<double> value;
+
+    /// Number of computed eigenvalues in the cluster
+    long int algebraicMultiplicity;
+
+    /// Geometric multiplicity, or -1 if it was not calculated
+    long int geometricMultiplicity;
+
+    /// The computed eigenvalues in the cluster
+    std::vector<std::complex<double> > members;
+
+    Candidate(std::complex<double> value_, long int algebraic)
+        : value(value_), algebraicMultiplicity(algebraic), geometricMultiplicity(-1),
+        members() {}
+};
+
+/// Orders candidates by decreasing algebraic multiplicity, then by value
+bool operator<(const Candidate& a, const Candidate& b) {
+    if (a.algebraicMultiplicity != b.algebraicMultiplicity)
+        return a.algebraicMultiplicity > b.algebraicMultiplicity;
+    if (a.value.real() != b.value.real())
+        return a.value.real() < b.value.real();
+    return a.value.imag() < b.value.imag();
+}
+
+/// Orders complex numbers by their real parts, then by their imaginary parts
+bool complexLess(const std::complex<double>& a, const std::complex<double>& b) {
+    if (a.real() != b.real())
+        return a.real() < b.real();
+    return a.imag() < b.imag();
+}
+
+/// Owns an igraph matrix for the duration of a scope
+struct ScopedMatrix {
+    igraph_matrix_t matrix;
+
+    ScopedMatrix(long int rows, long int columns) {
+        if (igraph_matrix_init(&matrix, rows, columns))
+            throw std::runtime_error("cannot allocate dense matrix");
+    }
+
+    ~ScopedMatrix() {
+        igraph_matrix_destroy(&matrix);
+    }
+};
+
+/// Owns an igraph vector for the duration of a scope
+struct ScopedVector {
+    igraph_vector_t vector;
+
+    explicit ScopedVector(long int size) {
+        if (igraph_vector_init(&vector, size))
+            throw std::runtime_error("cannot allocate vector");
+    }
+
+    ~ScopedVector() {
+        igraph_vector_destroy(&vector);
+    }
+};
+
+/// Calculates all the eigenvalues of a sparse matrix using dense LAPACK routines
+void calculateEigenvalues(const SparseMatrix& matrix, bool symmetric,
+        std::vector<std::complex<double> >& eigenvalues) {
+    long int i, k, n = matrix.size;
+    ScopedMatrix dense(n, n);
+
+    for (i = 0; i < n; i++) {
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++)
+            MATRIX(dense.matrix, i, matrix.columns[k]) = matrix.values[k];
+    }
+
+    eigenvalues.clear();
+    if (symmetric) {
+        ScopedVector values(0);
+        if (igraph_lapack_dsyevr(&dense.matrix, IGRAPH_LAPACK_DSYEV_ALL, 0, 0, 0,
+                    0, 0, 0, &values.vector, 0, 0))
+            throw std::runtime_error("cannot calculate the eigenvalues of the adjacency matrix");
+        for (i = 0; i < igraph_vector_size(&values.vector); i++)
+            eigenvalues.push_back(VECTOR(values.vector)[i]);
+    } else {
+        ScopedVector realParts(0), imaginaryParts(0);
+        int info = 0;
+        if (igraph_lapack_dgeev(&dense.matrix, &realParts.vector, &imaginaryParts.vector,
+                    0, 0, &info) || info != 0)
+            throw std::runtime_error("cannot calculate the eigenvalues of the adjacency matrix");
+        for (i = 0; i < igraph_vector_size(&realParts.vector); i++) {
+            eigenvalues.push_back(std::complex<double>(
+                        VECTOR(realParts.vector)[i], VECTOR(imaginaryParts.vector)[i]));
+        }
+    }
+}
+
+/// Finds the root of an element in a union-find forest
+long int findRoot(std::vector<long int>& parent, long int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/// Groups numerically close eigenvalues into candidates
+void clusterEigenvalues(std::vector<std::complex<double> >& eigenvalues,
+        double tolerance, std::vector<Candidate>& candidates) {
+    long int i, j, n = eigenvalues.size();
+    std::vector<long int> parent(n);
+    std::map<long int, std::vector<std::complex<double> > > clusters;
+    std::map<long int, std::vector<std::complex<double> > >::const_iterator it;
+
+    // Sweep along the real axis and merge eigenvalues closer than the
+    // tolerance to each other
+    std::sort(eigenvalues.begin(), eigenvalues.end(), complexLess);
+    for (i = 0; i < n; i++)
+        parent[i] = i;
+    for (i = 0; i < n; i++) {
+        for (j = i + 1; j < n && eigenvalues[j].real() - eigenvalues[i].real() <= tolerance; j++) {
+            if (std::abs(eigenvalues[j] - eigenvalues[i]) <= tolerance)
+                parent[findRoot(parent, j)] = findRoot(parent, i);
+        }
+    }
+
+    for (i = 0; i < n; i++)
+        clusters[findRoot(parent, i)].push_back(eigenvalues[i]);
+
+    // The mean of a cluster is a good estimate of a multiple eigenvalue even
+    // if it is defective, since the perturbed eigenvalues of a Jordan block
+    // are spread evenly around the true one
+    candidates.clear();
+    for (it = clusters.begin(); it != clusters.end(); ++it) {
+        std::complex<double> sum = 0.0;
+        for (size_t j = 0; j < it->second.size(); j++)
+            sum += it->second[j];
+        candidates.push_back(Candidate(sum / static_cast<double>(it->second.size()),
+                    it->second.size()));
+        candidates.back().members = it->second;
+    }
+}
+
+/// Calculates the geometric multiplicity of a candidate eigenvalue
+/**
+ * Real arithmetic is used if the imaginary part of the candidate is within
+ * the clustering tolerance.
+ */
+long int geometricMultiplicity(const SparseMatrix& matrix, std::complex<double>& value,
+        double clusterTolerance, double tolerance, std::vector<long int>* dependent = 0) {
+    if (std::fabs(value.imag()) <= clusterTolerance) {
+        value = value.real();
+        return rankDeficiency(matrix, value.real(), tolerance, dependent);
+    }
+    return rankDeficiency(matrix, value, tolerance, dependent);
+}
+
+/// Calculates the geometric multiplicity of a candidate
+/**
+ * If the candidate turns out not to be an eigenvalue, it may be a loose
+ * cluster of distinct eigenvalues; in this case its members are clustered
+ * again with the tight tolerance and the subclusters that may still beat
+ * the given lower bound are tried one by one. The value of the candidate is
+ * updated to the best subcluster.
+ */
+void evaluateCandidate(const SparseMatrix& matrix, Candidate& candidate,
+        double clusterTolerance, double tolerance, long int lowerBound) {
+    std::vector<Candidate> parts;
+    std::vector<std::complex<double> > members;
+    long int multiplicity;
+    size_t i;
+
+    candidate.geometricMultiplicity = geometricMultiplicity(matrix, candidate.value,
+            clusterTolerance, tolerance);
+    if (candidate.geometricMultiplicity > 0 || candidate.members.size() <= 1 ||
+            clusterTolerance <= tolerance)
+        return;
+
+    members = candidate.members;
+    clusterEigenvalues(members, tolerance, parts);
+    for (i = 0; i < parts.size(); i++) {
+        if (parts[i].algebraicMultiplicity < lowerBound ||
+                parts[i].algebraicMultiplicity <= candidate.geometricMultiplicity)
+            continue;
+        multiplicity = geometricMultiplicity(matrix, parts[i].value, tolerance, tolerance);
+        if (multiplicity > candidate.geometricMultiplicity) {
+            candidate.geometricMultiplicity = multiplicity;
+            candidate.value = parts[i].value;
+        }
+    }
+}
+
+}          // end of anonymous namespace
+
+void ExactControllabilityModel::calculate() {
+    // Check if we have a graph
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    long int i, n = m_pGraph->vcount(), k, lowerBound;
+    SparseMatrix matrix;
+    std::vector<std::complex<double> > eigenvalues;
+    std::vector<Candidate> candidates;
+    std::vector<long int> dependentRows;
+    double scale = 0.0, tolerance, clusterTolerance;
+    bool symmetric;
+
+    m_driverNodes.clear();
+    m_criticalEigenvalue = 0.0;
+    if (n == 0)
+        return;
+
+    {
+        ScopedPhase phase("exact.matrix");
+        symmetric = constructMatrix(matrix);
+    }
+
+    // Use the largest absolute row sum (an upper bound for the spectral
+    // radius) to make the tolerances relative
+    for (i = 0; i < n; i++) {
+        double rowSum = 0.0;
+        for (k = matrix.offsets[i]; k < matrix.offsets[i+1]; k++)
+            rowSum += std::fabs(matrix.values[k]);
+        scale = std::max(scale, rowSum);
+    }
+    tolerance = m_tolerance * std::max(scale, 1.0);
+
+    // Eigenvalues of non-normal matrices with nontrivial Jordan blocks are
+    // perturbed much more than the tolerance, so they are clustered more
+    // loosely. Clusters that merge distinct eigenvalues by accident are
+    // split again in evaluateCandidate().
+    clusterTolerance = symmetric ? tolerance : std::sqrt(m_tolerance) * std::max(scale, 1.0);
+
+    // Structural lower bound for the multiplicity of the zero eigenvalue
+    {
+        ScopedPhase phase("exact.matching");
+        DirectedMatching matching;
+        lowerBound = n - maximumMatching(AdjacencyView(m_pGraph->c_graph()), matching);
+    }
+
+    {
+        ScopedPhase phase("exact.eigenvalues");
+        calculateEigenvalues(matrix, symmetric, eigenvalues);
+        clusterEigenvalues(eigenvalues, clusterTolerance, candidates);
+    }
+
+    // Make sure that the zero eigenvalue is a candidate with the structural
+    // lower bound if it is known to be an eigenvalue. Eigenvalues with
+    // negative imaginary parts are skipped since their conjugates have the
+    // same multiplicity.
+    bool hasZero = false;
+    for (i = 0; i < static_cast<long int>(candidates.size()); i++) {
+        if (std::abs(candidates[i].value) <= clusterTolerance) {
+            candidates[i].algebraicMultiplicity =
+                std::max(candidates[i].algebraicMultiplicity, lowerBound);
+            hasZero = true;
+        }
+    }
+    if (!hasZero && lowerBound > 0)
+        candidates.push_back(Candidate(0.0, lowerBound));
+    for (i = 0; i < static_cast<long int>(candidates.size()); i++) {
+        if (candidates[i].value.imag() < -clusterTolerance) {
+            candidates[i] = candidates.back();
+            candidates.pop_back();
+            i--;
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Calculate the geometric multiplicities. Candidates whose algebraic
+    // multiplicity is smaller than the best geometric multiplicity so far
+    // are skipped; ties are not, so the result does not depend on the order
+    // in which the threads finish. The worker threads record the
+    // exact.ranks phase under their own thread indices, so the profile
+    // covers the whole cost of the ranks, not only the calling thread.
+    if (symmetric) {
+        for (i = 0; i < static_cast<long int>(candidates.size()); i++)
+            candidates[i].geometricMultiplicity = candidates[i].algebraicMultiplicity;
+    } else {
+        ScopedPhase phase("exact.ranks");
+        std::atomic<long int> best(lowerBound);
+
+        parallelFor(0, candidates.size(), [&](long int index) {
+            Candidate& candidate = candidates[index];
+            long int multiplicity, current = best;
+
+            if (candidate.algebraicMultiplicity < current)
+                return;
+
+            evaluateCandidate(matrix, candidate, clusterTolerance, tolerance, current);
+
+            multiplicity = candidate.geometricMultiplicity;
+            while (multiplicity > current && !best.compare_exchange_weak(current, multiplicity))
+                ;
+        });
+    }
+
+    // Select the eigenvalue with the largest geometric multiplicity
+    long int bestIndex = -1;
+    for (i = 0; i < static_cast<long int>(candidates.size()); i++) {
+        if (bestIndex < 0 || candidates[i].geometricMultiplicity >
+                candidates[bestIndex].geometricMultiplicity)
+            bestIndex = i;
+    }
+    if (bestIndex >= 0)
+        m_criticalEigenvalue = candidates[bestIndex].value;
+
+    // Find the driver nodes: the rows of lambda*I - A that depend linearly
+    // on the other rows
+    {
+        ScopedPhase phase("exact.driver_nodes");
+        geometricMultiplicity(matrix, m_criticalEigenvalue, clusterTolerance,
+                tolerance, &dependentRows);
+    }
+
+    for (i = 0; i < static_cast<long int>(dependentRows.size()); i++)
+        m_driverNodes.push_back(dependentRows[i]);
+
+    // Cleanup: if there is no driver node, we must provide at least one
+    if (m_driverNodes.empty()) {
+        m_driverNodes.push_back(0);
+    }
+}
+
+ControllabilityModel* ExactControllabilityModel::clone() {
+    ExactControllabilityModel* result = new ExactControllabilityModel(m_pGraph);
+    result->setTolerance(m_tolerance);
+    return result;
+}
+
+bool ExactControllabilityModel::constructMatrix(SparseMatrix& matrix) const {
+    return weightedAdjacencyMatrix(*m_pGraph, matrix);
+}
+
+float ExactControllabilityModel::controllability() const {
+    return m_driverNodes.size() / static_cast<float>(m_pGraph->vcount());
+}
+
+std::vector<ControlPath*> ExactControllabilityModel::controlPaths() const {
+    return std::vector<ControlPath*>();
+}
+
+igraph::VectorInt ExactControllabilityModel::driverNodes() const {
+    return m_driverNodes;
+}
+
+void ExactControllabilityModel::setGraph(igraph::Graph* graph) {
+    ControllabilityModel::setGraph(graph);
+    m_driverNodes.clear();
+    m_criticalEigenvalue = 0.0;
+}
+
+}          // end of namespace
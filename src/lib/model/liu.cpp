@@ -1,21 +1,34 @@
 /* vim:set ts=4 sw=4 sts=4 et: */
 
-#include <algorithm>
-#include <deque>
 #include <sstream>
-#include <igraph/cpp/edge_iterator.h>
+#include <stdexcept>
 #include <igraph/cpp/graph.h>
-#include <igraph/cpp/matching.h>
 #include <igraph/cpp/vector_bool.h>
 #include <igraph/cpp/vector_int.h>
-#include <igraph/cpp/analysis/components.h>
-#include <igraph/cpp/analysis/non_simple.h>
+#include <netctrl/kernel/edge_classes.h>
+#include <netctrl/kernel/matching.h>
 #include <netctrl/model/liu.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/profiler.h>
 
 namespace netctrl {
 
 using namespace igraph;
 
+namespace {
+
+/// Returns whether there is an edge from u to v in the graph
+bool hasEdge(const AdjacencyView& graph, long int u, long int v) {
+    long int i, k = graph.outDegree(u);
+    for (i = 0; i < k; i++) {
+        if (graph.outNeighbor(u, i) == v)
+            return true;
+    }
+    return false;
+}
+
+}          // end of anonymous namespace
+
 LiuControllabilityModel::~LiuControllabilityModel() {
     clearControlPaths();
 }
@@ -25,29 +38,125 @@ void LiuControllabilityModel::calculate() {
     if (m_pGraph == 0)
         throw std::runtime_error("m_pGraph must not be null");
 
-    // Construct the bipartite graph on which we are going to work
-    Graph bipartiteGraph = this->constructBipartiteGraph(false);
+    long int n = m_pGraph->vcount();
+    AdjacencyView adjacency(m_pGraph->c_graph());
 
-    // Construct the type vector
-    long int i = 0, n = m_pGraph->vcount(), u;
-    VectorBool types(2 * n);
-    for (i = 0; i < n; i++) {
-        types[i] = 1;
+    m_edgeClassTracker.invalidate();
+    m_edgeClassChanges.clear();
+
+    // Calculate the maximum matching
+    {
+        ScopedPhase phase("liu.matching");
+        if (m_warmStartMatching.size() == n && n > 0) {
+            MatchingEngine<AdjacencyView> engine;
+            m_matching = m_warmStartMatching;
+            engine.repair(adjacency, m_matching, m_warmStartChanges);
+        } else {
+            m_matching = DirectedMatching();
+            maximumMatching(adjacency, m_matching);
+        }
     }
-    // Calculate the maximum bipartite matching
-    VectorInt matching;
-    maximum_bipartite_matching(bipartiteGraph, types, 0, 0, &matching, 0, 0);
-    for (i = 0; i < n; i++) {
-        if (matching[i] != -1)
-            matching[i] -= n;
+
+    calculateControlPaths();
+}
+
+long int LiuControllabilityModel::updateEdges(const EdgeUpdates& updates) {
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    long int i, j, u, v, n = m_pGraph->vcount(), ignored;
+    std::vector<long int> sources, targets, flipped;
+    std::vector<long int>::const_iterator it;
+
+    // The warm start matching may use the deleted edges
+    m_warmStartMatching = DirectedMatching();
+    m_warmStartChanges.clear();
+
+    // Without a maximum matching, there is nothing to repair
+    if (m_matching.size() != n || n == 0)
+        return ControllabilityModel::updateEdges(updates);
+
+    {
+        ScopedPhase phase("liu.update_graph");
+        ignored = applyEdgeUpdates(*m_pGraph, updates);
     }
-    m_matching = DirectedMatching(matching, DirectedMatching::DIRECTION_IN_OUT);
 
-    // Create the list of driver nodes
+    AdjacencyView adjacency(m_pGraph->c_graph());
+    long int numDirections = adjacency.isDirected() ? 1 : 2;
+
+    {
+        ScopedPhase phase("liu.matching");
+
+        // Free the pairs whose last edge was deleted. In undirected graphs,
+        // an edge may be matched in either direction.
+        for (i = 0; i + 1 < static_cast<long int>(updates.deletions.size()); i += 2) {
+            for (j = 0; j < numDirections; j++) {
+                u = updates.deletions[i + j];
+                v = updates.deletions[i + 1 - j];
+                if (m_matching.matchOut(u) == v && !hasEdge(adjacency, u, v)) {
+                    m_matching.unmatch(u, v);
+                    sources.push_back(u);
+                    targets.push_back(v);
+                }
+            }
+        }
+
+        // New augmenting paths may also pass through the inserted edges
+        for (i = 0; i + 1 < static_cast<long int>(updates.insertions.size()); i += 2) {
+            for (j = 0; j < numDirections; j++)
+                sources.push_back(updates.insertions[i + j]);
+        }
+
+        m_matchingEngine.repairAround(adjacency, m_matching, sources, targets,
+                m_edgeClassTracker.valid() ? &flipped : 0);
+    }
+
+    // Record the nodes of the alternating graph whose edges or pairs were
+    // changed, unless they would cover most of the graph anyway
+    if (m_edgeClassTracker.valid()) {
+        const std::vector<long int>* lists[] = { &updates.deletions, &updates.insertions };
+        for (i = 0; i < 2; i++) {
+            for (j = 0; j + 1 < static_cast<long int>(lists[i]->size()); j += 2) {
+                u = (*lists[i])[j];
+                v = (*lists[i])[j + 1];
+                m_edgeClassChanges.push_back(u + n);
+                m_edgeClassChanges.push_back(v);
+                if (numDirections == 2) {
+                    m_edgeClassChanges.push_back(v + n);
+                    m_edgeClassChanges.push_back(u);
+                }
+            }
+        }
+        for (it = flipped.begin(); it != flipped.end(); ++it) {
+            m_edgeClassChanges.push_back(*it + n);
+            m_edgeClassChanges.push_back(m_matching.matchOut(*it));
+        }
+        if (static_cast<long int>(m_edgeClassChanges.size()) > n) {
+            m_edgeClassTracker.invalidate();
+            m_edgeClassChanges.clear();
+        }
+    }
+
+    calculateControlPaths();
+    return ignored;
+}
+
+void LiuControllabilityModel::calculateControlPaths() {
+    ScopedPhase phase("liu.control_paths");
+    long int i, n = m_pGraph->vcount(), u, numSources = 0, numSinks = 0;
+    AdjacencyView adjacency(m_pGraph->c_graph());
+
+    // Create the list of driver nodes and count the sources and the sinks
+    // for the control profile. Sources are never matched.
     m_driverNodes.clear();
     for (i = 0; i < n; i++) {
-        if (!m_matching.isMatched(i))
+        if (!m_matching.isMatched(i)) {
             m_driverNodes.push_back(i);
+            if (adjacency.inDegree(i) == 0)
+                numSources++;
+        }
+        if (adjacency.outDegree(i) == 0)
+            numSinks++;
     }
 
     // Clear the list of control paths
@@ -90,10 +199,11 @@ void LiuControllabilityModel::calculate() {
         // Check whether we can attach the bud to a stem
         for (VectorInt::const_iterator it = bud->nodes().begin(), end = bud->nodes().end();
                 it != end && bud->stem() == 0; it++) {
-            VectorInt neis = m_pGraph->neighbors(*it, IGRAPH_IN);
-            for (VectorInt::const_iterator it2 = neis.begin(); it2 != neis.end(); it2++) {
-                if (verticesToStems[*it2] != 0) {
-                    bud->setStem(verticesToStems[*it2]);
+            long int j, degree = adjacency.inDegree(*it);
+            for (j = 0; j < degree; j++) {
+                Stem* stem = verticesToStems[adjacency.inNeighbor(*it, j)];
+                if (stem != 0) {
+                    bud->setStem(stem);
                     break;
                 }
             }
@@ -106,6 +216,8 @@ void LiuControllabilityModel::calculate() {
     if (m_driverNodes.empty()) {
         m_driverNodes.push_back(0);
     }
+
+    m_controlProfile = ControlProfile(numSources, numSinks, m_driverNodes.size());
 }
 
 void LiuControllabilityModel::clearControlPaths() {
@@ -113,6 +225,7 @@ void LiuControllabilityModel::clearControlPaths() {
             it != m_controlPaths.end(); it++) {
         delete *it;
     }
+    m_controlPaths.clear();
 }
 
 ControllabilityModel* LiuControllabilityModel::clone() {
@@ -120,52 +233,6 @@ ControllabilityModel* LiuControllabilityModel::clone() {
     return result;
 }
 
-Graph LiuControllabilityModel::constructBipartiteGraph(bool directed) const {
-    long int i, n = m_pGraph->vcount(), m = m_pGraph->ecount() * 2, u, v;
-    Graph bipartiteGraph(2*n, directed);
-
-    VectorInt edges = m_pGraph->getEdgelist();
-
-    if (directed) {
-        for (i = 0; i < m; i += 2) {
-            u = edges[i]; v = edges[i+1];
-            if (m_matching.matchOut(u) == v) {
-                edges[i] = v;
-                edges[i+1] = u+n;
-            } else {
-                edges[i] = u+n;
-            }
-        }
-    } else {
-        for (i = 0; i < m; i += 2) {
-            edges[i] += n;
-        }
-    }
-    bipartiteGraph.addEdges(edges);
-
-    if (!m_pGraph->isDirected()) {
-        if (directed) {
-            for (i = 0; i < m; i += 2) {
-                if (edges[i] >= n) {
-                    edges[i] -= n;
-                    edges[i+1] += n;
-                } else {
-                    edges[i] += n;
-                    edges[i+1] -= n;
-                }
-            }
-        } else {
-            for (i = 0; i < m; i += 2) {
-                edges[i] -= n;
-                edges[i+1] += n;
-            }
-        }
-        bipartiteGraph.addEdges(edges);
-    }
-
-    return bipartiteGraph;
-}
-
 float LiuControllabilityModel::controllability() const {
     return m_driverNodes.size() / static_cast<float>(m_pGraph->vcount());
 }
@@ -179,109 +246,30 @@ igraph::VectorInt LiuControllabilityModel::driverNodes() const {
 }
 
 std::vector<EdgeClass> LiuControllabilityModel::edgeClasses() const {
-    integer_t from, to, i, n = m_pGraph->vcount(), m = m_pGraph->ecount();
-    std::vector<EdgeClass> result(m);
-    std::deque<long int> queue;
-
-    // The algorithm implemented here is adapted from Algorithm 2 of the
-    // following publication:
-    //
-    // Regin JC: A filtering algorithm for constraints of difference in CSPs.
-    // In: AAAI '94 Proceedings of the 12th national conference on Artificial
-    // intelligence (vol. 1), pp. 362-367, 1994.
-
-    // (1) Initially, all the edges are REDUNDANT
-    std::fill(result.begin(), result.end(), EDGE_REDUNDANT);
-
-    // (2) Construct the directed bipartite graph where matched edges are
-    //     directed from top to bottom and unmatched edges are directed
-    //     from bottom to top
-    Graph bipartiteGraph = this->constructBipartiteGraph(true);
-
-    // (3a) Start a backward BFS from unmatched nodes, mark all traversed edges
-    // as ORDINARY
-    VectorBool seen(2*n);
-    for (from = 0; from < n; from++) {
-        if (!m_matching.isMatched(from)) {
-            queue.push_back(from);
-            seen[from] = true;
-        }
-        if (!m_matching.isMatching(from)) {
-            queue.push_back(from+n);
-            seen[from+n] = true;
-        }
-    }
-    while (!queue.empty()) {
-        to = queue.front(); queue.pop_front();
-
-        igraph::VectorInt edges = bipartiteGraph.incident(to, IGRAPH_IN);
-        for (igraph::VectorInt::const_iterator it = edges.begin(); it != edges.end(); ++it) {
-            long int eid = *it;
-            if (eid >= m)    // needed for undirected graphs only
-                eid -= m;
-            result[eid] = EDGE_ORDINARY;
-            bipartiteGraph.edge(*it, &from, &to);
-            if (!seen[from]) {
-                seen[from] = true;
-                queue.push_back(from);
-            }
-        }
-    }
-    // (3b) Start a forward BFS
-    seen.fill(false);
-    for (from = 0; from < n; from++) {
-        if (!m_matching.isMatched(from)) {
-            queue.push_back(from);
-            seen[from] = true;
-        }
-        if (!m_matching.isMatching(from)) {
-            queue.push_back(from+n);
-            seen[from+n] = true;
-        }
-    }
-    while (!queue.empty()) {
-        from = queue.front(); queue.pop_front();
-
-        igraph::VectorInt edges = bipartiteGraph.incident(from, IGRAPH_OUT);
-        for (igraph::VectorInt::const_iterator it = edges.begin(); it != edges.end(); ++it) {
-            long int eid = *it;
-            if (eid >= m)    // needed for undirected graphs only
-                eid -= m;
-            result[eid] = EDGE_ORDINARY;
-            bipartiteGraph.edge(*it, &from, &to);
-            if (!seen[to]) {
-                seen[to] = true;
-                queue.push_back(to);
-            }
-        }
-    }
-
-    // (4) Compute the strongly connected components of the bipartite
-    //     directed graph, mark all edges inside the same component
-    //     as ORDINARY
-    VectorInt membership(2*n);
-    connected_components(bipartiteGraph, &membership, 0, 0, IGRAPH_STRONG);
-    for (i = 0; i < m; i++) {
-        bipartiteGraph.edge(i, &from, &to);
-        if (membership[from] == membership[to]) {
-            result[i] = EDGE_ORDINARY;
-        }
-    }
+    ScopedPhase phase("liu.edge_classes");
+    AdjacencyView adjacency(m_pGraph->c_graph());
+    std::vector<EdgeClass> result;
+    updateEdgeClasses(adjacency);
+    m_edgeClassTracker.classify(adjacency, m_matching, result);
+    return result;
+}
 
-    // (5) For all edges in the matching: if they are still REDUNDANT,
-    //     then they should become CRITICAL
-    for (from = 0; from < n; from++) {
-        to = m_matching.matchOut(from);
-        if (to < 0)
-            continue;
+std::vector<long int> LiuControllabilityModel::edgeClassCounts() const {
+    ScopedPhase phase("liu.edge_classes");
+    AdjacencyView adjacency(m_pGraph->c_graph());
+    std::vector<long int> result(EDGE_DISTINGUISHED + 1);
+    updateEdgeClasses(adjacency);
+    m_edgeClassTracker.count(adjacency, m_matching, &result[0]);
+    return result;
+}
 
-        i = m_pGraph->getEid(from, to);
-        if (result[i] == EDGE_REDUNDANT) {
-            result[i] = EDGE_CRITICAL;
-        }
+void LiuControllabilityModel::updateEdgeClasses(const AdjacencyView& adjacency) const {
+    if (m_edgeClassTracker.valid()) {
+        m_edgeClassTracker.update(adjacency, m_matching, m_edgeClassChanges);
+    } else {
+        m_edgeClassTracker.reset(adjacency, m_matching);
     }
-
-    return result;
+    m_edgeClassChanges.clear();
 }
 
 const DirectedMatching* LiuControllabilityModel::matching() const {
@@ -289,15 +277,29 @@ const DirectedMatching* LiuControllabilityModel::matching() const {
 }
 
 DirectedMatching* LiuControllabilityModel::matching() {
+    // The caller may change the matching behind the back of the tracker
+    m_edgeClassTracker.invalidate();
     return &m_matching;
 }
 
 void LiuControllabilityModel::setGraph(igraph::Graph* graph) {
     ControllabilityModel::setGraph(graph);
     m_driverNodes.clear();
+    m_controlProfile = ControlProfile();
+    m_matching = DirectedMatching();
+    m_warmStartMatching = DirectedMatching();
+    m_warmStartChanges.clear();
+    m_edgeClassTracker.invalidate();
+    m_edgeClassChanges.clear();
     clearControlPaths();
 }
 
+void LiuControllabilityModel::setWarmStartMatching(const DirectedMatching& matching,
+        const std::vector<long int>& changes) {
+    m_warmStartMatching = matching;
+    m_warmStartChanges = changes;
+}
+
 
 /*************************************************************************/
 
@@ -0,0 +1,108 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <stdexcept>
+#include <netctrl/model/snapshot.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+ControllabilitySnapshot::ControllabilitySnapshot(const ControllabilityModel& model,
+        long int version, int contents, const ControllabilitySnapshot* previous)
+    : m_version(version), m_vertexCount(0),
+    m_controllability(model.controllability()), m_driverNodeCount(0),
+    m_driverNodes(), m_edges(), m_edgeClasses(), m_pathNodes(), m_pathOffsets(),
+    m_pathTypeIndices(), m_pathTypes(), m_pathTypeNeedsInput() {
+    igraph::Graph* graph = model.graph();
+    long int i, j, numPaths;
+    std::vector<long int> values, offsets, typeIndices;
+
+    if (graph == 0)
+        throw std::runtime_error("the model must have a graph");
+    m_vertexCount = graph->vcount();
+
+    igraph::VectorInt driverNodes = model.driverNodes();
+    m_driverNodeCount = driverNodes.size();
+    if (contents & SNAPSHOT_DRIVER_NODES) {
+        values.assign(driverNodes.begin(), driverNodes.end());
+        m_driverNodes.assign(values, previous ? &previous->m_driverNodes : 0);
+    }
+
+    if (contents & SNAPSHOT_EDGE_CLASSES) {
+        std::vector<EdgeClass> classes = model.edgeClasses();
+        if (!classes.empty()) {
+            AdjacencyView adjacency(graph->c_graph());
+            long int m = adjacency.edgeCount();
+
+            values.resize(2 * m);
+            for (i = 0; i < m; i++) {
+                values[2*i] = adjacency.edgeSource(i);
+                values[2*i+1] = adjacency.edgeTarget(i);
+            }
+            m_edges.assign(values, previous ? &previous->m_edges : 0);
+            m_edgeClasses.assign(classes, previous ? &previous->m_edgeClasses : 0);
+        }
+    }
+
+    if (contents & SNAPSHOT_CONTROL_PATHS) {
+        std::vector<ControlPath*> paths = model.controlPaths();
+
+        // The path types of the previous snapshot keep their indices, so
+        // the type indices of unchanged paths stay the same
+        if (previous != 0) {
+            m_pathTypes = previous->m_pathTypes;
+            m_pathTypeNeedsInput = previous->m_pathTypeNeedsInput;
+        }
+
+        numPaths = paths.size();
+        values.clear();
+        offsets.reserve(numPaths + 1);
+        typeIndices.reserve(numPaths);
+        for (i = 0; i < numPaths; i++) {
+            const igraph::VectorInt& nodes = paths[i]->nodes();
+            std::string name = paths[i]->name();
+
+            // There are only a handful of path types in each model
+            for (j = 0; j < static_cast<long int>(m_pathTypes.size()); j++) {
+                if (m_pathTypes[j] == name)
+                    break;
+            }
+            if (j == static_cast<long int>(m_pathTypes.size())) {
+                m_pathTypes.push_back(name);
+                m_pathTypeNeedsInput.push_back(paths[i]->needsInputSignal());
+            }
+
+            offsets.push_back(values.size());
+            typeIndices.push_back(j);
+            values.insert(values.end(), nodes.begin(), nodes.end());
+        }
+        offsets.push_back(values.size());
+
+        m_pathNodes.assign(values, previous ? &previous->m_pathNodes : 0);
+        m_pathOffsets.assign(offsets, previous ? &previous->m_pathOffsets : 0);
+        m_pathTypeIndices.assign(typeIndices, previous ? &previous->m_pathTypeIndices : 0);
+    }
+}
+
+SnapshotPublisher::~SnapshotPublisher() {
+    delete m_current.load();
+}
+
+long int SnapshotPublisher::publish(const ControllabilityModel& model) {
+    ScopedPhase phase("snapshot.publish");
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const ControllabilitySnapshot* previous;
+
+    // Only this thread replaces the current snapshot, so it cannot be
+    // retired while the next one shares its chunks
+    previous = m_current.exchange(new ControllabilitySnapshot(model, m_version + 1,
+                m_contents, m_current.load()));
+    m_version++;
+
+    if (previous != 0)
+        m_domain.retire(previous);
+
+    return m_version;
+}
+
+}          // end of namespace
@@ -1,17 +1,15 @@
 /* vim:set ts=4 sw=4 sts=4 et: */
 
+#include <algorithm>
 #include <cassert>
 #include <deque>
+#include <iterator>
 #include <set>
 #include <sstream>
 #include <stdexcept>
-#include <igraph/cpp/edge.h>
-#include <igraph/cpp/edge_iterator.h>
-#include <igraph/cpp/edge_selector.h>
 #include <igraph/cpp/vector_bool.h>
-#include <igraph/cpp/analysis/components.h>
-#include <igraph/cpp/generators/line_graph.h>
 #include <netctrl/model/switchboard.h>
+#include <netctrl/util/profiler.h>
 
 
 namespace netctrl {
@@ -129,58 +127,425 @@ void tryToMergeClosedWalks(std::deque<ClosedWalk*>& closedWalksToMerge,
 	closedWalksToMerge.pop_back();
 }
 
-void SwitchboardControllabilityModel::calculate() {
-    VectorInt inDegrees, outDegrees;
-	VectorInt::const_iterator it;
-    long int i, j, n = m_pGraph->vcount();
-    long int balancedCount = 0;
+namespace {
 
-#define IS_BALANCED(i) ((outDegrees[i] == inDegrees[i]) && outDegrees[i] > 0)
+/// Returns whether the given control path is a closed walk
+bool isClosedWalk(const SwitchboardControlPath* path) {
+    return dynamic_cast<const ClosedWalk*>(path) != 0;
+}
 
-    m_driverNodes.clear();
-    m_pGraph->degree(&inDegrees,  V(m_pGraph), IGRAPH_IN,  true);
-    m_pGraph->degree(&outDegrees, V(m_pGraph), IGRAPH_OUT, true);
-    
-    // Find divergent nodes, count balanced nodes
-    for (i = 0; i < n; i++) {
-        if (outDegrees[i] > inDegrees[i])
-            m_driverNodes.push_back(i);
-        else if (IS_BALANCED(i)) {
-            balancedCount++;
+/**
+ * \brief Edits the walks of the switchboard model in place after a batch
+ *        of edge updates.
+ *
+ * The edits keep the walks an edge decomposition of the graph where open
+ * walks start at divergent nodes and end at convergent ones, as many of
+ * them at each node as its degree surplus, and where each closed walk
+ * shares no node with any other walk. The walks through each node are
+ * kept in an index so the walks around an updated edge are found without
+ * looking at the others. Walks that are removed are only deleted in
+ * \c commit(), so the pointers to them stay valid while the edits are in
+ * progress.
+ */
+class ControlPathEditor {
+public:
+    /// The walks that pass through each node
+    typedef std::vector<std::vector<SwitchboardControlPath*> > PathIndex;
+
+private:
+    /// The walks of the model
+    std::vector<ControlPath*>& m_paths;
+
+    /// The walks that pass through each node
+    PathIndex& m_index;
+
+    /// The walks removed by the edits
+    std::set<ControlPath*> m_removed;
+
+    /// The closed walks that may share a node with another walk
+    std::deque<ClosedWalk*> m_closedWalks;
+
+public:
+    /// Starts editing the given walks, indexing them first if needed
+    ControlPathEditor(std::vector<ControlPath*>& paths, PathIndex& index, long int n)
+        : m_paths(paths), m_index(index), m_removed(), m_closedWalks() {
+        std::vector<ControlPath*>::const_iterator it;
+
+        if (static_cast<long int>(m_index.size()) != n) {
+            m_index.assign(n, std::vector<SwitchboardControlPath*>());
+            for (it = m_paths.begin(); it != m_paths.end(); ++it) {
+                SwitchboardControlPath* path = static_cast<SwitchboardControlPath*>(*it);
+                addToIndex(path, path->nodes());
+            }
+        }
+    }
+
+    /// Splits the walk through the edge from u to v at that edge
+    /**
+     * \return \c false if there is no such edge in any walk
+     */
+    bool removeEdge(long int u, long int v) {
+        std::vector<SwitchboardControlPath*>::const_iterator it;
+        long int i, k;
+
+        for (it = m_index[u].begin(); it != m_index[u].end(); ++it) {
+            const VectorInt& nodes = (*it)->nodes();
+            bool closed = isClosedWalk(*it);
+
+            k = nodes.size();
+            for (i = 0; i < k; i++) {
+                if (nodes[i] == u && (i + 1 < k ? nodes[i + 1] == v : closed && nodes[0] == v))
+                    break;
+            }
+            if (i < k) {
+                split(*it, i);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Adds a walk that consists of the edge from u to v
+    void addEdge(long int u, long int v) {
+        if (u == v) {
+            VectorInt nodes(1);
+            nodes[0] = u;
+            ClosedWalk* walk = new ClosedWalk(nodes);
+            add(walk);
+            m_closedWalks.push_back(walk);
+        } else {
+            VectorInt nodes(2);
+            nodes[0] = u;
+            nodes[1] = v;
+            add(new OpenWalk(nodes));
+        }
+    }
+
+    /// Joins the open walks that end at the given node with the ones that
+    /// start there until only one kind is left
+    void joinAt(long int v) {
+        std::vector<SwitchboardControlPath*>::const_iterator it;
+        SwitchboardControlPath *ending, *starting;
+
+        while (true) {
+            const std::vector<SwitchboardControlPath*>& paths = m_index[v];
+
+            ending = starting = 0;
+            for (it = paths.begin(); it != paths.end() && ending == 0; ++it) {
+                if (!isClosedWalk(*it) && (*it)->nodes().back() == v)
+                    ending = *it;
+            }
+            if (ending == 0)
+                return;
+
+            // Prefer another walk so no closed walk is made needlessly
+            for (it = paths.begin(); it != paths.end(); ++it) {
+                if (!isClosedWalk(*it) && (*it)->nodes().front() == v &&
+                        (starting == 0 || starting == ending))
+                    starting = *it;
+            }
+            if (starting == 0)
+                return;
+
+            if (starting == ending) {
+                const VectorInt& nodes = ending->nodes();
+                VectorInt walkNodes(nodes.size() - 1);
+                std::copy(nodes.begin(), nodes.end() - 1, walkNodes.begin());
+                remove(ending);
+
+                ClosedWalk* walk = new ClosedWalk(walkNodes);
+                add(walk);
+                m_closedWalks.push_back(walk);
+            } else {
+                VectorInt& nodes = ending->nodes();
+                const VectorInt& rest = starting->nodes();
+                size_t k = nodes.size();
+
+                nodes.resize(k + rest.size() - 1);
+                std::copy(rest.begin() + 1, rest.end(), nodes.begin() + k);
+                remove(starting);
+                addToIndex(ending, rest);
+            }
+        }
+    }
+
+    /// Marks the closed walks through the given node for merging
+    void queueClosedWalksAt(long int v) {
+        std::vector<SwitchboardControlPath*>::const_iterator it;
+
+        for (it = m_index[v].begin(); it != m_index[v].end(); ++it) {
+            if (isClosedWalk(*it))
+                m_closedWalks.push_back(static_cast<ClosedWalk*>(*it));
         }
     }
 
-    if (balancedCount > 0) {
-        // Find the connected components consisting of balanced nodes
-        // only.
-        VectorInt membership;
-        integer_t cluster_count;
-        connected_components(*m_pGraph, &membership, 0, &cluster_count, IGRAPH_WEAK);
-
-        VectorBool balancedCluster(cluster_count);
-        balancedCluster.fill(true);
-        for (i = 0; i < n; i++) {
-            if (!IS_BALANCED(i)) {
-                balancedCluster[(long int)membership[i]] = false;
+    /// Merges the marked closed walks into the walks they share a node with
+    /**
+     * A closed walk that grows by a merge is merged further, so the closed
+     * walks that are left share no node with any other walk, just like
+     * \c tryToMergeClosedWalks() leaves them.
+     */
+    void mergeClosedWalks() {
+        std::vector<SwitchboardControlPath*>::const_iterator it;
+        VectorInt::const_iterator node;
+        SwitchboardControlPath* target;
+        ClosedWalk* walk;
+
+        while (!m_closedWalks.empty()) {
+            walk = m_closedWalks.front();
+            m_closedWalks.pop_front();
+            if (m_removed.count(walk))
+                continue;
+
+            const VectorInt& nodes = walk->nodes();
+            target = 0;
+            for (node = nodes.begin(); node != nodes.end() && target == 0; ++node) {
+                for (it = m_index[*node].begin(); it != m_index[*node].end(); ++it) {
+                    if (*it != walk) {
+                        target = *it;
+                        break;
+                    }
+                }
             }
+            if (target == 0)
+                continue;
+
+            target->extendWith(walk);
+            remove(walk);
+            addToIndex(target, nodes);
+            if (isClosedWalk(target))
+                m_closedWalks.push_back(static_cast<ClosedWalk*>(target));
+        }
+    }
+
+    /// Removes the walks that were taken apart from the model and deletes them
+    void commit() {
+        std::set<ControlPath*>::const_iterator it;
+
+        if (m_removed.empty())
+            return;
+
+        m_paths.erase(std::remove_if(m_paths.begin(), m_paths.end(),
+                    [this](ControlPath* path) { return m_removed.count(path) > 0; }),
+                m_paths.end());
+        for (it = m_removed.begin(); it != m_removed.end(); ++it)
+            delete *it;
+        m_removed.clear();
+    }
+
+private:
+    /// Adds a new walk to the model and the index
+    void add(SwitchboardControlPath* path) {
+        m_paths.push_back(path);
+        addToIndex(path, path->nodes());
+    }
+
+    /// Records that a walk passes through the given nodes
+    void addToIndex(SwitchboardControlPath* path, const VectorInt& nodes) {
+        VectorInt::const_iterator it;
+
+        for (it = nodes.begin(); it != nodes.end(); ++it) {
+            std::vector<SwitchboardControlPath*>& paths = m_index[*it];
+            if (std::find(paths.begin(), paths.end(), path) == paths.end())
+                paths.push_back(path);
         }
+    }
 
-        for (i = 0; i < n; i++) {
-            j = membership[i];
-            if (balancedCluster[j]) {
-                m_driverNodes.push_back(i);
-                balancedCluster[j] = false;
+    /// Removes a walk from the index and marks it for deletion
+    void remove(SwitchboardControlPath* path) {
+        removeFromIndex(path);
+        m_removed.insert(path);
+    }
+
+    /// Removes a walk from the index
+    void removeFromIndex(SwitchboardControlPath* path) {
+        const VectorInt& nodes = path->nodes();
+        VectorInt::const_iterator it;
+
+        for (it = nodes.begin(); it != nodes.end(); ++it) {
+            std::vector<SwitchboardControlPath*>& paths = m_index[*it];
+            std::vector<SwitchboardControlPath*>::iterator pos =
+                std::find(paths.begin(), paths.end(), path);
+            if (pos != paths.end())
+                paths.erase(pos);
+        }
+    }
+
+    /// Splits a walk at the edge that leaves its node at the given position
+    /**
+     * An open walk is cut in two, and a closed walk is opened up so that it
+     * starts at the target of the edge and ends at its source. Walks
+     * without edges are dropped.
+     */
+    void split(SwitchboardControlPath* path, long int position) {
+        VectorInt& nodes = path->nodes();
+        long int i, k = nodes.size();
+
+        if (isClosedWalk(path)) {
+            if (k > 1) {
+                VectorInt walkNodes(k);
+                for (i = 0; i < k; i++)
+                    walkNodes[i] = nodes[(position + 1 + i) % k];
+                add(new OpenWalk(walkNodes));
             }
+            remove(path);
+            return;
         }
+
+        VectorInt suffix(k - position - 1);
+        std::copy(nodes.begin() + position + 1, nodes.end(), suffix.begin());
+
+        removeFromIndex(path);
+        nodes.resize(position + 1);
+        if (position > 0)
+            addToIndex(path, nodes);
+        else
+            m_removed.insert(path);
+
+        if (suffix.size() > 1)
+            add(new OpenWalk(suffix));
     }
+};
+
+}          // end of anonymous namespace
+
+void SwitchboardControllabilityModel::calculate() {
+    AdjacencyView adjacency(m_pGraph->c_graph());
 
-#undef IS_BALANCED
+    // Find divergent nodes and balanced components
+    {
+        ScopedPhase phase("switchboard.driver_nodes");
+        findSwitchboardDriverNodes(adjacency, m_driverNodes, &m_degreeClasses);
+    }
+
+    calculateControlPaths();
+}
+
+long int SwitchboardControllabilityModel::updateEdges(const EdgeUpdates& updates) {
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    long int numDivergent, n = m_pGraph->vcount(), ignored;
+    std::vector<long int> touched, queue, removedRoots, roots, divergent;
+    std::vector<long int>::const_iterator it;
+
+    if (static_cast<long int>(m_degreeClasses.size()) != n || n == 0)
+        return ControllabilityModel::updateEdges(updates);
+
+    touched = updates.insertions;
+    touched.insert(touched.end(), updates.deletions.begin(), updates.deletions.end());
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    m_componentOwners.resize(n, 0);
+
+    // The divergent nodes come first among the driver nodes, followed by
+    // the roots of the balanced components. The components of the touched
+    // nodes may be merged, split or unbalanced by the update, so their
+    // roots are removed here and found again afterwards.
+    {
+        ScopedPhase phase("switchboard.driver_nodes");
+        AdjacencyView adjacency(m_pGraph->c_graph());
+        long int root;
+
+        for (numDivergent = 0; numDivergent < static_cast<long int>(m_driverNodes.size()) &&
+                m_degreeClasses[m_driverNodes[numDivergent]] > 0; numDivergent++)
+            ;
+        divergent.assign(m_driverNodes.begin(), m_driverNodes.begin() + numDivergent);
+        roots.assign(m_driverNodes.begin() + numDivergent, m_driverNodes.end());
+
+        for (it = touched.begin(); it != touched.end(); ++it) {
+            root = findBalancedComponentRoot(adjacency, m_degreeClasses, *it,
+                    m_componentOwners, queue);
+            if (root >= 0)
+                removedRoots.push_back(root);
+        }
+        for (it = queue.begin(); it != queue.end(); ++it)
+            m_componentOwners[*it] = 0;
+        queue.clear();
+    }
+
+    {
+        ScopedPhase phase("switchboard.update_graph");
+        ignored = applyEdgeUpdates(*m_pGraph, updates);
+    }
+
+    {
+        ScopedPhase phase("switchboard.driver_nodes");
+        AdjacencyView adjacency(m_pGraph->c_graph());
+        std::vector<long int> newlyDivergent, merged;
+        long int root, firstRoot;
+
+        for (it = touched.begin(); it != touched.end(); ++it) {
+            signed char previous = m_degreeClasses[*it];
+            m_degreeClasses[*it] = degreeClass(adjacency, *it);
+            if (previous <= 0 && m_degreeClasses[*it] > 0)
+                newlyDivergent.push_back(*it);
+        }
+        divergent.erase(std::remove_if(divergent.begin(), divergent.end(),
+                    [this](long int v) { return m_degreeClasses[v] <= 0; }),
+                divergent.end());
+        std::merge(divergent.begin(), divergent.end(), newlyDivergent.begin(),
+                newlyDivergent.end(), std::back_inserter(merged));
+        firstRoot = merged.size();
+
+        std::sort(removedRoots.begin(), removedRoots.end());
+        std::set_difference(roots.begin(), roots.end(), removedRoots.begin(),
+                removedRoots.end(), std::back_inserter(merged));
+        for (it = touched.begin(); it != touched.end(); ++it) {
+            root = findBalancedComponentRoot(adjacency, m_degreeClasses, *it,
+                    m_componentOwners, queue);
+            if (root >= 0)
+                merged.push_back(root);
+        }
+        for (it = queue.begin(); it != queue.end(); ++it)
+            m_componentOwners[*it] = 0;
+        std::sort(merged.begin() + firstRoot, merged.end());
+
+        m_driverNodes.resize(merged.size());
+        std::copy(merged.begin(), merged.end(), m_driverNodes.begin());
+    }
+
+    if (!m_pGraph->isDirected()) {
+        calculateControlPaths();
+        return ignored;
+    }
+
+    // Deletions come first as in applyEdgeUpdates(); the ones that were
+    // ignored there are not found in any walk either
+    {
+        ScopedPhase phase("switchboard.walks");
+        ControlPathEditor editor(m_controlPaths, m_controlPathsByNodes, n);
+        size_t i;
+
+        for (i = 0; i + 1 < updates.deletions.size(); i += 2)
+            editor.removeEdge(updates.deletions[i], updates.deletions[i + 1]);
+        for (i = 0; i + 1 < updates.insertions.size(); i += 2)
+            editor.addEdge(updates.insertions[i], updates.insertions[i + 1]);
+        for (it = touched.begin(); it != touched.end(); ++it)
+            editor.joinAt(*it);
+        for (it = touched.begin(); it != touched.end(); ++it)
+            editor.queueClosedWalksAt(*it);
+        editor.mergeClosedWalks();
+        editor.commit();
+    }
+
+    return ignored;
+}
+
+void SwitchboardControllabilityModel::calculateControlPaths() {
+	VectorInt::const_iterator it;
+    long int i, n = m_pGraph->vcount();
+    AdjacencyView adjacency(m_pGraph->c_graph());
+
+    ScopedPhase phase("switchboard.walks");
 
     // Clear the list of control paths
     clearControlPaths();
+    m_controlPathsByNodes.clear();
 
 	// Declare some more variables that we will need.
-    VectorBool edgeUsed(m_pGraph->ecount());
+    WalkBuilder<AdjacencyView> walker(adjacency);
 	std::vector<SwitchboardControlPath*> controlPathsByNodes(n);
 	std::unique_ptr<SwitchboardControlPath> path;
 	std::deque<ClosedWalk*> closedWalksToMerge;
@@ -191,9 +556,9 @@ void SwitchboardControllabilityModel::calculate() {
 	// are balanced, but we simply skip those for the time being.
     for (it = m_driverNodes.begin(); it != m_driverNodes.end(); it++) {
 		// While the node is divergent...
-        while (outDegrees[*it] > inDegrees[*it]) {
+        while (walker.remainingOutDegree(*it) > walker.remainingInDegree(*it)) {
             // Select an arbitrary outgoing edge and follow it until we get stuck.
-			path = createControlPathFromNode(*it, edgeUsed, outDegrees, inDegrees);
+			path = createControlPathFromNode(*it, walker);
 
 			// For each node in the path, associate the path to the node in
 			// controlPathsByNodes and then store the path.
@@ -207,10 +572,10 @@ void SwitchboardControllabilityModel::calculate() {
 	// degrees.
     for (i = 0; i < n; i++) {
 		// While the node still has any outbound edges left...
-        while (outDegrees[i] > 0) {
+        while (walker.remainingOutDegree(i) > 0) {
             // Select an arbitrary outgoing edge and follow it until we get stuck
 			// and construct a closed walk
-			path = createControlPathFromNode(i, edgeUsed, outDegrees, inDegrees);
+			path = createControlPathFromNode(i, walker);
 
 			// Store the closed walk in a deque that holds closed walks that could
 			// be potentially merged with other open or closed walks
@@ -242,6 +607,7 @@ void SwitchboardControllabilityModel::clearControlPaths() {
             it != m_controlPaths.end(); it++) {
         delete *it;
     }
+    m_controlPaths.clear();
 }
 
 ControllabilityModel* SwitchboardControllabilityModel::clone() {
@@ -285,57 +651,10 @@ std::vector<ControlPath*> SwitchboardControllabilityModel::controlPaths() const
 
 std::unique_ptr<SwitchboardControlPath>
 SwitchboardControllabilityModel::createControlPathFromNode(long int start,
-		VectorBool& edgeUsed, VectorInt& outDegrees, VectorInt& inDegrees) const {
-	long int v, w;
-	VectorInt walk, incs;
+		WalkBuilder<AdjacencyView>& walker) const {
+	VectorInt walk;
 	SwitchboardControlPath* path;
-
-	v = start;
-	while (v != -1) {
-		// Find an outbound edge that has not been used yet
-		w = -1;
-		m_pGraph->incident(&incs, v, IGRAPH_OUT);
-		for (VectorInt::const_iterator it = incs.begin(); it != incs.end(); it++) {
-			if (!edgeUsed[*it]) {
-				w = *it;
-				break;
-			}
-		}
-
-		// Did we get stuck? If so, break out of the loop.
-		if (w == -1) {
-			break;
-		}
-
-		// Add v to the walk
-		walk.push_back(v);
-
-		// Mark edge w as used and update v to the node edge w is pointing to.
-		// Also update the degree vectors
-		edgeUsed[w] = true;
-		outDegrees[v]--;
-		v = IGRAPH_OTHER(m_pGraph->c_graph(), w, v);
-		inDegrees[v]--;
-	}
-
-    // If the graph is directed, we can traverse the path backwards (we are
-    // essentially using each edge in both directions)
-    if (!m_pGraph->isDirected()) {
-        walk.push_back(v);
-        v = walk.size();
-        for (w = v - 1; w > 0; ) {
-            outDegrees[walk[w]]--;
-            w--;
-            if (w == 0) {
-                break;
-            }
-            walk.push_back(walk[w]);
-            inDegrees[walk[w]]--;
-        }
-        inDegrees[walk[0]]--;
-
-        v = walk[0];
-    }
+	long int v = walker.follow(start, walk);
 
 	// Add v to the walk unless it is equal to the starting point (in which case
 	// we have a closed walk)
@@ -359,125 +678,22 @@ VectorInt SwitchboardControllabilityModel::driverNodes() const {
 }
 
 VectorInt SwitchboardControllabilityModel::changesInDriverNodesAfterEdgeRemoval() const {
-    VectorInt degreeDiffs, outDegrees;
-    VectorInt result(m_pGraph->ecount());
-    EdgeSelector es = E(m_pGraph);
-    EdgeIterator eit(es);
-
-    m_pGraph->degree(&outDegrees, V(m_pGraph), IGRAPH_OUT, true);
-    m_pGraph->degree(&degreeDiffs, V(m_pGraph), IGRAPH_IN,  true);
-    degreeDiffs -= outDegrees;
-
-    while (!eit.end()) {
-        Edge edge = *eit;
-        long int i = eit.get();
-        long int u = edge.source(), v = edge.destination();
-
-        if (degreeDiffs[u] == -1) {
-            /* source vertex will become balanced instead of divergent */
-            result[i]--;
-        }
-        if (degreeDiffs[v] == 0) {
-            /* target vertex will become divergent instead of balanced */
-            result[i]++;
-        }
-
-        /* Treating special cases */
-        if (degreeDiffs[u] == 0 && degreeDiffs[v] == 0) {
-            /* u and v may potentially have been part of a balanced component.
-             * In this case, the component already has a driver node before
-             * the removal, so we will have to decrease result[i] by 1 */
-            if (isInBalancedComponent(u, degreeDiffs))
-                result[i]--;
-        }
-        if (degreeDiffs[v] == 1) {
-            /* v is convergent but will become balanced. If all its neighbors
-             * are balanced (except u), we may suspect that it becomes part
-             * of a balanced component, which will require one more driver
-             * node, so we will have to increase result[i] by 1 */
-            degreeDiffs[v]--; degreeDiffs[u]++;
-            if (isInBalancedComponentExcept(v, u, degreeDiffs))
-                result[i]++;
-            degreeDiffs[v]++; degreeDiffs[u]--;
-        }
-        if (degreeDiffs[u] == -1) {
-            /* u is divergent but will become balanced. If all its neighbors
-             * are balanced (except v), we may suspect that it becomes part
-             * of a balanced component, which will require one more driver
-             * node, so we will have to increase result[i] by 1 */
-            degreeDiffs[v]--; degreeDiffs[u]++;
-            if (isInBalancedComponentExcept(u, v, degreeDiffs))
-                result[i]++;
-            degreeDiffs[v]++; degreeDiffs[u]--;
-        }
-
-        ++eit;
-    }
-
+    VectorInt result;
+    switchboardDriverChanges(AdjacencyView(m_pGraph->c_graph()), result);
     return result;
 }
 
 std::vector<EdgeClass> SwitchboardControllabilityModel::edgeClasses() const {
-    VectorInt diffs = changesInDriverNodesAfterEdgeRemoval();
-    size_t i, n = diffs.size();
-    std::vector<EdgeClass> result(n);
-    for (i = 0; i < n; i++) {
-        if (diffs[i] < 0)
-            result[i] = EDGE_DISTINGUISHED;
-        else if (diffs[i] == 0)
-            result[i] = EDGE_REDUNDANT;
-        else
-            result[i] = EDGE_CRITICAL;
-    }
+    ScopedPhase phase("switchboard.edge_classes");
+    std::vector<EdgeClass> result;
+    classifySwitchboardEdges(AdjacencyView(m_pGraph->c_graph()), result);
     return result;
 }
 
-bool SwitchboardControllabilityModel::isInBalancedComponent(
-        long int v, const VectorInt& degreeDiffs) const {
-    return isInBalancedComponentExcept(v, -1, degreeDiffs);
-}
-
-bool SwitchboardControllabilityModel::isInBalancedComponentExcept(
-        long int v, long int u, const VectorInt& degreeDiffs) const {
-    VectorInt neis;
-    int i, j;
-    bool result = true;
-
-    /* Is v balanced? If not, we can return early */
-    if (degreeDiffs[v] != 0)
-        return false;
-
-    /* Does v have any neighbors apart from u? If not, v is in a
-     * _trivial_ balanced component, so we return false */
-    neis = m_pGraph->neighbors(v, IGRAPH_ALL);
-    if (neis.empty() || (neis.size() == 1 && neis[0] == u))
-        return false;
-
-    /* Prepare the queue */
-    VectorBool visited(m_pGraph->vcount());
-    std::deque<long int> q;
-    q.push_back(v); visited[v] = true;
-    if (u >= 0)
-        visited[u] = true;
-    
-    while (!q.empty()) {
-        v = q.front(); q.pop_front();
-        neis = m_pGraph->neighbors(v, IGRAPH_ALL);
-        j = neis.size();
-        for (i = 0; i < j; i++) {
-            u = neis[i];
-            if (visited[u])
-                continue;
-            if (degreeDiffs[u] != 0) {
-                result = false;
-                q.clear();
-                break;
-            }
-            q.push_back(u);
-            visited[u] = true;
-        }
-    }
-
+std::vector<long int> SwitchboardControllabilityModel::edgeClassCounts() const {
+    ScopedPhase phase("switchboard.edge_classes");
+    std::vector<long int> result(EDGE_DISTINGUISHED + 1);
+    countSwitchboardEdgeClasses(AdjacencyView(m_pGraph->c_graph()), &result[0]);
     return result;
 }
 
@@ -489,6 +705,8 @@ void SwitchboardControllabilityModel::setControllabilityMeasure(
 void SwitchboardControllabilityModel::setGraph(Graph* graph) {
     ControllabilityModel::setGraph(graph);
     m_driverNodes.clear();
+    m_degreeClasses.clear();
+    m_controlPathsByNodes.clear();
     clearControlPaths();
 }
 
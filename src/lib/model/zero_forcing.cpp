@@ -0,0 +1,77 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <igraph/cpp/graph.h>
+#include <netctrl/kernel/zero_forcing.h>
+#include <netctrl/model/zero_forcing.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/profiler.h>
+
+namespace netctrl {
+
+using namespace igraph;
+
+void ZeroForcingControllabilityModel::calculate() {
+    typedef std::chrono::steady_clock Clock;
+
+    // Check if we have a graph
+    if (m_pGraph == 0)
+        throw std::runtime_error("m_pGraph must not be null");
+
+    Clock::time_point start = Clock::now();
+    ForcingGraph graph(AdjacencyView(m_pGraph->c_graph()));
+    std::vector<long int> members;
+    std::vector<long int>::const_iterator it;
+
+    {
+        ScopedPhase phase("zero_forcing.restarts");
+        findZeroForcingSet(graph, m_restarts, m_timeBudget, m_seed, members);
+    }
+
+    {
+        // The pruning gets whatever is left from the time budget
+        ScopedPhase phase("zero_forcing.pruning");
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (m_timeBudget <= 0 || elapsed < m_timeBudget)
+            pruneZeroForcingSet(graph, members, m_timeBudget > 0 ? m_timeBudget - elapsed : 0);
+    }
+
+    std::sort(members.begin(), members.end());
+    m_driverNodes.clear();
+    for (it = members.begin(); it != members.end(); ++it)
+        m_driverNodes.push_back(*it);
+
+    // Cleanup: if there is no driver node, we must provide at least one
+    if (m_driverNodes.empty()) {
+        m_driverNodes.push_back(0);
+    }
+}
+
+ControllabilityModel* ZeroForcingControllabilityModel::clone() {
+    ZeroForcingControllabilityModel* result = new ZeroForcingControllabilityModel(m_pGraph);
+    result->setRestarts(m_restarts);
+    result->setTimeBudget(m_timeBudget);
+    result->setSeed(m_seed);
+    return result;
+}
+
+float ZeroForcingControllabilityModel::controllability() const {
+    return m_driverNodes.size() / static_cast<float>(m_pGraph->vcount());
+}
+
+std::vector<ControlPath*> ZeroForcingControllabilityModel::controlPaths() const {
+    return std::vector<ControlPath*>();
+}
+
+igraph::VectorInt ZeroForcingControllabilityModel::driverNodes() const {
+    return m_driverNodes;
+}
+
+void ZeroForcingControllabilityModel::setGraph(igraph::Graph* graph) {
+    ControllabilityModel::setGraph(graph);
+    m_driverNodes.clear();
+}
+
+}          // end of namespace
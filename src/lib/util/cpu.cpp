@@ -0,0 +1,22 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <netctrl/util/cpu.h>
+
+namespace netctrl {
+
+std::string dispatchedInstructionSet() {
+#if defined(NETCTRL_HAVE_TARGET_CLONES) && (defined(__x86_64__) || defined(__i386__))
+    // Mirrors the order in which the resolvers generated for NETCTRL_DISPATCH
+    // test the CPU features
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return "avx512f";
+    if (__builtin_cpu_supports("avx2"))
+        return "avx2";
+    if (__builtin_cpu_supports("sse4.2"))
+        return "sse4.2";
+#endif
+    return "default";
+}
+
+}          // end of namespace
@@ -0,0 +1,94 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <netctrl/util/csr_graph.h>
+
+namespace netctrl {
+
+/**
+ * \brief Fills a CSR index using counting sort.
+ *
+ * \param  n        the number of vertices
+ * \param  keys     the vertex that each entry belongs to
+ * \param  values   the value that should be stored for each entry
+ * \param  ids      the edge ID that should be stored for each entry
+ * \param  offsets  the offset vector to fill; it will have n+1 elements
+ * \param  sortedValues  the values, ordered by key
+ * \param  sortedIds     the IDs, ordered by key
+ */
+static void buildIndex(long int n, const std::vector<long int>& keys,
+        const std::vector<long int>& values, const std::vector<long int>& ids,
+        std::vector<long int>& offsets, std::vector<long int>& sortedValues,
+        std::vector<long int>& sortedIds) {
+    long int i, k, m = keys.size();
+
+    offsets.assign(n+1, 0);
+    for (i = 0; i < m; i++) {
+        if (keys[i] < 0 || keys[i] >= n || values[i] < 0 || values[i] >= n)
+            throw std::invalid_argument("invalid vertex ID in edge list");
+        offsets[keys[i]+1]++;
+    }
+    for (i = 0; i < n; i++) {
+        offsets[i+1] += offsets[i];
+    }
+
+    std::vector<long int> positions(offsets.begin(), offsets.end() - 1);
+    sortedValues.resize(m);
+    sortedIds.resize(m);
+    for (i = 0; i < m; i++) {
+        k = positions[keys[i]]++;
+        sortedValues[k] = values[i];
+        sortedIds[k] = ids[i];
+    }
+}
+
+CSRGraph::CSRGraph(long int vertexCount, const std::vector<long int>& edges, bool directed)
+    : m_vertexCount(vertexCount), m_directed(directed), m_outOffsets(), m_outTargets(),
+    m_outEdges(), m_inOffsets(1, 0), m_inSources(), m_inEdges() {
+    long int i, m = edges.size() / 2;
+    std::vector<long int> sources, targets, ids;
+
+    if (edges.size() % 2 != 0)
+        throw std::invalid_argument("edge list must have an even number of elements");
+
+    sources.reserve(directed ? m : 2*m);
+    targets.reserve(directed ? m : 2*m);
+    ids.reserve(directed ? m : 2*m);
+    for (i = 0; i < m; i++) {
+        sources.push_back(edges[2*i]);
+        targets.push_back(edges[2*i+1]);
+        ids.push_back(i);
+    }
+
+    if (directed) {
+        buildIndex(vertexCount, sources, targets, ids, m_outOffsets, m_outTargets, m_outEdges);
+        buildIndex(vertexCount, targets, sources, ids, m_inOffsets, m_inSources, m_inEdges);
+    } else {
+        for (i = 0; i < m; i++) {
+            sources.push_back(edges[2*i+1]);
+            targets.push_back(edges[2*i]);
+            ids.push_back(i);
+        }
+        buildIndex(vertexCount, sources, targets, ids, m_outOffsets, m_outTargets, m_outEdges);
+    }
+}
+
+std::vector<long int> CSRGraph::edgeList() const {
+    long int u, w, i, k, m = edgeCount();
+    std::vector<long int> result(2*m);
+
+    for (u = 0; u < m_vertexCount; u++) {
+        k = outDegree(u);
+        for (i = 0; i < k; i++) {
+            w = outNeighbor(u, i);
+            if (!m_directed && w < u)
+                continue;
+            result[2*outEdge(u, i)] = u;
+            result[2*outEdge(u, i)+1] = w;
+        }
+    }
+
+    return result;
+}
+
+}          // end of namespace
@@ -0,0 +1,64 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <stdexcept>
+#include <igraph/cpp/vector_int.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/edge_updates.h>
+
+namespace netctrl {
+
+using namespace igraph;
+
+long int applyEdgeUpdates(Graph& graph, const EdgeUpdates& updates) {
+    long int i, j, k, u, v, e, n = graph.vcount(), ignored = 0;
+    std::vector<long int>::const_iterator it;
+
+    for (it = updates.insertions.begin(); it != updates.insertions.end(); ++it) {
+        if (*it < 0 || *it >= n)
+            throw std::invalid_argument("invalid vertex ID in inserted edge");
+    }
+    for (it = updates.deletions.begin(); it != updates.deletions.end(); ++it) {
+        if (*it < 0 || *it >= n)
+            throw std::invalid_argument("invalid vertex ID in deleted edge");
+    }
+
+    if (!updates.deletions.empty()) {
+        AdjacencyView adjacency(graph.c_graph());
+        std::vector<bool> deleted(adjacency.edgeCount(), false);
+        VectorInt edgeIds;
+
+        // Each deletion takes the first edge between its endpoints that was
+        // not taken by an earlier one
+        for (i = 0; i + 1 < static_cast<long int>(updates.deletions.size()); i += 2) {
+            u = updates.deletions[i];
+            v = updates.deletions[i+1];
+            k = adjacency.outDegree(u);
+            for (j = 0; j < k; j++) {
+                e = adjacency.outEdge(u, j);
+                if (adjacency.outNeighbor(u, j) == v && !deleted[e])
+                    break;
+            }
+            if (j == k) {
+                ignored++;
+                continue;
+            }
+            deleted[e] = true;
+            edgeIds.push_back(e);
+        }
+
+        if (!edgeIds.empty() &&
+                igraph_delete_edges(graph.c_graph(), igraph_ess_vector(edgeIds.c_vector())))
+            throw std::runtime_error("cannot delete edges");
+    }
+
+    if (!updates.insertions.empty()) {
+        VectorInt edges(updates.insertions.size());
+        std::copy(updates.insertions.begin(), updates.insertions.end(), edges.begin());
+        graph.addEdges(edges);
+    }
+
+    return ignored;
+}
+
+}          // end of namespace
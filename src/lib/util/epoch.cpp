@@ -0,0 +1,85 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <netctrl/util/epoch.h>
+
+namespace netctrl {
+
+EpochDomain::Reader::Reader(EpochDomain& domain) : m_domain(domain), m_pSlot(0) {
+    std::lock_guard<std::mutex> lock(domain.m_mutex);
+    std::vector<std::unique_ptr<Slot> >::iterator it;
+
+    for (it = domain.m_slots.begin(); it != domain.m_slots.end(); ++it) {
+        if (!(*it)->used)
+            break;
+    }
+    if (it == domain.m_slots.end()) {
+        domain.m_slots.push_back(std::unique_ptr<Slot>(new Slot()));
+        it = domain.m_slots.end() - 1;
+    }
+
+    m_pSlot = it->get();
+    m_pSlot->used = true;
+}
+
+EpochDomain::Reader::~Reader() {
+    std::lock_guard<std::mutex> lock(m_domain.m_mutex);
+    m_pSlot->epoch.store(0);
+    m_pSlot->used = false;
+}
+
+EpochDomain::~EpochDomain() {
+    std::vector<Retired>::iterator it;
+    for (it = m_retired.begin(); it != m_retired.end(); ++it)
+        it->deleter(it->object);
+}
+
+void EpochDomain::retire(void* object, void (*deleter)(void*)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Retired retired;
+
+    // Readers that announce a later epoch entered after the object became
+    // unreachable, so they cannot see it
+    retired.object = object;
+    retired.deleter = deleter;
+    retired.epoch = m_epoch.fetch_add(1);
+    m_retired.push_back(retired);
+
+    collectLocked();
+}
+
+long int EpochDomain::collect() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return collectLocked();
+}
+
+long int EpochDomain::collectLocked() {
+    std::vector<std::unique_ptr<Slot> >::const_iterator it;
+    std::vector<Retired> pending;
+    unsigned long oldest = m_epoch.load(), epoch;
+    size_t i;
+
+    for (it = m_slots.begin(); it != m_slots.end(); ++it) {
+        epoch = (*it)->epoch.load();
+        if (epoch != 0)
+            oldest = std::min(oldest, epoch);
+    }
+
+    for (i = 0; i < m_retired.size(); i++) {
+        if (m_retired[i].epoch < oldest)
+            m_retired[i].deleter(m_retired[i].object);
+        else
+            pending.push_back(m_retired[i]);
+    }
+
+    i = m_retired.size() - pending.size();
+    m_retired.swap(pending);
+    return i;
+}
+
+long int EpochDomain::pendingCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_retired.size();
+}
+
+}          // end of namespace
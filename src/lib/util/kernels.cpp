@@ -0,0 +1,104 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <cmath>
+#include <netctrl/util/cpu.h>
+#include <netctrl/util/kernels.h>
+
+namespace netctrl {
+
+using igraph::integer_t;
+
+NETCTRL_DISPATCH
+long int classifyDegrees(const integer_t* outDegrees, const integer_t* inDegrees,
+        signed char* classes, long int n) {
+    long int i, balancedCount = 0;
+
+    // The loop body is branch-free so the compiler can vectorize it
+    for (i = 0; i < n; i++) {
+        int divergent = outDegrees[i] > inDegrees[i];
+        int balanced = (outDegrees[i] == inDegrees[i]) & (outDegrees[i] > 0);
+        classes[i] = static_cast<signed char>(divergent - !(divergent | balanced));
+        balancedCount += balanced;
+    }
+
+    return balancedCount;
+}
+
+// The selection kernels write every index and advance the output position
+// only for the selected entries, so the loop body has no branches
+
+NETCTRL_DISPATCH
+long int selectAboveThreshold(const double* values, long int n, double threshold,
+        long int* indices) {
+    long int i, count = 0;
+
+    for (i = 0; i < n; i++) {
+        indices[count] = i;
+        count += std::fabs(values[i]) > threshold;
+    }
+
+    return count;
+}
+
+NETCTRL_DISPATCH
+long int selectAboveThreshold(const float* values, long int n, float threshold,
+        long int* indices) {
+    long int i, count = 0;
+
+    for (i = 0; i < n; i++) {
+        indices[count] = i;
+        count += std::fabs(values[i]) > threshold;
+    }
+
+    return count;
+}
+
+NETCTRL_DISPATCH
+long int selectAboveThreshold(const uint8_t* values, long int n, uint8_t threshold,
+        long int* indices) {
+    long int i, count = 0;
+
+    for (i = 0; i < n; i++) {
+        indices[count] = i;
+        count += values[i] > threshold;
+    }
+
+    return count;
+}
+
+NETCTRL_DISPATCH
+size_t bitsetCount(const uint64_t* words, size_t n) {
+    size_t i, result = 0;
+
+    for (i = 0; i < n; i++) {
+        result += __builtin_popcountll(words[i]);
+    }
+
+    return result;
+}
+
+NETCTRL_DISPATCH
+size_t bitsetAndNot(uint64_t* dst, const uint64_t* a, const uint64_t* b, size_t n) {
+    size_t i, result = 0;
+
+    for (i = 0; i < n; i++) {
+        dst[i] = a[i] & ~b[i];
+        result += __builtin_popcountll(dst[i]);
+    }
+
+    return result;
+}
+
+NETCTRL_DISPATCH
+size_t bitsetOr(uint64_t* dst, const uint64_t* a, size_t n) {
+    size_t i, result = 0;
+
+    for (i = 0; i < n; i++) {
+        dst[i] |= a[i];
+        result += __builtin_popcountll(dst[i]);
+    }
+
+    return result;
+}
+
+}          // end of namespace
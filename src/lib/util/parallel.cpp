@@ -0,0 +1,44 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <netctrl/util/parallel.h>
+
+namespace netctrl {
+
+namespace {
+
+/// Number of threads used by the parallel kernels
+std::atomic<int> numberOfThreads(1);
+
+}          // end of anonymous namespace
+
+int threadCount() {
+    return numberOfThreads;
+}
+
+void setThreadCount(int numThreads) {
+    if (numThreads <= 0) {
+        numThreads = std::thread::hardware_concurrency();
+        if (numThreads <= 0)
+            numThreads = 1;
+    }
+    numberOfThreads = numThreads;
+}
+
+Barrier::Barrier(long int size) : m_size(size), m_waiting(0), m_step(0) {}
+
+void Barrier::wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    long int step = m_step;
+
+    if (++m_waiting == m_size) {
+        m_waiting = 0;
+        m_step++;
+        m_released.notify_all();
+        return;
+    }
+
+    while (m_step == step)
+        m_released.wait(lock);
+}
+
+}          // end of namespace
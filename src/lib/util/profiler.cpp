@@ -0,0 +1,260 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <atomic>
+#include <cstring>
+#include <vector>
+#include <netctrl/util/profiler.h>
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace netctrl {
+
+namespace {
+
+/// Names of the hardware counters in the JSON output
+const char* const counterNames[NUM_COUNTERS] = {
+    "cycles", "instructions", "llc_misses", "branch_misses"
+};
+
+/// Hardware counters of a single thread
+/**
+ * The counters are opened as a single group so they are scheduled onto
+ * the PMU together and can be read atomically with one \c read() call.
+ * They count user space events of the thread that opened them only.
+ */
+class ThreadCounters {
+private:
+    /// File descriptors of the counters; the first one is the group leader
+    int m_fds[NUM_COUNTERS];
+
+    /// Whether all the counters were opened successfully
+    bool m_available;
+
+public:
+    ThreadCounters() : m_available(false) {
+        int i;
+
+        for (i = 0; i < NUM_COUNTERS; i++)
+            m_fds[i] = -1;
+
+#ifdef __linux__
+        // PERF_COUNT_HW_CACHE_MISSES usually counts last level cache misses
+        static const uint64_t configs[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        struct perf_event_attr attr;
+
+        for (i = 0; i < NUM_COUNTERS; i++) {
+            memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.disabled = (i == 0) ? 1 : 0;
+
+            m_fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1,
+                    i == 0 ? -1 : m_fds[0], 0);
+            if (m_fds[i] < 0) {
+                close();
+                return;
+            }
+        }
+
+        ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        m_available = true;
+#endif
+    }
+
+    ~ThreadCounters() {
+        close();
+    }
+
+    /// Closes all the counters that are open
+    void close() {
+#ifdef __linux__
+        for (int i = NUM_COUNTERS - 1; i >= 0; i--) {
+            if (m_fds[i] >= 0)
+                ::close(m_fds[i]);
+            m_fds[i] = -1;
+        }
+#endif
+        m_available = false;
+    }
+
+    /// Reads the current values of the counters
+    void read(CounterValues& values) const {
+        values.valid = false;
+
+#ifdef __linux__
+        // With PERF_FORMAT_GROUP, the leader returns the number of counters
+        // followed by the value of each counter
+        uint64_t buffer[NUM_COUNTERS + 1];
+
+        if (!m_available)
+            return;
+        if (::read(m_fds[0], buffer, sizeof(buffer)) != sizeof(buffer))
+            return;
+        if (buffer[0] != NUM_COUNTERS)
+            return;
+
+        for (int i = 0; i < NUM_COUNTERS; i++)
+            values.values[i] = buffer[i + 1];
+        values.valid = true;
+#endif
+    }
+};
+
+/// The next unused thread index in the profile
+std::atomic<int> nextThreadIndex(0);
+
+/// The index of the calling thread in the profile; -1 until first needed
+thread_local int currentThreadIndex = -1;
+
+/// The innermost phase of the calling thread
+thread_local const char* currentPhaseName = 0;
+
+/// The thread index of each worker position of \c parallelFor(), or -1
+std::vector<int> workerThreadIndices;
+
+/// Mutex guarding \c workerThreadIndices
+std::mutex workerMutex;
+
+/// Writes a string to the given stream as a JSON string literal
+void writeJSONString(std::ostream& os, const std::string& str) {
+    os << '"';
+    for (std::string::const_iterator it = str.begin(); it != str.end(); ++it) {
+        if (*it == '"' || *it == '\\')
+            os << '\\';
+        os << *it;
+    }
+    os << '"';
+}
+
+}          // end of anonymous namespace
+
+Profiler::Profiler() : m_enabled(false), m_countersEnabled(false), m_phases(), m_mutex() {
+}
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::readCounters(CounterValues& values) {
+    static thread_local ThreadCounters counters;
+    counters.read(values);
+}
+
+void Profiler::record(const std::string& phase, double seconds,
+        const CounterValues& start, const CounterValues& end) {
+    std::pair<std::string, int> key(phase, threadIndex());
+    std::lock_guard<std::mutex> lock(m_mutex);
+    PhaseStatistics& stats = m_phases[key];
+
+    stats.calls++;
+    stats.seconds += seconds;
+    if (start.valid && end.valid) {
+        for (int i = 0; i < NUM_COUNTERS; i++)
+            stats.counters[i] += end.values[i] - start.values[i];
+    } else {
+        stats.hasCounters = false;
+    }
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_phases.clear();
+}
+
+bool Profiler::setCountersEnabled(bool enabled) {
+    CounterValues values;
+
+    if (enabled) {
+        readCounters(values);
+        if (!values.valid) {
+            m_countersEnabled = false;
+            return false;
+        }
+    }
+
+    m_countersEnabled = enabled;
+    return true;
+}
+
+Profiler::PhaseMap Profiler::snapshot() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_phases;
+}
+
+int Profiler::threadIndex() {
+    if (currentThreadIndex < 0)
+        currentThreadIndex = nextThreadIndex++;
+    return currentThreadIndex;
+}
+
+void Profiler::setWorkerSlot(int slot) {
+    std::lock_guard<std::mutex> lock(workerMutex);
+
+    if (slot >= static_cast<int>(workerThreadIndices.size()))
+        workerThreadIndices.resize(slot + 1, -1);
+    if (workerThreadIndices[slot] < 0)
+        workerThreadIndices[slot] = nextThreadIndex++;
+    currentThreadIndex = workerThreadIndices[slot];
+}
+
+const char* Profiler::currentPhase() {
+    return currentPhaseName;
+}
+
+const char* Profiler::swapCurrentPhase(const char* name) {
+    const char* previous = currentPhaseName;
+    currentPhaseName = name;
+    return previous;
+}
+
+void Profiler::writeJSON(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    PhaseMap::const_iterator it;
+    int i;
+
+    os << "{\n";
+    os << "  \"hardware_counters\": " << (m_countersEnabled ? "true" : "false") << ",\n";
+    os << "  \"phases\": [";
+    for (it = m_phases.begin(); it != m_phases.end(); ++it) {
+        const PhaseStatistics& stats = it->second;
+        bool hasCounters = m_countersEnabled && stats.hasCounters;
+
+        os << (it == m_phases.begin() ? "\n" : ",\n");
+        os << "    {\"name\": ";
+        writeJSONString(os, it->first.first);
+        os << ", \"thread\": " << it->first.second
+           << ", \"calls\": " << stats.calls
+           << ", \"seconds\": " << stats.seconds;
+        for (i = 0; i < NUM_COUNTERS; i++) {
+            os << ", \"" << counterNames[i] << "\": ";
+            if (hasCounters)
+                os << stats.counters[i];
+            else
+                os << "null";
+        }
+        os << ", \"ipc\": ";
+        if (hasCounters && stats.counters[COUNTER_CYCLES] > 0)
+            os << static_cast<double>(stats.counters[COUNTER_INSTRUCTIONS]) /
+                  stats.counters[COUNTER_CYCLES];
+        else
+            os << "null";
+        os << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+}          // end of namespace
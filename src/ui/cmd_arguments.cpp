@@ -1,6 +1,7 @@
 /* vim:set ts=4 sw=4 sts=4 et: */
 
 #include <algorithm>
+#include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <string>
@@ -12,7 +13,12 @@ using namespace SimpleOpt;
 
 enum {
     HELP=30000, VERSION, VERBOSE, QUIET, USE_STDIN, OUT_FILE, MODEL,
-    MODE, USE_EDGE, INPUT_FORMAT, OUTPUT_FORMAT
+    MODE, USE_EDGE, JOBS, TIME_BUDGET, RESTARTS, EGO_RADIUS, MEMBERSHIP,
+    LOAD_MATCHING, SAVE_MATCHING, UPDATES, INPUTS, QUERY_THREADS, FULL_SNAPSHOTS,
+    HORIZON,
+    INPUT_FORMAT, OUTPUT_FORMAT, THRESHOLD, SOURCE_COLUMN, TARGET_COLUMN,
+    WEIGHT_COLUMN, DELIMITER, QUOTE, NO_HEADER, PROFILE, REPEAT, WARMUP,
+    KEEP_OUTPUT, DISCARD_OUTPUT
 };
 
 CommandLineArguments::CommandLineArguments(
@@ -21,8 +27,12 @@ CommandLineArguments::CommandLineArguments(
     m_options(),
     inputFile(), verbosity(1), outputFile(),
     modelType(SWITCHBOARD_MODEL), operationMode(MODE_DRIVER_NODES),
-    useEdgeMeasure(false),
-    inputFormat(GRAPH_FORMAT_AUTO), outputFormat(GRAPH_FORMAT_GML)
+    useEdgeMeasure(false), numJobs(1), timeBudget(1.0), numRestarts(1000), egoRadius(1),
+    membershipFile(), loadMatchingFile(), saveMatchingFile(), updatesFile(),
+    inputsFile(), energyHorizon(1000), numQueryThreads(0), fullSnapshots(false),
+    inputFormat(GRAPH_FORMAT_AUTO), outputFormat(GRAPH_FORMAT_GML), readerOptions(),
+    profileFile(), numRepeats(0), numWarmups(0), keepOutput(false),
+    discardOutput(false)
 {
 
     addOption(USE_STDIN, "-", SO_NONE);
@@ -40,8 +50,32 @@ CommandLineArguments::CommandLineArguments(
 
     addOption(INPUT_FORMAT,  "-f", SO_REQ_SEP, "--input-format");
     addOption(OUTPUT_FORMAT, "-F", SO_REQ_SEP, "--output-format");
+    addOption(THRESHOLD,     "--threshold", SO_REQ_SEP);
+    addOption(SOURCE_COLUMN, "--source-column", SO_REQ_SEP);
+    addOption(TARGET_COLUMN, "--target-column", SO_REQ_SEP);
+    addOption(WEIGHT_COLUMN, "--weight-column", SO_REQ_SEP);
+    addOption(DELIMITER,     "--delimiter", SO_REQ_SEP);
+    addOption(QUOTE,         "--quote", SO_REQ_SEP);
+    addOption(NO_HEADER,     "--no-header", SO_NONE);
 
     addOption(USE_EDGE, "-e", SO_NONE, "--edge");
+    addOption(JOBS,     "-j", SO_REQ_SEP, "--jobs");
+    addOption(TIME_BUDGET, "--time-budget", SO_REQ_SEP);
+    addOption(RESTARTS, "--restarts", SO_REQ_SEP);
+    addOption(EGO_RADIUS, "--ego-radius", SO_REQ_SEP);
+    addOption(MEMBERSHIP, "--membership", SO_REQ_SEP);
+    addOption(LOAD_MATCHING, "--load-matching", SO_REQ_SEP);
+    addOption(SAVE_MATCHING, "--save-matching", SO_REQ_SEP);
+    addOption(UPDATES, "--updates", SO_REQ_SEP);
+    addOption(INPUTS, "--inputs", SO_REQ_SEP);
+    addOption(QUERY_THREADS, "--query-threads", SO_REQ_SEP);
+    addOption(FULL_SNAPSHOTS, "--full-snapshots", SO_NONE);
+    addOption(HORIZON, "--horizon", SO_REQ_SEP);
+    addOption(PROFILE,  "--profile", SO_REQ_SEP);
+    addOption(REPEAT,   "--repeat", SO_REQ_SEP);
+    addOption(WARMUP,   "--warmup", SO_REQ_SEP);
+    addOption(KEEP_OUTPUT, "--keep-output", SO_NONE);
+    addOption(DISCARD_OUTPUT, "--discard-output", SO_NONE);
 }
 
 void CommandLineArguments::addOption(int id, const char* option,
@@ -122,6 +156,12 @@ void CommandLineArguments::parse(int argc, char** argv) {
                     modelType = LIU_MODEL;
                 else if (arg == "switchboard")
                     modelType = SWITCHBOARD_MODEL;
+                else if (arg == "exact")
+                    modelType = EXACT_MODEL;
+                else if (arg == "dominating")
+                    modelType = DOMINATING_SET_MODEL;
+                else if (arg == "zero_forcing")
+                    modelType = ZERO_FORCING_MODEL;
                 else {
                     cerr << "Unknown model type: " << arg << '\n';
                     ret = 1;
@@ -140,6 +180,18 @@ void CommandLineArguments::parse(int argc, char** argv) {
                     operationMode = MODE_STATISTICS;
                 else if (arg == "significance")
                     operationMode = MODE_SIGNIFICANCE;
+                else if (arg == "ego")
+                    operationMode = MODE_EGO;
+                else if (arg == "communities")
+                    operationMode = MODE_COMMUNITIES;
+                else if (arg == "structural_rank")
+                    operationMode = MODE_STRUCTURAL_RANK;
+                else if (arg == "updates")
+                    operationMode = MODE_UPDATES;
+                else if (arg == "energy")
+                    operationMode = MODE_ENERGY;
+                else if (arg == "verify_inputs")
+                    operationMode = MODE_VERIFY_INPUTS;
                 else {
                     cerr << "Unknown operation mode: " << arg << '\n';
                     ret = 1;
@@ -151,6 +203,117 @@ void CommandLineArguments::parse(int argc, char** argv) {
                 useEdgeMeasure = true;
                 break;
 
+            case JOBS:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                numJobs = atoi(arg.c_str());
+                if (numJobs < 0 || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid number of jobs: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case TIME_BUDGET:
+                {
+                    char* end;
+                    arg = args.OptionArg() ? args.OptionArg() : "";
+                    timeBudget = strtod(arg.c_str(), &end);
+                    if (arg.empty() || *end != 0 || timeBudget < 0) {
+                        cerr << "Invalid time budget: " << arg << '\n';
+                        ret = 1;
+                    }
+                }
+                break;
+
+            case RESTARTS:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                numRestarts = atol(arg.c_str());
+                if (numRestarts <= 0 || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid number of restarts: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case EGO_RADIUS:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                egoRadius = atol(arg.c_str());
+                if (arg.empty() || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid ego network radius: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case MEMBERSHIP:
+                membershipFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case LOAD_MATCHING:
+                loadMatchingFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case SAVE_MATCHING:
+                saveMatchingFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case UPDATES:
+                updatesFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case INPUTS:
+                inputsFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case QUERY_THREADS:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                numQueryThreads = atoi(arg.c_str());
+                if (arg.empty() || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid number of query threads: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case FULL_SNAPSHOTS:
+                fullSnapshots = true;
+                break;
+
+            case HORIZON:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                energyHorizon = atol(arg.c_str());
+                if (energyHorizon <= 0 || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid horizon: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case PROFILE:
+                profileFile = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case REPEAT:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                numRepeats = atol(arg.c_str());
+                if (numRepeats <= 0 || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid number of repetitions: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case WARMUP:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                numWarmups = atol(arg.c_str());
+                if (arg.empty() || arg.find_first_not_of("0123456789") != string::npos) {
+                    cerr << "Invalid number of warmup runs: " << arg << '\n';
+                    ret = 1;
+                }
+                break;
+
+            case KEEP_OUTPUT:
+                keepOutput = true;
+                break;
+
+            case DISCARD_OUTPUT:
+                discardOutput = true;
+                break;
+
             /* Processing format options parameters */
             case INPUT_FORMAT:
                 arg = args.OptionArg() ? args.OptionArg() : "";
@@ -175,6 +338,58 @@ void CommandLineArguments::parse(int argc, char** argv) {
                 }
                 break;
 
+            case THRESHOLD:
+                {
+                    char* end;
+                    arg = args.OptionArg() ? args.OptionArg() : "";
+                    readerOptions.threshold = strtod(arg.c_str(), &end);
+                    if (arg.empty() || *end != 0 || readerOptions.threshold < 0) {
+                        cerr << "Invalid threshold: " << arg << '\n';
+                        ret = 1;
+                    }
+                }
+                break;
+
+            case SOURCE_COLUMN:
+                readerOptions.sourceColumn = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case TARGET_COLUMN:
+                readerOptions.targetColumn = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case WEIGHT_COLUMN:
+                readerOptions.weightColumn = args.OptionArg() ? args.OptionArg() : "";
+                break;
+
+            case DELIMITER:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                if (arg == "\\t" || arg == "tab")
+                    arg = "\t";
+                if (arg.size() != 1 || arg[0] == '\n') {
+                    cerr << "Invalid delimiter: " << arg << '\n';
+                    ret = 1;
+                } else {
+                    readerOptions.delimiter = arg[0];
+                }
+                break;
+
+            case QUOTE:
+                arg = args.OptionArg() ? args.OptionArg() : "";
+                if (arg.empty() || arg == "none") {
+                    readerOptions.quote = 0;
+                } else if (arg.size() != 1 || arg[0] == '\n') {
+                    cerr << "Invalid quote character: " << arg << '\n';
+                    ret = 1;
+                } else {
+                    readerOptions.quote = arg[0];
+                }
+                break;
+
+            case NO_HEADER:
+                readerOptions.header = false;
+                break;
+
             default:
                 arg = args.OptionArg() ? args.OptionArg() : "";
                 ret = handleOption(args.OptionId(), arg);
@@ -216,23 +431,94 @@ void CommandLineArguments::showHelp(ostream& os) const {
           "\n"
           "Basic algorithm parameters:\n"
           "    -m, --model         selects the controllability model to use.\n"
-          "                        Supported models: liu, switchboard.\n"
+          "                        Supported models: liu, switchboard, exact,\n"
+          "                        dominating, zero_forcing.\n"
           "                        Default: switchboard.\n"
           "    -M, --mode          selects the mode in which the application will operate.\n"
           "                        Supported modes: driver_nodes, control_paths, graph,\n"
-          "                        statistics, significance. Default: driver_nodes.\n"
+          "                        statistics, significance, ego, communities,\n"
+          "                        structural_rank, updates, energy, verify_inputs.\n"
+          "                        Default: driver_nodes.\n"
           "    -o, --output        specifies the name of the output file where the results\n"
-          "                        should be written.\n"
+          "                        should be written. Names ending in .gz are compressed\n"
+          "                        with gzip.\n"
           "\n"
           "Advanced algorithm parameters:\n"
           "    -e, --edge          use the edge-based controllability measure for the\n"
           "                        switchboard model.\n"
+          "    -j, --jobs          number of worker processes to use in the significance\n"
+          "                        mode and number of threads to use in the other\n"
+          "                        modes and for compressing the output. Zero means\n"
+          "                        one per CPU core. Default: 1.\n"
+          "    --time-budget SECS  maximum running time of the heuristic search for the\n"
+          "                        driver nodes in the dominating and zero_forcing\n"
+          "                        models. Zero means no limit. Default: 1.\n"
+          "    --restarts N        number of randomized restarts in the zero_forcing\n"
+          "                        model. Default: 1000.\n"
+          "    --ego-radius K      radius of the ego networks in the ego mode. Default: 1.\n"
+          "    --membership FILE   file that assigns the vertices to communities in the\n"
+          "                        communities mode. Each line contains the name of a\n"
+          "                        vertex and the label of its community.\n"
+          "    --load-matching FILE\n"
+          "                        starts the liu model from the matching saved in\n"
+          "                        FILE by --save-matching, possibly for an earlier\n"
+          "                        version of the graph. Pairs of vertices that are\n"
+          "                        not connected any more are dropped and the rest is\n"
+          "                        augmented to a maximum matching.\n"
+          "    --save-matching FILE\n"
+          "                        saves the maximum matching found by the liu model\n"
+          "                        to FILE, one matched pair of vertex names per line.\n"
+          "    --updates FILE      file of edge updates for the updates mode. Each line\n"
+          "                        is '+ u v' to insert or '- u v' to delete an edge\n"
+          "                        between the named vertices; lines starting with '='\n"
+          "                        end a batch.\n"
+          "    --inputs FILE       file of candidate input sets for the verify_inputs\n"
+          "                        mode, one set of vertex names per line.\n"
+          "    --query-threads N   in the updates mode, runs N threads that query the\n"
+          "                        latest results while the updates are applied and\n"
+          "                        prints the query throughput to stderr. Default: 0.\n"
+          "                        The queries only see the driver nodes unless\n"
+          "                        --full-snapshots is given.\n"
+          "    --full-snapshots    also publishes the edge classes and the control paths\n"
+          "                        to the query threads after each batch of updates.\n"
+          "    --horizon N         largest number of time steps in the control energy\n"
+          "                        estimates of the energy mode. Default: 1000.\n"
+          "    --profile FILE      writes the running time of each phase of the calculation\n"
+          "                        to the given file in JSON format, along with CPU cycles,\n"
+          "                        instructions, cache and branch misses where available.\n"
+          "    --repeat N          loads the graph once and runs the selected mode N times,\n"
+          "                        then prints the minimum, median and 95th percentile\n"
+          "                        of the running time of each phase to stderr. The\n"
+          "                        results are discarded in every repetition, so only\n"
+          "                        the calculation is timed, unless --keep-output is\n"
+          "                        given.\n"
+          "    --warmup K          runs the selected mode K more times before the\n"
+          "                        measured repetitions of --repeat. Default: 0.\n"
+          "    --keep-output       writes the results of the last measured repetition of\n"
+          "                        --repeat; the times of that repetition include the\n"
+          "                        writing.\n"
+          "    --discard-output    discards the results instead of writing them.\n"
           "\n"
           "Input/output format:\n"
           "    -f, --input-format  specifies the input format for reading graphs.\n"
-          "                        Supported formats: auto, edgelist, gml, graphml, lgl, ncol\n"
+          "                        Supported formats: auto, edgelist, gml, graphml, lgl, ncol,\n"
+          "                        matrix, matrix_f32, matrix_u8, mtx, csv, tsv.\n"
           "                        Default: auto, except when the input file comes from\n"
           "                        stdin; in this case, edgelist is used.\n"
+          "    --threshold X       entries of dense adjacency matrices whose absolute value\n"
+          "                        is not larger than X are not edges. Default: 0.\n"
+          "    --source-column C   column of CSV and TSV edge tables holding the source\n"
+          "                        vertices, given by its index (starting from 1) or by\n"
+          "                        its name in the header. Default: 1.\n"
+          "    --target-column C   column of edge tables holding the target vertices.\n"
+          "                        Default: 2.\n"
+          "    --weight-column C   column of edge tables holding the edge weights.\n"
+          "                        Default: none.\n"
+          "    --delimiter CHAR    character separating the fields of edge tables; use\n"
+          "                        'tab' for tabs. Default: comma for CSV, tab for TSV.\n"
+          "    --quote CHAR        character around quoted fields of edge tables; use\n"
+          "                        'none' to disable quoting. Default: \".\n"
+          "    --no-header         the first line of edge tables is an edge, not a header.\n"
           "    -F, --output-format specifies the output format for writing graphs. Used only\n"
           "                        when mode = graph. Supported formats: gml, graphml.\n"
           "                        Default: gml.\n";
@@ -11,13 +11,15 @@
 
 /// Possible model types handled by the application
 typedef enum {
-    LIU_MODEL, SWITCHBOARD_MODEL
+    LIU_MODEL, SWITCHBOARD_MODEL, EXACT_MODEL, DOMINATING_SET_MODEL,
+    ZERO_FORCING_MODEL
 } ModelType;
 
 /// Possible operation modes for the application
 typedef enum {
     MODE_DRIVER_NODES, MODE_STATISTICS, MODE_SIGNIFICANCE,
-    MODE_CONTROL_PATHS, MODE_GRAPH
+    MODE_CONTROL_PATHS, MODE_GRAPH, MODE_EGO, MODE_COMMUNITIES,
+    MODE_STRUCTURAL_RANK, MODE_UPDATES, MODE_ENERGY, MODE_VERIFY_INPUTS
 } OperationMode;
 
 /// Parses the command line arguments of the main app
@@ -59,6 +61,49 @@ public:
     /// Flag to denote whether we are using the edge-based measure for SBD
     bool useEdgeMeasure;
 
+    /// Number of worker processes to use; zero means one per CPU core
+    int numJobs;
+
+    /// Time budget of the heuristic searches of some models, in seconds
+    double timeBudget;
+
+    /// Number of randomized restarts in the zero forcing model
+    long int numRestarts;
+
+    /// Radius of the ego networks in the ego mode
+    long int egoRadius;
+
+    /// Name of the file that assigns the vertices to communities in the
+    /// communities mode
+    std::string membershipFile;
+
+    /// Name of the file holding the matching that the Liu model should start
+    /// from; empty if it should start from scratch
+    std::string loadMatchingFile;
+
+    /// Name of the file where the matching found by the Liu model should be
+    /// saved; empty if it should not be saved
+    std::string saveMatchingFile;
+
+    /// Name of the file holding the batches of edge updates in the updates
+    /// mode
+    std::string updatesFile;
+
+    /// Name of the file holding the candidate input sets in the input
+    /// verification mode
+    std::string inputsFile;
+
+    /// Largest number of time steps in the control energy estimates
+    long int energyHorizon;
+
+    /// Number of threads querying snapshots of the results in the updates
+    /// mode while the updates are applied; zero if there are no queries
+    int numQueryThreads;
+
+    /// Whether the snapshots of the updates mode contain the edge classes
+    /// and the control paths besides the driver nodes
+    bool fullSnapshots;
+
     /***************************/
     /* Input/output parameters */
     /***************************/
@@ -69,6 +114,27 @@ public:
     /// Output format for writing graphs
     GraphFormat outputFormat;
 
+    /// Options of the graph readers
+    GraphReaderOptions readerOptions;
+
+    /// Name of the file where the profile should be written; empty if no
+    /// profiling is needed
+    std::string profileFile;
+
+    /// Number of measured repetitions of the selected mode; zero if the mode
+    /// should simply be run once without measuring it
+    long int numRepeats;
+
+    /// Number of repetitions of the selected mode before the measured ones
+    long int numWarmups;
+
+    /// Whether the last measured repetition should write its results; the
+    /// results of the other repetitions are always discarded
+    bool keepOutput;
+
+    /// Whether the results should be discarded instead of being written
+    bool discardOutput;
+
 public:
 	/// Constructor
 	CommandLineArguments(const std::string programName = "netctrl",
@@ -0,0 +1,492 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <igraph/cpp/edge.h>
+#include <igraph/cpp/vertex.h>
+#include <netctrl/util/parallel.h>
+#include "edge_table_reader.h"
+#include "number_parser.h"
+
+using namespace igraph;
+using namespace netctrl;
+
+namespace {
+
+/// A field of a table, without the quotes around it
+struct Field {
+    const char* data;
+    size_t size;
+
+    Field() : data(0), size(0) {}
+    Field(const char* data_, size_t size_) : data(data_), size(size_) {}
+
+    std::string str() const {
+        return std::string(data, size);
+    }
+};
+
+/// Mixes the bits of a hash value; this is a bijection of 64-bit integers
+inline uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/// Hashes the contents of a field with FNV-1a
+inline uint64_t hashField(const Field& field) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < field.size; i++) {
+        hash ^= static_cast<unsigned char>(field.data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return mixHash(hash);
+}
+
+/// The edges found in a chunk of lines of a table
+struct TableChunk {
+    /// The source and target fields of the edges, interleaved
+    std::vector<Field> endpoints;
+
+    /// The hashes of the endpoints
+    std::vector<uint64_t> hashes;
+
+    /// The weights of the edges; empty if there is no weight column
+    std::vector<double> weights;
+
+    /// Unescaped copies of the quoted fields that contained doubled quotes
+    std::deque<std::string> unescaped;
+
+    /// Whether every endpoint is a non-negative integer
+    bool integers;
+
+    TableChunk() : endpoints(), hashes(), weights(), unescaped(), integers(true) {}
+};
+
+/// Returns the end of the line that starts at the given position
+inline const char* lineEndOf(const char* p, const char* end) {
+    const char* result = static_cast<const char*>(memchr(p, '\n', end - p));
+    return result ? result : end;
+}
+
+/// Throws an exception about an invalid line of a table
+void invalidLine(const char* what, const char* begin, const char* end) {
+    std::ostringstream oss;
+    oss << what << ": " << std::string(begin, std::min(end, begin + 80));
+    throw std::runtime_error(oss.str());
+}
+
+/// Scans the field that starts at the given position
+/**
+ * \param  p          the first character of the field
+ * \param  lineEnd    the end of the line, without the line break
+ * \param  delimiter  the character separating the fields
+ * \param  quote      the quote character; zero if fields are never quoted
+ * \param  field      the contents of the field are returned here
+ * \param  escaped    whether the field contains doubled quotes is returned here
+ * \return the position of the delimiter after the field, or the end of the line
+ */
+inline const char* scanField(const char* p, const char* lineEnd, char delimiter,
+        char quote, Field& field, bool& escaped) {
+    const char* next;
+
+    escaped = false;
+    if (!quote || p == lineEnd || *p != quote) {
+        next = static_cast<const char*>(memchr(p, delimiter, lineEnd - p));
+        if (next == 0)
+            next = lineEnd;
+        field = Field(p, next - p);
+        return next;
+    }
+
+    const char* start = ++p;
+    for (;;) {
+        p = static_cast<const char*>(memchr(p, quote, lineEnd - p));
+        if (p == 0)
+            invalidLine("unterminated quoted field", start - 1, lineEnd);
+        if (p + 1 == lineEnd || p[1] != quote)
+            break;
+        escaped = true;
+        p += 2;
+    }
+    field = Field(start, p - start);
+
+    // Anything between the closing quote and the delimiter is ignored
+    next = static_cast<const char*>(memchr(p, delimiter, lineEnd - p));
+    return next ? next : lineEnd;
+}
+
+/// Replaces the doubled quotes in a field by single ones
+std::string unescape(const Field& field, char quote) {
+    std::string result;
+    size_t i;
+
+    result.reserve(field.size);
+    for (i = 0; i < field.size; i++) {
+        result.push_back(field.data[i]);
+        if (field.data[i] == quote)
+            i++;
+    }
+
+    return result;
+}
+
+/// Converts a field to an integer if it is written in canonical form
+/**
+ * \return \c true if the field is a non-negative integer without leading
+ *         zeros
+ */
+inline bool canonicalInteger(const Field& field, long int* value) {
+    if (field.size > 1 && field.data[0] == '0')
+        return false;
+    return parseNonNegativeInteger(field.data, field.data + field.size, value);
+}
+
+/// Finds the index of a column from its one-based index or its name
+long int findColumn(const std::string& column, const std::vector<std::string>& header,
+        bool hasHeader) {
+    long int index;
+
+    if (parseNonNegativeInteger(column.data(), column.data() + column.size(), &index)) {
+        if (index < 1)
+            throw std::runtime_error("column indices start from 1");
+        return index - 1;
+    }
+
+    if (!hasHeader) {
+        throw std::runtime_error("column " + column +
+                " is selected by name but the table has no header");
+    }
+
+    std::vector<std::string>::const_iterator it =
+        std::find(header.begin(), header.end(), column);
+    if (it == header.end())
+        throw std::runtime_error("no such column in the header: " + column);
+
+    return it - header.begin();
+}
+
+/// Tokenizes the lines of a chunk of a table
+void tokenizeChunk(const char* p, const char* end, char delimiter, char quote,
+        const long int columns[3], TableChunk& chunk) {
+    const long int lastColumn = std::max(columns[0], std::max(columns[1], columns[2]));
+    const char *lineEnd, *next, *q;
+    long int column, value;
+    double weight;
+    Field field;
+    bool escaped;
+
+    for (; p < end; p = next) {
+        lineEnd = lineEndOf(p, end);
+        next = lineEnd + 1;
+        if (lineEnd != p && lineEnd[-1] == '\r')
+            --lineEnd;
+        if (lineEnd == p)
+            continue;
+
+        for (column = 0, q = p; column <= lastColumn; column++) {
+            if (column > 0) {
+                if (q == lineEnd)
+                    invalidLine("missing columns in line", p, lineEnd);
+                ++q;
+            }
+            q = scanField(q, lineEnd, delimiter, quote, field, escaped);
+
+            if (column == columns[0] || column == columns[1]) {
+                if (escaped) {
+                    chunk.unescaped.push_back(unescape(field, quote));
+                    field = Field(chunk.unescaped.back().data(),
+                            chunk.unescaped.back().size());
+                }
+                if (column == columns[0]) {
+                    chunk.endpoints.push_back(field);
+                    chunk.hashes.push_back(hashField(field));
+                }
+                if (column == columns[1]) {
+                    chunk.endpoints.push_back(field);
+                    chunk.hashes.push_back(hashField(field));
+                }
+                if (chunk.integers && !canonicalInteger(field, &value))
+                    chunk.integers = false;
+            }
+            if (column == columns[2]) {
+                if (!parseDouble(field.data, field.data + field.size, &weight))
+                    invalidLine("invalid weight in line", p, lineEnd);
+                chunk.weights.push_back(weight);
+            }
+        }
+
+        // The source must come before the target even if its column is later
+        if (columns[0] > columns[1]) {
+            std::iter_swap(chunk.endpoints.end() - 2, chunk.endpoints.end() - 1);
+            std::iter_swap(chunk.hashes.end() - 2, chunk.hashes.end() - 1);
+        }
+    }
+}
+
+/// The number of high bits of the hashes that select the shard of an endpoint
+const int SHARD_BITS = 6;
+
+/// Numbers the distinct endpoints of a shard in the order of their appearance
+/**
+ * Uses an open addressing hash table with linear probing that stores the
+ * local IDs of the distinct endpoints.
+ *
+ * \param  hashes     the hashes of all the endpoints
+ * \param  positions  the positions of the endpoints of the shard, in order
+ * \param  count      the number of endpoints in the shard
+ * \param  same       predicate that tells whether the endpoints at two
+ *                    positions with the same hash are equal
+ * \param  localIds   the local ID of each endpoint of the shard is returned
+ *                    here, at its position
+ * \param  isFirst    the positions where the endpoints of the shard appear
+ *                    first are marked here
+ * \return the number of distinct endpoints in the shard
+ */
+template <typename Same>
+long int internShard(const std::vector<uint64_t>& hashes, const long int* positions,
+        long int count, Same same, std::vector<long int>& localIds,
+        std::vector<char>& isFirst) {
+    std::vector<long int> slots(16, -1), keyPositions;
+    uint64_t mask = slots.size() - 1;
+    long int i, j;
+
+    for (i = 0; i < count; i++) {
+        long int position = positions[i];
+        uint64_t hash = hashes[position], slot;
+
+        for (slot = hash & mask; slots[slot] >= 0; slot = (slot + 1) & mask) {
+            long int other = keyPositions[slots[slot]];
+            if (hashes[other] == hash && same(other, position))
+                break;
+        }
+
+        if (slots[slot] < 0) {
+            slots[slot] = keyPositions.size();
+            keyPositions.push_back(position);
+            isFirst[position] = 1;
+
+            // Keeping the load factor below one half
+            if (2 * keyPositions.size() > slots.size()) {
+                slots.assign(2 * slots.size(), -1);
+                mask = slots.size() - 1;
+                for (j = 0; j < static_cast<long int>(keyPositions.size()); j++) {
+                    for (slot = hashes[keyPositions[j]] & mask; slots[slot] >= 0;
+                            slot = (slot + 1) & mask)
+                        ;
+                    slots[slot] = j;
+                }
+            }
+
+            localIds[position] = keyPositions.size() - 1;
+        } else {
+            localIds[position] = slots[slot];
+        }
+    }
+
+    return keyPositions.size();
+}
+
+/// Numbers the distinct endpoints of a table in the order of their first appearance
+/**
+ * The endpoints are distributed among shards by the high bits of their
+ * hashes with a stable counting sort, and the shards are interned in
+ * parallel. The first appearances are then numbered in the order of the
+ * table, so the result does not depend on the number of threads.
+ *
+ * \param  hashes        the hashes of the endpoints
+ * \param  same          predicate that tells whether the endpoints at two
+ *                       positions with the same hash are equal
+ * \param  ids           the vertex ID of each endpoint is returned here
+ * \param  keyPositions  the position of the first appearance of each vertex
+ *                       is returned here
+ */
+template <typename Same>
+void internEndpoints(const std::vector<uint64_t>& hashes, Same same, VectorInt& ids,
+        std::vector<long int>& keyPositions) {
+    const long int numShards = 1L << SHARD_BITS, blockSize = 1L << 16;
+    const long int count = hashes.size(), numBlocks = (count + blockSize - 1) / blockSize;
+    std::vector<long int> blockCounts(numBlocks * numShards, 0), shardOffsets(numShards + 1);
+    std::vector<long int> positions(count), localIds(count), firstCounts(numBlocks + 1, 0);
+    std::vector<std::vector<long int> > shardIds(numShards);
+    std::vector<char> isFirst(count, 0);
+    long int b, s, total;
+
+    // Stable counting sort of the positions by shard
+    parallelFor(0, numBlocks, [&](long int block) {
+        long int k, end = std::min(count, (block + 1) * blockSize);
+        for (k = block * blockSize; k < end; k++)
+            blockCounts[block * numShards + (hashes[k] >> (64 - SHARD_BITS))]++;
+    });
+    for (s = 0, total = 0; s < numShards; s++) {
+        shardOffsets[s] = total;
+        for (b = 0; b < numBlocks; b++) {
+            long int blockCount = blockCounts[b * numShards + s];
+            blockCounts[b * numShards + s] = total;
+            total += blockCount;
+        }
+    }
+    shardOffsets[numShards] = total;
+    parallelFor(0, numBlocks, [&](long int block) {
+        long int k, end = std::min(count, (block + 1) * blockSize);
+        long int* cursors = &blockCounts[block * numShards];
+        for (k = block * blockSize; k < end; k++)
+            positions[cursors[hashes[k] >> (64 - SHARD_BITS)]++] = k;
+    });
+
+    parallelFor(0, numShards, [&](long int shard) {
+        long int keys = internShard(hashes, &positions[0] + shardOffsets[shard],
+                shardOffsets[shard + 1] - shardOffsets[shard], same, localIds, isFirst);
+        shardIds[shard].resize(keys);
+    });
+
+    // Numbering the first appearances in the order of the table
+    parallelFor(0, numBlocks, [&](long int block) {
+        long int k, end = std::min(count, (block + 1) * blockSize);
+        for (k = block * blockSize; k < end; k++)
+            firstCounts[block + 1] += isFirst[k];
+    });
+    for (b = 0; b < numBlocks; b++)
+        firstCounts[b + 1] += firstCounts[b];
+
+    keyPositions.resize(firstCounts[numBlocks]);
+    ids.resize(count);
+    parallelFor(0, numBlocks, [&](long int block) {
+        long int k, id = firstCounts[block], end = std::min(count, (block + 1) * blockSize);
+        for (k = block * blockSize; k < end; k++) {
+            if (isFirst[k]) {
+                shardIds[hashes[k] >> (64 - SHARD_BITS)][localIds[k]] = id;
+                keyPositions[id++] = k;
+            }
+        }
+    });
+    parallelFor(0, numBlocks, [&](long int block) {
+        long int k, end = std::min(count, (block + 1) * blockSize);
+        for (k = block * blockSize; k < end; k++)
+            ids[k] = shardIds[hashes[k] >> (64 - SHARD_BITS)][localIds[k]];
+    });
+}
+
+}          // end of anonymous namespace
+
+Graph readEdgeTable(const MappedFile& file, char delimiter,
+        const GraphReaderOptions& options, bool directed) {
+    const char *p = file.data(), *end = file.end(), *lineEnd, *q;
+    const char quote = options.quote;
+    std::vector<std::string> header;
+    long int i, n, numChunks, columns[3];
+    bool integers = true, escaped, weighted = false;
+    Field field;
+    VectorInt edges;
+
+    if (options.delimiter)
+        delimiter = options.delimiter;
+
+    // The header is the first non-empty line
+    lineEnd = p;
+    if (options.header) {
+        for (; p < end; p = lineEnd + 1) {
+            lineEnd = lineEndOf(p, end);
+            q = lineEnd;
+            if (lineEnd != p && lineEnd[-1] == '\r')
+                --lineEnd;
+            if (lineEnd == p)
+                continue;
+
+            for (; ; ++p) {
+                p = scanField(p, lineEnd, delimiter, quote, field, escaped);
+                header.push_back(escaped ? unescape(field, quote) : field.str());
+                if (p == lineEnd)
+                    break;
+            }
+            lineEnd = q;
+            break;
+        }
+        p = std::min(end, lineEnd + 1);
+    }
+
+    columns[0] = findColumn(options.sourceColumn, header, options.header);
+    columns[1] = findColumn(options.targetColumn, header, options.header);
+    columns[2] = options.weightColumn.empty() ? -1 :
+        findColumn(options.weightColumn, header, options.header);
+
+    // The lines are split into chunks of about 4 MB at line boundaries
+    numChunks = p < end ? std::max(1L, static_cast<long int>((end - p) >> 22)) : 0;
+    std::vector<const char*> boundaries(numChunks + 1, end);
+    for (i = 0; i < numChunks; i++) {
+        q = p + (end - p) / numChunks * i;
+        if (i > 0)
+            q = std::max(boundaries[i-1], std::min(end, lineEndOf(q, end) + 1));
+        boundaries[i] = q;
+    }
+
+    std::vector<TableChunk> chunks(numChunks);
+    parallelFor(0, numChunks, [&](long int index) {
+        tokenizeChunk(boundaries[index], boundaries[index + 1], delimiter, quote,
+                columns, chunks[index]);
+    });
+    // Concatenating the chunks
+    std::vector<long int> offsets(numChunks + 1, 0), keyPositions;
+    for (i = 0; i < numChunks; i++) {
+        offsets[i + 1] = offsets[i] + chunks[i].endpoints.size();
+        integers = integers && chunks[i].integers;
+        weighted = weighted || std::find_if(chunks[i].weights.begin(),
+                chunks[i].weights.end(),
+                [](double weight) { return weight != 1; }) != chunks[i].weights.end();
+    }
+
+    std::vector<Field> endpoints(offsets[numChunks]);
+    std::vector<uint64_t> hashes(offsets[numChunks]);
+    parallelFor(0, numChunks, [&](long int index) {
+        const TableChunk& chunk = chunks[index];
+        long int j, k = offsets[index], count = chunk.endpoints.size();
+
+        for (j = 0; j < count; j++, k++) {
+            endpoints[k] = chunk.endpoints[j];
+            if (integers) {
+                // The hashes of integers are their mixed values, so equal
+                // hashes mean equal integers and the fields are not compared
+                long int value;
+                canonicalInteger(chunk.endpoints[j], &value);
+                hashes[k] = mixHash(value);
+            } else {
+                hashes[k] = chunk.hashes[j];
+            }
+        }
+    });
+
+    if (integers) {
+        internEndpoints(hashes, [](long int, long int) { return true; }, edges, keyPositions);
+    } else {
+        internEndpoints(hashes, [&](long int a, long int b) {
+            return endpoints[a].size == endpoints[b].size &&
+                memcmp(endpoints[a].data, endpoints[b].data, endpoints[a].size) == 0;
+        }, edges, keyPositions);
+    }
+
+    n = keyPositions.size();
+    Graph result(n, directed);
+    result.addEdges(edges);
+    for (i = 0; i < n; i++)
+        result.vertex(i).setAttribute("name", endpoints[keyPositions[i]].str());
+
+    if (weighted) {
+        long int k = 0;
+        for (i = 0; i < numChunks; i++) {
+            std::vector<double>::const_iterator it;
+            for (it = chunks[i].weights.begin(); it != chunks[i].weights.end(); ++it, ++k)
+                result.edge(k).setAttribute("weight", *it);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,43 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _EDGE_TABLE_READER_H
+#define _EDGE_TABLE_READER_H
+
+#include <igraph/cpp/graph.h>
+#include "graph_util.h"
+#include "mapped_file.h"
+
+/**
+ * \brief Reads a graph from a delimited table with one edge per line.
+ *
+ * The source, target and (optionally) weight columns are selected in the
+ * options, either by their one-based index or by their name in the header.
+ * Fields may be enclosed in quotes, with doubled quotes standing for a quote
+ * inside the field; quoted fields may contain delimiters but not line
+ * breaks. Empty lines are ignored.
+ *
+ * The vertices are numbered in the order of their first appearance and
+ * their names are stored in the \c name vertex attribute. If every source
+ * and target is a non-negative integer without leading zeros, the vertices
+ * are told apart by their numeric value, so the names never have to be
+ * compared. If any edge has a weight different from 1, the weights are
+ * stored in the \c weight edge attribute.
+ *
+ * The table is split into chunks of lines that are tokenized in parallel on
+ * the threads of the library. The tokenizer only records the selected
+ * columns; the others are skipped without copying, and the rest of the line
+ * is skipped after the last selected column. The names are then interned in
+ * parallel in shards selected by their hashes.
+ *
+ * \param  file       the contents of the file
+ * \param  delimiter  the character separating the fields, unless the options
+ *                    specify another one
+ * \param  options    the columns to use, header handling and quoting
+ * \param  directed   whether the graph is directed
+ * \throws std::runtime_error if the table is malformed or a column does not
+ *         exist
+ */
+igraph::Graph readEdgeTable(const MappedFile& file, char delimiter,
+        const GraphReaderOptions& options, bool directed);
+
+#endif       // _EDGE_TABLE_READER_H
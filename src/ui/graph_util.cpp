@@ -3,7 +3,11 @@
 #include <algorithm>
 #include <sstream>
 #include <igraph/cpp/io.h>
+#include "edge_table_reader.h"
 #include "graph_util.h"
+#include "mapped_file.h"
+#include "matrix_market.h"
+#include "matrix_reader.h"
 
 using namespace std;
 using namespace igraph;
@@ -19,6 +23,18 @@ GraphFormat GraphUtil::formatFromString(const std::string& str) {
         return GRAPH_FORMAT_GRAPHML;
     else if (str == "gml")
         return GRAPH_FORMAT_GML;
+    else if (str == "matrix")
+        return GRAPH_FORMAT_MATRIX;
+    else if (str == "matrix_f32")
+        return GRAPH_FORMAT_MATRIX_FLOAT32;
+    else if (str == "matrix_u8")
+        return GRAPH_FORMAT_MATRIX_UINT8;
+    else if (str == "mtx" || str == "matrixmarket")
+        return GRAPH_FORMAT_MATRIX_MARKET;
+    else if (str == "csv")
+        return GRAPH_FORMAT_CSV;
+    else if (str == "tsv")
+        return GRAPH_FORMAT_TSV;
     else
         return GRAPH_FORMAT_UNKNOWN;
 }
@@ -41,11 +57,24 @@ GraphFormat GraphUtil::detectFormat(const string& filename) {
         return GRAPH_FORMAT_EDGELIST;
     if (extension == "graphml")
         return GRAPH_FORMAT_GRAPHML;
+    if (extension == "matrix" || extension == "adj")
+        return GRAPH_FORMAT_MATRIX;
+    if (extension == "f32")
+        return GRAPH_FORMAT_MATRIX_FLOAT32;
+    if (extension == "u8")
+        return GRAPH_FORMAT_MATRIX_UINT8;
+    if (extension == "mtx")
+        return GRAPH_FORMAT_MATRIX_MARKET;
+    if (extension == "csv")
+        return GRAPH_FORMAT_CSV;
+    if (extension == "tsv" || extension == "tab")
+        return GRAPH_FORMAT_TSV;
 
     return GRAPH_FORMAT_UNKNOWN;
 }
 
-Graph GraphUtil::readGraph(const string& filename, GraphFormat format, bool directed) {
+Graph GraphUtil::readGraph(const string& filename, GraphFormat format, bool directed,
+        const GraphReaderOptions& options) {
     if (format == GRAPH_FORMAT_AUTO || format == GRAPH_FORMAT_UNKNOWN)
         format = GraphUtil::detectFormat(filename);
 
@@ -57,7 +86,7 @@ Graph GraphUtil::readGraph(const string& filename, GraphFormat format, bool dire
     }
 
     try {
-        Graph result = readGraph(fptr, format, directed);
+        Graph result = readGraph(fptr, format, directed, options);
         fclose(fptr);
         return result;
     } catch (const UnknownGraphFormatException& ex) {
@@ -65,7 +94,8 @@ Graph GraphUtil::readGraph(const string& filename, GraphFormat format, bool dire
     }
 }
 
-Graph GraphUtil::readGraph(FILE* fptr, GraphFormat format, bool directed) {
+Graph GraphUtil::readGraph(FILE* fptr, GraphFormat format, bool directed,
+        const GraphReaderOptions& options) {
     Graph result;
 
     switch (format) {
@@ -89,6 +119,33 @@ Graph GraphUtil::readGraph(FILE* fptr, GraphFormat format, bool directed) {
             result = read_gml(fptr);
             break;
 
+        case GRAPH_FORMAT_MATRIX:
+            result = readDenseMatrix(MappedFile(fptr), MATRIX_TEXT,
+                    options.threshold, directed);
+            break;
+
+        case GRAPH_FORMAT_MATRIX_FLOAT32:
+            result = readDenseMatrix(MappedFile(fptr), MATRIX_FLOAT32,
+                    options.threshold, directed);
+            break;
+
+        case GRAPH_FORMAT_MATRIX_UINT8:
+            result = readDenseMatrix(MappedFile(fptr), MATRIX_UINT8,
+                    options.threshold, directed);
+            break;
+
+        case GRAPH_FORMAT_MATRIX_MARKET:
+            result = readMatrixMarketGraph(MappedFile(fptr), directed);
+            break;
+
+        case GRAPH_FORMAT_CSV:
+            result = readEdgeTable(MappedFile(fptr), ',', options, directed);
+            break;
+
+        case GRAPH_FORMAT_TSV:
+            result = readEdgeTable(MappedFile(fptr), '\t', options, directed);
+            break;
+
         default:
             throw UnknownGraphFormatException();
     }
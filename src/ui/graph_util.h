@@ -4,6 +4,7 @@
 #define _GRAPH_UTIL_H
 
 #include <stdexcept>
+#include <string>
 #include <igraph/cpp/graph.h>
 
 /// Supported formats
@@ -14,9 +15,46 @@ typedef enum {
     GRAPH_FORMAT_NCOL,
     GRAPH_FORMAT_LGL,
     GRAPH_FORMAT_GRAPHML,
-    GRAPH_FORMAT_GML
+    GRAPH_FORMAT_GML,
+    GRAPH_FORMAT_MATRIX,
+    GRAPH_FORMAT_MATRIX_FLOAT32,
+    GRAPH_FORMAT_MATRIX_UINT8,
+    GRAPH_FORMAT_MATRIX_MARKET,
+    GRAPH_FORMAT_CSV,
+    GRAPH_FORMAT_TSV
 } GraphFormat;
 
+/// Options of the graph readers that are not stored in the files
+struct GraphReaderOptions {
+    /// Entries of adjacency matrices whose absolute value is not larger than
+    /// this are not edges
+    double threshold;
+
+    /// Column of edge tables holding the source vertices; either a one-based
+    /// index or a name from the header
+    std::string sourceColumn;
+
+    /// Column of edge tables holding the target vertices
+    std::string targetColumn;
+
+    /// Column of edge tables holding the weights; empty if there are none
+    std::string weightColumn;
+
+    /// Character separating the fields of edge tables; zero means the
+    /// default of the format (comma for CSV, tab for TSV)
+    char delimiter;
+
+    /// Character around quoted fields of edge tables; zero if fields are
+    /// never quoted
+    char quote;
+
+    /// Whether the first line of edge tables is a header
+    bool header;
+
+    GraphReaderOptions() : threshold(0.0), sourceColumn("1"), targetColumn("2"),
+        weightColumn(), delimiter(0), quote('"'), header(true) {}
+};
+
 /// Exception thrown when the format of a graph is unknown
 class UnknownGraphFormatException : public std::runtime_error {
 private:
@@ -39,11 +77,13 @@ public:
     /// Reads a graph without having to know what format it is in
     static igraph::Graph readGraph(const std::string& filename,
             GraphFormat format = GRAPH_FORMAT_AUTO,
-            bool directed = true);
+            bool directed = true,
+            const GraphReaderOptions& options = GraphReaderOptions());
 
     /// Reads a graph from the given stream using the given format
     static igraph::Graph readGraph(FILE* fptr, GraphFormat format,
-            bool directed = true);
+            bool directed = true,
+            const GraphReaderOptions& options = GraphReaderOptions());
 
     /// Writes a graph to the given stream using the given format
     static void writeGraph(FILE* fptr, const igraph::Graph& graph, GraphFormat format);
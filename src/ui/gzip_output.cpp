@@ -0,0 +1,251 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <zlib.h>
+
+#include "gzip_output.h"
+
+namespace {
+
+#if defined(__APPLE__) || defined(__FreeBSD__)
+int cookieWrite(void* cookie, const char* data, int size) {
+    GzipOutputBuffer* buffer = static_cast<GzipOutputBuffer*>(cookie);
+    return buffer->sputn(data, size) == size ? size : -1;
+}
+
+int cookieClose(void*) {
+    return 0;
+}
+#else
+ssize_t cookieWrite(void* cookie, const char* data, size_t size) {
+    GzipOutputBuffer* buffer = static_cast<GzipOutputBuffer*>(cookie);
+    return buffer->sputn(data, size) == static_cast<std::streamsize>(size) ? size : 0;
+}
+
+int cookieClose(void*) {
+    return 0;
+}
+#endif
+
+}          // end of anonymous namespace
+
+GzipOutputBuffer::GzipOutputBuffer(const std::string& filename, int numThreads,
+        int level, size_t blockSize) : std::streambuf(),
+    m_file(0), m_level(level), m_blockSize(blockSize > 0 ? blockSize : 1),
+    m_maxPendingBlocks(numThreads > 1 ? 2 * numThreads : 1), m_bytesWritten(0),
+    m_failed(false), m_closed(false), m_current(), m_pending(), m_queue(),
+    m_mutex(), m_blockQueued(), m_blockCompressed(), m_stopping(false),
+    m_workers() {
+    int i;
+
+    m_file = fopen(filename.c_str(), "wb");
+    if (m_file == 0)
+        throw std::runtime_error("cannot open output file for writing: " + filename);
+
+    m_current.reset(new Block);
+    m_current->input.resize(m_blockSize);
+    setp(&m_current->input[0], &m_current->input[0] + m_blockSize);
+
+    for (i = 0; numThreads > 1 && i < numThreads; i++)
+        m_workers.push_back(std::thread(&GzipOutputBuffer::workerMain, this));
+}
+
+GzipOutputBuffer::~GzipOutputBuffer() {
+    close();
+}
+
+bool GzipOutputBuffer::close() {
+    if (m_closed)
+        return !m_failed;
+
+    submitCurrentBlock();
+    if (m_bytesWritten == 0) {
+        // Write an empty member so the result is still a valid gzip file
+        std::shared_ptr<Block> block(new Block);
+        block->failed = !compressBlock(*block);
+        block->done = true;
+        m_pending.push_back(block);
+    }
+
+    while (!m_pending.empty())
+        writeFinishedBlocks(true);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_blockQueued.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++)
+        m_workers[i].join();
+    m_workers.clear();
+
+    if (fclose(m_file) != 0)
+        m_failed = true;
+    m_file = 0;
+
+    m_current.reset();
+    setp(0, 0);
+    m_closed = true;
+
+    return !m_failed;
+}
+
+bool GzipOutputBuffer::compressBlock(Block& block) const {
+    z_stream stream;
+    int retval;
+
+    memset(&stream, 0, sizeof(stream));
+
+    // 15 + 16 = 32K window with a gzip header and trailer
+    if (deflateInit2(&stream, m_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    block.output.resize(deflateBound(&stream, block.input.size()) + 32);
+    stream.next_in = reinterpret_cast<Bytef*>(block.input.empty() ? 0 : &block.input[0]);
+    stream.avail_in = block.input.size();
+    stream.next_out = reinterpret_cast<Bytef*>(&block.output[0]);
+    stream.avail_out = block.output.size();
+
+    retval = deflate(&stream, Z_FINISH);
+    block.output.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    // The input is not needed any more
+    std::vector<char>().swap(block.input);
+
+    return retval == Z_STREAM_END;
+}
+
+FILE* GzipOutputBuffer::openFile() {
+#if defined(__APPLE__) || defined(__FreeBSD__)
+    return funopen(this, 0, cookieWrite, 0, cookieClose);
+#else
+    cookie_io_functions_t functions;
+    functions.read = 0;
+    functions.write = cookieWrite;
+    functions.seek = 0;
+    functions.close = cookieClose;
+    return fopencookie(this, "w", functions);
+#endif
+}
+
+GzipOutputBuffer::int_type GzipOutputBuffer::overflow(int_type ch) {
+    if (m_closed || m_failed)
+        return traits_type::eof();
+
+    submitCurrentBlock();
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+
+    return m_failed ? traits_type::eof() : traits_type::not_eof(ch);
+}
+
+void GzipOutputBuffer::submitCurrentBlock() {
+    size_t size = pptr() - pbase();
+
+    if (m_current.get() == 0 || size == 0)
+        return;
+
+    m_current->input.resize(size);
+    m_bytesWritten += size;
+
+    if (m_workers.empty()) {
+        m_current->failed = !compressBlock(*m_current);
+        m_current->done = true;
+        m_pending.push_back(m_current);
+    } else {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending.push_back(m_current);
+            m_queue.push_back(m_current);
+        }
+        m_blockQueued.notify_one();
+    }
+
+    // Write whatever is ready, and wait if too many blocks are in flight
+    writeFinishedBlocks(m_pending.size() >= m_maxPendingBlocks);
+
+    m_current.reset(new Block);
+    m_current->input.resize(m_blockSize);
+    setp(&m_current->input[0], &m_current->input[0] + m_blockSize);
+}
+
+void GzipOutputBuffer::workerMain() {
+    std::shared_ptr<Block> block;
+    bool ok;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stopping && m_queue.empty())
+                m_blockQueued.wait(lock);
+            if (m_queue.empty())
+                return;
+            block = m_queue.front();
+            m_queue.pop_front();
+        }
+
+        ok = compressBlock(*block);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            block->failed = !ok;
+            block->done = true;
+        }
+        m_blockCompressed.notify_all();
+        block.reset();
+    }
+}
+
+void GzipOutputBuffer::writeFinishedBlocks(bool wait) {
+    std::shared_ptr<Block> block;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_pending.empty())
+                return;
+            block = m_pending.front();
+            if (!block->done && !wait)
+                return;
+            while (!block->done)
+                m_blockCompressed.wait(lock);
+            m_pending.pop_front();
+        }
+
+        if (block->failed)
+            m_failed = true;
+        else if (!block->output.empty() &&
+                fwrite(&block->output[0], 1, block->output.size(), m_file) != block->output.size())
+            m_failed = true;
+
+        wait = false;
+    }
+}
+
+std::streamsize GzipOutputBuffer::xsputn(const char* s, std::streamsize n) {
+    std::streamsize written = 0, chunk;
+
+    if (m_closed || m_failed)
+        return 0;
+
+    while (written < n) {
+        if (pptr() == epptr()) {
+            submitCurrentBlock();
+            if (m_failed)
+                break;
+        }
+
+        chunk = std::min<std::streamsize>(n - written, epptr() - pptr());
+        memcpy(pptr(), s + written, chunk);
+        pbump(chunk);
+        written += chunk;
+    }
+
+    return written;
+}
@@ -0,0 +1,140 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _GZIP_OUTPUT_H
+#define _GZIP_OUTPUT_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Stream buffer that writes gzip-compressed data using several threads
+/**
+ * The data is cut into blocks of fixed size and each block is compressed
+ * independently into a separate gzip member on a worker thread, like
+ * \c pigz does. The members are written to the output file in order; the
+ * concatenation of gzip members is a valid gzip file that any gzip
+ * decompressor can read.
+ *
+ * The buffer can be used by several \c std::ostream objects and C-style
+ * \c FILE objects (see \c openFile()) at the same time. Buffered data is
+ * written only when a block is full or when the buffer is closed.
+ */
+class GzipOutputBuffer : public std::streambuf {
+private:
+    /// A block of data in the compression pipeline
+    struct Block {
+        std::vector<char> input;
+        std::vector<char> output;
+        bool done;
+        bool failed;
+
+        Block() : input(), output(), done(false), failed(false) {}
+    };
+
+    /// The file where the compressed data is written
+    FILE* m_file;
+
+    /// Compression level
+    int m_level;
+
+    /// Size of the uncompressed blocks
+    size_t m_blockSize;
+
+    /// Maximum number of blocks being compressed or waiting to be written
+    size_t m_maxPendingBlocks;
+
+    /// Number of bytes written so far; used to emit an empty member at the end
+    size_t m_bytesWritten;
+
+    /// Whether an error happened while compressing or writing
+    bool m_failed;
+
+    /// Whether the buffer has been closed already
+    bool m_closed;
+
+    /// The block being filled by the stream
+    std::shared_ptr<Block> m_current;
+
+    /// Blocks submitted for compression, in the order of writing
+    std::deque<std::shared_ptr<Block> > m_pending;
+
+    /// Blocks that are not taken by a worker thread yet
+    std::deque<std::shared_ptr<Block> > m_queue;
+
+    /// Mutex guarding the queue and the state of the blocks
+    std::mutex m_mutex;
+
+    /// Condition variable signalled when a block is added to the queue
+    std::condition_variable m_blockQueued;
+
+    /// Condition variable signalled when a block is compressed
+    std::condition_variable m_blockCompressed;
+
+    /// Whether the worker threads should exit
+    bool m_stopping;
+
+    /// The worker threads
+    std::vector<std::thread> m_workers;
+
+    /// Copying is not allowed
+    GzipOutputBuffer(const GzipOutputBuffer&);
+    GzipOutputBuffer& operator=(const GzipOutputBuffer&);
+
+public:
+    /// Opens the given file for writing compressed data into it
+    /**
+     * \param  filename    name of the file to write
+     * \param  numThreads  number of compression threads; zero or one means
+     *                     that the blocks are compressed on the calling thread
+     * \param  level       the zlib compression level
+     * \param  blockSize   size of the uncompressed blocks
+     * \throws std::runtime_error if the file cannot be opened
+     */
+    explicit GzipOutputBuffer(const std::string& filename, int numThreads = 1,
+            int level = 6, size_t blockSize = 1 << 20);
+
+    /// Closes the buffer if it was not closed yet
+    virtual ~GzipOutputBuffer();
+
+    /// Compresses and writes all remaining data and closes the file
+    /**
+     * \return \c true if all the data was written successfully
+     */
+    bool close();
+
+    /// Returns a C-style file object that writes into this buffer
+    /**
+     * The file object must be closed with \c fclose() before the buffer
+     * itself is closed; closing the file object does not close the buffer.
+     */
+    FILE* openFile();
+
+protected:
+    virtual int_type overflow(int_type ch);
+    virtual std::streamsize xsputn(const char* s, std::streamsize n);
+
+private:
+    /// Compresses a single block into a standalone gzip member
+    bool compressBlock(Block& block) const;
+
+    /// Submits the current block for compression and starts a new one
+    void submitCurrentBlock();
+
+    /// Writes the compressed blocks at the front of the pending queue
+    /**
+     * \param  wait  whether to wait for the first block if it is not
+     *               compressed yet
+     */
+    void writeFinishedBlocks(bool wait);
+
+    /// Body of the worker threads
+    void workerMain();
+};
+
+#endif       // _GZIP_OUTPUT_H
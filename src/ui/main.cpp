@@ -1,20 +1,42 @@
 /* vim:set ts=4 sw=4 sts=4 et: */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <fstream>
+#include <map>
 #include <memory>
 #include <sstream>
+#include <thread>
+#include <unordered_map>
 #include <igraph/cpp/graph.h>
 #include <igraph/cpp/edge.h>
 #include <igraph/cpp/vertex.h>
 #include <igraph/cpp/vertex_selector.h>
 #include <igraph/cpp/generators/degree_sequence.h>
 #include <igraph/cpp/generators/erdos_renyi.h>
+#include <netctrl/kernel/communities.h>
+#include <netctrl/kernel/ego.h>
+#include <netctrl/kernel/input_sets.h>
+#include <netctrl/kernel/matching.h>
 #include <netctrl/model.h>
+#include <netctrl/util/adjacency_view.h>
+#include <netctrl/util/cpu.h>
+#include <netctrl/util/csr_graph.h>
+#include <netctrl/util/parallel.h>
+#include <netctrl/util/profiler.h>
 
 #include "cmd_arguments.h"
 #include "graph_util.h"
+#ifdef NETCTRL_HAVE_ZLIB
+#  include "gzip_output.h"
+#endif
 #include "logging.h"
+#include "mapped_file.h"
+#include "matrix_market.h"
+#include "worker_pool.h"
 
 using namespace igraph;
 using namespace netctrl;
@@ -37,6 +59,313 @@ std::vector<std::string> split(const std::string& s, char delim) {
     return split(s, delim, elems);
 }
 
+/// Helper function to calculate the mean of a vector
+/**
+ * When \c stride is larger than one, the vector is treated as a table with
+ * \c stride columns stored row by row, and the mean of the given column is
+ * calculated.
+ */
+double mean(const std::vector<double>& values, size_t column = 0, size_t stride = 1) {
+    size_t i, count = 0;
+    double sum = 0.0;
+    for (i = column; i < values.size(); i += stride, count++)
+        sum += values[i];
+    return count == 0 ? 0.0 : sum / count;
+}
+
+/// Returns the given percentile of a sorted vector using the nearest-rank method
+double percentile(const std::vector<double>& sortedValues, double percent) {
+    size_t rank;
+    if (sortedValues.empty())
+        return 0.0;
+    rank = static_cast<size_t>(std::ceil(percent / 100.0 * sortedValues.size()));
+    return sortedValues[rank > 0 ? rank - 1 : 0];
+}
+
+/// Stream buffer that throws away everything that is written into it
+class NullOutputBuffer : public std::streambuf {
+protected:
+    int overflow(int ch) {
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) {
+        return count;
+    }
+};
+
+/// The edge classes in the order in which their counts are reported
+const EdgeClass reportedEdgeClasses[] = {
+    EDGE_DISTINGUISHED, EDGE_REDUNDANT, EDGE_ORDINARY, EDGE_CRITICAL
+};
+
+/// The number of elements in \c reportedEdgeClasses
+const size_t numReportedEdgeClasses = sizeof(reportedEdgeClasses) / sizeof(EdgeClass);
+
+/// Converts edge class counts to fractions in the order of \c reportedEdgeClasses
+void edgeClassFractions(const std::vector<long int>& counts, long int numEdges,
+        double* fractions) {
+    for (size_t i = 0; i < numReportedEdgeClasses; i++) {
+        fractions[i] = numEdges > 0 ?
+            counts[reportedEdgeClasses[i]] / static_cast<double>(numEdges) : 0.0;
+    }
+}
+
+/// The number of fractions in a control profile
+const size_t numControlProfileFractions = 3;
+
+/// Stores the fractions of a control profile in the order in which they are
+/// reported: sources, external dilations, internal dilations
+void controlProfileFractions(const ControlProfile& profile, double* fractions) {
+    fractions[0] = profile.sourceFraction();
+    fractions[1] = profile.externalDilationFraction();
+    fractions[2] = profile.internalDilationFraction();
+}
+
+/// Trials of a null model in the significance calculation mode
+/**
+ * Each trial measures the controllability of a randomized graph and,
+ * optionally, the fractions of its edges in each edge class, in the order
+ * of \c reportedEdgeClasses, and the control profile of the Liu model. The
+ * edges are only counted per class, the class of each edge is never stored.
+ * The random number generator of igraph is re-seeded before each trial from
+ * a base seed and the index of the trial, so the results do not depend on
+ * how the trials are distributed among the worker processes. The degree
+ * sequences of the observed graph are kept in shared memory so the workers
+ * do not need private copies of them.
+ */
+class NullModelTrials : public TrialTask {
+public:
+    /// Null models supported by the trials
+    typedef enum {
+        ERDOS_RENYI, CONFIGURATION, CONFIGURATION_NO_JOINT
+    } NullModel;
+
+private:
+    /// The model whose controllability is measured on the randomized graphs
+    ControllabilityModel* m_pModel;
+
+    /// The null model to use
+    NullModel m_nullModel;
+
+    /// Whether the fractions of the edge classes are measured as well
+    bool m_edgeClasses;
+
+    /// Whether the control profile is measured as well; the model must be
+    /// a \c LiuControllabilityModel
+    bool m_controlProfile;
+
+    /// The number of vertices of the observed graph
+    long int m_numNodes;
+
+    /// The number of edges of the observed graph
+    long int m_numEdges;
+
+    /// Whether the observed graph is directed
+    bool m_directed;
+
+    /// The out-degrees of the observed graph
+    SharedArray<integer_t> m_outDegrees;
+
+    /// The in-degrees of the observed graph
+    SharedArray<integer_t> m_inDegrees;
+
+    /// The seed from which the seeds of the individual trials are derived
+    unsigned long int m_baseSeed;
+
+public:
+    /// Prepares the trials for the given model and its current graph
+    NullModelTrials(ControllabilityModel* pModel, NullModel nullModel,
+            bool edgeClasses = false, bool controlProfile = false)
+        : m_pModel(pModel), m_nullModel(nullModel), m_edgeClasses(edgeClasses),
+        m_controlProfile(controlProfile),
+        m_numNodes(pModel->graph()->vcount()), m_numEdges(pModel->graph()->ecount()),
+        m_directed(pModel->graph()->isDirected()),
+        m_outDegrees(m_numNodes), m_inDegrees(m_numNodes), m_baseSeed(0) {
+        Graph* pGraph = pModel->graph();
+        VectorInt degrees;
+
+        pGraph->degree(&degrees, V(pGraph), IGRAPH_OUT, true);
+        std::copy(degrees.begin(), degrees.end(), m_outDegrees.begin());
+        pGraph->degree(&degrees, V(pGraph), IGRAPH_IN, true);
+        std::copy(degrees.begin(), degrees.end(), m_inDegrees.begin());
+
+        m_baseSeed = igraph_rng_get_integer(igraph_rng_default(), 0, 0x3FFFFFFF);
+    }
+
+    size_t resultSize() const {
+        return 1 + (m_edgeClasses ? numReportedEdgeClasses : 0) +
+            (m_controlProfile ? numControlProfileFractions : 0);
+    }
+
+    void run(long int trial, double* results) {
+        std::unique_ptr<Graph> graph;
+
+        igraph_rng_seed(igraph_rng_default(), m_baseSeed + trial);
+
+        if (m_nullModel == ERDOS_RENYI) {
+            graph = igraph::erdos_renyi_game_gnm(m_numNodes, m_numEdges,
+                    m_directed, false);
+        } else {
+            VectorInt outDegrees(m_numNodes), inDegrees(m_numNodes);
+            std::copy(m_outDegrees.begin(), m_outDegrees.end(), outDegrees.begin());
+            std::copy(m_inDegrees.begin(), m_inDegrees.end(), inDegrees.begin());
+            if (m_nullModel == CONFIGURATION_NO_JOINT) {
+                inDegrees.shuffle();
+                outDegrees.shuffle();
+            }
+            graph = igraph::degree_sequence_game(outDegrees, inDegrees,
+                    IGRAPH_DEGSEQ_CONFIGURATION);
+        }
+
+        std::unique_ptr<ControllabilityModel> pModel(m_pModel->clone());
+        pModel->setGraph(graph.get());
+        pModel->calculate();
+
+        results[0] = pModel->controllability();
+        if (m_edgeClasses) {
+            edgeClassFractions(pModel->edgeClassCounts(), graph->ecount(), results + 1);
+            results += numReportedEdgeClasses;
+        }
+        if (m_controlProfile) {
+            controlProfileFractions(
+                    static_cast<LiuControllabilityModel*>(pModel.get())->controlProfile(),
+                    results + 1);
+        }
+    }
+};
+
+/// Threads that query the latest snapshot of a model until they are stopped
+/**
+ * Each query takes the latest snapshot and looks up a pseudo-random driver
+ * node, edge class and control path in it, the way a service answering
+ * point queries would. The threads only count their queries and the
+ * distinct versions they saw; the lookups are summed into a checksum so
+ * that they are not optimized away.
+ */
+class SnapshotQueryLoad {
+private:
+    /// The publisher whose snapshots are queried
+    SnapshotPublisher& m_publisher;
+
+    /// Whether the threads should stop
+    std::atomic<bool> m_stop;
+
+    /// The query threads
+    std::vector<std::thread> m_threads;
+
+    /// The number of queries answered by each thread
+    std::vector<long int> m_queryCounts;
+
+    /// The number of distinct snapshot versions seen by each thread
+    std::vector<long int> m_versionCounts;
+
+    /// The checksum of the lookups of each thread
+    std::vector<long int> m_checksums;
+
+    /// The time when the threads were started
+    std::chrono::steady_clock::time_point m_start;
+
+    /// The time the threads were running for, in seconds
+    double m_seconds;
+
+public:
+    /// Starts the given number of threads querying the given publisher
+    SnapshotQueryLoad(SnapshotPublisher& publisher, int numThreads)
+        : m_publisher(publisher), m_stop(false), m_threads(),
+        m_queryCounts(numThreads, 0), m_versionCounts(numThreads, 0),
+        m_checksums(numThreads, 0), m_start(std::chrono::steady_clock::now()),
+        m_seconds(0.0) {
+        for (int i = 0; i < numThreads; i++)
+            m_threads.push_back(std::thread(&SnapshotQueryLoad::run, this, i));
+    }
+
+    /// Stops the threads if they are still running
+    ~SnapshotQueryLoad() {
+        stop();
+    }
+
+    /// Returns the total number of queries answered
+    long int queryCount() const {
+        long int result = 0;
+        for (size_t i = 0; i < m_queryCounts.size(); i++)
+            result += m_queryCounts[i];
+        return result;
+    }
+
+    /// Returns the time the threads were running for, in seconds
+    double seconds() const {
+        return m_seconds;
+    }
+
+    /// Returns the number of threads
+    int threadCount() const {
+        return m_queryCounts.size();
+    }
+
+    /// Returns the number of distinct versions seen by a thread, on average
+    double versionCount() const {
+        long int result = 0;
+        for (size_t i = 0; i < m_versionCounts.size(); i++)
+            result += m_versionCounts[i];
+        return m_versionCounts.empty() ? 0.0 :
+            result / static_cast<double>(m_versionCounts.size());
+    }
+
+    /// Stops the threads and waits for them
+    void stop() {
+        if (m_threads.empty())
+            return;
+
+        m_stop = true;
+        for (size_t i = 0; i < m_threads.size(); i++)
+            m_threads[i].join();
+        m_threads.clear();
+        m_seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    /// Body of the query thread with the given index
+    void run(int index) {
+        SnapshotPublisher::Reader reader(m_publisher);
+        unsigned long state = 0x9E3779B97F4A7C15UL * (index + 1);
+        long int numQueries = 0, numVersions = 0, lastVersion = -1, checksum = 0;
+        long int count;
+
+        while (!m_stop.load(std::memory_order_relaxed)) {
+            SnapshotPublisher::Guard snapshot(reader);
+            if (snapshot.get() == 0)
+                continue;
+
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+
+            if (snapshot->version() != lastVersion) {
+                lastVersion = snapshot->version();
+                numVersions++;
+            }
+
+            count = snapshot->driverNodes().size();
+            if (count > 0)
+                checksum += snapshot->driverNodes()[state % count];
+            count = snapshot->edgeClasses().size();
+            if (count > 0)
+                checksum += snapshot->edgeClasses()[state % count];
+            count = snapshot->controlPathCount();
+            if (count > 0)
+                checksum += snapshot->controlPathSize(state % count);
+
+            numQueries++;
+        }
+
+        m_queryCounts[index] = numQueries;
+        m_versionCounts[index] = numVersions;
+        m_checksums[index] = checksum;
+    }
+};
+
 class NetworkControllabilityApp {
 private:
     /// Parsed command line arguments
@@ -54,30 +383,122 @@ private:
     /// The C++-style output stream where the results will be written
     std::ostream* m_pOutputStream;
 
+    /// Stream buffer of the output stream when the results are discarded
+    NullOutputBuffer m_nullOutputBuffer;
+
+    /// Whether the results of the current repetition of --repeat are
+    /// discarded even if --discard-output was not given
+    bool m_discardingRepetition;
+
+#ifdef NETCTRL_HAVE_ZLIB
+    /// Compressor shared by the output stream and the output file object
+    /// when writing gzip-compressed output
+    std::unique_ptr<GzipOutputBuffer> m_pCompressor;
+#endif
+
 public:
     LOGGING_FUNCTION(debug, 2);
     LOGGING_FUNCTION(info, 1);
     LOGGING_FUNCTION(error, 0);
 
     /// Constructor
-    NetworkControllabilityApp() : m_outputFileObject(0), m_pOutputStream(0) {}
+    NetworkControllabilityApp() : m_outputFileObject(0), m_pOutputStream(0),
+        m_nullOutputBuffer(), m_discardingRepetition(false) {}
 
     /// Destructor
     ~NetworkControllabilityApp() {
+        closeOutput();
+    }
+
+    /// Closes the output file object and stream
+    /**
+     * \return \c true if all the output was written successfully
+     */
+    bool closeOutput() {
+        bool ok = true;
+
         if (m_outputFileObject != 0 && m_outputFileObject != stdout) {
-            fclose(m_outputFileObject);
+            ok = fclose(m_outputFileObject) == 0 && ok;
         }
+        m_outputFileObject = 0;
 
         if (m_pOutputStream != 0 && m_pOutputStream != &std::cout) {
+            m_pOutputStream->flush();
+            ok = !m_pOutputStream->fail() && ok;
             delete m_pOutputStream;
         }
+        m_pOutputStream = 0;
+
+#ifdef NETCTRL_HAVE_ZLIB
+        if (m_pCompressor.get() != 0) {
+            ok = m_pCompressor->close() && ok;
+            m_pCompressor.reset();
+        }
+#endif
+
+        return ok;
+    }
+
+    /// Returns whether the results should be thrown away instead of being written
+    bool isDiscardingOutput() {
+        return m_args.discardOutput || m_discardingRepetition;
+    }
+
+    /// Returns whether the output should be gzip-compressed
+    bool isWritingCompressedOutput() {
+        return !isDiscardingOutput() && !isWritingToStandardOutput() &&
+            m_args.outputFile.size() > 3 &&
+            m_args.outputFile.compare(m_args.outputFile.size() - 3, 3, ".gz") == 0;
+    }
+
+#ifdef NETCTRL_HAVE_ZLIB
+    /// Returns the compressor that writes gzip-compressed output
+    GzipOutputBuffer& getCompressor() {
+        if (m_pCompressor.get() == 0) {
+            try {
+                m_pCompressor.reset(new GzipOutputBuffer(m_args.outputFile,
+                            m_args.numJobs > 0 ? m_args.numJobs : numberOfCPUCores()));
+            } catch (const std::runtime_error& ex) {
+                error("%s", ex.what());
+                exit(3);
+            }
+        }
+        return *m_pCompressor;
+    }
+#endif
+
+    /// Exits if the output should be compressed but zlib support is missing
+    void checkCompressionSupport() {
+#ifndef NETCTRL_HAVE_ZLIB
+        if (isWritingCompressedOutput()) {
+            error("cannot write compressed output to %s; netctrl was compiled "
+                    "without zlib", m_args.outputFile.c_str());
+            exit(3);
+        }
+#endif
     }
 
     /// Returns the C-style output file object where the results should be written
     FILE* getOutputFileObject() {
         if (m_outputFileObject == 0) {
-            if (isWritingToStandardOutput()) {
+            checkCompressionSupport();
+            if (isDiscardingOutput()) {
+                m_outputFileObject = fopen("/dev/null", "w");
+                if (m_outputFileObject == 0) {
+                    error("cannot open /dev/null for writing");
+                    exit(3);
+                }
+            } else if (isWritingToStandardOutput()) {
                 m_outputFileObject = stdout;
+#ifdef NETCTRL_HAVE_ZLIB
+            } else if (isWritingCompressedOutput()) {
+                m_outputFileObject = getCompressor().openFile();
+                if (m_outputFileObject == 0) {
+                    error("cannot open output file for writing: %s",
+                            m_args.outputFile.c_str());
+                    exit(3);
+                }
+#endif
             } else {
                 m_outputFileObject = fopen(m_args.outputFile.c_str(), "w");
                 if (m_outputFileObject == 0) {
@@ -93,8 +514,15 @@ public:
     /// Returns the C++-style output stream where the results should be written
     std::ostream& getOutputStream() {
         if (m_pOutputStream == 0) {
-            if (isWritingToStandardOutput()) {
+            checkCompressionSupport();
+            if (isDiscardingOutput()) {
+                m_pOutputStream = new std::ostream(&m_nullOutputBuffer);
+            } else if (isWritingToStandardOutput()) {
                 m_pOutputStream = &std::cout;
+#ifdef NETCTRL_HAVE_ZLIB
+            } else if (isWritingCompressedOutput()) {
+                m_pOutputStream = new std::ostream(&getCompressor());
+#endif
             } else {
                 m_pOutputStream = new std::ofstream(m_args.outputFile.c_str());
                 if (m_pOutputStream->fail()) {
@@ -112,6 +540,16 @@ public:
         return m_args.outputFile.empty() || m_args.outputFile == "-";
     }
 
+    /// Writes the name of a vertex (or its index if it has no name)
+    void writeVertexName(std::ostream& out, long int vertex) {
+        any name(m_pGraph->vertex(vertex).getAttribute("name", vertex));
+        if (name.type() == typeid(std::string)) {
+            out << name.as<std::string>();
+        } else {
+            out << name.as<long int>();
+        }
+    }
+
     /// Returns whether we are running in quiet mode
     bool isQuiet() {
         return m_args.verbosity < 1;
@@ -134,7 +572,8 @@ public:
             // Loading graph from standard input
             if (format == GRAPH_FORMAT_AUTO)
                 format = GRAPH_FORMAT_EDGELIST;
-            result.reset(new Graph(GraphUtil::readGraph(stdin, format)));
+            result.reset(new Graph(GraphUtil::readGraph(stdin, format, true,
+                            m_args.readerOptions)));
         } else if (filename.find("://") != filename.npos) {
             // Generating graph from model
             size_t pos = filename.find("://");
@@ -163,28 +602,83 @@ public:
             }
         } else {
             // Loading graph from file
-            result.reset(new Graph(GraphUtil::readGraph(filename, format)));
+            result.reset(new Graph(GraphUtil::readGraph(filename, format, true,
+                            m_args.readerOptions)));
             result->setAttribute("filename", filename);
         }
 
         return result;
     }
 
+    /// Returns the format of the input file, detected from its name if needed
+    GraphFormat inputFormat() {
+        if (m_args.inputFormat != GRAPH_FORMAT_AUTO || m_args.inputFile == "-")
+            return m_args.inputFormat;
+        return GraphUtil::detectFormat(m_args.inputFile);
+    }
+
     /// Runs the user interface
     int run(int argc, char** argv) {
         int retval;
 
         m_args.parse(argc, argv);
 
-        info(">> loading graph: %s", m_args.inputFile.c_str());
-        m_pGraph = loadGraph(m_args.inputFile, m_args.inputFormat);
-        if (m_pGraph.get() == NULL)
-            return 2;
+        debug(">> using %s kernels", dispatchedInstructionSet().c_str());
+        setThreadCount(m_args.numJobs);
+
+        if (!m_args.profileFile.empty()) {
+            Profiler::instance().setEnabled(true);
+            if (!Profiler::instance().setCountersEnabled(true))
+                info(">> hardware performance counters are not available; "
+                        "profiling timings only");
+        }
 
-        info(">> graph is %s and has %ld vertices and %ld edges",
-             m_pGraph->isDirected() ? "directed" : "undirected",
-             (long)m_pGraph->vcount(), (long)m_pGraph->ecount());
+        if (m_args.numWarmups > 0 && m_args.numRepeats == 0)
+            m_args.numRepeats = 1;
+        if (m_args.numRepeats > 0)
+            Profiler::instance().setEnabled(true);
 
+        if ((!m_args.loadMatchingFile.empty() || !m_args.saveMatchingFile.empty()) &&
+                m_args.modelType != LIU_MODEL) {
+            error("matchings can only be loaded and saved in the liu model");
+            return 1;
+        }
+
+        // Sparse matrices may be rectangular, so they are not loaded as graphs
+        // in the structural rank mode
+        if (!isRunningMatrixStructuralRank()) {
+            info(">> loading graph: %s", m_args.inputFile.c_str());
+            {
+                ScopedPhase phase("load_graph");
+                m_pGraph = loadGraph(m_args.inputFile, m_args.inputFormat);
+            }
+            if (m_pGraph.get() == NULL)
+                return 2;
+
+            info(">> graph is %s and has %ld vertices and %ld edges",
+                 m_pGraph->isDirected() ? "directed" : "undirected",
+                 (long)m_pGraph->vcount(), (long)m_pGraph->ecount());
+
+            createModel();
+            if (!m_args.loadMatchingFile.empty() && !loadMatching(m_args.loadMatchingFile))
+                return 2;
+        }
+
+        retval = m_args.numRepeats > 0 ? runRepeatedly() : runMode();
+        if (!retval && !m_args.saveMatchingFile.empty() &&
+                !saveMatching(m_args.saveMatchingFile))
+            retval = 3;
+        return finish(retval);
+    }
+
+    /// Returns whether the structural rank mode reads a sparse matrix directly
+    bool isRunningMatrixStructuralRank() {
+        return m_args.operationMode == MODE_STRUCTURAL_RANK &&
+            inputFormat() == GRAPH_FORMAT_MATRIX_MARKET;
+    }
+
+    /// Creates the controllability model selected by the user on the loaded graph
+    void createModel() {
         switch (m_args.modelType) {
             case LIU_MODEL:
                 m_pModel.reset(new LiuControllabilityModel(m_pGraph.get()));
@@ -201,40 +695,476 @@ public:
                     m_pModel.reset(sbdModel);
                 }
                 break;
+            case EXACT_MODEL:
+                m_pModel.reset(new ExactControllabilityModel(m_pGraph.get()));
+                break;
+            case DOMINATING_SET_MODEL:
+                {
+                    DominatingSetControllabilityModel* dsModel;
+                    dsModel = new DominatingSetControllabilityModel(m_pGraph.get());
+                    dsModel->setTimeBudget(m_args.timeBudget);
+                    m_pModel.reset(dsModel);
+                }
+                break;
+            case ZERO_FORCING_MODEL:
+                {
+                    ZeroForcingControllabilityModel* zfModel;
+                    zfModel = new ZeroForcingControllabilityModel(m_pGraph.get());
+                    zfModel->setRestarts(m_args.numRestarts);
+                    zfModel->setTimeBudget(m_args.timeBudget);
+                    m_pModel.reset(zfModel);
+                }
+                break;
         }
+    }
+
+    /// Runs the selected mode once on the loaded graph
+    /**
+     * \return the exit code of the mode
+     */
+    int runMode() {
+        if (isRunningMatrixStructuralRank())
+            return runMatrixStructuralRank();
 
         switch (m_args.operationMode) {
             case MODE_CONTROL_PATHS:
-                retval = runControlPaths();
-                break;
+                return runControlPaths();
 
             case MODE_DRIVER_NODES:
-                retval = runDriverNodes();
-                break;
+                return runDriverNodes();
 
             case MODE_GRAPH:
-                retval = runGraph();
-                break;
+                return runGraph();
 
             case MODE_STATISTICS:
-                retval = runStatistics();
-                break;
+                return runStatistics();
 
             case MODE_SIGNIFICANCE:
-                retval = runSignificance();
-                break;
+                return runSignificance();
+
+            case MODE_EGO:
+                return runEgo();
+
+            case MODE_COMMUNITIES:
+                return runCommunities();
+
+            case MODE_STRUCTURAL_RANK:
+                return runStructuralRank();
+
+            case MODE_UPDATES:
+                return runUpdates();
+
+            case MODE_ENERGY:
+                return runEnergy();
+
+            case MODE_VERIFY_INPUTS:
+                return runVerifyInputs();
 
             default:
-                retval = 1;
+                return 1;
         }
+    }
 
-        if (!retval && !isWritingToStandardOutput()) {
+    /// Runs the selected mode repeatedly and reports the time spent in each phase
+    /**
+     * The graph is loaded only once, before the first repetition; in the
+     * structural rank mode of MatrixMarket files, the matrix is read again
+     * in each repetition since reading it is part of the mode. The warmup
+     * repetitions are not measured. The results of all the repetitions are
+     * discarded, so that the times cover the calculation only, except for
+     * the last one with --keep-output; the output is opened only then. The time of each phase in each measured
+     * repetition is taken from the difference of two profiler snapshots;
+     * phases that ran on several threads are represented by the thread that
+     * spent the most time in them. The minimum, median and 95th percentile
+     * of the times of each phase are written to the standard error, along
+     * with the \c total phase that covers whole repetitions.
+     *
+     * \return the exit code of the mode
+     */
+    int runRepeatedly() {
+        Profiler& profiler = Profiler::instance();
+        Profiler::PhaseMap before, after;
+        Profiler::PhaseMap::const_iterator it, previous;
+        std::map<std::string, std::vector<double> > timings;
+        std::map<std::string, std::vector<double> >::iterator timing;
+        long int i, numRuns = m_args.numWarmups + m_args.numRepeats;
+        int retval = 0;
+
+        info(">> running %ld warmup and %ld measured repetition(s)",
+                m_args.numWarmups, m_args.numRepeats);
+        for (i = 0; i < numRuns && !retval; i++) {
+            m_discardingRepetition = !m_args.keepOutput || i + 1 < numRuns;
+            before = profiler.snapshot();
+            {
+                ScopedPhase phase("total");
+                retval = runMode();
+            }
+            after = profiler.snapshot();
+            if (m_discardingRepetition)
+                closeOutput();
+            if (i < m_args.numWarmups)
+                continue;
+
+            std::map<std::string, double> seconds;
+            for (it = after.begin(); it != after.end(); ++it) {
+                previous = before.find(it->first);
+                if (previous != before.end() && previous->second.calls == it->second.calls)
+                    continue;
+                double elapsed = it->second.seconds -
+                    (previous != before.end() ? previous->second.seconds : 0.0);
+                double& longest = seconds[it->first.first];
+                longest = std::max(longest, elapsed);
+            }
+            for (std::map<std::string, double>::const_iterator it2 = seconds.begin();
+                    it2 != seconds.end(); ++it2)
+                timings[it2->first].push_back(it2->second);
+        }
+        if (retval)
+            return retval;
+
+        fprintf(stderr, "phase\truns\tmin\tmedian\tp95\n");
+        for (timing = timings.begin(); timing != timings.end(); ++timing) {
+            std::vector<double>& values = timing->second;
+            std::sort(values.begin(), values.end());
+            fprintf(stderr, "%s\t%ld\t%.6f\t%.6f\t%.6f\n", timing->first.c_str(),
+                    static_cast<long int>(values.size()), values.front(),
+                    (values[(values.size() - 1) / 2] + values[values.size() / 2]) / 2,
+                    percentile(values, 95));
+        }
+
+        return 0;
+    }
+
+    /// Writes the profile and closes the output after running a mode
+    /**
+     * \param  retval  the exit code of the mode
+     * \return the exit code of the application
+     */
+    int finish(int retval) {
+        if (!m_args.profileFile.empty() && !writeProfile()) {
+            error("cannot write profile to %s", m_args.profileFile.c_str());
+            if (!retval)
+                retval = 3;
+        }
+
+        if (!closeOutput() && !retval) {
+            error("error while writing the results to %s", m_args.outputFile.c_str());
+            retval = 3;
+        }
+
+        if (!retval && !isDiscardingOutput() && !isWritingToStandardOutput()) {
             info(">> results were written to %s", m_args.outputFile.c_str());
         }
 
         return retval;
     }
 
+    /// Writes the collected profile into the profile file
+    /**
+     * \return \c true if the profile was written successfully
+     */
+    bool writeProfile() {
+        std::ofstream os(m_args.profileFile.c_str());
+        Profiler::instance().writeJSON(os);
+        os.close();
+        return !os.fail();
+    }
+
+    /// Loads the membership file of the communities mode
+    /**
+     * Each non-empty line of the file that does not start with \c # contains
+     * the name of a vertex and the label of its community, separated by
+     * whitespace. Communities are numbered in the order of their first
+     * appearance; vertices that are not listed belong to no community.
+     *
+     * \param  filename    the name of the file
+     * \param  membership  the community of each vertex is returned here
+     * \param  labels      the label of each community is returned here
+     * \return \c true if the file was loaded successfully
+     */
+    bool loadMembership(const std::string& filename, std::vector<long int>& membership,
+            std::vector<std::string>& labels) {
+        long int i, n = m_pGraph->vcount();
+        std::unordered_map<std::string, long int> vertexIds;
+        std::map<std::string, long int> communityIds;
+        std::map<std::string, long int>::const_iterator it;
+        std::unordered_map<std::string, long int>::const_iterator vertex;
+        std::ifstream in(filename.c_str());
+        std::string line, name, label;
+
+        if (in.fail()) {
+            error("cannot open membership file: %s", filename.c_str());
+            return false;
+        }
+
+        findVertexIds(vertexIds);
+
+        membership.assign(n, -1);
+        labels.clear();
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            if (!(is >> name) || name[0] == '#')
+                continue;
+            if (!(is >> label)) {
+                error("missing community label for vertex %s in membership file",
+                        name.c_str());
+                return false;
+            }
+
+            vertex = vertexIds.find(name);
+            if (vertex == vertexIds.end()) {
+                error("unknown vertex in membership file: %s", name.c_str());
+                return false;
+            }
+            i = vertex->second;
+
+            it = communityIds.find(label);
+            if (it == communityIds.end()) {
+                it = communityIds.insert(std::make_pair(label, labels.size())).first;
+                labels.push_back(label);
+            }
+            membership[i] = it->second;
+        }
+
+        return true;
+    }
+
+    /// Maps the names of the vertices (or their indices if they have no names) to their IDs
+    void findVertexIds(std::unordered_map<std::string, long int>& vertexIds) {
+        long int i, n = m_pGraph->vcount();
+
+        vertexIds.clear();
+        vertexIds.reserve(n);
+        for (i = 0; i < n; i++) {
+            std::ostringstream os;
+            writeVertexName(os, i);
+            vertexIds[os.str()] = i;
+        }
+    }
+
+    /// Loads the matching that the Liu model should start from
+    /**
+     * Each line of the file contains the names of a matching vertex and the
+     * vertex it is matched to, as written by \c saveMatching(). Pairs whose
+     * vertices or edge do not exist in the current graph are dropped, as
+     * well as pairs that conflict with an earlier one; the model augments
+     * the rest to a maximum matching.
+     *
+     * \return \c true if the file could be read
+     */
+    bool loadMatching(const std::string& filename) {
+        ScopedPhase phase("load_matching");
+        long int i, k, u, v, n = m_pGraph->vcount(), numPairs = 0, numReused = 0;
+        std::vector<long int> changes;
+        std::unordered_map<std::string, long int> vertexIds;
+        std::unordered_map<std::string, long int>::const_iterator source, target;
+        AdjacencyView adjacency(m_pGraph->c_graph());
+        DirectedMatching matching(n);
+        std::ifstream in(filename.c_str());
+        std::string line, sourceName, targetName;
+
+        if (in.fail()) {
+            error("cannot open matching file: %s", filename.c_str());
+            return false;
+        }
+
+        findVertexIds(vertexIds);
+
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            if (!(is >> sourceName) || sourceName[0] == '#')
+                continue;
+            if (!(is >> targetName)) {
+                error("missing matched vertex for vertex %s in matching file",
+                        sourceName.c_str());
+                return false;
+            }
+            numPairs++;
+
+            source = vertexIds.find(sourceName);
+            if (source == vertexIds.end())
+                continue;
+            u = source->second;
+
+            target = vertexIds.find(targetName);
+            v = target != vertexIds.end() ? target->second : -1;
+            if (v == -1 || matching.isMatching(u) || matching.isMatched(v)) {
+                changes.push_back(u);
+                continue;
+            }
+
+            k = adjacency.outDegree(u);
+            for (i = 0; i < k && adjacency.outNeighbor(u, i) != v; i++)
+                ;
+            if (i < k) {
+                matching.setMatch(u, v);
+                numReused++;
+            } else {
+                changes.push_back(u);
+            }
+        }
+
+        info(">> reusing %ld of %ld matched pair(s) from %s", numReused, numPairs,
+                filename.c_str());
+        static_cast<LiuControllabilityModel*>(m_pModel.get())->setWarmStartMatching(
+                matching, changes);
+        return true;
+    }
+
+    /// Saves the matching found by the Liu model
+    /**
+     * Each line of the file contains the names of a matching vertex and the
+     * vertex it is matched to, separated by a tab.
+     *
+     * \return \c true if the matching was saved successfully
+     */
+    bool saveMatching(const std::string& filename) {
+        const LiuControllabilityModel* model =
+            static_cast<LiuControllabilityModel*>(m_pModel.get());
+        long int u, v, n = m_pGraph.get() ? m_pGraph->vcount() : 0;
+
+        if (model == 0 || model->matching()->size() != n) {
+            error("no matching was calculated in this mode, cannot save it");
+            return false;
+        }
+
+        const DirectedMatching* matching = model->matching();
+
+        std::ofstream out(filename.c_str());
+        for (u = 0; u < n; u++) {
+            v = matching->matchOut(u);
+            if (v == -1)
+                continue;
+            writeVertexName(out, u);
+            out << '\t';
+            writeVertexName(out, v);
+            out << '\n';
+        }
+        out.close();
+
+        if (out.fail()) {
+            error("cannot write matching to %s", filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /// Loads the batches of edge updates for the updates mode
+    /**
+     * Each line of the file is <tt>+ u v</tt> to insert an edge from vertex
+     * \c u to vertex \c v or <tt>- u v</tt> to delete one, where the
+     * vertices are given by their names. Lines starting with \c = end the
+     * current batch; empty lines and lines starting with \c # are ignored.
+     * Updates that refer to vertices not in the graph are skipped.
+     *
+     * \return \c true if the file could be read
+     */
+    bool loadEdgeUpdates(const std::string& filename, std::vector<EdgeUpdates>& batches) {
+        ScopedPhase phase("load_updates");
+        long int numSkipped = 0, lineNumber = 0;
+        std::unordered_map<std::string, long int> vertexIds;
+        std::unordered_map<std::string, long int>::const_iterator source, target;
+        std::ifstream in(filename.c_str());
+        std::string line, operation, sourceName, targetName;
+
+        if (in.fail()) {
+            error("cannot open edge update file: %s", filename.c_str());
+            return false;
+        }
+
+        findVertexIds(vertexIds);
+
+        batches.assign(1, EdgeUpdates());
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            lineNumber++;
+            if (!(is >> operation) || operation[0] == '#')
+                continue;
+            if (operation[0] == '=') {
+                if (!batches.back().empty())
+                    batches.push_back(EdgeUpdates());
+                continue;
+            }
+            if ((operation != "+" && operation != "-") || !(is >> sourceName >> targetName)) {
+                error("invalid edge update in line %ld of %s", lineNumber, filename.c_str());
+                return false;
+            }
+
+            source = vertexIds.find(sourceName);
+            target = vertexIds.find(targetName);
+            if (source == vertexIds.end() || target == vertexIds.end()) {
+                numSkipped++;
+                continue;
+            }
+
+            std::vector<long int>& edges = operation == "+" ?
+                batches.back().insertions : batches.back().deletions;
+            edges.push_back(source->second);
+            edges.push_back(target->second);
+        }
+        if (batches.back().empty())
+            batches.pop_back();
+
+        if (numSkipped > 0)
+            info(">> skipped %ld edge update(s) with unknown vertices", numSkipped);
+        return true;
+    }
+
+    /// Loads the candidate input sets for the input verification mode
+    /**
+     * Each line of the file lists the names of the vertices in one
+     * candidate set, separated by whitespace. Empty lines and lines
+     * starting with \c # are ignored; every other line is a candidate,
+     * even if it only has a comment after the first name.
+     *
+     * \param  filename  the name of the file
+     * \param  inputs    the vertices of all the candidates are returned here
+     *                   one after the other
+     * \param  offsets   the index of the first vertex of each candidate in
+     *                   \c inputs is returned here, followed by the size of
+     *                   \c inputs
+     * \return \c true if the file was loaded successfully
+     */
+    bool loadInputSets(const std::string& filename, std::vector<long int>& inputs,
+            std::vector<long int>& offsets) {
+        ScopedPhase phase("load_inputs");
+        long int lineNumber = 0;
+        std::unordered_map<std::string, long int> vertexIds;
+        std::unordered_map<std::string, long int>::const_iterator vertex;
+        std::ifstream in(filename.c_str());
+        std::string line, name;
+
+        if (in.fail()) {
+            error("cannot open input set file: %s", filename.c_str());
+            return false;
+        }
+
+        findVertexIds(vertexIds);
+
+        inputs.clear();
+        offsets.clear();
+        while (std::getline(in, line)) {
+            std::istringstream is(line);
+            lineNumber++;
+            if (!(is >> name) || name[0] == '#')
+                continue;
+
+            offsets.push_back(inputs.size());
+            do {
+                vertex = vertexIds.find(name);
+                if (vertex == vertexIds.end()) {
+                    error("unknown vertex in line %ld of %s: %s", lineNumber,
+                            filename.c_str(), name.c_str());
+                    return false;
+                }
+                inputs.push_back(vertex->second);
+            } while (is >> name);
+        }
+        offsets.push_back(inputs.size());
+
+        return true;
+    }
+
     /// Runs the control path calculation mode
     int runControlPaths() {
         info(">> calculating control paths");
@@ -262,14 +1192,364 @@ public:
 
         info(">> found %d driver node(s)", driver_nodes.size());
         for (VectorInt::const_iterator it = driver_nodes.begin(); it != driver_nodes.end(); it++) {
-            any name(m_pGraph->vertex(*it).getAttribute("name", (long int)*it));
-            if (name.type() == typeid(std::string)) {
-                out << name.as<std::string>() << '\n';
-            } else {
-                out << name.as<long int>() << '\n';
+            writeVertexName(out, *it);
+            out << '\n';
+        }
+
+        return 0;
+    }
+
+    /// Runs the edge update mode
+    /**
+     * The driver nodes are calculated for the original graph first, then the
+     * batches of edge updates are applied one by one and the model repairs
+     * its results after each batch. The number of driver nodes and the
+     * controllability are written after each batch, with batch zero being
+     * the original graph. In repeated runs, each repetition starts from the
+     * original graph again.
+     *
+     * With \c --query-threads, a snapshot of the results is published after
+     * each batch and the given number of threads keep querying the latest
+     * one while the batches are applied; their throughput is reported at
+     * the end. The snapshots only hold the driver nodes unless
+     * \c --full-snapshots is given, since the edge classes and the control
+     * paths span the whole graph.
+     */
+    int runUpdates() {
+        std::vector<EdgeUpdates> batches;
+        std::unique_ptr<Graph> original;
+        std::unique_ptr<SnapshotPublisher> publisher;
+        std::unique_ptr<SnapshotQueryLoad> queries;
+        std::vector<long int> edgeClassCounts;
+        double fractions[numReportedEdgeClasses];
+        long int i, ignored;
+        size_t j;
+        bool edgeClasses;
+
+        if (m_args.updatesFile.empty()) {
+            error("the updates mode needs a file of edge updates; use --updates");
+            return 1;
+        }
+        if (!loadEdgeUpdates(m_args.updatesFile, batches))
+            return 2;
+        if (m_args.numRepeats > 0)
+            original.reset(new Graph(*m_pGraph));
+
+        info(">> calculating control paths and driver nodes");
+        m_pModel->calculate();
+
+        // The query threads only see the snapshots published after the
+        // batches, never the model while it is being updated
+        if (m_args.numQueryThreads > 0) {
+            publisher.reset(new SnapshotPublisher(
+                        m_args.fullSnapshots ? SNAPSHOT_ALL : SNAPSHOT_DRIVER_NODES));
+            publisher->publish(*m_pModel);
+            queries.reset(new SnapshotQueryLoad(*publisher, m_args.numQueryThreads));
+        }
+
+        // The fractions of the edge classes follow the controllability if
+        // the model classifies the edges; the liu model keeps the classes up
+        // to date around the changes instead of classifying every edge again
+        edgeClassCounts = m_pModel->edgeClassCounts();
+        edgeClasses = !edgeClassCounts.empty();
+
+        std::ostream& out = getOutputStream();
+        out << "batch\tinsertions\tdeletions\tdriver_nodes\tcontrollability";
+        if (edgeClasses) {
+            for (j = 0; j < numReportedEdgeClasses; j++)
+                out << '\t' << edgeClassToString(reportedEdgeClasses[j]);
+        }
+        out << '\n';
+        out << "0\t0\t0\t" << m_pModel->driverNodes().size() << '\t'
+            << m_pModel->controllability();
+        if (edgeClasses) {
+            edgeClassFractions(edgeClassCounts, m_pGraph->ecount(), fractions);
+            for (j = 0; j < numReportedEdgeClasses; j++)
+                out << '\t' << fractions[j];
+        }
+        out << '\n';
+
+        info(">> applying %ld batch(es) of edge updates", (long int)batches.size());
+        for (i = 0; i < static_cast<long int>(batches.size()); i++) {
+            {
+                ScopedPhase phase("update");
+                ignored = m_pModel->updateEdges(batches[i]);
+            }
+            if (publisher.get() != 0)
+                publisher->publish(*m_pModel);
+            if (ignored > 0)
+                info(">> ignored %ld deletion(s) of missing edges in batch %ld",
+                        ignored, i + 1);
+
+            out << (i + 1) << '\t' << batches[i].insertionCount() << '\t'
+                << batches[i].deletionCount() - ignored << '\t'
+                << m_pModel->driverNodes().size() << '\t'
+                << m_pModel->controllability();
+            if (edgeClasses) {
+                edgeClassFractions(m_pModel->edgeClassCounts(), m_pGraph->ecount(),
+                        fractions);
+                for (j = 0; j < numReportedEdgeClasses; j++)
+                    out << '\t' << fractions[j];
             }
+            out << '\n';
         }
 
+        if (queries.get() != 0) {
+            queries->stop();
+            info(">> %ld queries on %d thread(s) in %.3f s (%.0f per second); "
+                    "each thread saw %.1f of %ld snapshot(s) on average",
+                    queries->queryCount(), queries->threadCount(), queries->seconds(),
+                    queries->seconds() > 0 ? queries->queryCount() / queries->seconds() : 0.0,
+                    queries->versionCount(), publisher->version());
+        }
+
+        if (original.get() != 0)
+            *m_pGraph = *original;
+
+        return 0;
+    }
+
+    /// Runs the ego network controllability mode
+    int runEgo() {
+        long int i, n = m_pGraph->vcount();
+        std::vector<long int> driverCounts, egoSizes;
+        std::ostream& out = getOutputStream();
+
+        if (m_args.modelType != LIU_MODEL) {
+            error("the ego mode supports the liu model only");
+            return 1;
+        }
+
+        info(">> calculating driver nodes of ego networks of radius %ld", m_args.egoRadius);
+        {
+            ScopedPhase phase("ego.driver_nodes");
+            egoDriverCounts(AdjacencyView(m_pGraph->c_graph()), m_args.egoRadius,
+                    driverCounts, &egoSizes);
+        }
+
+        for (i = 0; i < n; i++) {
+            writeVertexName(out, i);
+            out << '\t' << driverCounts[i] / static_cast<double>(egoSizes[i]) << '\n';
+        }
+
+        return 0;
+    }
+
+    /// Runs the input verification mode
+    /**
+     * Each candidate input set of the file given by \c --inputs is checked
+     * by an \c InputSetVerifier, which starts every check from the same
+     * maximum matching of the graph.
+     */
+    int runVerifyInputs() {
+        std::vector<long int> inputs, offsets;
+        std::vector<InputSetCheck> results;
+        std::unique_ptr<InputSetVerifier<AdjacencyView> > verifier;
+        long int i, numCandidates, numControllable = 0;
+        AdjacencyView adjacency(m_pGraph->c_graph());
+
+        if (m_args.modelType != LIU_MODEL) {
+            error("the verify_inputs mode supports the liu model only");
+            return 1;
+        }
+        if (m_args.inputsFile.empty()) {
+            error("the verify_inputs mode needs a file of candidate input sets; "
+                    "use --inputs");
+            return 1;
+        }
+        if (!loadInputSets(m_args.inputsFile, inputs, offsets))
+            return 2;
+        numCandidates = offsets.size() - 1;
+
+        info(">> calculating maximum matching and source components");
+        {
+            ScopedPhase phase("verify_inputs.prepare");
+            verifier.reset(new InputSetVerifier<AdjacencyView>(adjacency));
+        }
+
+        info(">> verifying %ld candidate input set(s)", numCandidates);
+        {
+            ScopedPhase phase("verify_inputs.verify");
+            verifier->verify(inputs, offsets, results);
+        }
+
+        std::ostream& out = getOutputStream();
+        out << "candidate\tinputs\tdeficiency\tuncovered_sources\tcontrollable\n";
+        for (i = 0; i < numCandidates; i++) {
+            out << (i + 1) << '\t' << results[i].inputCount << '\t'
+                << results[i].deficiency << '\t' << results[i].uncoveredSources << '\t'
+                << (results[i].controllable() ? 1 : 0) << '\n';
+            if (results[i].controllable())
+                numControllable++;
+        }
+
+        info(">> %ld of %ld candidate(s) make the network structurally controllable; "
+                "the graph needs at least %ld driver node(s)", numControllable,
+                numCandidates, std::max<long int>(m_pGraph->vcount() - verifier->matchedCount(),
+                    verifier->sourceCount()));
+
+        return 0;
+    }
+
+    /// Runs the per-community controllability mode
+    int runCommunities() {
+        std::vector<long int> membership;
+        std::vector<std::string> labels;
+        std::vector<CommunityControllability> results;
+        std::ostream& out = getOutputStream();
+        long int i, j, numCommunities;
+
+        if (m_args.membershipFile.empty()) {
+            error("the communities mode needs a membership file; use --membership");
+            return 1;
+        }
+        if (!loadMembership(m_args.membershipFile, membership, labels))
+            return 2;
+
+        numCommunities = labels.size();
+        info(">> calculating driver nodes and edge classes of %ld communities",
+                numCommunities);
+        {
+            ScopedPhase phase("communities.controllability");
+            communityControllability(AdjacencyView(m_pGraph->c_graph()), membership, results);
+        }
+
+        info(">> order is as follows:");
+        info(">> community, vertices, edges; for the liu and the switchboard model: "
+                "driver nodes; distinguished, redundant, ordinary, critical edges");
+        info(">> the last row (*) is for the edges between the communities");
+
+        labels.push_back("*");
+        for (i = 0; i <= numCommunities; i++) {
+            const CommunityControllability& result = results[i];
+            const long int* edgeCounts[2] = {
+                result.liuEdgeCounts, result.switchboardEdgeCounts
+            };
+            const long int driverCounts[2] = {
+                result.liuDriverCount, result.switchboardDriverCount
+            };
+
+            out << labels[i] << '\t' << result.vertexCount << '\t' << result.edgeCount;
+            for (j = 0; j < 2; j++) {
+                out << '\t' << driverCounts[j]
+                    << '\t' << edgeCounts[j][EDGE_DISTINGUISHED]
+                    << '\t' << edgeCounts[j][EDGE_REDUNDANT]
+                    << '\t' << edgeCounts[j][EDGE_ORDINARY]
+                    << '\t' << edgeCounts[j][EDGE_CRITICAL];
+            }
+            out << '\n';
+        }
+
+        return 0;
+    }
+
+    /// Runs the structural rank mode on the loaded graph
+    int runStructuralRank() {
+        long int rank, n = m_pGraph->vcount();
+
+        info(">> calculating structural rank");
+        {
+            ScopedPhase phase("structural_rank.matching");
+            rank = structuralRank(AdjacencyView(m_pGraph->c_graph()));
+        }
+
+        writeStructuralRank(n, n, m_pGraph->ecount(), rank);
+        return 0;
+    }
+
+    /// Runs the structural rank mode on a sparse matrix in MatrixMarket format
+    /**
+     * The matrix is not loaded as a graph: its entries are turned into a
+     * compressed sparse row graph directly, which also works for rectangular
+     * matrices; see \c structuralRank().
+     */
+    int runMatrixStructuralRank() {
+        CoordinateMatrix matrix;
+        std::vector<long int> edges;
+        std::unique_ptr<CSRGraph> graph;
+        long int rank;
+
+        info(">> loading sparse matrix: %s", m_args.inputFile.c_str());
+        {
+            ScopedPhase phase("load_graph");
+            FILE* fptr = (m_args.inputFile == "-") ? stdin :
+                fopen(m_args.inputFile.c_str(), "r");
+            if (fptr == NULL) {
+                error("cannot open input file: %s", m_args.inputFile.c_str());
+                return 2;
+            }
+            {
+                MappedFile file(fptr);
+                readMatrixMarket(file, matrix);
+            }
+            if (fptr != stdin)
+                fclose(fptr);
+        }
+
+        info(">> matrix has %ld rows, %ld columns and %ld stored entries",
+                matrix.rowCount, matrix.columnCount, matrix.entryCount());
+
+        {
+            ScopedPhase phase("structural_rank.build_csr");
+            matrix.edges(true, edges);
+            graph.reset(new CSRGraph(std::max(matrix.rowCount, matrix.columnCount),
+                        edges, true));
+        }
+
+        info(">> calculating structural rank");
+        {
+            ScopedPhase phase("structural_rank.matching");
+            rank = structuralRank(*graph);
+        }
+
+        writeStructuralRank(matrix.rowCount, matrix.columnCount, edges.size() / 2, rank);
+        return 0;
+    }
+
+    /// Writes the result of the structural rank mode
+    void writeStructuralRank(long int rows, long int columns, long int entries,
+            long int rank) {
+        info(">> order is as follows:");
+        info(">> rows, columns, nonzero entries, structural rank");
+
+        getOutputStream() << rows << '\t' << columns << '\t' << entries << '\t'
+            << rank << '\n';
+    }
+
+    /// Runs the control energy mode
+    /**
+     * The driver nodes of the model are taken as the inputs of the linear
+     * dynamics on the weighted adjacency matrix of the graph; see
+     * \c estimateControlEnergy().
+     */
+    int runEnergy() {
+        GramianOptions options;
+        GramianEstimate estimate;
+        long int num_driver;
+
+        info(">> calculating driver nodes");
+        m_pModel->calculate();
+        num_driver = m_pModel->driverNodes().size();
+
+        info(">> estimating control energy of %ld driver node(s)", num_driver);
+        options.maxHorizon = m_args.energyHorizon;
+        estimateControlEnergy(*m_pModel, estimate, options);
+
+        if (!estimate.exactTrace)
+            info(">> trace estimated from %ld random probe(s)", options.traceProbes);
+        if (estimate.horizon >= options.maxHorizon)
+            info(">> the series was truncated at the horizon; consider --horizon");
+
+        info(">> order is as follows:");
+        info(">> driver nodes, scale, horizon, trace, largest eigenvalue, "
+             "smallest eigenvalue, minimum energy, maximum energy");
+
+        std::ostream& out = getOutputStream();
+        out << num_driver << '\t' << estimate.scale << '\t' << estimate.horizon << '\t'
+            << estimate.trace << '\t' << estimate.largestEigenvalue << '\t'
+            << estimate.smallestEigenvalue << '\t' << estimate.minimumEnergy() << '\t'
+            << estimate.maximumEnergy() << '\n';
+
         return 0;
     }
 
@@ -315,90 +1595,115 @@ public:
         }
 
         // Print the graph
+        ScopedPhase phase("write_graph");
         GraphUtil::writeGraph(getOutputFileObject(), (*m_pGraph.get()), m_args.outputFormat);
 
         return 0;
     }
 
     /// Runs the signficance calculation mode
+    /**
+     * Each line of the output contains the controllability of the observed
+     * graph or its mean over the trials of a null model. If the model can
+     * classify the edges, the line continues with the fractions of the
+     * distinguished, redundant, ordinary and critical edges, in the same
+     * order as in the statistics mode. For the Liu model, the line ends
+     * with the control profile: the fractions of the driver nodes that are
+     * sources, external dilations and internal dilations. The profile of
+     * each trial comes from the same calculation as its driver nodes.
+     */
     int runSignificance() {
-        size_t observedDriverNodeCount;
-        size_t numTrials = 100, i;
-        float numNodes = m_pGraph->vcount();
-        float controllability;
-        Vector counts;
+        size_t i, numObserved, observedDriverNodeCount;
+        long int numTrials = 100;
+        std::vector<double> results;
+        std::vector<long int> edgeClassCounts;
+        double observed[1 + numReportedEdgeClasses + numControlProfileFractions];
+        LiuControllabilityModel* liuModel;
+        bool edgeClasses, controlProfile;
         std::ostream& out = getOutputStream();
+        WorkerPool pool(m_args.numJobs);
         
         info(">> calculating control paths and driver nodes");
         m_pModel->calculate();
 
         observedDriverNodeCount = m_pModel->driverNodes().size();
-        controllability = m_pModel->controllability();
-
+        observed[0] = m_pModel->controllability();
         info(">> found %d driver node(s)", observedDriverNodeCount);
-        out << "Observed\t" << controllability << '\n';
-
-        // Testing Erdos-Renyi null model
-        info(">> testing Erdos-Renyi null model");
-        counts.clear();
-        for (i = 0; i < numTrials; i++) {
-            std::unique_ptr<Graph> graph = igraph::erdos_renyi_game_gnm(
-                    numNodes, m_pGraph->ecount(),
-                    m_pGraph->isDirected(), false);
-
-            std::unique_ptr<ControllabilityModel> pModel(m_pModel->clone());
-            pModel->setGraph(graph.get());
-            pModel->calculate();
-
-            counts.push_back(pModel->controllability());
-        }
-        counts.sort();
-        out << "ER\t" << counts.sum() / counts.size() << '\n';
-
-        // Testing configuration model
-        VectorInt inDegrees, outDegrees;
-        m_pGraph->degree(&outDegrees, V(m_pGraph.get()), IGRAPH_OUT, true);
-        m_pGraph->degree(&inDegrees,  V(m_pGraph.get()), IGRAPH_IN,  true);
-
-        info(">> testing configuration model (preserving joint degree distribution)");
-        counts.clear();
-        for (i = 0; i < numTrials; i++) {
-            std::unique_ptr<Graph> graph =
-                igraph::degree_sequence_game(outDegrees, inDegrees,
-                    IGRAPH_DEGSEQ_CONFIGURATION);
 
-            std::unique_ptr<ControllabilityModel> pModel(m_pModel->clone());
-            pModel->setGraph(graph.get());
-            pModel->calculate();
+        info(">> classifying edges");
+        edgeClassCounts = m_pModel->edgeClassCounts();
+        edgeClasses = !edgeClassCounts.empty();
+        numObserved = 1;
+        if (edgeClasses) {
+            edgeClassFractions(edgeClassCounts, m_pGraph->ecount(), observed + numObserved);
+            numObserved += numReportedEdgeClasses;
+        }
 
-            counts.push_back(pModel->controllability());
+        liuModel = dynamic_cast<LiuControllabilityModel*>(m_pModel.get());
+        controlProfile = (liuModel != 0);
+        if (controlProfile) {
+            controlProfileFractions(liuModel->controlProfile(), observed + numObserved);
+            numObserved += numControlProfileFractions;
         }
-        counts.sort();
-        out << "Configuration\t" << counts.sum() / counts.size() << '\n';
 
-        // Testing configuration model
-        info(">> testing configuration model (destroying joint degree distribution)");
-        counts.clear();
-        for (i = 0; i < numTrials; i++) {
-            inDegrees.shuffle();
-            outDegrees.shuffle();
+        out << "Observed";
+        for (i = 0; i < numObserved; i++)
+            out << '\t' << observed[i];
+        out << '\n';
 
-            std::unique_ptr<Graph> graph =
-                igraph::degree_sequence_game(outDegrees, inDegrees,
-                    IGRAPH_DEGSEQ_CONFIGURATION);
+        if (pool.numWorkers() > 1) {
+            info(">> running null model trials in %d worker processes", pool.numWorkers());
+            // The workers already keep every core busy
+            setThreadCount(1);
+        }
+
+        try {
+            // Testing Erdos-Renyi null model
+            info(">> testing Erdos-Renyi null model");
+            {
+                ScopedPhase phase("significance.er");
+                NullModelTrials trials(m_pModel.get(), NullModelTrials::ERDOS_RENYI,
+                        edgeClasses, controlProfile);
+                pool.run(trials, numTrials, results);
+                writeTrialMeans(out, "ER", results, trials.resultSize());
+            }
 
-            std::unique_ptr<ControllabilityModel> pModel(m_pModel->clone());
-            pModel->setGraph(graph.get());
-            pModel->calculate();
+            // Testing configuration model
+            info(">> testing configuration model (preserving joint degree distribution)");
+            {
+                ScopedPhase phase("significance.configuration");
+                NullModelTrials trials(m_pModel.get(), NullModelTrials::CONFIGURATION,
+                        edgeClasses, controlProfile);
+                pool.run(trials, numTrials, results);
+                writeTrialMeans(out, "Configuration", results, trials.resultSize());
+            }
 
-            counts.push_back(pModel->controllability());
+            // Testing configuration model
+            info(">> testing configuration model (destroying joint degree distribution)");
+            {
+                ScopedPhase phase("significance.configuration_no_joint");
+                NullModelTrials trials(m_pModel.get(), NullModelTrials::CONFIGURATION_NO_JOINT,
+                        edgeClasses, controlProfile);
+                pool.run(trials, numTrials, results);
+                writeTrialMeans(out, "Configuration_no_joint", results, trials.resultSize());
+            }
+        } catch (const std::runtime_error& ex) {
+            error("%s", ex.what());
+            return 4;
         }
-        counts.sort();
-        out << "Configuration_no_joint\t" << counts.sum() / counts.size() << '\n';
 
         return 0;
     }
 
+    /// Writes the means of the results of null model trials in a single line
+    void writeTrialMeans(std::ostream& out, const char* name,
+            const std::vector<double>& results, size_t resultSize) {
+        out << name;
+        for (size_t i = 0; i < resultSize; i++)
+            out << '\t' << mean(results, i, resultSize);
+        out << '\n';
+    }
+
     /// Runs the general statistics calculation mode
     int runStatistics() {
         float n = m_pGraph->vcount();
@@ -412,22 +1717,19 @@ public:
         num_driver = m_pModel->driverNodes().size();
 
         info(">> classifying edges");
-        std::vector<EdgeClass> edge_classes = m_pModel->edgeClasses();
-        if (edge_classes.size() == m && !edge_classes.empty()) {
-            for (long int i = 0; i < m; i++) {
-                if (edge_classes[i] == EDGE_REDUNDANT)
-                    num_redundant++;
-                else if (edge_classes[i] == EDGE_ORDINARY)
-                    num_ordinary++;
-                else if (edge_classes[i] == EDGE_DISTINGUISHED)
-                    num_distinguished++;
-                else
-                    num_critical++;
-            }
+        std::vector<long int> edge_class_counts = m_pModel->edgeClassCounts();
+        if (!edge_class_counts.empty()) {
+            num_redundant = edge_class_counts[EDGE_REDUNDANT];
+            num_ordinary = edge_class_counts[EDGE_ORDINARY];
+            num_distinguished = edge_class_counts[EDGE_DISTINGUISHED];
+            num_critical = edge_class_counts[EDGE_CRITICAL];
         }
 
         info(">> order is as follows:");
         info(">> driver nodes; distinguished, redundant, ordinary, critical edges");
+        if (m_args.modelType == LIU_MODEL)
+            info(">> third row: fraction of driver nodes due to sources, external "
+                    "and internal dilations");
 
         out << num_driver << ' '
             << num_distinguished << ' '
@@ -440,6 +1742,15 @@ public:
             << num_ordinary / m << ' '
             << num_critical / m << '\n';
 
+        LiuControllabilityModel* liuModel =
+            dynamic_cast<LiuControllabilityModel*>(m_pModel.get());
+        if (liuModel != 0) {
+            const ControlProfile& profile = liuModel->controlProfile();
+            out << profile.sourceFraction() << ' '
+                << profile.externalDilationFraction() << ' '
+                << profile.internalDilationFraction() << '\n';
+        }
+
         return 0;
     }
 
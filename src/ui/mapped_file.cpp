@@ -0,0 +1,46 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_file.h"
+
+MappedFile::MappedFile(FILE* fptr) : m_data(0), m_size(0), m_mapped(false), m_buffer() {
+    struct stat info;
+    int fd = fileno(fptr);
+    size_t bytesRead;
+    char chunk[65536];
+
+    // Map regular files that are read from the beginning
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && ftell(fptr) == 0) {
+        m_size = info.st_size;
+        if (m_size == 0)
+            return;
+
+        void* address = mmap(0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            madvise(address, m_size, MADV_SEQUENTIAL);
+            m_data = static_cast<const char*>(address);
+            m_mapped = true;
+            return;
+        }
+    }
+
+    // Read everything else into a buffer
+    while ((bytesRead = fread(chunk, 1, sizeof(chunk), fptr)) > 0)
+        m_buffer.insert(m_buffer.end(), chunk, chunk + bytesRead);
+    if (ferror(fptr))
+        throw std::runtime_error(std::string("cannot read input: ") + strerror(errno));
+
+    m_size = m_buffer.size();
+    m_data = m_buffer.empty() ? 0 : &m_buffer[0];
+}
+
+MappedFile::~MappedFile() {
+    if (m_mapped)
+        munmap(const_cast<char*>(m_data), m_size);
+}
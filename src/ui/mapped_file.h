@@ -0,0 +1,60 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+/// Read-only view of the whole contents of an input stream
+/**
+ * Regular files are mapped into memory, so the readers can parse them in
+ * place and in parallel without copying them. Other streams (pipes, the
+ * standard input) are read into a buffer from their current position.
+ */
+class MappedFile {
+private:
+    /// The contents of the stream
+    const char* m_data;
+
+    /// The number of bytes in the stream
+    size_t m_size;
+
+    /// Whether \c m_data points to a memory mapping
+    bool m_mapped;
+
+    /// Buffer holding the contents of streams that cannot be mapped
+    std::vector<char> m_buffer;
+
+    /// Copying is not allowed
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+public:
+    /// Maps or reads the contents of the given stream
+    /**
+     * \throws std::runtime_error if the stream cannot be read
+     */
+    explicit MappedFile(FILE* fptr);
+
+    /// Unmaps the contents of the stream
+    ~MappedFile();
+
+    /// Returns a pointer to the first byte of the contents
+    const char* data() const {
+        return m_data;
+    }
+
+    /// Returns a pointer past the last byte of the contents
+    const char* end() const {
+        return m_data + m_size;
+    }
+
+    /// Returns the number of bytes in the contents
+    size_t size() const {
+        return m_size;
+    }
+};
+
+#endif       // _MAPPED_FILE_H
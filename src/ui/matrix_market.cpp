@@ -0,0 +1,257 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <igraph/cpp/edge.h>
+#include <netctrl/util/parallel.h>
+#include "matrix_market.h"
+#include "number_parser.h"
+
+using namespace igraph;
+using namespace netctrl;
+
+namespace {
+
+/// The entries found in a chunk of lines of a MatrixMarket file
+struct EntryChunk {
+    /// The row and column indices of the entries, interleaved, counted from one
+    std::vector<long int> entries;
+
+    /// The values of the entries
+    std::vector<double> values;
+};
+
+/// Returns whether the given character separates the fields of a line
+inline bool isBlank(char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+/// Finds the next field of a line
+/**
+ * \return \c false if there are no more fields in the line
+ */
+inline bool nextField(const char*& p, const char* lineEnd, const char*& field) {
+    while (p != lineEnd && isBlank(*p))
+        ++p;
+    if (p == lineEnd)
+        return false;
+    for (field = p; p != lineEnd && !isBlank(*p); ++p)
+        ;
+    return true;
+}
+
+/// Returns the end of the line that starts at the given position
+inline const char* lineEndOf(const char* p, const char* end) {
+    const char* result = static_cast<const char*>(memchr(p, '\n', end - p));
+    return result ? result : end;
+}
+
+/// Throws an exception about an invalid line of a MatrixMarket file
+void invalidLine(const char* what, const char* begin, const char* end) {
+    std::ostringstream oss;
+    oss << what << ": " << std::string(begin, std::min(end, begin + 80));
+    throw std::runtime_error(oss.str());
+}
+
+/// Parses the entries in the given chunk of lines
+void parseChunk(const char* p, const char* end, bool pattern, EntryChunk& chunk) {
+    const char *lineEnd, *field;
+    long int row, column;
+    double value;
+
+    while (p < end) {
+        lineEnd = lineEndOf(p, end);
+
+        const char* q = p;
+        if (nextField(q, lineEnd, field) && *field != '%') {
+            if (!parseNonNegativeInteger(field, q, &row) ||
+                    !nextField(q, lineEnd, field) ||
+                    !parseNonNegativeInteger(field, q, &column))
+                invalidLine("invalid MatrixMarket entry", p, lineEnd);
+
+            if (!pattern) {
+                if (!nextField(q, lineEnd, field) || !parseDouble(field, q, &value))
+                    invalidLine("invalid MatrixMarket entry", p, lineEnd);
+                chunk.values.push_back(value);
+            }
+
+            chunk.entries.push_back(row);
+            chunk.entries.push_back(column);
+        }
+
+        p = lineEnd + 1;
+    }
+}
+
+}          // end of anonymous namespace
+
+void CoordinateMatrix::edges(bool directed, std::vector<long int>& edges,
+        std::vector<double>* weights) const {
+    long int i, m = entryCount();
+
+    edges.clear();
+    edges.reserve(symmetric && directed ? 4*m : 2*m);
+    if (weights) {
+        weights->clear();
+        weights->reserve(symmetric && directed ? 2*m : m);
+    }
+
+    for (i = 0; i < m; i++) {
+        long int row = entries[2*i], column = entries[2*i+1];
+        double value = values.empty() ? 1.0 : values[i];
+
+        edges.push_back(row);
+        edges.push_back(column);
+        if (weights)
+            weights->push_back(value);
+
+        if (symmetric && directed && row != column) {
+            edges.push_back(column);
+            edges.push_back(row);
+            if (weights)
+                weights->push_back(value);
+        }
+    }
+}
+
+void readMatrixMarket(const MappedFile& file, CoordinateMatrix& matrix) {
+    const char *p = file.data(), *end = file.end(), *lineEnd, *field;
+    std::vector<std::string> banner;
+    long int i, nnz, numChunks;
+    bool pattern;
+
+    // The banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+    lineEnd = lineEndOf(p, end);
+    for (const char* q = p; nextField(q, lineEnd, field); ) {
+        std::string token(field, q);
+        std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+        banner.push_back(token);
+    }
+    if (banner.size() != 5 || banner[0] != "%%matrixmarket" || banner[1] != "matrix")
+        invalidLine("invalid MatrixMarket banner", p, lineEnd);
+    if (banner[2] != "coordinate") {
+        throw std::runtime_error("only the coordinate format of MatrixMarket "
+                "is supported, not " + banner[2]);
+    }
+    if (banner[3] != "real" && banner[3] != "double" && banner[3] != "integer" &&
+            banner[3] != "pattern") {
+        throw std::runtime_error("unsupported MatrixMarket field: " + banner[3]);
+    }
+    if (banner[4] != "general" && banner[4] != "symmetric" &&
+            banner[4] != "skew-symmetric" && banner[4] != "hermitian") {
+        throw std::runtime_error("unsupported MatrixMarket symmetry: " + banner[4]);
+    }
+    pattern = (banner[3] == "pattern");
+
+    // Comments, then the size line: <rows> <columns> <entries>
+    long int sizes[3];
+    for (p = lineEnd + 1; p < end; p = lineEnd + 1) {
+        const char* q = p;
+        lineEnd = lineEndOf(p, end);
+        if (!nextField(q, lineEnd, field) || *field == '%')
+            continue;
+
+        for (i = 0; i < 3; i++) {
+            if (i > 0 && !nextField(q, lineEnd, field))
+                break;
+            if (!parseNonNegativeInteger(field, q, &sizes[i]))
+                break;
+        }
+        if (i < 3)
+            invalidLine("invalid MatrixMarket size line", p, lineEnd);
+        break;
+    }
+    if (p >= end)
+        throw std::runtime_error("MatrixMarket file has no size line");
+    p = std::min(end, lineEnd + 1);
+
+    matrix.rowCount = sizes[0];
+    matrix.columnCount = sizes[1];
+    matrix.symmetric = (banner[4] != "general");
+    nnz = sizes[2];
+    if (matrix.symmetric && matrix.rowCount != matrix.columnCount)
+        throw std::runtime_error("symmetric MatrixMarket matrix is not square");
+
+    // The entries are split into chunks of about 4 MB at line boundaries
+    numChunks = p < end ? std::max(1L, static_cast<long int>((end - p) >> 22)) : 0;
+    std::vector<const char*> boundaries(numChunks + 1, end);
+    for (i = 0; i < numChunks; i++) {
+        const char* q = p + (end - p) / numChunks * i;
+        if (i > 0)
+            q = std::max(boundaries[i-1], std::min(end, lineEndOf(q, end) + 1));
+        boundaries[i] = q;
+    }
+
+    std::vector<EntryChunk> chunks(numChunks);
+    parallelFor(0, numChunks, [&](long int index) {
+        parseChunk(boundaries[index], boundaries[index + 1], pattern, chunks[index]);
+    });
+
+    // Concatenating the chunks in order and converting the indices
+    std::vector<long int> offsets(numChunks + 1, 0);
+    for (i = 0; i < numChunks; i++)
+        offsets[i + 1] = offsets[i] + chunks[i].entries.size() / 2;
+    if (offsets[numChunks] != nnz) {
+        std::ostringstream oss;
+        oss << "MatrixMarket file has " << offsets[numChunks]
+            << " entries instead of " << nnz;
+        throw std::runtime_error(oss.str());
+    }
+
+    matrix.entries.resize(2 * nnz);
+    matrix.values.resize(pattern ? 0 : nnz);
+    parallelFor(0, numChunks, [&](long int index) {
+        const EntryChunk& chunk = chunks[index];
+        long int j, k = offsets[index], count = chunk.entries.size() / 2;
+
+        for (j = 0; j < count; j++, k++) {
+            long int row = chunk.entries[2*j], column = chunk.entries[2*j+1];
+            if (row < 1 || row > matrix.rowCount || column < 1 || column > matrix.columnCount) {
+                std::ostringstream oss;
+                oss << "MatrixMarket entry out of range: " << row << " " << column;
+                throw std::runtime_error(oss.str());
+            }
+            matrix.entries[2*k] = row - 1;
+            matrix.entries[2*k+1] = column - 1;
+        }
+        if (!pattern)
+            std::copy(chunk.values.begin(), chunk.values.end(),
+                    matrix.values.begin() + offsets[index]);
+    });
+}
+
+Graph readMatrixMarketGraph(const MappedFile& file, bool directed) {
+    CoordinateMatrix matrix;
+    std::vector<long int> edges;
+    std::vector<double> weights;
+    long int i, m;
+
+    readMatrixMarket(file, matrix);
+    if (matrix.rowCount != matrix.columnCount) {
+        std::ostringstream oss;
+        oss << "adjacency matrix is not square: " << matrix.rowCount << " x "
+            << matrix.columnCount;
+        throw std::runtime_error(oss.str());
+    }
+
+    matrix.edges(directed, edges, &weights);
+    m = weights.size();
+
+    VectorInt edgeVector(edges.size());
+    std::copy(edges.begin(), edges.end(), edgeVector.begin());
+
+    Graph result(matrix.rowCount, directed);
+    result.addEdges(edgeVector);
+    if (std::find_if(weights.begin(), weights.end(),
+                [](double weight) { return weight != 1; }) != weights.end()) {
+        for (i = 0; i < m; i++)
+            result.edge(i).setAttribute("weight", weights[i]);
+    }
+
+    return result;
+}
@@ -0,0 +1,89 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _MATRIX_MARKET_H
+#define _MATRIX_MARKET_H
+
+#include <vector>
+#include <igraph/cpp/graph.h>
+#include "mapped_file.h"
+
+/// Sparse matrix in coordinate form, as read from a MatrixMarket file
+struct CoordinateMatrix {
+    /// The number of rows
+    long int rowCount;
+
+    /// The number of columns
+    long int columnCount;
+
+    /// The row and column indices of the stored entries, interleaved and
+    /// counted from zero
+    std::vector<long int> entries;
+
+    /// The values of the stored entries; empty for pattern matrices
+    std::vector<double> values;
+
+    /// Whether only the lower triangle of a symmetric matrix is stored.
+    /// Skew-symmetric and Hermitian matrices are symmetric as far as their
+    /// nonzero pattern is concerned, so they are flagged here as well.
+    bool symmetric;
+
+    CoordinateMatrix() : rowCount(0), columnCount(0), entries(), values(),
+        symmetric(false) {}
+
+    /// Returns the number of stored entries
+    long int entryCount() const {
+        return entries.size() / 2;
+    }
+
+    /**
+     * \brief Returns the edges of the graph whose adjacency matrix is this
+     *        matrix.
+     *
+     * The entry in row i and column j is an edge from vertex i to vertex j,
+     * as in the dense adjacency matrix readers. The missing upper triangle
+     * of a symmetric matrix is added if the graph is directed. Rectangular
+     * matrices give bipartite graphs whose row and column vertices overlap;
+     * this is fine for the structural rank, see \c structuralRank().
+     *
+     * \param  directed  whether the edges will be used in a directed graph
+     * \param  edges     the source and target vertices of the edges are
+     *                   returned here, interleaved
+     * \param  weights   if not null, the values of the entries belonging to
+     *                   the edges are returned here; all ones for pattern
+     *                   matrices
+     */
+    void edges(bool directed, std::vector<long int>& edges,
+            std::vector<double>* weights = 0) const;
+};
+
+/**
+ * \brief Reads a sparse matrix in the coordinate format of MatrixMarket.
+ *
+ * Real, integer and pattern matrices are supported, with general, symmetric,
+ * skew-symmetric or Hermitian symmetry; complex values and the dense array
+ * format are not. The entries are parsed in parallel on the threads of the
+ * library, in chunks of lines, and they are returned in the order of the
+ * file.
+ *
+ * \param  file    the contents of the file
+ * \param  matrix  the matrix is returned here
+ * \throws std::runtime_error if the file is malformed or not supported
+ */
+void readMatrixMarket(const MappedFile& file, CoordinateMatrix& matrix);
+
+/**
+ * \brief Reads a graph from a square sparse matrix in MatrixMarket format.
+ *
+ * See \c CoordinateMatrix::edges() for the orientation of the edges. If any
+ * edge has a weight different from 1, the weights are stored in the
+ * \c weight edge attribute.
+ *
+ * \param  file      the contents of the file
+ * \param  directed  whether the graph is directed. If not, only the stored
+ *                   entries of symmetric matrices are used.
+ * \throws std::runtime_error if the file is malformed or the matrix is not
+ *         square
+ */
+igraph::Graph readMatrixMarketGraph(const MappedFile& file, bool directed);
+
+#endif       // _MATRIX_MARKET_H
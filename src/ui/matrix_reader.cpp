@@ -0,0 +1,298 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <igraph/cpp/edge.h>
+#include <igraph/cpp/vertex.h>
+#include <netctrl/util/kernels.h>
+#include <netctrl/util/parallel.h>
+#include "matrix_reader.h"
+#include "number_parser.h"
+
+using namespace igraph;
+using namespace netctrl;
+
+namespace {
+
+/// The edges found in a block of consecutive rows of a matrix
+struct RowBlock {
+    /// The targets of the edges, row by row
+    std::vector<long int> targets;
+
+    /// The number of edges in each row of the block
+    std::vector<long int> rowSizes;
+
+    /// The weights of the edges
+    std::vector<double> weights;
+};
+
+/// Returns whether the given character separates the fields of a text matrix
+inline bool isSeparator(char ch) {
+    return ch == ',' || ch == ';' || ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+/// Splits a line of a text matrix into fields
+void splitFields(const char* begin, const char* end,
+        std::vector<std::pair<const char*, const char*> >& fields) {
+    const char* fieldStart;
+
+    fields.clear();
+    while (begin != end) {
+        while (begin != end && isSeparator(*begin))
+            ++begin;
+        if (begin == end)
+            break;
+        fieldStart = begin;
+        while (begin != end && !isSeparator(*begin))
+            ++begin;
+        fields.push_back(std::make_pair(fieldStart, begin));
+    }
+}
+
+/// Removes the double quotes around a name in a text matrix
+std::string unquote(const char* begin, const char* end) {
+    if (end - begin >= 2 && *begin == '"' && *(end - 1) == '"')
+        return std::string(begin + 1, end - 1);
+    return std::string(begin, end);
+}
+
+/// Returns whether the given field of a text matrix is a number
+bool isNumber(const std::pair<const char*, const char*>& field) {
+    double value;
+    return parseDouble(field.first, field.second, &value);
+}
+
+/// Returns whether the first line of a text matrix is a header
+/**
+ * The line is a header if any of its fields after the first one is not a
+ * number, or if none of its fields are numbers. The first field alone may
+ * be the name of the vertex of the row.
+ */
+bool isHeader(const std::vector<std::pair<const char*, const char*> >& fields) {
+    size_t i, numbers = 0;
+
+    for (i = 0; i < fields.size(); i++) {
+        if (isNumber(fields[i]))
+            numbers++;
+        else if (i > 0)
+            return true;
+    }
+
+    return numbers == 0;
+}
+
+/// Finds the lines of a text matrix that are not empty and not comments
+void findLines(const MappedFile& file,
+        std::vector<std::pair<const char*, const char*> >& lines) {
+    const char *p = file.data(), *end = file.end(), *lineEnd, *first;
+
+    lines.clear();
+    while (p < end) {
+        lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (lineEnd == 0)
+            lineEnd = end;
+
+        for (first = p; first != lineEnd && isSeparator(*first); ++first)
+            ;
+        if (first != lineEnd && *first != '#' && *first != '%')
+            lines.push_back(std::make_pair(p, lineEnd));
+
+        p = lineEnd + 1;
+    }
+}
+
+/// Appends the entries of a row that are above the threshold to a block
+template <typename T>
+void selectRow(const T* values, long int row, long int n, T threshold, bool directed,
+        std::vector<long int>& indices, RowBlock& block) {
+    long int offset = directed ? 0 : row, i, count;
+
+    count = selectAboveThreshold(values + offset, n - offset, threshold, &indices[0]);
+    for (i = 0; i < count; i++) {
+        block.targets.push_back(indices[i] + offset);
+        block.weights.push_back(values[indices[i] + offset]);
+    }
+    block.rowSizes.push_back(count);
+}
+
+/// Builds the graph from the edges found in the blocks of rows
+Graph buildGraph(long int n, bool directed, const std::vector<RowBlock>& blocks,
+        long int blockSize) {
+    long int i, j, k, numBlocks = blocks.size();
+    std::vector<long int> offsets(numBlocks + 1, 0);
+    bool weighted = false;
+
+    for (i = 0; i < numBlocks; i++) {
+        offsets[i + 1] = offsets[i] + blocks[i].targets.size();
+        for (j = 0; !weighted && j < static_cast<long int>(blocks[i].weights.size()); j++)
+            weighted = blocks[i].weights[j] != 1;
+    }
+
+    // The edges are emitted in the order of their sources
+    VectorInt edges(2 * offsets[numBlocks]);
+    parallelFor(0, numBlocks, [&](long int index) {
+        const RowBlock& block = blocks[index];
+        long int row, t, position = 2 * offsets[index], source = index * blockSize;
+        std::vector<long int>::const_iterator target = block.targets.begin();
+
+        for (row = 0; row < static_cast<long int>(block.rowSizes.size()); row++, source++) {
+            for (t = 0; t < block.rowSizes[row]; t++, ++target) {
+                edges[position++] = source;
+                edges[position++] = *target;
+            }
+        }
+    });
+
+    Graph result(n, directed);
+    result.addEdges(edges);
+
+    if (weighted) {
+        for (i = 0, k = 0; i < numBlocks; i++) {
+            for (j = 0; j < static_cast<long int>(blocks[i].weights.size()); j++, k++)
+                result.edge(k).setAttribute("weight", blocks[i].weights[j]);
+        }
+    }
+
+    return result;
+}
+
+/// Reads a raw binary matrix with entries of type T
+template <typename T>
+Graph readBinaryMatrix(const MappedFile& file, T threshold, bool directed) {
+    long int count = file.size() / sizeof(T);
+    long int n = static_cast<long int>(std::sqrt(static_cast<double>(count)) + 0.5);
+    long int blockSize, numBlocks;
+    const T* values = reinterpret_cast<const T*>(file.data());
+
+    if (file.size() % sizeof(T) != 0 || n * n != count) {
+        std::ostringstream oss;
+        oss << "binary matrix is not square: " << file.size() << " bytes";
+        throw std::runtime_error(oss.str());
+    }
+
+    blockSize = std::max(1L, (1L << 20) / std::max(1L, n));
+    numBlocks = (n + blockSize - 1) / blockSize;
+
+    std::vector<RowBlock> blocks(numBlocks);
+    parallelFor(0, numBlocks, [&](long int index) {
+        std::vector<long int> indices(n);
+        long int row, end = std::min(n, (index + 1) * blockSize);
+
+        for (row = index * blockSize; row < end; row++)
+            selectRow(values + row * n, row, n, threshold, directed, indices, blocks[index]);
+    });
+
+    return buildGraph(n, directed, blocks, blockSize);
+}
+
+/// Reads a text matrix
+Graph readTextMatrix(const MappedFile& file, double threshold, bool directed) {
+    std::vector<std::pair<const char*, const char*> > lines, fields;
+    std::vector<std::string> names;
+    long int i, n, blockSize, numBlocks, firstRow = 0;
+    bool hasRowNames = false;
+
+    findLines(file, lines);
+    if (lines.empty())
+        return Graph(0, directed);
+
+    // The first line may be a header; data rows may start with the name of
+    // their vertex
+    splitFields(lines[0].first, lines[0].second, fields);
+    if (isHeader(fields)) {
+        for (i = 0; i < static_cast<long int>(fields.size()); i++)
+            names.push_back(unquote(fields[i].first, fields[i].second));
+        firstRow = 1;
+    }
+    n = lines.size() - firstRow;
+
+    if (n > 0) {
+        splitFields(lines[firstRow].first, lines[firstRow].second, fields);
+        hasRowNames = !fields.empty() && !isNumber(fields[0]);
+    }
+    if (names.size() == static_cast<size_t>(n + 1))
+        names.erase(names.begin());
+    if (!names.empty() && names.size() != static_cast<size_t>(n)) {
+        std::ostringstream oss;
+        oss << "matrix header has " << names.size() << " names for " << n << " rows";
+        throw std::runtime_error(oss.str());
+    }
+    if (hasRowNames && names.empty())
+        names.resize(n);
+
+    blockSize = std::max(1L, (1L << 20) / std::max(1L, n));
+    numBlocks = (n + blockSize - 1) / blockSize;
+
+    std::vector<RowBlock> blocks(numBlocks);
+    parallelFor(0, numBlocks, [&](long int index) {
+        std::vector<double> values(n);
+        std::vector<long int> indices(n);
+        long int row, j, end = std::min(n, (index + 1) * blockSize);
+
+        for (row = index * blockSize; row < end; row++) {
+            const char *p = lines[firstRow + row].first, *lineEnd = lines[firstRow + row].second;
+            const char* field;
+
+            // The fields are parsed as they are found, without splitting
+            // the line first
+            for (j = hasRowNames ? -1 : 0; ; j++) {
+                while (p != lineEnd && isSeparator(*p))
+                    ++p;
+                if (p == lineEnd)
+                    break;
+                for (field = p; p != lineEnd && !isSeparator(*p); ++p)
+                    ;
+
+                if (j < 0) {
+                    if (firstRow == 0)
+                        names[row] = unquote(field, p);
+                } else if (j >= n || !parseDouble(field, p, &values[j])) {
+                    std::ostringstream oss;
+                    if (j >= n)
+                        oss << "row " << row + 1 << " of the matrix has more than "
+                            << n << " entries";
+                    else
+                        oss << "invalid matrix entry in row " << row + 1 << ": "
+                            << std::string(field, p);
+                    throw std::runtime_error(oss.str());
+                }
+            }
+            if (j != n) {
+                std::ostringstream oss;
+                oss << "row " << row + 1 << " of the matrix has " << std::max(j, 0L)
+                    << " entries instead of " << n;
+                throw std::runtime_error(oss.str());
+            }
+
+            selectRow(&values[0], row, n, threshold, directed, indices, blocks[index]);
+        }
+    });
+
+    Graph result = buildGraph(n, directed, blocks, blockSize);
+    for (i = 0; i < static_cast<long int>(names.size()); i++)
+        result.vertex(i).setAttribute("name", names[i]);
+
+    return result;
+}
+
+}          // end of anonymous namespace
+
+Graph readDenseMatrix(const MappedFile& file, MatrixEncoding encoding,
+        double threshold, bool directed) {
+    switch (encoding) {
+        case MATRIX_FLOAT32:
+            return readBinaryMatrix<float>(file, threshold, directed);
+
+        case MATRIX_UINT8:
+            return readBinaryMatrix<uint8_t>(file,
+                    static_cast<uint8_t>(std::min(std::floor(threshold), 255.0)), directed);
+
+        default:
+            return readTextMatrix(file, threshold, directed);
+    }
+}
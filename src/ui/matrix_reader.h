@@ -0,0 +1,51 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _MATRIX_READER_H
+#define _MATRIX_READER_H
+
+#include <igraph/cpp/graph.h>
+#include "mapped_file.h"
+
+/// Encodings of dense adjacency matrices
+typedef enum {
+    /// Text with one row per line and numbers separated by commas,
+    /// semicolons or whitespace
+    MATRIX_TEXT,
+
+    /// Raw single precision floating point numbers in native byte order,
+    /// row by row
+    MATRIX_FLOAT32,
+
+    /// Raw unsigned bytes, row by row
+    MATRIX_UINT8
+} MatrixEncoding;
+
+/**
+ * \brief Reads a graph from a dense adjacency matrix.
+ *
+ * The entry in row i and column j of the matrix is the weight of the edge
+ * from vertex i to vertex j; entries whose absolute value is not larger than
+ * the threshold are not edges. If any edge has a weight different from 1,
+ * the weights are stored in the \c weight edge attribute.
+ *
+ * Raw binary matrices must be square; their size is inferred from the size
+ * of the file. Text matrices may have a header line with the names of the
+ * vertices, and each row may start with the name of its vertex; the names
+ * are stored in the \c name vertex attribute. Empty lines and lines
+ * starting with \c # or \c % are ignored.
+ *
+ * The rows are parsed and thresholded in parallel on the threads of the
+ * library, and the edges are emitted in the order of their source vertices
+ * so they form the rows of a compressed sparse row representation.
+ *
+ * \param  file       the contents of the file
+ * \param  encoding   the encoding of the matrix
+ * \param  threshold  the threshold of the absolute values of the entries
+ * \param  directed   whether the graph is directed. If not, only the upper
+ *                    triangle of the matrix (including the diagonal) is read.
+ * \throws std::runtime_error if the matrix is malformed
+ */
+igraph::Graph readDenseMatrix(const MappedFile& file, MatrixEncoding encoding,
+        double threshold, bool directed);
+
+#endif       // _MATRIX_READER_H
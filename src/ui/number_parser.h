@@ -0,0 +1,117 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _NUMBER_PARSER_H
+#define _NUMBER_PARSER_H
+
+#include <cstdlib>
+#include <string>
+
+/// Parses a non-negative integer from a range of characters
+/**
+ * \param  begin  the first character
+ * \param  end    the character after the last one
+ * \param  value  the parsed value is returned here
+ * \return \c true if the whole range is a valid integer that fits in a
+ *         \c long \c int
+ */
+inline bool parseNonNegativeInteger(const char* begin, const char* end, long int* value) {
+    long int result = 0;
+
+    if (begin == end || end - begin > 18)
+        return false;
+
+    for (; begin != end; ++begin) {
+        unsigned int digit = static_cast<unsigned char>(*begin) - '0';
+        if (digit > 9)
+            return false;
+        result = result * 10 + digit;
+    }
+
+    *value = result;
+    return true;
+}
+
+/// Parses a floating point number from a range of characters
+/**
+ * Numbers with at most 15 significant digits and a small decimal exponent
+ * are converted directly, which is exact since both the digits and the
+ * power of ten are representable as doubles. Everything else, including
+ * \c inf and \c nan, is handed over to \c strtod().
+ *
+ * \param  begin  the first character
+ * \param  end    the character after the last one
+ * \param  value  the parsed value is returned here
+ * \return \c true if the whole range is a valid number
+ */
+inline bool parseDouble(const char* begin, const char* end, double* value) {
+    static const double powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = begin;
+    unsigned long long mantissa = 0;
+    long int digits = 0, exponent = 0, explicitExponent = 0;
+    bool negative = false, negativeExponent = false, anyDigits = false;
+
+    if (p != end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    // Integer part; leading zeros are not significant
+    for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+        anyDigits = true;
+        if (mantissa == 0 && *p == '0')
+            continue;
+        if (digits < 19)
+            mantissa = mantissa * 10 + (*p - '0');
+        else
+            exponent++;
+        digits++;
+    }
+
+    // Fractional part
+    if (p != end && *p == '.') {
+        for (++p; p != end && *p >= '0' && *p <= '9'; ++p) {
+            anyDigits = true;
+            if (mantissa == 0 && *p == '0') {
+                exponent--;
+                continue;
+            }
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+            digits++;
+        }
+    }
+
+    // Exponent
+    if (anyDigits && p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        if (p != end && (*p == '-' || *p == '+'))
+            negativeExponent = (*p++ == '-');
+        if (p == end || *p < '0' || *p > '9')
+            return false;
+        for (; p != end && *p >= '0' && *p <= '9'; ++p) {
+            if (explicitExponent < 100000)
+                explicitExponent = explicitExponent * 10 + (*p - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (anyDigits && p == end && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double result = static_cast<double>(mantissa);
+        result = exponent < 0 ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+        *value = negative ? -result : result;
+        return true;
+    }
+
+    // Slow path: hand over a null-terminated copy to strtod()
+    std::string copy(begin, end);
+    char* stop;
+    if (copy.empty())
+        return false;
+    *value = strtod(copy.c_str(), &stop);
+    return *stop == 0;
+}
+
+#endif       // _NUMBER_PARSER_H
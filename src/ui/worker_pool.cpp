@@ -0,0 +1,232 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "worker_pool.h"
+
+namespace {
+
+/// Slot of the result ring in shared memory
+/**
+ * The sequence number of a slot tells who may touch it next: a producer
+ * that reserved ring position \c p waits until it becomes \c p, then fills
+ * the slot and sets it to <tt>p+1</tt>. The parent waits for <tt>p+1</tt>,
+ * reads the slot and sets it to <tt>p+capacity</tt>, handing the slot over
+ * to the producer of the next round. The results of the trial are stored
+ * in the values area of the ring at the same index as the slot.
+ */
+struct RingSlot {
+    std::atomic<long int> sequence;
+    long int trial;
+};
+
+/// Header of the shared memory block used by a worker pool
+struct RingHeader {
+    /// Index of the next trial to be taken by a worker
+    std::atomic<long int> nextTrial;
+
+    /// Next ring position to be reserved by a worker
+    std::atomic<long int> writePosition;
+};
+
+/// Sleeps a little while waiting for the other processes
+void backOff() {
+    struct timespec delay = { 0, 50000 };
+    nanosleep(&delay, 0);
+}
+
+/// Body of a worker process
+/**
+ * \return  the exit code of the worker
+ */
+int runWorker(TrialTask& task, long int numTrials, RingHeader* header,
+        RingSlot* slots, double* values, size_t capacity) {
+    size_t resultSize = task.resultSize();
+    std::vector<double> results(resultSize);
+    long int trial, position;
+
+    try {
+        while ((trial = header->nextTrial.fetch_add(1)) < numTrials) {
+            task.run(trial, &results[0]);
+
+            position = header->writePosition.fetch_add(1);
+            RingSlot& slot = slots[position % capacity];
+            while (slot.sequence.load(std::memory_order_acquire) != position)
+                backOff();
+
+            slot.trial = trial;
+            std::copy(results.begin(), results.end(),
+                    values + (position % capacity) * resultSize);
+            slot.sequence.store(position + 1, std::memory_order_release);
+        }
+    } catch (const std::exception& ex) {
+        fprintf(stderr, "worker %ld failed: %s\n", (long int)getpid(), ex.what());
+        return 1;
+    } catch (...) {
+        fprintf(stderr, "worker %ld failed\n", (long int)getpid());
+        return 1;
+    }
+
+    return 0;
+}
+
+/// Reaps the workers that have exited already
+/**
+ * \return  \c false if one of the workers exited abnormally
+ */
+bool reapWorkers(std::vector<pid_t>& pids, int flags) {
+    bool ok = true;
+    size_t i = 0;
+    int status;
+    pid_t pid;
+
+    while (i < pids.size()) {
+        pid = waitpid(pids[i], &status, flags);
+        if (pid == 0 || (pid < 0 && errno == EINTR)) {
+            i++;
+            continue;
+        }
+        if (pid < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ok = false;
+        pids[i] = pids.back();
+        pids.pop_back();
+    }
+
+    return ok;
+}
+
+/// Terminates and reaps all the workers that are still running
+void killWorkers(std::vector<pid_t>& pids) {
+    for (size_t i = 0; i < pids.size(); i++)
+        kill(pids[i], SIGTERM);
+    reapWorkers(pids, 0);
+}
+
+}          // end of anonymous namespace
+
+int numberOfCPUCores() {
+    long int result = sysconf(_SC_NPROCESSORS_ONLN);
+    return result > 0 ? result : 1;
+}
+
+void* allocateSharedMemory(size_t size) {
+    void* result = mmap(0, size, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (result == MAP_FAILED)
+        throw std::runtime_error(std::string("cannot map shared memory: ") + strerror(errno));
+    return result;
+}
+
+void freeSharedMemory(void* ptr, size_t size) {
+    munmap(ptr, size);
+}
+
+WorkerPool::WorkerPool(int numWorkers, size_t ringCapacity)
+    : m_numWorkers(numWorkers), m_ringCapacity(ringCapacity) {
+    if (m_numWorkers <= 0)
+        m_numWorkers = numberOfCPUCores();
+    if (m_ringCapacity == 0)
+        m_ringCapacity = 1;
+}
+
+void WorkerPool::run(TrialTask& task, long int numTrials, std::vector<double>& results) {
+    long int i, position, numWorkers = m_numWorkers;
+    size_t resultSize = task.resultSize();
+    std::vector<pid_t> pids;
+    size_t blockSize;
+    void* block;
+    bool ok = true;
+
+    results.assign(numTrials > 0 ? numTrials * resultSize : 0, 0.0);
+    if (numTrials <= 0)
+        return;
+
+    if (numWorkers > numTrials)
+        numWorkers = numTrials;
+
+    if (numWorkers <= 1) {
+        for (i = 0; i < numTrials; i++)
+            task.run(i, &results[i * resultSize]);
+        return;
+    }
+
+    // Set up the ring in shared memory; the values area follows the slots
+    blockSize = sizeof(RingHeader) + m_ringCapacity * sizeof(RingSlot) +
+        m_ringCapacity * resultSize * sizeof(double);
+    block = allocateSharedMemory(blockSize);
+
+    RingHeader* header = new (block) RingHeader;
+    RingSlot* slots = reinterpret_cast<RingSlot*>(header + 1);
+    double* values = reinterpret_cast<double*>(slots + m_ringCapacity);
+    header->nextTrial = 0;
+    header->writePosition = 0;
+    for (size_t j = 0; j < m_ringCapacity; j++) {
+        new (slots + j) RingSlot;
+        slots[j].sequence = j;
+    }
+
+    // Start the workers. Pending output is flushed first so it does not get
+    // duplicated; the workers leave with _exit() and never flush anything
+    // they inherited from us.
+    fflush(0);
+    for (i = 0; i < numWorkers; i++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            int errorCode = errno;
+            killWorkers(pids);
+            freeSharedMemory(block, blockSize);
+            throw std::runtime_error(std::string("cannot start worker process: ") +
+                    strerror(errorCode));
+        }
+        if (pid == 0) {
+            int exitCode = runWorker(task, numTrials, header, slots, values,
+                    m_ringCapacity);
+            fflush(stderr);
+            _exit(exitCode);
+        }
+        pids.push_back(pid);
+    }
+
+    // Collect the results
+    for (position = 0; ok && position < numTrials; position++) {
+        RingSlot& slot = slots[position % m_ringCapacity];
+        while (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            if (!reapWorkers(pids, WNOHANG) || pids.empty()) {
+                // Either a worker died or everyone exited without
+                // producing this result; check the slot once more since
+                // the last worker might have filled it before exiting
+                ok = slot.sequence.load(std::memory_order_acquire) == position + 1;
+                break;
+            }
+            backOff();
+        }
+        if (!ok)
+            break;
+
+        const double* slotValues = values + (position % m_ringCapacity) * resultSize;
+        std::copy(slotValues, slotValues + resultSize, &results[slot.trial * resultSize]);
+        slot.sequence.store(position + m_ringCapacity, std::memory_order_release);
+    }
+
+    if (ok)
+        ok = reapWorkers(pids, 0);
+    else
+        killWorkers(pids);
+
+    freeSharedMemory(block, blockSize);
+
+    if (!ok)
+        throw std::runtime_error("a worker process failed before finishing its trials");
+}
@@ -0,0 +1,134 @@
+/* vim:set ts=4 sw=4 sts=4 et: */
+
+#ifndef _WORKER_POOL_H
+#define _WORKER_POOL_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+/// Returns the number of online CPU cores
+int numberOfCPUCores();
+
+/// Allocates a memory block that is shared with forked child processes
+/**
+ * \throws std::runtime_error if the block cannot be mapped
+ */
+void* allocateSharedMemory(size_t size);
+
+/// Releases a memory block allocated with allocateSharedMemory()
+void freeSharedMemory(void* ptr, size_t size);
+
+/// Fixed-size array living in memory that is shared with forked workers
+/**
+ * The array is mapped before the workers are forked so each worker sees the
+ * same physical pages instead of a copy-on-write snapshot of the parent.
+ * Only plain old data types may be stored in it.
+ */
+template <typename T>
+class SharedArray {
+private:
+    /// Pointer to the first element
+    T* m_data;
+
+    /// Number of elements
+    size_t m_size;
+
+    /// Copying is not allowed
+    SharedArray(const SharedArray&);
+    SharedArray& operator=(const SharedArray&);
+
+public:
+    /// Maps a new zero-initialized shared array with the given size
+    explicit SharedArray(size_t size) : m_data(0), m_size(size) {
+        if (size > 0)
+            m_data = static_cast<T*>(allocateSharedMemory(size * sizeof(T)));
+    }
+
+    /// Unmaps the array
+    ~SharedArray() {
+        if (m_data != 0)
+            freeSharedMemory(m_data, m_size * sizeof(T));
+    }
+
+    T* begin() { return m_data; }
+    const T* begin() const { return m_data; }
+    T* end() { return m_data + m_size; }
+    const T* end() const { return m_data + m_size; }
+
+    T& operator[](size_t index) { return m_data[index]; }
+    const T& operator[](size_t index) const { return m_data[index]; }
+
+    /// Returns the number of elements in the array
+    size_t size() const { return m_size; }
+};
+
+/// Abstract superclass for tasks consisting of many independent trials
+class TrialTask {
+public:
+    /// Virtual destructor that does nothing
+    virtual ~TrialTask() {}
+
+    /// Returns the number of numeric results that each trial produces
+    virtual size_t resultSize() const {
+        return 1;
+    }
+
+    /// Runs the trial with the given index and stores its numeric results
+    /**
+     * Trials may be executed in any order and in any process, so the
+     * results must depend only on the trial index and on the state that
+     * the task had when the workers were forked.
+     *
+     * \param  trial    the index of the trial
+     * \param  results  array of \c resultSize() elements where the results
+     *                  of the trial must be stored
+     */
+    virtual void run(long int trial, double* results) = 0;
+};
+
+/// Runs the trials of a \c TrialTask in a pool of forked worker processes
+/**
+ * Each worker is a separate process with its own copy of igraph's global
+ * state (random number generator, error and attribute handlers), so the
+ * trials do not need to be thread-safe. Workers take trial indices from a
+ * shared counter and send their results back to the parent through a ring
+ * buffer in shared memory; each slot of the ring holds all the results of
+ * a trial.
+ *
+ * With a single worker, the trials are executed in the calling process.
+ */
+class WorkerPool {
+private:
+    /// Number of worker processes to use
+    int m_numWorkers;
+
+    /// Number of slots in the result ring
+    size_t m_ringCapacity;
+
+public:
+    /// Constructs a pool with the given number of workers
+    /**
+     * Zero or negative values mean one worker per online CPU core.
+     */
+    explicit WorkerPool(int numWorkers = 1, size_t ringCapacity = 256);
+
+    /// Returns the number of worker processes that the pool uses
+    int numWorkers() const {
+        return m_numWorkers;
+    }
+
+    /// Runs the given number of trials and collects their results
+    /**
+     * \param  task       the task whose trials are to be executed
+     * \param  numTrials  the number of trials
+     * \param  results    the results of the trials are returned here; the
+     *                    j-th result of trial \c i is element
+     *                    <tt>i * task.resultSize() + j</tt>
+     * \throws std::runtime_error if a worker could not be started or did
+     *         not finish its trials
+     */
+    void run(TrialTask& task, long int numTrials, std::vector<double>& results);
+};
+
+#endif       // _WORKER_POOL_H